@@ -53,7 +53,13 @@ namespace WPEFramework
           mLifecycleManagerStateRemoteObject(nullptr),
           mNotification(*this),
           mCurrentservice(nullptr),
-          mAppIdAwaitingPause("")
+          mLoadedAppsStale(true),
+          mLoadedAppsPayload(""),
+          mLoadedApps(),
+          mLoadedAppsResult(""),
+          mAppStates(),
+          mStateWaiters(),
+          mAppStateEvents(0)
         {
             LOGINFO("Create LifecycleInterfaceConnector Instance");
             LifecycleInterfaceConnector::_instance = this;
@@ -99,6 +105,8 @@ namespace WPEFramework
                 mLifecycleManagerStateRemoteObject->AddRef();
                 mLifecycleManagerStateRemoteObject->Register(&mNotification);
                 LOGINFO("LifecycleManagerState notification registered");
+                invalidateLoadedApps();
+                clearAppStates();
 
                 status = Core::ERROR_NONE;
             }
@@ -107,6 +115,9 @@ namespace WPEFramework
 
         void LifecycleInterfaceConnector::releaseLifecycleManagerRemoteObject()
         {
+            invalidateLoadedApps();
+            /* without the notification the mirror can no longer be trusted */
+            clearAppStates();
             ASSERT(nullptr != mLifecycleManagerRemoteObject );
             if(mLifecycleManagerRemoteObject )
             {
@@ -126,6 +137,21 @@ namespace WPEFramework
         Core::hresult LifecycleInterfaceConnector::isAppLoaded(const string& appId, bool& loaded)
         {
             Core::hresult status = Core::ERROR_GENERAL;
+
+            mAppStateLock.Lock();
+            std::unordered_map<string, AppState>::const_iterator known = mAppStates.find(appId);
+            if (known != mAppStates.end())
+            {
+                loaded = (known->second.state != Exchange::ILifecycleManager::LifecycleState::UNLOADED);
+                status = Core::ERROR_NONE;
+            }
+            mAppStateLock.Unlock();
+
+            if (Core::ERROR_NONE == status)
+            {
+                return status;
+            }
+
             mAdminLock.Lock();
             /* Checking if mLifecycleManagerRemoteObject is not valid then create the object */
             if (nullptr == mLifecycleManagerRemoteObject)
@@ -140,12 +166,93 @@ namespace WPEFramework
 
             if (nullptr != mLifecycleManagerRemoteObject)
             {
+                const uint32_t events = mAppStateEvents.load();
                 status = mLifecycleManagerRemoteObject->IsAppLoaded(appId, loaded);
+
+                /* First question about this app, from now on the state events keep the answer current */
+                mAppStateLock.Lock();
+                if ((Core::ERROR_NONE == status) && (events == mAppStateEvents.load()) && (mAppStates.find(appId) == mAppStates.end()))
+                {
+                    AppState& appState = mAppStates[appId];
+                    appState.appInstanceId = GetAppInstanceId(appId);
+                    /* the exact state is unknown until the next event, only loaded/unloaded is used from it */
+                    appState.state = loaded ? Exchange::ILifecycleManager::LifecycleState::INITIALIZING : Exchange::ILifecycleManager::LifecycleState::UNLOADED;
+                }
+                mAppStateLock.Unlock();
             }
             mAdminLock.Unlock();
             return status;
         }
 
+        /* Records an app state reported by LifecycleManager and releases whoever waits for it */
+        void LifecycleInterfaceConnector::updateAppState(const string& appId, const string& appInstanceId, const Exchange::ILifecycleManager::LifecycleState state)
+        {
+            mAppStateLock.Lock();
+            mAppStateEvents++;
+
+            AppState& appState = mAppStates[appId];
+            appState.appInstanceId = appInstanceId;
+            appState.state = state;
+
+            std::unordered_map<string, std::shared_ptr<StateWaiter>>::iterator waiter = mStateWaiters.find(appId);
+            if ((waiter != mStateWaiters.end()) && (waiter->second->state == state))
+            {
+                waiter->second->reached.set_value();
+                mStateWaiters.erase(waiter);
+            }
+            mAppStateLock.Unlock();
+        }
+
+        /* SpawnApp succeeded, an app still mirrored as unloaded is loading now even if no event arrived yet.
+         * The target state is not reached yet, the state events record it once it is.
+         */
+        void LifecycleInterfaceConnector::appSpawned(const string& appId, const string& appInstanceId)
+        {
+            mAppStateLock.Lock();
+            std::unordered_map<string, AppState>::iterator known = mAppStates.find(appId);
+            if ((known == mAppStates.end()) || (known->second.state == Exchange::ILifecycleManager::LifecycleState::UNLOADED))
+            {
+                AppState& appState = mAppStates[appId];
+                appState.appInstanceId = appInstanceId;
+                appState.state = Exchange::ILifecycleManager::LifecycleState::LOADING;
+            }
+            mAppStateLock.Unlock();
+        }
+
+        void LifecycleInterfaceConnector::clearAppStates()
+        {
+            mAppStateLock.Lock();
+            mAppStateEvents++;
+            mAppStates.clear();
+            mAppStateLock.Unlock();
+        }
+
+        /* Must be called before the state is requested, so an event arriving right after the request is not missed */
+        std::shared_future<void> LifecycleInterfaceConnector::expectAppState(const string& appId, const Exchange::ILifecycleManager::LifecycleState state)
+        {
+            std::shared_future<void> result;
+
+            mAppStateLock.Lock();
+            std::shared_ptr<StateWaiter>& waiter = mStateWaiters[appId];
+            if ((nullptr == waiter) || (waiter->state != state))
+            {
+                waiter = std::make_shared<StateWaiter>();
+                waiter->state = state;
+                waiter->future = waiter->reached.get_future().share();
+            }
+            result = waiter->future;
+            mAppStateLock.Unlock();
+
+            return result;
+        }
+
+        void LifecycleInterfaceConnector::cancelAppState(const string& appId)
+        {
+            mAppStateLock.Lock();
+            mStateWaiters.erase(appId);
+            mAppStateLock.Unlock();
+        }
+
 
 /*
  * @brief LaunchApp invokes this to call LifecycleManager API.
@@ -154,6 +261,7 @@ namespace WPEFramework
  */
         Core::hresult LifecycleInterfaceConnector::launch(const string& appId, const string& intent, const string& launchArgs, WPEFramework::Exchange::RuntimeConfig& runtimeConfigObject)
         {
+            invalidateLoadedApps();
             Core::hresult status = Core::ERROR_GENERAL;
             AppManagerImplementation*appManagerImplInstance = AppManagerImplementation::getInstance();
             bool loaded = false;
@@ -224,6 +332,7 @@ namespace WPEFramework
                             if (status == Core::ERROR_NONE)
                             {
                                 LOGINFO("Update App Info");
+                                appSpawned(appId, appInstanceId);
                                 it->second.appInstanceId   = std::move(appInstanceId);
                                 it->second.appIntent       = intent;
                                 it->second.packageInfo.type = AppManagerImplementation::APPLICATION_TYPE_INTERACTIVE;
@@ -246,6 +355,7 @@ namespace WPEFramework
         /* PreloadApp invokes it */
         Core::hresult LifecycleInterfaceConnector::preLoadApp(const string& appId, const string& launchArgs, WPEFramework::Exchange::RuntimeConfig& runtimeConfigObject, string& error)
         {
+            invalidateLoadedApps();
             Core::hresult status = Core::ERROR_GENERAL;
             AppManagerImplementation *appManagerImplInstance = AppManagerImplementation::getInstance();
 
@@ -287,6 +397,7 @@ namespace WPEFramework
                     if (status == Core::ERROR_NONE)
                     {
                         LOGINFO("Update App Info");
+                        appSpawned(appId, appInstanceId);
 
                         /*Insert/update loaded app info*/
                         if (nullptr != appManagerImplInstance)
@@ -311,6 +422,7 @@ namespace WPEFramework
         /* Close App invokes it */
         Core::hresult LifecycleInterfaceConnector::closeApp(const string& appId)
         {
+            invalidateLoadedApps();
             uint32_t status = Core::ERROR_GENERAL;
             std::string appInstanceId = "";
             std::string appIntent = "";
@@ -335,17 +447,18 @@ namespace WPEFramework
                         {
                             appManagerImplInstance->updateCurrentAction(appId, AppManagerImplementation::APP_ACTION_CLOSE);
 
+                            std::shared_future<void> paused = expectAppState(appId, Exchange::ILifecycleManager::LifecycleState::PAUSED);
                             status = mLifecycleManagerRemoteObject->SetTargetAppState(appInstanceId, Exchange::ILifecycleManager::LifecycleState::PAUSED, appIntent);
 
                             if(status == Core::ERROR_NONE)
                             {
                                 LOGINFO("Requested PAUSED state for appId: %s. Waiting for PAUSED confirmation...", appId.c_str());
 
-                                mAppIdAwaitingPause = appId;
+                                /* Only this app's state event completes the wait, operations on other apps proceed meanwhile */
                                 mAdminLock.Unlock();
+                                if (paused.wait_for(std::chrono::milliseconds(PAUSE_STATE_WAITTIME)) != std::future_status::ready)
                                 {
-                                    std::unique_lock<std::mutex> lk(mStateMutex);
-                                    mStateChangedCV.wait_for(lk, std::chrono::milliseconds(PAUSE_STATE_WAITTIME));
+                                    cancelAppState(appId);
                                 }
 
                                 mAdminLock.Lock();
@@ -353,7 +466,6 @@ namespace WPEFramework
                                 if(it != appManagerImplInstance->mAppInfo.end() &&
                                     it->second.appNewState == Exchange::IAppManager::AppLifecycleState::APP_STATE_PAUSED)
                                 {
-                                    mAppIdAwaitingPause.clear();
 
                                     auto retryIt = appManagerImplInstance->mAppInfo.find(appId);
                                     if (retryIt != appManagerImplInstance->mAppInfo.end())
@@ -409,6 +521,7 @@ namespace WPEFramework
                             }
                             else
                             {
+                                cancelAppState(appId);
                                 LOGERR("Failed to set PAUSED state for AppId: %s", appId.c_str());
                             }
                         }
@@ -428,6 +541,7 @@ namespace WPEFramework
         /* Terminate App invokes it */
         Core::hresult LifecycleInterfaceConnector::terminateApp(const string& appId)
         {
+            invalidateLoadedApps();
             uint32_t status = Core::ERROR_GENERAL;
             std::string appInstanceId = "";
             AppManagerImplementation* appManagerImplInstance = AppManagerImplementation::getInstance();
@@ -475,6 +589,7 @@ namespace WPEFramework
         /* Kill App invokes it */
         Core::hresult LifecycleInterfaceConnector::killApp(const string& appId)
         {
+            invalidateLoadedApps();
             LOGINFO("killApp entered");
             Core::hresult result = Core::ERROR_GENERAL;
             AppManagerImplementation* appManagerImplInstance = AppManagerImplementation::getInstance();
@@ -589,51 +704,39 @@ namespace WPEFramework
             ASSERT (nullptr != mLifecycleManagerRemoteObject);
             if (nullptr != mLifecycleManagerRemoteObject)
             {
-                JsonArray loadedAppsArray;
-                string loadedApps = "";
-                LOGINFO("Get Loaded Apps");
-                result = mLifecycleManagerRemoteObject->GetLoadedApps(false, loadedApps);
-                // Parse the string into a JSON array
-                JsonArray loadedAppsJsonArray;
-                if ((result != Core::ERROR_NONE) || loadedApps.empty() || !loadedAppsJsonArray.FromString(loadedApps))
-                {
-                    LOGERR("GetLoadedApps call: %s", (result != Core::ERROR_NONE) ? "Failed" : (loadedApps.empty() ? "returned empty list" : "format not a JSON string"));
-                    goto End;
-                }
-                else
+                /* Nothing changed since the last call, the snapshot is still what LifecycleManager would return */
+                if (mLoadedAppsStale.exchange(false) || mLoadedAppsPayload.empty())
                 {
+                    string loadedApps = "";
+                    LOGINFO("Get Loaded Apps");
+                    result = mLifecycleManagerRemoteObject->GetLoadedApps(false, loadedApps);
+                    if ((result != Core::ERROR_NONE) || loadedApps.empty())
+                    {
+                        LOGERR("GetLoadedApps call: %s", (result != Core::ERROR_NONE) ? "Failed" : "returned empty list");
+                        result = Core::ERROR_GENERAL;
+                        invalidateLoadedApps();
+                        goto End;
+                    }
+                    /* LifecycleManager returns the same string while its apps are unchanged, decode only when it differs */
+                    if ((loadedApps != mLoadedAppsPayload) && !decodeLoadedApps(loadedApps))
+                    {
+                        LOGERR("GetLoadedApps call: format not a JSON string");
+                        result = Core::ERROR_GENERAL;
+                        invalidateLoadedApps();
+                        goto End;
+                    }
                     LOGINFO("GetLoadedApps succeeded: %s", loadedApps.c_str());
                 }
 
-                auto getIntJsonField = [&](JsonObject& obj, const char* key) -> int {
-	                return obj.HasLabel(key) ? static_cast<int>(obj[key].Number()) : 0;
-	            };
-
-                // Iterate through each app JSON object in the array
-                for (size_t i = 0; i < loadedAppsJsonArray.Length(); ++i)
+                for (std::vector<LoadedApp>::const_iterator loadedApp = mLoadedApps.begin(); loadedApp != mLoadedApps.end(); ++loadedApp)
                 {
-                    JsonObject loadedAppsObject = loadedAppsJsonArray[i].Object();
-                    string appId = loadedAppsObject.HasLabel("appId")?loadedAppsObject["appId"].String():"";
-                    LOGINFO("Loaded appId: %s", appId.c_str());
-                    auto& appInfo = appManagerImplInstance->mAppInfo[appId];
-
-                    JsonObject loadedAppJson;
-                    loadedAppJson["appId"] = appId;
-                    loadedAppJson["appInstanceId"] = appInfo.appInstanceId = loadedAppsObject.HasLabel("appInstanceID")?loadedAppsObject["appInstanceID"].String():"";
-                    loadedAppJson["activeSessionId"] = appInfo.activeSessionId = loadedAppsObject.HasLabel("activeSessionId")?loadedAppsObject["activeSessionId"].String():"";
-                    appInfo.targetAppState = mapAppLifecycleState(
-                        static_cast<Exchange::ILifecycleManager::LifecycleState>(
-                            getIntJsonField(loadedAppsObject, "targetLifecycleState")));
-                    loadedAppJson["targetLifecycleState"] = static_cast<int>(appInfo.targetAppState);
-                    appInfo.appNewState = mapAppLifecycleState(
-                        static_cast<Exchange::ILifecycleManager::LifecycleState>(
-                            getIntJsonField(loadedAppsObject, "currentLifecycleState")));
-                    loadedAppJson["currentLifecycleState"] = static_cast<int>(appInfo.appNewState);
-
-                    loadedAppsArray.Add(loadedAppJson);
+                    auto& appInfo = appManagerImplInstance->mAppInfo[loadedApp->appId];
+                    appInfo.appInstanceId = loadedApp->appInstanceId;
+                    appInfo.activeSessionId = loadedApp->activeSessionId;
+                    appInfo.targetAppState = loadedApp->targetAppState;
+                    appInfo.appNewState = loadedApp->currentAppState;
                 }
-                // Convert the JSON array back to string to return
-                loadedAppsArray.ToString(apps);
+                apps = mLoadedAppsResult;
                 LOGINFO("getLoadedApps result JSON: %s", apps.c_str());
                 result = Core::ERROR_NONE;
             }
@@ -646,6 +749,77 @@ End:
             return result;
         }
 
+        /* Decodes the LifecycleManager payload in one pass per app, called with mAdminLock held */
+        bool LifecycleInterfaceConnector::decodeLoadedApps(const string& loadedApps)
+        {
+            JsonArray loadedAppsJsonArray;
+            if (!loadedAppsJsonArray.FromString(loadedApps))
+            {
+                return false;
+            }
+
+            std::vector<LoadedApp> decoded;
+            JsonArray loadedAppsArray;
+            decoded.reserve(loadedAppsJsonArray.Length());
+
+            for (size_t i = 0; i < loadedAppsJsonArray.Length(); ++i)
+            {
+                LoadedApp loadedApp = { "", "", "", Exchange::IAppManager::AppLifecycleState::APP_STATE_UNKNOWN, Exchange::IAppManager::AppLifecycleState::APP_STATE_UNKNOWN };
+                Exchange::ILifecycleManager::LifecycleState targetLifecycleState = Exchange::ILifecycleManager::LifecycleState::UNLOADED;
+                Exchange::ILifecycleManager::LifecycleState currentLifecycleState = Exchange::ILifecycleManager::LifecycleState::UNLOADED;
+
+                JsonObject loadedAppsObject = loadedAppsJsonArray[i].Object();
+                JsonObject::Iterator field = loadedAppsObject.Variants();
+                while (field.Next())
+                {
+                    const string label(field.Label());
+                    if (label == "appId")
+                    {
+                        loadedApp.appId = field.Current().String();
+                    }
+                    else if (label == "appInstanceID")
+                    {
+                        loadedApp.appInstanceId = field.Current().String();
+                    }
+                    else if (label == "activeSessionId")
+                    {
+                        loadedApp.activeSessionId = field.Current().String();
+                    }
+                    else if (label == "targetLifecycleState")
+                    {
+                        targetLifecycleState = static_cast<Exchange::ILifecycleManager::LifecycleState>(field.Current().Number());
+                    }
+                    else if (label == "currentLifecycleState")
+                    {
+                        currentLifecycleState = static_cast<Exchange::ILifecycleManager::LifecycleState>(field.Current().Number());
+                    }
+                }
+                loadedApp.targetAppState = mapAppLifecycleState(targetLifecycleState);
+                loadedApp.currentAppState = mapAppLifecycleState(currentLifecycleState);
+                LOGINFO("Loaded appId: %s", loadedApp.appId.c_str());
+
+                JsonObject loadedAppJson;
+                loadedAppJson["appId"] = loadedApp.appId;
+                loadedAppJson["appInstanceId"] = loadedApp.appInstanceId;
+                loadedAppJson["activeSessionId"] = loadedApp.activeSessionId;
+                loadedAppJson["targetLifecycleState"] = static_cast<int>(loadedApp.targetAppState);
+                loadedAppJson["currentLifecycleState"] = static_cast<int>(loadedApp.currentAppState);
+                loadedAppsArray.Add(loadedAppJson);
+
+                decoded.push_back(std::move(loadedApp));
+            }
+
+            mLoadedApps.swap(decoded);
+            loadedAppsArray.ToString(mLoadedAppsResult);
+            mLoadedAppsPayload = loadedApps;
+            return true;
+        }
+
+        void LifecycleInterfaceConnector::invalidateLoadedApps()
+        {
+            mLoadedAppsStale = true;
+        }
+
         Exchange::IAppManager::AppLifecycleState WPEFramework::Plugin::LifecycleInterfaceConnector::mapAppLifecycleState(Exchange::ILifecycleManager::LifecycleState state)
         {
             Exchange::IAppManager::AppLifecycleState result = Exchange::IAppManager::AppLifecycleState::APP_STATE_UNKNOWN;
@@ -693,6 +867,7 @@ End:
 
         void LifecycleInterfaceConnector::OnAppLifecycleStateChanged(const string& appId, const string& appInstanceId, const Exchange::ILifecycleManager::LifecycleState oldState, const Exchange::ILifecycleManager::LifecycleState newState, const string& navigationIntent)
         {
+            invalidateLoadedApps();
             AppManagerImplementation*appManagerImplInstance = AppManagerImplementation::getInstance();
             Exchange::IAppManager::AppLifecycleState oldAppState = mapAppLifecycleState(oldState);
             Exchange::IAppManager::AppLifecycleState newAppState = mapAppLifecycleState(newState);
@@ -704,6 +879,7 @@ End:
                 oldAppState == Exchange::IAppManager::APP_STATE_UNKNOWN)
             {
                 LOGINFO("Skipping notification: new or old app state is UNKNOWN");
+                updateAppState(appId, appInstanceId, newState);
                 return;
             }
 
@@ -739,14 +915,6 @@ End:
                             gAppsActiveCounter++;
                             it->second.lastActiveIndex = gAppsActiveCounter;
                         }
-                        if (newAppState == Exchange::IAppManager::AppLifecycleState::APP_STATE_PAUSED)
-                        {
-                            if (appId == mAppIdAwaitingPause)
-                            {
-                                std::lock_guard<std::mutex> lk(mStateMutex);
-                                mStateChangedCV.notify_all();
-                            }
-                        }
                         break;
                     }
                 }
@@ -766,6 +934,9 @@ End:
                     }
                 }
             }
+
+            /* After mAppInfo is updated, a closeApp woken up here reads the new state from it */
+            updateAppState(appId, appInstanceId, newState);
         }
 
         /* Returns appInstanceId for appId. Does not synchronize access to LoadedAppInfo.
@@ -36,7 +36,10 @@
 #include <interfaces/ILifecycleManager.h>
 #include <interfaces/ILifecycleManagerState.h>
 #include <interfaces/IAppManager.h>
-#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <vector>
+#include <unordered_map>
 
 namespace WPEFramework
 {
@@ -45,6 +48,31 @@ namespace WPEFramework
         class LifecycleInterfaceConnector
         {
             private:
+            /* one entry of the LifecycleManager GetLoadedApps result, decoded once */
+            struct LoadedApp
+            {
+                string appId;
+                string appInstanceId;
+                string activeSessionId;
+                Exchange::IAppManager::AppLifecycleState targetAppState;
+                Exchange::IAppManager::AppLifecycleState currentAppState;
+            };
+
+            /* last lifecycle state known for an app, kept current by OnAppLifecycleStateChanged */
+            struct AppState
+            {
+                string appInstanceId;
+                Exchange::ILifecycleManager::LifecycleState state;
+            };
+
+            /* a caller waiting for an app to reach a lifecycle state */
+            struct StateWaiter
+            {
+                Exchange::ILifecycleManager::LifecycleState state;
+                std::promise<void> reached;
+                std::shared_future<void> future;
+            };
+
             class NotificationHandler : public Exchange::ILifecycleManagerState::INotification {
 
                 public:
@@ -86,15 +114,33 @@ namespace WPEFramework
                     Core::hresult isAppLoaded(const string& appId, bool& loaded);
                     bool fileExists(const char* pFileName);
 
+                private:
+                    bool decodeLoadedApps(const string& loadedApps);
+                    void invalidateLoadedApps();
+                    void updateAppState(const string& appId, const string& appInstanceId, const Exchange::ILifecycleManager::LifecycleState state);
+                    void appSpawned(const string& appId, const string& appInstanceId);
+                    void clearAppStates();
+                    std::shared_future<void> expectAppState(const string& appId, const Exchange::ILifecycleManager::LifecycleState state);
+                    void cancelAppState(const string& appId);
+
                 private:
                     mutable Core::CriticalSection mAdminLock;
                     Exchange::ILifecycleManager *mLifecycleManagerRemoteObject;
                     Exchange::ILifecycleManagerState *mLifecycleManagerStateRemoteObject;
                     Core::Sink<NotificationHandler> mNotification;
                     PluginHost::IShell* mCurrentservice;
-                    std::condition_variable mStateChangedCV;
-                    std::mutex mStateMutex;
-                    std::string mAppIdAwaitingPause;
+                    /* event-sourced mirror of the LifecycleManager app states, an app missing here is unknown and
+                     * asked for once; UNLOADED entries are kept so repeated queries for unloaded apps stay local */
+                    mutable Core::CriticalSection mAppStateLock;
+                    std::unordered_map<string, AppState> mAppStates;
+                    std::unordered_map<string, std::shared_ptr<StateWaiter>> mStateWaiters;
+                    /* bumped on every state event, a remote answer is only mirrored if no event raced with it */
+                    std::atomic<uint32_t> mAppStateEvents;
+                    /* snapshot of the loaded apps, reused until a lifecycle change or an app request makes it stale */
+                    std::atomic<bool> mLoadedAppsStale;
+                    string mLoadedAppsPayload;
+                    std::vector<LoadedApp> mLoadedApps;
+                    string mLoadedAppsResult;
         };
     }
 }
@@ -28,7 +28,7 @@ namespace WPEFramework
         {
 	}
 
-        ApplicationContext::ApplicationContext (std::string appId): mAppInstanceId(""), mAppId(std::move(appId)), mLastLifecycleStateChangeTime(), mActiveSessionId(""), mTargetLifecycleState(), mMostRecentIntent(""), mState(nullptr), mStateChangeId(0)
+        ApplicationContext::ApplicationContext (std::string appId): mAppInstanceId(""), mAppId(std::move(appId)), mLastLifecycleStateChangeTime(), mActiveSessionId(""), mTargetLifecycleState(), mMostRecentIntent(""), mState(nullptr), mStateChangeId(0), mRevision(0)
         {
             mState = (void*) new UnloadedState(this);
             sem_init(&mReachedLoadingStateSemaphore, 0, 0);
@@ -56,31 +56,37 @@ namespace WPEFramework
         void ApplicationContext::setAppInstanceId(std::string& id)
         {
             mAppInstanceId = id;
+            mRevision++;
         }
 
         void ApplicationContext::setActiveSessionId(std::string& id)
         {
             mActiveSessionId = id;
+            mRevision++;
         }
 
         void ApplicationContext::setMostRecentIntent(const std::string& intent)
         {
             mMostRecentIntent = intent;
+            mRevision++;
         }
 
         void ApplicationContext::setLastLifecycleStateChangeTime(timespec changeTime)
 	{
             mLastLifecycleStateChangeTime = changeTime;
+            mRevision++;
 	}
 
         void ApplicationContext::setState(void* state)
 	{
             mState = state;
+            mRevision++;
 	}
 
 	void ApplicationContext::setTargetLifecycleState(Exchange::ILifecycleManager::LifecycleState state)
 	{
             mTargetLifecycleState = state;
+            mRevision++;
         }
 
         void ApplicationContext::setStateChangeId(uint32_t id)
@@ -148,6 +154,11 @@ namespace WPEFramework
             return mStateChangeId;
 	}
 
+        uint32_t ApplicationContext::getRevision() const
+	{
+            return mRevision;
+	}
+
 	ApplicationLaunchParams& ApplicationContext::getApplicationLaunchParams()
 	{
             return mLaunchParams;
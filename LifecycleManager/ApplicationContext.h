@@ -24,6 +24,7 @@
 #include <time.h>
 #include <string>
 #include <semaphore>
+#include <atomic>
 
 namespace WPEFramework
 {
@@ -70,6 +71,8 @@ namespace WPEFramework
 		Exchange::ILifecycleManager::LifecycleState getTargetLifecycleState();
                 std::string getMostRecentIntent();
                 uint32_t getStateChangeId();
+                /* bumped whenever a field reported by GetLoadedApps changes */
+                uint32_t getRevision() const;
                 ApplicationLaunchParams& getApplicationLaunchParams();
                 ApplicationKillParams& getApplicationKillParams();
                 sem_t mReachedLoadingStateSemaphore;
@@ -91,6 +94,7 @@ namespace WPEFramework
                 uint32_t mStateChangeId;
                 ApplicationLaunchParams mLaunchParams;
                 ApplicationKillParams mKillParams;
+                std::atomic<uint32_t> mRevision;
         };
     } /* namespace Plugin */
 } /* namespace WPEFramework */
@@ -30,7 +30,7 @@ namespace WPEFramework
     {
         SERVICE_REGISTRATION(LifecycleManagerImplementation, 1, 0);
 
-        LifecycleManagerImplementation::LifecycleManagerImplementation(): mLifecycleManagerNotification(), mLifecycleManagerStateNotification(), mLoadedApplications(), mService(nullptr)
+        LifecycleManagerImplementation::LifecycleManagerImplementation(): mLifecycleManagerNotification(), mLifecycleManagerStateNotification(), mLoadedApplications(), mApplicationsByAppId(), mApplicationsByInstanceId(), mLoadedAppEntries(), mLoadedApps(), mLoadedAppsValid(false), mApplicationsLock(), mService(nullptr)
         {
             LOGINFO("Create LifecycleManagerImplementation Instance");
         }
@@ -166,52 +166,94 @@ namespace WPEFramework
         Core::hresult LifecycleManagerImplementation::GetLoadedApps(const bool verbose, string& apps)
         {
             Core::hresult status = Core::ERROR_NONE;
-            JsonArray appsInformation;
-            std::list<ApplicationContext*>::iterator iter = mLoadedApplications.end();
-	    for (iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
-	    {
-                if (nullptr != *iter)
+            if (!verbose)
+            {
+                mApplicationsLock.Lock();
+                bool changed = !mLoadedAppsValid;
+                for (std::list<ApplicationContext*>::iterator iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
                 {
-                    JsonObject appData;
-                    ApplicationContext* context = (*iter);
-                    appData["appInstanceID"] = context->getAppInstanceId();
-                    appData["appId"] = context->getAppId();
-		    struct timespec lastStateChangeTime = context->getLastLifecycleStateChangeTime();
-                    char timeData[200];
-                    char timeDataExpanded[1000];
-		    memset(timeData, 0, sizeof(timeData));
-		    memset(timeDataExpanded, 0, sizeof(timeDataExpanded));
-                    strftime(timeData, sizeof timeData, "%D %T", gmtime(&lastStateChangeTime.tv_sec));
-                    sprintf(timeDataExpanded, "%s.%09ld", timeData, lastStateChangeTime.tv_nsec);
-                    appData["currentLifecycleState"] = (uint32_t) context->getCurrentLifecycleState();
-                    appData["timeOfLastLifecycleStateChange"] = string(timeDataExpanded);
-                    appData["activeSessionId"] = context->getActiveSessionId();
-                    appData["targetLifecycleState"] = (uint32_t) context->getTargetLifecycleState();
-                    appData["mostRecentIntent"] = context->getMostRecentIntent();
-                    if (verbose)
-		    {	    
-                        RuntimeManagerHandler* runtimeManagerHandler = RequestHandler::getInstance()->getRuntimeManagerHandler();
-			if (nullptr != runtimeManagerHandler)
-			{
-                            string runtimeStats("");
-                            Core::hresult runtimeStatsResult = runtimeManagerHandler->getRuntimeStats(context->getAppInstanceId(), runtimeStats);
-                            if (Core::ERROR_NONE == runtimeStatsResult)
-                            {
-                                appData["runtimeStats"] = runtimeStats;
-                            }
-                            else
-                            {
-                                printf("unable to get runtime status of application\n");
-                                fflush(stdout);
-                            }
+                    std::pair<uint32_t, string>& entry = mLoadedAppEntries[*iter];
+                    uint32_t revision = (*iter)->getRevision();
+                    if ((entry.second.empty()) || (entry.first != revision))
+                    {
+                        JsonObject appData;
+                        fillAppData(*iter, appData);
+                        appData.ToString(entry.second);
+                        entry.first = revision;
+                        changed = true;
+                    }
+                }
+                if (changed)
+                {
+                    mLoadedApps = "[";
+                    for (std::list<ApplicationContext*>::iterator iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
+                    {
+                        if (mLoadedApps.size() > 1)
+                        {
+                            mLoadedApps += ",";
                         }
+                        mLoadedApps += mLoadedAppEntries[*iter].second;
+                    }
+                    mLoadedApps += "]";
+                    mLoadedAppsValid = true;
+                }
+                apps = mLoadedApps;
+                mApplicationsLock.Unlock();
+                return status;
+            }
+
+            /* contexts can be removed and deleted as soon as the lock is released, copy what is needed */
+            std::list<std::pair<string, JsonObject>> loadedApplications;
+            mApplicationsLock.Lock();
+            for (std::list<ApplicationContext*>::iterator iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
+            {
+                loadedApplications.emplace_back((*iter)->getAppInstanceId(), JsonObject());
+                fillAppData(*iter, loadedApplications.back().second);
+            }
+            mApplicationsLock.Unlock();
+
+            JsonArray appsInformation;
+            RuntimeManagerHandler* runtimeManagerHandler = RequestHandler::getInstance()->getRuntimeManagerHandler();
+            for (std::list<std::pair<string, JsonObject>>::iterator iter = loadedApplications.begin(); iter != loadedApplications.end(); iter++)
+            {
+                JsonObject& appData = iter->second;
+		if (nullptr != runtimeManagerHandler)
+		{
+                    string runtimeStats("");
+                    Core::hresult runtimeStatsResult = runtimeManagerHandler->getRuntimeStats(iter->first, runtimeStats);
+                    if (Core::ERROR_NONE == runtimeStatsResult)
+                    {
+                        appData["runtimeStats"] = runtimeStats;
+                    }
+                    else
+                    {
+                        printf("unable to get runtime status of application\n");
+                        fflush(stdout);
                     }
-                    appsInformation.Add(appData);
                 }
+                appsInformation.Add(appData);
 	    }
             appsInformation.ToString(apps);
             return status;
         }
+
+        void LifecycleManagerImplementation::fillAppData(ApplicationContext* context, JsonObject& appData) const
+        {
+            appData["appInstanceID"] = context->getAppInstanceId();
+            appData["appId"] = context->getAppId();
+	    struct timespec lastStateChangeTime = context->getLastLifecycleStateChangeTime();
+            char timeData[200];
+            char timeDataExpanded[1000];
+	    memset(timeData, 0, sizeof(timeData));
+	    memset(timeDataExpanded, 0, sizeof(timeDataExpanded));
+            strftime(timeData, sizeof timeData, "%D %T", gmtime(&lastStateChangeTime.tv_sec));
+            sprintf(timeDataExpanded, "%s.%09ld", timeData, lastStateChangeTime.tv_nsec);
+            appData["currentLifecycleState"] = (uint32_t) context->getCurrentLifecycleState();
+            appData["timeOfLastLifecycleStateChange"] = string(timeDataExpanded);
+            appData["activeSessionId"] = context->getActiveSessionId();
+            appData["targetLifecycleState"] = (uint32_t) context->getTargetLifecycleState();
+            appData["mostRecentIntent"] = context->getMostRecentIntent();
+        }
         
         Core::hresult LifecycleManagerImplementation::IsAppLoaded(const string& appId, bool& loaded) const
         {
@@ -237,7 +279,7 @@ namespace WPEFramework
 	    {
                 context = new ApplicationContext(appId);
                 context->setApplicationLaunchParams(appId, launchIntent, launchArgs, targetLifecycleState, runtimeConfigObject);
-		mLoadedApplications.push_back(context);
+                addContext(context);
                 firstLaunch = true;
 	    }
             context->setTargetLifecycleState(targetLifecycleState);
@@ -252,6 +294,7 @@ namespace WPEFramework
                 if (firstLaunch)
 		{
                     sem_wait(&context->mReachedLoadingStateSemaphore);
+                    indexInstanceId(context);
 		}
                 appInstanceId = context->getAppInstanceId();
             }
@@ -467,26 +510,86 @@ namespace WPEFramework
         ApplicationContext* LifecycleManagerImplementation::getContext(const string& appInstanceId, const string& appId) const
 	{
             ApplicationContext* context = nullptr;
-            std::list<ApplicationContext*>::const_iterator iter = mLoadedApplications.end();
-	    for (iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
-	    {
-                if (nullptr != *iter)
-		{
-                    if ((!appInstanceId.empty()) && ((*iter)->getAppInstanceId() == appInstanceId))
-                    {
-		        context = *iter;
-		        break;
-                    }
-		    else if ((!appId.empty()) && ((*iter)->getAppId() == appId))
+            mApplicationsLock.Lock();
+            if (!appInstanceId.empty())
+            {
+                std::unordered_map<string, ApplicationContext*>::const_iterator index = mApplicationsByInstanceId.find(appInstanceId);
+                if (index != mApplicationsByInstanceId.end())
+                {
+                    context = index->second;
+                }
+                else
+                {
+                    /* the instance id is generated by the loading state, events may refer to it before SpawnApp indexed it */
+                    for (std::list<ApplicationContext*>::const_iterator iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
                     {
-		        context = *iter;
-		        break;
+                        if ((*iter)->getAppInstanceId() == appInstanceId)
+                        {
+                            context = *iter;
+                            mApplicationsByInstanceId[appInstanceId] = context;
+                            break;
+                        }
                     }
-		}
-	    }
+                }
+            }
+            if ((nullptr == context) && (!appId.empty()))
+            {
+                std::unordered_map<string, ApplicationContext*>::const_iterator index = mApplicationsByAppId.find(appId);
+                if (index != mApplicationsByAppId.end())
+                {
+                    context = index->second;
+                }
+            }
+            mApplicationsLock.Unlock();
 	    return context;
 	}
 
+        void LifecycleManagerImplementation::addContext(ApplicationContext* context)
+        {
+            mApplicationsLock.Lock();
+            mLoadedApplications.push_back(context);
+            mApplicationsByAppId[context->getAppId()] = context;
+            mLoadedAppsValid = false;
+            mApplicationsLock.Unlock();
+        }
+
+        void LifecycleManagerImplementation::indexInstanceId(ApplicationContext* context)
+        {
+            string appInstanceId = context->getAppInstanceId();
+            if (!appInstanceId.empty())
+            {
+                mApplicationsLock.Lock();
+                mApplicationsByInstanceId[appInstanceId] = context;
+                mApplicationsLock.Unlock();
+            }
+        }
+
+        void LifecycleManagerImplementation::removeContext(ApplicationContext* context)
+        {
+            mApplicationsLock.Lock();
+            mLoadedApplications.remove(context);
+            std::unordered_map<string, ApplicationContext*>::iterator byAppId = mApplicationsByAppId.find(context->getAppId());
+            if ((byAppId != mApplicationsByAppId.end()) && (byAppId->second == context))
+            {
+                mApplicationsByAppId.erase(byAppId);
+            }
+            for (std::unordered_map<string, ApplicationContext*>::iterator byInstanceId = mApplicationsByInstanceId.begin(); byInstanceId != mApplicationsByInstanceId.end(); )
+            {
+                /* also drops entries left behind if the instance id was regenerated */
+                if (byInstanceId->second == context)
+                {
+                    byInstanceId = mApplicationsByInstanceId.erase(byInstanceId);
+                }
+                else
+                {
+                    byInstanceId++;
+                }
+            }
+            mLoadedAppEntries.erase(context);
+            mLoadedAppsValid = false;
+            mApplicationsLock.Unlock();
+        }
+
 	void LifecycleManagerImplementation::onRuntimeManagerEvent(JsonObject& data)
 	{
             dispatchEvent(LifecycleManagerImplementation::EventNames::LIFECYCLE_MANAGER_EVENT_RUNTIME, data);
@@ -565,24 +668,11 @@ namespace WPEFramework
 	    {
                 return;
 	    }
-            ApplicationContext* context = nullptr;
-            std::list<ApplicationContext*>::iterator iter = mLoadedApplications.end();
-	    for (iter = mLoadedApplications.begin(); iter != mLoadedApplications.end(); iter++)
-	    {
-                context = *iter;
-                if (nullptr == context)
-		{
-                    continue;
-		}
-                if (context->getAppInstanceId() == appInstanceId)
-	        {
-	            break;	    
-                }
-	    }
-	    if ((iter != mLoadedApplications.end()) && (nullptr != context))
+            ApplicationContext* context = getContext(appInstanceId, "");
+	    if (nullptr != context)
 	    {
+                removeContext(context);
                 delete context;
-                mLoadedApplications.erase(iter);
 	    }
     }
 
@@ -27,6 +27,7 @@
 #include "UtilsLogging.h"
 #include "tracing/Logging.h"
 #include <mutex>
+#include <unordered_map>
 #include "ApplicationContext.h"
 
 namespace WPEFramework
@@ -137,6 +138,14 @@ namespace WPEFramework
 	        std::list<Exchange::ILifecycleManager::INotification*> mLifecycleManagerNotification;
 	        std::list<Exchange::ILifecycleManagerState::INotification*> mLifecycleManagerStateNotification;
                 std::list<ApplicationContext*> mLoadedApplications;
+                /* lookup indexes over mLoadedApplications, all guarded by mApplicationsLock */
+                std::unordered_map<string, ApplicationContext*> mApplicationsByAppId;
+                mutable std::unordered_map<string, ApplicationContext*> mApplicationsByInstanceId;
+                /* GetLoadedApps result, rebuilt from per app entries when an app is added, removed or changes revision */
+                std::unordered_map<ApplicationContext*, std::pair<uint32_t, string>> mLoadedAppEntries;
+                string mLoadedApps;
+                bool mLoadedAppsValid;
+                mutable Core::CriticalSection mApplicationsLock;
                 PluginHost::IShell* mService;
 	    private: /* internal methods */
                 bool initialize(PluginHost::IShell* service);
@@ -147,6 +156,10 @@ namespace WPEFramework
                 void handleStateChangeEvent(const JsonObject &data);
                 void handleWindowManagerEvent(const JsonObject &data);
                 ApplicationContext* getContext(const string& appInstanceId, const string& appId) const;
+                void addContext(ApplicationContext* context);
+                void indexInstanceId(ApplicationContext* context);
+                void removeContext(ApplicationContext* context);
+                void fillAppData(ApplicationContext* context, JsonObject& appData) const;
 
                 friend class Job;
         };
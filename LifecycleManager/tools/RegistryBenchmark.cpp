@@ -0,0 +1,279 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Application registry of LifecycleManager with many loaded apps: getContext walking the list of
+ * contexts and GetLoadedApps serializing every app on every call, as before, against the appId and
+ * appInstanceId indexes and the per app GetLoadedApps entries rebuilt only on a revision change.
+ *
+ *   LifecycleManagerRegistryBenchmark [-a apps] [-e events] [-g events per GetLoadedApps] [-c changes per mille]
+ *
+ * Every event looks up its context by instance id, like state change and runtime events do, and
+ * changes the state of the app for the given share of them. GetLoadedApps is called at the given
+ * rate in between. Serializing an app is done by hand with the fields fillAppData sets, the plugin
+ * goes through JsonObject, which costs more. The lookup time includes reading the clock twice.
+ */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Context
+    {
+        std::string mAppId;
+        std::string mAppInstanceId;
+        uint32_t mCurrentState;
+        uint32_t mTargetState;
+        uint64_t mLastStateChange;
+        std::string mActiveSessionId;
+        uint32_t mRevision;
+
+        void setState(const uint32_t state, const uint64_t now)
+        {
+            mCurrentState = state;
+            mTargetState = state;
+            mLastStateChange = now;
+            mRevision++;
+        }
+    };
+
+    void fillAppData(const Context& context, std::string& out)
+    {
+        char time[64];
+        snprintf(time, sizeof(time), "%llu.%09llu", static_cast<unsigned long long>(context.mLastStateChange / 1000000000ULL),
+            static_cast<unsigned long long>(context.mLastStateChange % 1000000000ULL));
+
+        out = "{\"appInstanceID\":\"" + context.mAppInstanceId + "\",\"appId\":\"" + context.mAppId
+            + "\",\"currentLifecycleState\":" + std::to_string(context.mCurrentState)
+            + ",\"timeOfLastLifecycleStateChange\":\"" + time
+            + "\",\"activeSessionId\":\"" + context.mActiveSessionId
+            + "\",\"targetLifecycleState\":" + std::to_string(context.mTargetState) + "}";
+    }
+
+    /* What the plugin did before: walk the list for every lookup, serialize everything on every call */
+    class ListRegistry
+    {
+    public:
+        explicit ListRegistry(std::list<Context*>& contexts)
+        : mContexts(contexts)
+        {
+        }
+
+        Context* getContext(const std::string& appInstanceId)
+        {
+            for (std::list<Context*>::iterator iter = mContexts.begin(); iter != mContexts.end(); iter++)
+            {
+                if ((*iter)->mAppInstanceId == appInstanceId)
+                {
+                    return *iter;
+                }
+            }
+            return nullptr;
+        }
+
+        const std::string& getLoadedApps()
+        {
+            std::string entry;
+            mLoadedApps = "[";
+            for (std::list<Context*>::iterator iter = mContexts.begin(); iter != mContexts.end(); iter++)
+            {
+                if (mLoadedApps.size() > 1)
+                {
+                    mLoadedApps += ",";
+                }
+                fillAppData(**iter, entry);
+                mLoadedApps += entry;
+            }
+            mLoadedApps += "]";
+            return mLoadedApps;
+        }
+
+    private:
+        std::list<Context*>& mContexts;
+        std::string mLoadedApps;
+    };
+
+    /* The plugin now: hashed lookup, per app entries checked against the context revision */
+    class IndexedRegistry
+    {
+    public:
+        explicit IndexedRegistry(std::list<Context*>& contexts)
+        : mContexts(contexts)
+        , mLoadedAppsValid(false)
+        {
+            for (std::list<Context*>::iterator iter = mContexts.begin(); iter != mContexts.end(); iter++)
+            {
+                mByInstanceId.emplace((*iter)->mAppInstanceId, *iter);
+            }
+        }
+
+        Context* getContext(const std::string& appInstanceId)
+        {
+            std::unordered_map<std::string, Context*>::iterator iter = mByInstanceId.find(appInstanceId);
+            return (iter != mByInstanceId.end()) ? iter->second : nullptr;
+        }
+
+        const std::string& getLoadedApps()
+        {
+            bool changed = !mLoadedAppsValid;
+            for (std::list<Context*>::iterator iter = mContexts.begin(); iter != mContexts.end(); iter++)
+            {
+                std::pair<uint32_t, std::string>& entry = mEntries[*iter];
+                if ((entry.second.empty()) || (entry.first != (*iter)->mRevision))
+                {
+                    fillAppData(**iter, entry.second);
+                    entry.first = (*iter)->mRevision;
+                    changed = true;
+                }
+            }
+            if (changed)
+            {
+                mLoadedApps = "[";
+                for (std::list<Context*>::iterator iter = mContexts.begin(); iter != mContexts.end(); iter++)
+                {
+                    if (mLoadedApps.size() > 1)
+                    {
+                        mLoadedApps += ",";
+                    }
+                    mLoadedApps += mEntries[*iter].second;
+                }
+                mLoadedApps += "]";
+                mLoadedAppsValid = true;
+            }
+            return mLoadedApps;
+        }
+
+    private:
+        std::list<Context*>& mContexts;
+        std::unordered_map<std::string, Context*> mByInstanceId;
+        std::unordered_map<Context*, std::pair<uint32_t, std::string>> mEntries;
+        std::string mLoadedApps;
+        bool mLoadedAppsValid;
+    };
+
+    struct Result
+    {
+        double mLookupSeconds;
+        double mLoadedAppsSeconds;
+        size_t mLength;
+    };
+
+    template <typename REGISTRY>
+    Result run(const uint32_t apps, const uint32_t events, const uint32_t interval, const uint32_t changes)
+    {
+        std::vector<Context> storage(apps);
+        std::list<Context*> contexts;
+        std::vector<std::string> instanceIds;
+
+        for (uint32_t i = 0; i < apps; i++)
+        {
+            Context& context = storage[i];
+            context.mAppId = "com.example.app" + std::to_string(i);
+            context.mAppInstanceId = "5f0e8c2a-4b7d-4c39-9a1e-" + std::to_string(100000000000ULL + i);
+            context.mCurrentState = 1;
+            context.mTargetState = 1;
+            context.mLastStateChange = 1700000000000000000ULL + i;
+            context.mActiveSessionId = "";
+            context.mRevision = 0;
+            contexts.push_back(&context);
+            instanceIds.push_back(context.mAppInstanceId);
+        }
+
+        REGISTRY registry(contexts);
+        std::mt19937 random(42);
+        Result result = { 0, 0, 0 };
+        uint64_t now = 1800000000000000000ULL;
+
+        for (uint32_t event = 0; event < events; event++)
+        {
+            const std::string& appInstanceId = instanceIds[random() % apps];
+
+            Clock::time_point start = Clock::now();
+            Context* context = registry.getContext(appInstanceId);
+            result.mLookupSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            if ((nullptr != context) && ((random() % 1000) < changes))
+            {
+                context->setState((context->mCurrentState % 4) + 1, now++);
+            }
+
+            if (((event + 1) % interval) == 0)
+            {
+                start = Clock::now();
+                result.mLength += registry.getLoadedApps().length();
+                result.mLoadedAppsSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+            }
+        }
+        return result;
+    }
+
+    void report(const char name[], const Result& result, const uint32_t events, const uint32_t calls)
+    {
+        printf("  %-8s getContext %8.1f ns per event, GetLoadedApps %9.2f us per call (%zu bytes returned)\n",
+            name, (result.mLookupSeconds * 1e9) / events, (calls != 0) ? ((result.mLoadedAppsSeconds * 1e6) / calls) : 0.0, result.mLength);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t apps = 64;
+    uint32_t events = 1000000;
+    uint32_t interval = 100;
+    uint32_t changes = 100;
+    int option;
+
+    while ((option = getopt(argc, argv, "a:e:g:c:")) != -1)
+    {
+        switch (option)
+        {
+        case 'a': apps = static_cast<uint32_t>(strtoul(optarg, nullptr, 10)); break;
+        case 'e': events = static_cast<uint32_t>(strtoul(optarg, nullptr, 10)); break;
+        case 'g': interval = static_cast<uint32_t>(strtoul(optarg, nullptr, 10)); break;
+        case 'c': changes = static_cast<uint32_t>(strtoul(optarg, nullptr, 10)); break;
+        default:
+            fprintf(stderr, "usage: %s [-a apps] [-e events] [-g events per GetLoadedApps] [-c changes per mille]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if ((apps == 0) || (interval == 0))
+    {
+        fprintf(stderr, "apps and events per GetLoadedApps must be at least 1\n");
+        return 1;
+    }
+
+    printf("%u apps, %u events, GetLoadedApps every %u events, %u per mille of the events change an app\n", apps, events, interval, changes);
+
+    const uint32_t calls = events / interval;
+    report("list", run<ListRegistry>(apps, events, interval, changes), events, calls);
+    report("indexed", run<IndexedRegistry>(apps, events, interval, changes), events, calls);
+    return 0;
+}
@@ -43,18 +43,87 @@ namespace WPEFramework {
         : Core::JSON::Container()
         , Port(2200)
         , Binding("0.0.0.0")
+        , Binary(false)
     {
         Add(_T("port"), &Port);
         Add(_T("binding"), &Binding);
+        Add(_T("binary"), &Binary);
     }
 
     MessageControl::Config::NetworkNode::NetworkNode(const NetworkNode& copy)
         : Core::JSON::Container()
         , Port(copy.Port)
         , Binding(copy.Binding)
+        , Binary(copy.Binary)
     {
         Add(_T("port"), &Port);
         Add(_T("binding"), &Binding);
+        Add(_T("binary"), &Binary);
+    }
+
+    MessageControl::ThrottleRule::ThrottleRule()
+        : Core::JSON::Container()
+        , Type()
+        , Name()
+        , Rate(0)
+        , Burst(0)
+        , Sample(0)
+    {
+        Add(_T("type"), &Type);
+        Add(_T("name"), &Name);
+        Add(_T("rate"), &Rate);
+        Add(_T("burst"), &Burst);
+        Add(_T("sample"), &Sample);
+    }
+
+    MessageControl::ThrottleRule::ThrottleRule(const ThrottleRule& copy)
+        : Core::JSON::Container()
+        , Type(copy.Type)
+        , Name(copy.Name)
+        , Rate(copy.Rate)
+        , Burst(copy.Burst)
+        , Sample(copy.Sample)
+    {
+        Add(_T("type"), &Type);
+        Add(_T("name"), &Name);
+        Add(_T("rate"), &Rate);
+        Add(_T("burst"), &Burst);
+        Add(_T("sample"), &Sample);
+    }
+
+    bool MessageControl::ThrottleRule::Scope(Publishers::Throttle::scope& scope) const
+    {
+        bool valid = true;
+
+        if (Type.Value() == _T("module")) {
+            scope = Publishers::Throttle::scope::MODULE;
+        }
+        else if (Type.Value() == _T("category")) {
+            scope = Publishers::Throttle::scope::CATEGORY;
+        }
+        else {
+            valid = false;
+        }
+
+        return (valid && (Name.Value().empty() == false));
+    }
+
+    MessageControl::ThrottleInfo::ThrottleInfo()
+        : ThrottleRule()
+        , Passed(0)
+        , Suppressed(0)
+    {
+        Add(_T("passed"), &Passed);
+        Add(_T("suppressed"), &Suppressed);
+    }
+
+    MessageControl::ThrottleInfo::ThrottleInfo(const ThrottleInfo& copy)
+        : ThrottleRule(copy)
+        , Passed(copy.Passed)
+        , Suppressed(copy.Suppressed)
+    {
+        Add(_T("passed"), &Passed);
+        Add(_T("suppressed"), &Suppressed);
     }
 
     MessageControl::MessageControl()
@@ -63,6 +132,8 @@ namespace WPEFramework {
         , _config()
         , _outputDirector()
         , _webSocketExporter()
+        , _frameExporter()
+        , _throttle()
         , _callback(nullptr)
         , _observer(*this)
         , _service(nullptr)
@@ -109,15 +180,48 @@ namespace WPEFramework {
         }
         if (_config.FileName.Value().empty() == false) {
             _config.FileName = service->VolatilePath() + _config.FileName.Value();
-            Announce(new Publishers::FileOutput(abbreviate, _config.FileName.Value()));
+
+            Publishers::FileOutput::Rotation rotation;
+            rotation.MaxSize = static_cast<uint64_t>(_config.FileMaxSize.Value()) * 1024;
+            rotation.Period = _config.FileRotatePeriod.Value();
+            rotation.Segments = _config.FileSegments.Value();
+            rotation.Compress = _config.FileCompress.Value();
+
+            if ((rotation.Compress == true) && (Publishers::FileOutput::CompressionSupported() == false)) {
+                TRACE(Trace::Error, (_T("filecompress is set, but zlib support is not built in. Rotated files are kept uncompressed.")));
+                rotation.Compress = false;
+            }
+
+            Announce(new Publishers::FileOutput(abbreviate, _config.FileName.Value(), rotation));
         }
+
+        // a datagram can not exceed the socket buffer of the UDP output
+        _frameExporter.FrameSize(std::min(_config.FrameSize.Value(), static_cast<uint16_t>(Messaging::MessageUnit::DataSize)));
+
         if ((_config.Remote.Binding.Value().empty() == false) && (_config.Remote.Port.Value() != 0)) {
-            Announce(new Publishers::UDPOutput(Core::NodeId(_config.Remote.NodeId())));
+            Publishers::UDPOutput* output = new Publishers::UDPOutput(Core::NodeId(_config.Remote.NodeId()), _config.Remote.Binary.Value());
+            Announce(output);
+            _frameExporter.Announce(output);
         }
 
         _webSocketExporter.Initialize(service, _config.MaxExportConnections.Value());
+        _frameExporter.Announce(&_webSocketExporter);
+
+        _throttle.Interval(_config.ThrottleInterval.Value());
+
+        Core::JSON::ArrayType<ThrottleRule>::Iterator rules(_config.Throttle.Elements());
+        while (rules.Next() == true) {
+            Publishers::Throttle::scope scope;
+            if (rules.Current().Scope(scope) == true) {
+                _throttle.Set(scope, rules.Current().Name.Value(), rules.Current().Limit());
+            }
+            else {
+                TRACE(Trace::Error, (_T("Ignoring throttle rule with type <%s> and name <%s>"), rules.Current().Type.Value().c_str(), rules.Current().Name.Value().c_str()));
+            }
+        }
 
         Exchange::JMessageControl::Register(*this, this);
+        RegisterAll();
 
         _service->Register(&_observer);
         
@@ -133,6 +237,7 @@ namespace WPEFramework {
         if (_service != nullptr) {
             ASSERT (_service == service);
 
+            UnregisterAll();
             Exchange::JMessageControl::Unregister(*this);
 
             Callback(nullptr);
@@ -141,6 +246,7 @@ namespace WPEFramework {
 
             _outputLock.Lock();
 
+            _frameExporter.Clear();
             _webSocketExporter.Deinitialize();
 
             _outputLock.Unlock();
@@ -150,6 +256,8 @@ namespace WPEFramework {
                 _outputDirector.pop_back();
             }
 
+            _throttle.Clear();
+
             _service->Release();
             _service = nullptr;
         }
@@ -74,6 +74,42 @@ namespace Plugin {
     private:
         using OutputList = std::vector<Publishers::IPublish*>;
 
+    public:
+        class ThrottleRule : public Core::JSON::Container {
+        public:
+            ThrottleRule();
+            ThrottleRule(const ThrottleRule& copy);
+            ThrottleRule& operator=(const ThrottleRule&) = delete;
+            ~ThrottleRule() override = default;
+
+        public:
+            bool Scope(Publishers::Throttle::scope& scope) const;
+
+            Publishers::Throttle::Limit Limit() const {
+                return { Rate.Value(), Burst.Value(), Sample.Value() };
+            }
+
+        public:
+            Core::JSON::String Type; // "module" or "category"
+            Core::JSON::String Name;
+            Core::JSON::DecUInt32 Rate;
+            Core::JSON::DecUInt32 Burst;
+            Core::JSON::DecUInt32 Sample;
+        };
+
+        class ThrottleInfo : public ThrottleRule {
+        public:
+            ThrottleInfo();
+            ThrottleInfo(const ThrottleInfo& copy);
+            ThrottleInfo& operator=(const ThrottleInfo&) = delete;
+            ~ThrottleInfo() override = default;
+
+        public:
+            Core::JSON::DecUInt64 Passed;
+            Core::JSON::DecUInt64 Suppressed;
+        };
+
+    private:
         class Config : public Core::JSON::Container {
         private:
             class NetworkNode : public Core::JSON::Container {
@@ -90,6 +126,7 @@ namespace Plugin {
             public:
                 Core::JSON::DecUInt16 Port;
                 Core::JSON::String Binding;
+                Core::JSON::Boolean Binary;
             };
 
         public:
@@ -98,16 +135,30 @@ namespace Plugin {
                 , Console(false)
                 , SysLog(false)
                 , FileName()
+                , FileMaxSize(0)
+                , FileRotatePeriod(0)
+                , FileSegments(Publishers::FileOutput::DefaultSegments)
+                , FileCompress(false)
                 , Abbreviated(true)
                 , MaxExportConnections(Publishers::WebSocketOutput::DefaultMaxConnections)
                 , Remote()
+                , FrameSize(Publishers::FrameExport::DefaultFrameSize)
+                , ThrottleInterval(Publishers::Throttle::DefaultReportInterval)
+                , Throttle()
             {
                 Add(_T("console"), &Console);
                 Add(_T("syslog"), &SysLog);
                 Add(_T("filepath"), &FileName);
+                Add(_T("filemaxsize"), &FileMaxSize);
+                Add(_T("filerotateperiod"), &FileRotatePeriod);
+                Add(_T("filesegments"), &FileSegments);
+                Add(_T("filecompress"), &FileCompress);
                 Add(_T("abbreviated"), &Abbreviated);
                 Add(_T("maxexportconnections"), &MaxExportConnections);
                 Add(_T("remote"), &Remote);
+                Add(_T("framesize"), &FrameSize);
+                Add(_T("throttleinterval"), &ThrottleInterval);
+                Add(_T("throttle"), &Throttle);
             }
             ~Config() = default;
 
@@ -117,9 +168,16 @@ namespace Plugin {
             Core::JSON::Boolean Console;
             Core::JSON::Boolean SysLog;
             Core::JSON::String FileName;
+            Core::JSON::DecUInt32 FileMaxSize; // KB
+            Core::JSON::DecUInt32 FileRotatePeriod; // seconds
+            Core::JSON::DecUInt8 FileSegments;
+            Core::JSON::Boolean FileCompress;
             Core::JSON::Boolean Abbreviated;
             Core::JSON::DecUInt16 MaxExportConnections;
             NetworkNode Remote;
+            Core::JSON::DecUInt16 FrameSize; // bytes per binary export frame
+            Core::JSON::DecUInt32 ThrottleInterval; // seconds between suppression reports
+            Core::JSON::ArrayType<ThrottleRule> Throttle;
         };
 
         class Observer
@@ -329,15 +387,33 @@ namespace Plugin {
         void Message(const Core::Messaging::MessageInfo& metadata, const string& message)
         {
             // Time to start sending it to all interested parties...
-            _outputLock.Lock();
+            if (_throttle.Allowed(metadata) == true) {
+                _outputLock.Lock();
 
-            for (auto& entry : _outputDirector) {
-                entry->Message(metadata, message);
-            }
+                for (auto& entry : _outputDirector) {
+                    entry->Message(metadata, message);
+                }
 
-            _webSocketExporter.Message(metadata, message);
+                _webSocketExporter.Message(metadata, message);
 
-            _outputLock.Unlock();
+                _frameExporter.Message(metadata, message);
+
+                _outputLock.Unlock();
+            }
+        }
+
+        void Report()
+        {
+            Publishers::Throttle::StatisticsList report;
+
+            if (_throttle.Report(report) == true) {
+                for (const Publishers::Throttle::Statistics& entry : report) {
+                    SYSLOG(Logging::Notification, (_T("Suppressed %llu messages of %s [%s] in the last %u seconds"),
+                        static_cast<unsigned long long>(entry.Suppressed),
+                        (entry.Scope == Publishers::Throttle::scope::MODULE ? _T("module") : _T("category")),
+                        entry.Name.c_str(), _throttle.Interval()));
+                }
+            }
         }
 
     public:
@@ -438,20 +514,38 @@ namespace Plugin {
     private:
         void Dispatch()
         {
-            _client.WaitForUpdates(Core::infinite);
+            // While throttling, wake up at least once per report interval so suppression counts
+            // are reported even when the flood has stopped.
+            _client.WaitForUpdates(_throttle.Active() == true ? (_throttle.Interval() * 1000) : Core::infinite);
 
             _client.PopMessagesAndCall([this](const Core::ProxyType<Core::Messaging::MessageInfo>& metadata, const Core::ProxyType<Core::Messaging::IEvent>& message) {
                 // Turn data into piecies to trasfer over the wire
                 Message(*metadata, message->Data());
             });
+
+            // Whatever was batched is sent now, a frame never waits for the next wakeup
+            _outputLock.Lock();
+            _frameExporter.Flush();
+            _outputLock.Unlock();
+
+            Report();
         }
 
+    private:
+        void RegisterAll();
+        void UnregisterAll();
+        uint32_t endpoint_throttle(const ThrottleRule& params);
+        uint32_t endpoint_unthrottle(const ThrottleRule& params);
+        uint32_t get_throttlestats(Core::JSON::ArrayType<ThrottleInfo>& response) const;
+
     private:
         Core::CriticalSection _adminLock;
         Core::CriticalSection _outputLock;
         Config _config;
         OutputList _outputDirector;
         Publishers::WebSocketOutput _webSocketExporter;
+        Publishers::FrameExport _frameExporter;
+        Publishers::Throttle _throttle;
         MessageControl::ICollect::ICallback* _callback;
         Core::Sink<Observer> _observer;
         PluginHost::IShell* _service;
@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "MessageControl.h"
+
+namespace WPEFramework {
+
+namespace Plugin {
+
+    // Registration
+    //
+
+    void MessageControl::RegisterAll()
+    {
+        Register<ThrottleRule,void>(_T("throttle"), &MessageControl::endpoint_throttle, this);
+        Register<ThrottleRule,void>(_T("unthrottle"), &MessageControl::endpoint_unthrottle, this);
+        Property<Core::JSON::ArrayType<ThrottleInfo>>(_T("throttlestats"), &MessageControl::get_throttlestats, nullptr, this);
+    }
+
+    void MessageControl::UnregisterAll()
+    {
+        Unregister(_T("throttle"));
+        Unregister(_T("unthrottle"));
+        Unregister(_T("throttlestats"));
+    }
+
+    // API implementation
+    //
+
+    // Method: throttle - Sets the rate limit and sampling for a module or category
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_BAD_REQUEST: Type is not "module" or "category", or name is empty
+    uint32_t MessageControl::endpoint_throttle(const ThrottleRule& params)
+    {
+        uint32_t result = Core::ERROR_BAD_REQUEST;
+        Publishers::Throttle::scope scope;
+
+        if (params.Scope(scope) == true) {
+            _throttle.Set(scope, params.Name.Value(), params.Limit());
+            result = Core::ERROR_NONE;
+        }
+
+        return (result);
+    }
+
+    // Method: unthrottle - Removes the rate limit and sampling of a module or category
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_BAD_REQUEST: Type is not "module" or "category", or name is empty
+    //  - ERROR_UNKNOWN_KEY: No rule for this module or category
+    uint32_t MessageControl::endpoint_unthrottle(const ThrottleRule& params)
+    {
+        uint32_t result = Core::ERROR_BAD_REQUEST;
+        Publishers::Throttle::scope scope;
+
+        if (params.Scope(scope) == true) {
+            result = (_throttle.Remove(scope, params.Name.Value()) == true ? Core::ERROR_NONE : Core::ERROR_UNKNOWN_KEY);
+        }
+
+        return (result);
+    }
+
+    // Property: throttlestats - Passed and suppressed message counts of every throttle rule
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t MessageControl::get_throttlestats(Core::JSON::ArrayType<ThrottleInfo>& response) const
+    {
+        Publishers::Throttle::StatisticsList statistics;
+        _throttle.Snapshot(statistics);
+
+        for (const Publishers::Throttle::Statistics& entry : statistics) {
+            ThrottleInfo& info = response.Add();
+            info.Type = (entry.Scope == Publishers::Throttle::scope::MODULE ? _T("module") : _T("category"));
+            info.Name = entry.Name;
+            info.Rate = entry.Rule.Rate;
+            info.Burst = entry.Rule.Burst;
+            info.Sample = entry.Rule.Sample;
+            info.Passed = entry.Passed;
+            info.Suppressed = entry.Suppressed;
+        }
+
+        return (Core::ERROR_NONE);
+    }
+
+} // namespace Plugin
+}
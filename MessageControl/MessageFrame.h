@@ -0,0 +1,222 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Binary export format shared by the plugin and tools/MessageDecoder. Kept free of
+// framework dependencies so the decoder builds standalone.
+//
+// A frame carries a batch of messages, all integers are little endian:
+//
+//   frame  := magic[2] ('M' 'C') | version (1) | count (1) | length (2, whole frame) | record[count]
+//   record := timestamp (8, us since epoch) | type (1)
+//             | module length (1) | module | category length (1) | category
+//             | payload length (2) | payload
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace WPEFramework {
+
+namespace Publishers {
+
+namespace Frame {
+
+    static constexpr uint8_t Version = 1;
+    static constexpr uint16_t HeaderSize = 6;
+    static constexpr uint16_t MaxSize = 0xFFFF;
+
+    struct Record {
+        uint64_t TimeStamp;
+        uint8_t Type;
+        std::string Module;
+        std::string Category;
+        std::string Payload;
+    };
+
+    class Writer {
+    public:
+        Writer() = delete;
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        Writer(uint8_t buffer[], const uint16_t capacity)
+            : _buffer(buffer)
+            , _capacity(capacity)
+            , _length(HeaderSize)
+            , _count(0)
+        {
+        }
+        ~Writer() = default;
+
+    public:
+        const uint8_t* Data() const {
+            return (_buffer);
+        }
+        uint16_t Length() const {
+            return (_count != 0 ? _length : 0);
+        }
+        uint8_t Count() const {
+            return (_count);
+        }
+        void Reset()
+        {
+            _length = HeaderSize;
+            _count = 0;
+        }
+
+        // Returns false if the record does not fit, the caller should flush and retry. A record
+        // that does not even fit an empty frame is stored with its payload truncated.
+        bool Append(const uint64_t timeStamp, const uint8_t type, const std::string& module, const std::string& category, const std::string& payload)
+        {
+            const uint8_t moduleLength = static_cast<uint8_t>(module.length() < 0xFF ? module.length() : 0xFF);
+            const uint8_t categoryLength = static_cast<uint8_t>(category.length() < 0xFF ? category.length() : 0xFF);
+            const uint32_t fixed = 8 + 1 + 1 + moduleLength + 1 + categoryLength + 2;
+            uint32_t payloadLength = static_cast<uint32_t>(payload.length());
+
+            if ((_count == 0xFF) || ((_length + fixed + payloadLength) > _capacity)) {
+                if ((_count != 0) || ((_length + fixed) >= _capacity)) {
+                    return (false);
+                }
+                payloadLength = _capacity - _length - fixed;
+            }
+
+            uint8_t* out = &_buffer[_length];
+
+            for (uint8_t index = 0; index < 8; index++) {
+                *out++ = static_cast<uint8_t>(timeStamp >> (8 * index));
+            }
+            *out++ = type;
+            *out++ = moduleLength;
+            ::memcpy(out, module.data(), moduleLength);
+            out += moduleLength;
+            *out++ = categoryLength;
+            ::memcpy(out, category.data(), categoryLength);
+            out += categoryLength;
+            *out++ = static_cast<uint8_t>(payloadLength & 0xFF);
+            *out++ = static_cast<uint8_t>(payloadLength >> 8);
+            ::memcpy(out, payload.data(), payloadLength);
+
+            _length += static_cast<uint16_t>(fixed + payloadLength);
+            _count++;
+
+            _buffer[0] = 'M';
+            _buffer[1] = 'C';
+            _buffer[2] = Version;
+            _buffer[3] = _count;
+            _buffer[4] = static_cast<uint8_t>(_length & 0xFF);
+            _buffer[5] = static_cast<uint8_t>(_length >> 8);
+
+            return (true);
+        }
+
+    private:
+        uint8_t* _buffer;
+        const uint16_t _capacity;
+        uint16_t _length;
+        uint8_t _count;
+    };
+
+    class Reader {
+    public:
+        Reader() = delete;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // Parses the frame at the start of the buffer, Length() tells where the next frame starts
+        Reader(const uint8_t buffer[], const uint32_t available)
+            : _buffer(buffer)
+            , _length(0)
+            , _offset(HeaderSize)
+            , _remaining(0)
+        {
+            if ((available >= HeaderSize) && (buffer[0] == 'M') && (buffer[1] == 'C') && (buffer[2] == Version)) {
+                const uint16_t length = static_cast<uint16_t>(buffer[4] | (buffer[5] << 8));
+                if ((length >= HeaderSize) && (length <= available)) {
+                    _length = length;
+                    _remaining = buffer[3];
+                }
+            }
+        }
+        ~Reader() = default;
+
+    public:
+        bool IsValid() const {
+            return (_length != 0);
+        }
+        uint16_t Length() const {
+            return (_length);
+        }
+
+        bool Next(Record& record)
+        {
+            if ((_remaining == 0) || (Available() < 10)) {
+                return (false);
+            }
+
+            record.TimeStamp = 0;
+            for (uint8_t index = 0; index < 8; index++) {
+                record.TimeStamp |= (static_cast<uint64_t>(_buffer[_offset++]) << (8 * index));
+            }
+            record.Type = _buffer[_offset++];
+
+            bool valid = String(1, record.Module) && String(1, record.Category) && String(2, record.Payload);
+
+            _remaining = (valid == true ? _remaining - 1 : 0);
+
+            return (valid);
+        }
+
+    private:
+        uint32_t Available() const {
+            return (_length - _offset);
+        }
+
+        bool String(const uint8_t sizeBytes, std::string& value)
+        {
+            if (Available() < sizeBytes) {
+                return (false);
+            }
+
+            uint32_t size = _buffer[_offset++];
+            if (sizeBytes == 2) {
+                size |= (static_cast<uint32_t>(_buffer[_offset++]) << 8);
+            }
+            if (Available() < size) {
+                return (false);
+            }
+
+            value.assign(reinterpret_cast<const char*>(&_buffer[_offset]), size);
+            _offset += size;
+
+            return (true);
+        }
+
+    private:
+        const uint8_t* _buffer;
+        uint16_t _length;
+        uint32_t _offset;
+        uint8_t _remaining;
+    };
+
+} // namespace Frame
+
+} // namespace Publishers
+}
@@ -19,10 +19,58 @@
 
 #include "MessageOutput.h"
 
+#include <algorithm>
+#include <cstdio>
+
+#ifdef MESSAGECONTROL_COMPRESS_ROTATED
+#include <zlib.h>
+#endif
+
 namespace WPEFramework {
 
 namespace Publishers {
 
+    constexpr uint16_t FrameExport::DefaultFrameSize;
+
+    bool FrameExport::Exporting() const
+    {
+        bool exporting = false;
+
+        for (const IExport* exporter : _exporters) {
+            exporting = exporting || exporter->Exporting();
+        }
+
+        return (exporting);
+    }
+
+    void FrameExport::Message(const Core::Messaging::MessageInfo& metadata, const string& text)
+    {
+        if ((_exporters.empty() == false) && (Exporting() == true)) {
+            const uint8_t type = static_cast<uint8_t>(metadata.Type());
+
+            if (_frame->Append(metadata.TimeStamp(), type, metadata.Module(), metadata.Category(), text) == false) {
+                Flush();
+
+                if (_frame->Append(metadata.TimeStamp(), type, metadata.Module(), metadata.Category(), text) == false) {
+                    TRACE(Trace::Error, (_T("Message of module <%s> does not fit an export frame"), metadata.Module().c_str()));
+                }
+            }
+        }
+    }
+
+    void FrameExport::Flush()
+    {
+        if (_frame->Count() != 0) {
+            for (IExport* exporter : _exporters) {
+                if (exporter->Exporting() == true) {
+                    exporter->Frame(_frame->Data(), _frame->Length());
+                }
+            }
+
+            _frame->Reset();
+        }
+    }
+
     string Text::Convert(const Core::Messaging::MessageInfo& metadata, const string& text) /* override */
     {
         ASSERT(metadata.Type() != Core::Messaging::Metadata::type::INVALID);
@@ -33,6 +81,156 @@ namespace Publishers {
         return (output);
     }
 
+    constexpr uint32_t Throttle::DefaultReportInterval;
+
+    void Throttle::Set(const scope which, const string& name, const Limit& limit)
+    {
+        _adminLock.Lock();
+
+        BucketMap& buckets = Buckets(which);
+
+        if ((limit.Rate == 0) && (limit.Sample <= 1)) {
+            buckets.erase(name);
+        }
+        else {
+            Bucket& bucket = buckets[name];
+            bucket.Rule = limit;
+            bucket.Tokens = (limit.Burst != 0 ? limit.Burst : limit.Rate);
+            bucket.Refilled = Core::Time::Now().Ticks();
+            bucket.Counter = 0;
+        }
+
+        _active = ((_modules.empty() == false) || (_categories.empty() == false));
+
+        _adminLock.Unlock();
+    }
+
+    bool Throttle::Remove(const scope which, const string& name)
+    {
+        _adminLock.Lock();
+
+        bool removed = (Buckets(which).erase(name) != 0);
+        _active = ((_modules.empty() == false) || (_categories.empty() == false));
+
+        _adminLock.Unlock();
+
+        return (removed);
+    }
+
+    void Throttle::Clear()
+    {
+        _adminLock.Lock();
+
+        _modules.clear();
+        _categories.clear();
+        _active = false;
+
+        _adminLock.Unlock();
+    }
+
+    bool Throttle::Allowed(const Core::Messaging::MessageInfo& metadata)
+    {
+        bool allowed = true;
+
+        if (Active() == true) {
+            const uint64_t now = Core::Time::Now().Ticks();
+
+            _adminLock.Lock();
+
+            if (_modules.empty() == false) {
+                BucketMap::iterator index = _modules.find(metadata.Module());
+                if (index != _modules.end()) {
+                    allowed = Admit(index->second, now);
+                }
+            }
+            if ((allowed == true) && (_categories.empty() == false)) {
+                BucketMap::iterator index = _categories.find(metadata.Category());
+                if (index != _categories.end()) {
+                    allowed = Admit(index->second, now);
+                }
+            }
+
+            _adminLock.Unlock();
+        }
+
+        return (allowed);
+    }
+
+    /* static */ bool Throttle::Admit(Bucket& bucket, const uint64_t now)
+    {
+        bool admitted = true;
+
+        if (bucket.Rule.Sample > 1) {
+            admitted = ((bucket.Counter++ % bucket.Rule.Sample) == 0);
+        }
+
+        if ((admitted == true) && (bucket.Rule.Rate != 0)) {
+            const double depth = (bucket.Rule.Burst != 0 ? bucket.Rule.Burst : bucket.Rule.Rate);
+            const double refill = (static_cast<double>(now - bucket.Refilled) * bucket.Rule.Rate) / (Core::Time::TicksPerMillisecond * 1000);
+
+            bucket.Tokens = std::min(depth, bucket.Tokens + refill);
+            bucket.Refilled = now;
+
+            if (bucket.Tokens >= 1.0) {
+                bucket.Tokens -= 1.0;
+            }
+            else {
+                admitted = false;
+            }
+        }
+
+        if (admitted == true) {
+            bucket.Passed++;
+        }
+        else {
+            bucket.Suppressed++;
+            bucket.Pending++;
+        }
+
+        return (admitted);
+    }
+
+    bool Throttle::Report(StatisticsList& report)
+    {
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _adminLock.Lock();
+
+        if ((now - _reported) >= (static_cast<uint64_t>(_interval) * Core::Time::TicksPerMillisecond * 1000)) {
+            _reported = now;
+
+            for (BucketMap* buckets : { &_modules, &_categories }) {
+                for (auto& entry : *buckets) {
+                    if (entry.second.Pending != 0) {
+                        report.push_back({ (buckets == &_modules ? scope::MODULE : scope::CATEGORY), entry.first, entry.second.Rule, entry.second.Passed, entry.second.Pending });
+                        entry.second.Pending = 0;
+                    }
+                }
+            }
+        }
+
+        _adminLock.Unlock();
+
+        return (report.empty() == false);
+    }
+
+    void Throttle::Snapshot(StatisticsList& statistics) const
+    {
+        _adminLock.Lock();
+
+        Collect(scope::MODULE, _modules, statistics);
+        Collect(scope::CATEGORY, _categories, statistics);
+
+        _adminLock.Unlock();
+    }
+
+    /* static */ void Throttle::Collect(const scope which, const BucketMap& buckets, StatisticsList& statistics)
+    {
+        for (const auto& entry : buckets) {
+            statistics.push_back({ which, entry.first, entry.second.Rule, entry.second.Passed, entry.second.Suppressed });
+        }
+    }
+
     void ConsoleOutput::Message(const Core::Messaging::MessageInfo& metadata, const string& text) /* override */
     {
         std::cout << _convertor.Convert(metadata, text);
@@ -47,12 +245,278 @@ namespace Publishers {
 #endif
     }
 
-    void FileOutput::Message(const Core::Messaging::MessageInfo& metadata, const string& text) /* override */
+    constexpr uint32_t FileOutput::DefaultFlushInterval;
+    constexpr uint32_t FileOutput::DefaultFlushSize;
+    constexpr uint32_t FileOutput::DefaultMaxPending;
+    constexpr uint8_t FileOutput::DefaultSegments;
+
+    FileOutput::FileOutput(const Core::Messaging::MessageInfo::abbreviate abbreviate, const string& filepath, const Rotation& rotation)
+        : _convertor(abbreviate)
+        , _filepath(filepath)
+        , _rotation(rotation)
+        , _file(filepath)
+        , _opened(false)
+        , _adminLock()
+        , _signal(false, false)
+        , _front()
+        , _back()
+        , _dropped(0)
+        , _segmentSize(0)
+        , _segmentStart(Core::Time::Now().Ticks())
+        , _rotations(0)
+        , _writer(*this)
+        , _rotatedLock()
+        , _rotatedSignal(false, false)
+        , _rotated()
+        , _compressor(*this)
+    {
+        _file.Create();
+
+        if (!_file.IsOpen()) {
+            TRACE(Trace::Error, (_T("Could not open file <%s>. Outputting warnings to file unavailable."), filepath.c_str()));
+        }
+        else {
+            _opened = true;
+            _front.reserve(DefaultFlushSize * 2);
+            _back.reserve(DefaultFlushSize * 2);
+            _writer.Run();
+
+            if (_rotation.Compress == true) {
+                _compressor.Run();
+            }
+        }
+    }
+
+    FileOutput::~FileOutput()
     {
+        _writer.Stop();
+        _signal.SetEvent();
+        _writer.Wait(Core::Thread::STOPPED, Core::infinite);
+
         if (_file.IsOpen()) {
+            // Write whatever was queued after the last wakeup of the writer
+            _signal.SetEvent();
+            Flush();
+            _file.Close();
+        }
+
+        _compressor.Stop();
+        _rotatedSignal.SetEvent();
+        _compressor.Wait(Core::Thread::STOPPED, Core::infinite);
+
+        // Segments rotated out while shutting down
+        CompressRotated();
+    }
+
+    void FileOutput::Message(const Core::Messaging::MessageInfo& metadata, const string& text) /* override */
+    {
+        // _file itself belongs to the writer, it is closed and reopened on rotation
+        if (_opened == true) {
             const string line = _convertor.Convert(metadata, text);
-            _file.Write(reinterpret_cast<const uint8_t*>(line.c_str()), static_cast<uint32_t>(line.length()));
+
+            _adminLock.Lock();
+
+            if ((_front.size() + line.length()) > DefaultMaxPending) {
+                // The device cannot keep up, shed load rather than growing without bound
+                _dropped++;
+            }
+            else {
+                _front.append(line);
+
+                if (_front.size() >= DefaultFlushSize) {
+                    _signal.SetEvent();
+                }
+            }
+
+            _adminLock.Unlock();
+        }
+    }
+
+    void FileOutput::Flush()
+    {
+        _signal.Lock(DefaultFlushInterval);
+
+        _adminLock.Lock();
+        _front.swap(_back);
+        const uint32_t dropped = _dropped;
+        _dropped = 0;
+        _adminLock.Unlock();
+
+        if (dropped != 0) {
+            _back.append(Core::Format(_T("[MessageControl] %u messages dropped, file output could not keep up\n"), dropped));
+        }
+
+        if (RotationDue(static_cast<uint32_t>(_back.size())) == true) {
+            Rotate();
+        }
+
+        if ((_back.empty() == false) && (_file.IsOpen() == true)) {
+            // One write per batch instead of one per message
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(_back.c_str());
+            uint32_t length = static_cast<uint32_t>(_back.length());
+
+            while (length > 0) {
+                const uint32_t written = _file.Write(data, length);
+
+                if (written == 0) {
+                    break;
+                }
+                data += written;
+                length -= written;
+            }
+            _segmentSize += (_back.length() - length);
+        }
+
+        // clear() keeps the capacity, so steady state needs no allocations
+        _back.clear();
+    }
+
+    bool FileOutput::RotationDue(const uint32_t pending) const
+    {
+        bool due = false;
+
+        if (_segmentSize > 0) {
+            if ((_rotation.MaxSize != 0) && ((_segmentSize + pending) > _rotation.MaxSize)) {
+                due = true;
+            }
+            else if ((_rotation.Period != 0) && ((Core::Time::Now().Ticks() - _segmentStart) >= (static_cast<uint64_t>(_rotation.Period) * 1000000))) {
+                due = true;
+            }
+        }
+
+        return (due);
+    }
+
+    /* static */ bool FileOutput::CompressionSupported()
+    {
+#ifdef MESSAGECONTROL_COMPRESS_ROTATED
+        return (true);
+#else
+        return (false);
+#endif
+    }
+
+    string FileOutput::SegmentName(const uint8_t index, const bool compressed) const
+    {
+        return (_filepath + '.' + Core::NumberType<uint8_t>(index).Text() + (compressed == true ? _T(".gz") : _T("")));
+    }
+
+    // Moves <file>.N[.gz] to <file>.N+1[.gz] and drops the oldest, so <file>.1 is free. Segments
+    // that could not be compressed rotate as plain files next to the compressed ones.
+    void FileOutput::ShiftSegments() const
+    {
+        Core::File(SegmentName(_rotation.Segments, false)).Destroy();
+        Core::File(SegmentName(_rotation.Segments, true)).Destroy();
+
+        for (uint8_t index = _rotation.Segments - 1; index > 0; index--) {
+            for (const bool compressed : { false, true }) {
+                const string from(SegmentName(index, compressed));
+
+                if (Core::File(from).Exists() == true) {
+                    std::rename(from.c_str(), SegmentName(index + 1, compressed).c_str());
+                }
+            }
+        }
+    }
+
+    void FileOutput::Rotate()
+    {
+        _file.Close();
+
+        if (_rotation.Segments == 0) {
+            Core::File(_filepath).Destroy();
+        }
+        else if (_rotation.Compress == true) {
+            // Renaming is all the writer does, the compressor shifts and compresses the segment
+            const string rotated(_filepath + _T(".rotated.") + Core::NumberType<uint32_t>(_rotations++).Text());
+
+            if (std::rename(_filepath.c_str(), rotated.c_str()) == 0) {
+                _rotatedLock.Lock();
+                _rotated.push_back(rotated);
+                if (_rotated.size() > _rotation.Segments) {
+                    // The compressor is this far behind, the oldest would be rotated out anyway
+                    TRACE(Trace::Warning, (_T("Compression of rotated segments is behind, dropping <%s>."), _rotated.front().c_str()));
+                    Core::File(_rotated.front()).Destroy();
+                    _rotated.pop_front();
+                }
+                _rotatedLock.Unlock();
+
+                _rotatedSignal.SetEvent();
+            }
+        }
+        else {
+            ShiftSegments();
+            std::rename(_filepath.c_str(), SegmentName(1, false).c_str());
+        }
+
+        _file.Create();
+
+        if (!_file.IsOpen()) {
+            TRACE(Trace::Error, (_T("Could not reopen file <%s> after rotation."), _filepath.c_str()));
         }
+
+        _segmentSize = 0;
+        _segmentStart = Core::Time::Now().Ticks();
+    }
+
+    void FileOutput::CompressRotated()
+    {
+        _rotatedLock.Lock();
+
+        while (_rotated.empty() == false) {
+            const string rotated(_rotated.front());
+            _rotated.pop_front();
+            _rotatedLock.Unlock();
+
+            ShiftSegments();
+
+            if (Compress(rotated, SegmentName(1, true)) == true) {
+                Core::File(rotated).Destroy();
+            }
+            else {
+                // Kept as a plain <file>.1, it rotates with the compressed segments
+                TRACE(Trace::Error, (_T("Could not compress <%s>, keeping it uncompressed."), rotated.c_str()));
+                Core::File(SegmentName(1, true)).Destroy();
+                std::rename(rotated.c_str(), SegmentName(1, false).c_str());
+            }
+
+            _rotatedLock.Lock();
+        }
+
+        _rotatedLock.Unlock();
+    }
+
+    bool FileOutput::Compress(const string& source, const string& destination) const
+    {
+        bool result = false;
+
+#ifdef MESSAGECONTROL_COMPRESS_ROTATED
+        FILE* input = fopen(source.c_str(), "rb");
+
+        if (input != nullptr) {
+            gzFile output = gzopen(destination.c_str(), "wb");
+
+            if (output != nullptr) {
+                uint8_t buffer[16 * 1024];
+                size_t loaded;
+
+                result = true;
+
+                while ((result == true) && ((loaded = fread(buffer, 1, sizeof(buffer), input)) > 0)) {
+                    result = (gzwrite(output, buffer, static_cast<unsigned>(loaded)) == static_cast<int>(loaded));
+                }
+
+                result = (gzclose(output) == Z_OK) && (result == true);
+            }
+
+            fclose(input);
+        }
+#else
+        TRACE(Trace::Warning, (_T("Compression of <%s> requested, but zlib support is not built in."), destination.c_str()));
+        (void)source;
+#endif
+
+        return (result);
     }
 
     void JSON::Convert(const Core::Messaging::MessageInfo& metadata, const string& text, Data& data)
@@ -143,9 +607,19 @@ namespace Publishers {
     {
         _adminLock.Lock();
 
-        uint16_t actualByteCount = (_loaded > maxSendSize ? maxSendSize : _loaded);
-        memcpy(dataFrame, _sendBuffer, actualByteCount);
-        _loaded = 0;
+        uint16_t actualByteCount = 0;
+
+        if (_loaded != 0) {
+            actualByteCount = (_loaded > maxSendSize ? maxSendSize : _loaded);
+            memcpy(dataFrame, _sendBuffer, actualByteCount);
+            _loaded = 0;
+        }
+        else if (_frames.empty() == false) {
+            const std::vector<uint8_t>& frame = _frames.front();
+            actualByteCount = static_cast<uint16_t>(frame.size() > maxSendSize ? maxSendSize : frame.size());
+            memcpy(dataFrame, frame.data(), actualByteCount);
+            _frames.pop_front();
+        }
 
         _adminLock.Unlock();
 
@@ -177,16 +651,77 @@ namespace Publishers {
         Trigger();
     }
 
-    UDPOutput::UDPOutput(const Core::NodeId& nodeId)
-        : _output(nodeId) {
+    void UDPOutput::Channel::Output(const uint8_t data[], const uint16_t length)
+    {
+        _adminLock.Lock();
+
+        if (_frames.size() >= UDPOutput::MaxPendingFrames) {
+            // The socket can not keep up, drop the oldest batch rather than grow without bound
+            _frames.pop_front();
+        }
+        _frames.emplace_back(data, data + length);
+
+        _adminLock.Unlock();
+
+        Trigger();
+    }
+
+    constexpr uint8_t UDPOutput::MaxPendingFrames;
+
+    UDPOutput::UDPOutput(const Core::NodeId& nodeId, const bool binary)
+        : _output(nodeId)
+        , _binary(binary) {
         _output.Open(0);
     }
 
     void UDPOutput::Message(const Core::Messaging::MessageInfo& metadata, const string& text) /* override */
     {
-        //yikes, recreating stuff from received pieces
-        Messaging::TextMessage textMessage(text);
-        _output.Output(metadata, &textMessage);
+        // In binary mode messages reach us batched through Frame()
+        if (_binary == false) {
+            //yikes, recreating stuff from received pieces
+            Messaging::TextMessage textMessage(text);
+            _output.Output(metadata, &textMessage);
+        }
+    }
+
+    void UDPOutput::Frame(const uint8_t data[], const uint16_t length) /* override */
+    {
+        _output.Output(data, length);
+    }
+
+    void WebSocketOutput::Frame(const uint8_t data[], const uint16_t length) /* override */
+    {
+        std::list<uint32_t> channels;
+        PluginHost::IShell* server = nullptr;
+
+        _lock.Lock();
+
+        if (_server != nullptr) {
+            for (const auto& item : _channels) {
+                if ((item.second.Paused() == false) && (item.second.Binary() == true)) {
+                    channels.push_back(item.first);
+                }
+            }
+            if (channels.empty() == false) {
+                server = _server;
+                server->AddRef();
+            }
+        }
+
+        _lock.Unlock();
+
+        if (server != nullptr) {
+            // Encoded once, the same element is submitted to every binary channel
+            Core::ProxyType<ExportFrame> frame = _jsonExportFrameFactory.Element();
+            string encoded;
+            Core::ToString(data, length, true, encoded);
+            frame->Frame = encoded;
+
+            for (const uint32_t id : channels) {
+                server->Submit(id, Core::ProxyType<Core::JSON::IElement>(frame));
+            }
+            server->Release();
+        }
     }
 
 } // namespace Publishers
@@ -19,6 +19,7 @@
 
 #pragma once
 #include "Module.h"
+#include "MessageFrame.h"
 
 namespace WPEFramework {
 
@@ -30,6 +31,70 @@ namespace Publishers {
         virtual void Message(const Core::Messaging::MessageInfo& metadata, const string& text) = 0;
     };
 
+    // Receives batches of messages in the binary format of MessageFrame.h. The same frame is
+    // handed to every exporter, so it is serialized once regardless of the number of subscribers.
+    struct IExport {
+        virtual ~IExport() = default;
+
+        virtual bool Exporting() const = 0;
+        virtual void Frame(const uint8_t data[], const uint16_t length) = 0;
+    };
+
+    class FrameExport {
+    private:
+        using ExportList = std::vector<IExport*>;
+
+    public:
+        static constexpr uint16_t DefaultFrameSize = 1400; // keeps a datagram within a typical MTU
+
+    public:
+        FrameExport(const FrameExport&) = delete;
+        FrameExport& operator=(const FrameExport&) = delete;
+
+        FrameExport()
+            : _exporters()
+            , _buffer(new uint8_t[DefaultFrameSize])
+            , _frame(new Frame::Writer(_buffer.get(), DefaultFrameSize))
+        {
+        }
+        ~FrameExport() = default;
+
+    public:
+        void FrameSize(const uint16_t size)
+        {
+            ASSERT(_frame->Count() == 0);
+
+            const uint16_t capacity = (size > Frame::HeaderSize ? size : DefaultFrameSize);
+            _frame.reset();
+            _buffer.reset(new uint8_t[capacity]);
+            _frame.reset(new Frame::Writer(_buffer.get(), capacity));
+        }
+
+        void Announce(IExport* exporter)
+        {
+            ASSERT(std::find(_exporters.begin(), _exporters.end(), exporter) == _exporters.end());
+            _exporters.push_back(exporter);
+        }
+
+        void Clear()
+        {
+            _exporters.clear();
+            _frame->Reset();
+        }
+
+        // Not thread safe, called from the message dispatcher only
+        void Message(const Core::Messaging::MessageInfo& metadata, const string& text);
+        void Flush();
+
+    private:
+        bool Exporting() const;
+
+    private:
+        ExportList _exporters;
+        std::unique_ptr<uint8_t[]> _buffer;
+        std::unique_ptr<Frame::Writer> _frame;
+    };
+
     class Text {
     public:
         Text() = delete;
@@ -49,6 +114,103 @@ namespace Publishers {
         Core::Messaging::MessageInfo::abbreviate _abbreviated;
     };
 
+    // Per module and per category rate limiting and sampling, evaluated before any output
+    // formats a message, so suppressed messages cost a hash lookup and nothing else.
+    class Throttle {
+    public:
+        static constexpr uint32_t DefaultReportInterval = 10; // seconds
+
+        enum class scope : uint8_t {
+            MODULE,
+            CATEGORY
+        };
+
+        struct Limit {
+            uint32_t Rate; // messages per second, 0 disables rate limiting
+            uint32_t Burst; // bucket depth, 0 allows one second worth of Rate
+            uint32_t Sample; // pass 1 in Sample messages, 0 or 1 passes all
+        };
+
+        struct Statistics {
+            scope Scope;
+            string Name;
+            Limit Rule;
+            uint64_t Passed;
+            uint64_t Suppressed;
+        };
+
+        using StatisticsList = std::vector<Statistics>;
+
+    private:
+        struct Bucket {
+            Limit Rule;
+            double Tokens;
+            uint64_t Refilled;
+            uint32_t Counter;
+            uint64_t Passed;
+            uint64_t Suppressed;
+            uint64_t Pending; // suppressed since the last report
+        };
+
+        using BucketMap = std::unordered_map<string, Bucket>;
+
+    public:
+        Throttle(const Throttle&) = delete;
+        Throttle& operator=(const Throttle&) = delete;
+
+        Throttle()
+            : _adminLock()
+            , _modules()
+            , _categories()
+            , _active(false)
+            , _interval(DefaultReportInterval)
+            , _reported(Core::Time::Now().Ticks())
+        {
+        }
+        ~Throttle() = default;
+
+    public:
+        bool Active() const {
+            return (_active.load(std::memory_order_relaxed));
+        }
+
+        uint32_t Interval() const {
+            return (_interval);
+        }
+
+        void Interval(const uint32_t seconds)
+        {
+            _interval = (seconds != 0 ? seconds : DefaultReportInterval);
+        }
+
+        // A limit without rate and sampling removes the rule
+        void Set(const scope which, const string& name, const Limit& limit);
+        bool Remove(const scope which, const string& name);
+        void Clear();
+
+        bool Allowed(const Core::Messaging::MessageInfo& metadata);
+
+        // Collects the rules that suppressed messages since the previous report, once per interval
+        bool Report(StatisticsList& report);
+        void Snapshot(StatisticsList& statistics) const;
+
+    private:
+        static bool Admit(Bucket& bucket, const uint64_t now);
+        static void Collect(const scope which, const BucketMap& buckets, StatisticsList& statistics);
+
+        BucketMap& Buckets(const scope which) {
+            return (which == scope::MODULE ? _modules : _categories);
+        }
+
+    private:
+        mutable Core::CriticalSection _adminLock;
+        BucketMap _modules;
+        BucketMap _categories;
+        std::atomic<bool> _active;
+        std::atomic<uint32_t> _interval;
+        uint64_t _reported;
+    };
+
     class ConsoleOutput : public IPublish {
     public:
         ConsoleOutput() = delete;
@@ -88,34 +250,119 @@ namespace Publishers {
     };
   
     class FileOutput : public IPublish {
+    private:
+        // Drains the filled buffer to disk, so a slow device never stalls the message dispatcher.
+        class Writer : public Core::Thread {
+        public:
+            Writer() = delete;
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            Writer(FileOutput& parent)
+                : Core::Thread()
+                , _parent(parent)
+            {
+            }
+            ~Writer() override = default;
+
+        private:
+            uint32_t Worker() override
+            {
+                _parent.Flush();
+
+                return (0);
+            }
+
+        private:
+            FileOutput& _parent;
+        };
+
+        // Compresses rotated segments, so gzip of a large segment never holds up the writer.
+        class Compressor : public Core::Thread {
+        public:
+            Compressor() = delete;
+            Compressor(const Compressor&) = delete;
+            Compressor& operator=(const Compressor&) = delete;
+
+            Compressor(FileOutput& parent)
+                : Core::Thread()
+                , _parent(parent)
+            {
+            }
+            ~Compressor() override = default;
+
+        private:
+            uint32_t Worker() override
+            {
+                _parent._rotatedSignal.Lock(Core::infinite);
+                _parent.CompressRotated();
+
+                return (0);
+            }
+
+        private:
+            FileOutput& _parent;
+        };
+
+    public:
+        static constexpr uint32_t DefaultFlushInterval = 1000; // ms
+        static constexpr uint32_t DefaultFlushSize = 64 * 1024;
+        static constexpr uint32_t DefaultMaxPending = 4 * 1024 * 1024;
+        static constexpr uint8_t DefaultSegments = 3;
+
+        struct Rotation {
+            uint64_t MaxSize; // bytes per segment, 0 disables size based rotation
+            uint32_t Period; // seconds per segment, 0 disables time based rotation
+            uint8_t Segments; // rotated segments kept next to the active file
+            bool Compress; // gzip rotated segments, needs zlib support, see CompressionSupported()
+        };
+
+        static bool CompressionSupported();
+
     public:
         FileOutput() = delete;
         FileOutput(const FileOutput&) = delete;
         FileOutput& operator=(const FileOutput&) = delete;
 
-        explicit FileOutput(const Core::Messaging::MessageInfo::abbreviate abbreviate, const string& filepath)
-            : _convertor(abbreviate)
-            , _file(filepath)
-        {
-            _file.Create();
-
-            if (!_file.IsOpen()) {
-                TRACE(Trace::Error, (_T("Could not open file <%s>. Outputting warnings to file unavailable."), filepath));
-            }
-        }
-        ~FileOutput() override
-        {
-            if (_file.IsOpen()) {
-                _file.Close();
-            }
-        }
+        FileOutput(const Core::Messaging::MessageInfo::abbreviate abbreviate, const string& filepath, const Rotation& rotation);
+        ~FileOutput() override;
 
     public:
         void Message(const Core::Messaging::MessageInfo& metadata, const string& text);
 
+    private:
+        void Flush();
+        void Rotate();
+        bool RotationDue(const uint32_t pending) const;
+        string SegmentName(const uint8_t index, const bool compressed) const;
+        void ShiftSegments() const;
+        void CompressRotated();
+        bool Compress(const string& source, const string& destination) const;
+
     private:
         Text _convertor;
+        const string _filepath;
+        const Rotation _rotation;
         Core::File _file;
+        bool _opened;
+
+        Core::CriticalSection _adminLock;
+        Core::Event _signal; // auto reset, every wakeup is consumed by the Lock() in Flush()
+        string _front;
+        string _back;
+        uint32_t _dropped;
+
+        // only touched by the writer thread
+        uint64_t _segmentSize;
+        uint64_t _segmentStart;
+        uint32_t _rotations;
+        Writer _writer;
+
+        // segments rotated out by the writer, waiting for the compressor
+        Core::CriticalSection _rotatedLock;
+        Core::Event _rotatedSignal; // auto reset, like _signal
+        std::list<string> _rotated;
+        Compressor _compressor;
     };
 
     class JSON  {
@@ -130,7 +377,8 @@ namespace Publishers {
             CALLSIGN      = 0x20,
             INCLUDINGDATE = 0x40,
             ALL           = 0x7F,
-            PAUSED        = 0x80
+            PAUSED        = 0x80,
+            BINARY        = 0x100
         };
 
     public:
@@ -295,6 +543,20 @@ namespace Publishers {
             }
         }
 
+        bool Binary() const {
+            return ((AsNumber<ExtraOutputOptions>(_outputOptions) & AsNumber(ExtraOutputOptions::BINARY)) != 0);
+        }
+
+        void Binary(const bool enabled)
+        {
+            if (enabled == true) {
+                _outputOptions = static_cast<ExtraOutputOptions>(AsNumber<ExtraOutputOptions>(_outputOptions) | AsNumber(ExtraOutputOptions::BINARY));
+            }
+            else {
+                _outputOptions = static_cast<ExtraOutputOptions>(AsNumber<ExtraOutputOptions>(_outputOptions) & ~AsNumber(ExtraOutputOptions::BINARY));
+            }
+        }
+
         void Convert(const Core::Messaging::MessageInfo& metadata, const string& text, Data& info);
 
     private:
@@ -307,7 +569,7 @@ namespace Publishers {
         std::atomic<ExtraOutputOptions> _outputOptions;
     };
 
-    class UDPOutput : public IPublish {
+    class UDPOutput : public IPublish, public IExport {
     private:
         class Channel : public Core::SocketDatagram {
         public:
@@ -319,6 +581,7 @@ namespace Publishers {
             ~Channel() override;
 
             void Output(const Core::Messaging::Metadata& metadata, const Core::Messaging::IEvent* message);
+            void Output(const uint8_t data[], const uint16_t length);
 
         private:
             uint16_t SendData(uint8_t* dataFrame, const uint16_t maxSendSize) override;
@@ -328,24 +591,35 @@ namespace Publishers {
 
             uint8_t _sendBuffer[Messaging::MessageUnit::DataSize];
             uint16_t _loaded;
+            // binary frames waiting for the socket, one datagram each
+            std::list<std::vector<uint8_t>> _frames;
             Core::CriticalSection _adminLock;
         };
 
+    public:
+        static constexpr uint8_t MaxPendingFrames = 64;
+
     public:
         UDPOutput() = delete;
         UDPOutput(const UDPOutput&) = delete;
         UDPOutput& operator=(const UDPOutput&) = delete;
 
-        explicit UDPOutput(const Core::NodeId& nodeId);
-        ~UDPOutput() = default;
+        UDPOutput(const Core::NodeId& nodeId, const bool binary = false);
+        ~UDPOutput() override = default;
 
         void Message(const Core::Messaging::MessageInfo& metadata, const string& text);
 
+        bool Exporting() const override {
+            return (_binary);
+        }
+        void Frame(const uint8_t data[], const uint16_t length) override;
+
     private:
         Channel _output;
+        const bool _binary;
     };
 
-    class WebSocketOutput : public IPublish {
+    class WebSocketOutput : public IPublish, public IExport {
     private:
         class ExportCommand : public Core::JSON::Container {
         public:
@@ -361,6 +635,7 @@ namespace Publishers {
                 , Callsign()
                 , IncludingDate()
                 , Paused()
+                , Binary()
             {
                 Add(_T("filename"), &FileName);
                 Add(_T("linenumber"), &LineNumber);
@@ -370,6 +645,7 @@ namespace Publishers {
                 Add(_T("callsign"), &Callsign);
                 Add(_T("includingdate"), &IncludingDate);
                 Add(_T("paused"), &Paused);
+                Add(_T("binary"), &Binary);
             }
             ~ExportCommand() override = default;
 
@@ -382,6 +658,25 @@ namespace Publishers {
             Core::JSON::Boolean Callsign;
             Core::JSON::Boolean IncludingDate;
             Core::JSON::Boolean Paused;
+            Core::JSON::Boolean Binary;
+        };
+
+        // A batch of messages in the MessageFrame.h format, base64 encoded
+        class ExportFrame : public Core::JSON::Container {
+        public:
+            ExportFrame(const ExportFrame&) = delete;
+            ExportFrame& operator=(const ExportFrame&) = delete;
+
+            ExportFrame()
+                : Core::JSON::Container()
+                , Frame()
+            {
+                Add(_T("frame"), &Frame);
+            }
+            ~ExportFrame() override = default;
+
+        public:
+            Core::JSON::String Frame;
         };
 
         using ChannelMap = std::unordered_map<uint32_t, JSON>;
@@ -398,8 +693,10 @@ namespace Publishers {
             , _server(nullptr)
             , _channels()
             , _maxExportConnections(0)
+            , _binaryChannels(0)
             , _jsonExportDataFactory(2)
             , _jsonExportCommandFactory(2)
+            , _jsonExportFrameFactory(2)
         {
         }
         ~WebSocketOutput() override = default;
@@ -424,6 +721,7 @@ namespace Publishers {
             _server = nullptr;
             _channels.clear();
             _maxExportConnections = 0;
+            _binaryChannels = 0;
 
             _lock.Unlock();
         }
@@ -459,6 +757,7 @@ namespace Publishers {
 
             if (index != _channels.end()) {
                 _channels.erase(index);
+                CountBinaryChannels();
                 deactivated = true;
             }
 
@@ -508,6 +807,10 @@ namespace Publishers {
                     if (info->Paused.IsSet() == true) {
                         index->second.Paused(info->Paused == true);
                     }
+                    if (info->Binary.IsSet() == true) {
+                        index->second.Binary(info->Binary == true);
+                    }
+                    CountBinaryChannels();
 
                     info->Clear();
                     info->FileName = index->second.FileName();
@@ -518,6 +821,7 @@ namespace Publishers {
                     info->Callsign = index->second.Callsign();
                     info->IncludingDate = index->second.Date();
                     info->Paused = index->second.Paused();
+                    info->Binary = index->second.Binary();
                 }
 
                 _lock.Unlock();
@@ -535,7 +839,7 @@ namespace Publishers {
 
             if (_server != nullptr) {
                 for (auto& item : _channels) {
-                    if (item.second.Paused() == false) {
+                    if ((item.second.Paused() == false) && (item.second.Binary() == false)) {
                         Core::ProxyType<JSON::Data> data = _jsonExportDataFactory.Element();
                         item.second.Convert(metadata, text, *data);
                         cachedList.emplace_back(item.first, Core::ProxyType<Core::JSON::IElement>(data));
@@ -562,13 +866,33 @@ namespace Publishers {
             return (Core::ProxyType<Core::JSON::IElement>(_jsonExportCommandFactory.Element()));
         }
 
+        bool Exporting() const override {
+            return (_binaryChannels.load(std::memory_order_relaxed) != 0);
+        }
+
+        void Frame(const uint8_t data[], const uint16_t length) override;
+
+    private:
+        void CountBinaryChannels()
+        {
+            uint32_t count = 0;
+            for (const auto& item : _channels) {
+                if ((item.second.Paused() == false) && (item.second.Binary() == true)) {
+                    count++;
+                }
+            }
+            _binaryChannels = count;
+        }
+
     private:
         mutable Core::CriticalSection _lock;
         PluginHost::IShell* _server;
         ChannelMap _channels;
         uint32_t _maxExportConnections;
+        std::atomic<uint32_t> _binaryChannels;
         Core::ProxyPoolType<JSON::Data> _jsonExportDataFactory;
         Core::ProxyPoolType<ExportCommand> _jsonExportCommandFactory;
+        Core::ProxyPoolType<ExportFrame> _jsonExportFrameFactory;
     };
 
 } // namespace Publishers
@@ -0,0 +1,279 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// CPU spent per exported message: the text datagram per message and the JSON element per message
+// and WebSocket channel MessageControl sent before, against the binary frames of MessageFrame.h,
+// one datagram per frame and one base64 encoding per frame shared by all binary channels.
+//
+//   MessageControlExportBenchmark [-n messages] [-s message bytes] [-c channels] [-f frame size]
+//
+// Datagrams go to a bound but unread socket on the loopback, the kernel drops what does not fit,
+// so the send cost is included. WebSocket delivery itself is not simulated, a channel gets the
+// finished string.
+
+#include "../MessageFrame.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace WPEFramework::Publishers;
+
+namespace {
+
+    struct Message {
+        uint64_t TimeStamp;
+        std::string Module;
+        std::string Category;
+        std::string FileName;
+        uint16_t LineNumber;
+        std::string ClassName;
+        std::string Text;
+    };
+
+    struct Result {
+        double CpuSeconds;
+        uint64_t Datagrams;
+        uint64_t WebSocketBytes;
+    };
+
+    double CpuSeconds()
+    {
+        struct timespec now;
+        ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+        return (now.tv_sec + (now.tv_nsec / 1e9));
+    }
+
+    class Loopback {
+    public:
+        Loopback()
+            : _receiver(::socket(AF_INET, SOCK_DGRAM, 0))
+            , _sender(::socket(AF_INET, SOCK_DGRAM, 0))
+        {
+            ::memset(&_address, 0, sizeof(_address));
+            _address.sin_family = AF_INET;
+            _address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            _address.sin_port = 0;
+
+            socklen_t length = sizeof(_address);
+            ::bind(_receiver, reinterpret_cast<struct sockaddr*>(&_address), sizeof(_address));
+            ::getsockname(_receiver, reinterpret_cast<struct sockaddr*>(&_address), &length);
+        }
+        ~Loopback()
+        {
+            ::close(_sender);
+            ::close(_receiver);
+        }
+
+        void Send(const uint8_t data[], const uint16_t length)
+        {
+            ::sendto(_sender, data, length, 0, reinterpret_cast<const struct sockaddr*>(&_address), sizeof(_address));
+        }
+
+    private:
+        int _receiver;
+        int _sender;
+        struct sockaddr_in _address;
+    };
+
+    // Serialized like Metadata and TextMessage: fixed fields followed by zero terminated strings
+    uint16_t SerializeText(const Message& message, uint8_t buffer[], const uint16_t capacity)
+    {
+        uint16_t length = 0;
+
+        auto append = [&](const void* data, const size_t size) {
+            const uint16_t fits = static_cast<uint16_t>(size < static_cast<size_t>(capacity - length) ? size : (capacity - length));
+            ::memcpy(&buffer[length], data, fits);
+            length += fits;
+        };
+        const uint8_t type = 1;
+
+        append(&type, 1);
+        append(message.Category.c_str(), message.Category.length() + 1);
+        append(message.Module.c_str(), message.Module.length() + 1);
+        append(&message.TimeStamp, sizeof(message.TimeStamp));
+        append(message.FileName.c_str(), message.FileName.length() + 1);
+        append(&message.LineNumber, sizeof(message.LineNumber));
+        append(message.ClassName.c_str(), message.ClassName.length() + 1);
+        append(message.Text.c_str(), message.Text.length() + 1);
+
+        return (length);
+    }
+
+    void Escaped(std::string& out, const std::string& value)
+    {
+        out += '"';
+        for (const char c : value) {
+            if ((c == '"') || (c == '\\')) {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    // What a text channel gets for every message
+    std::string Json(const Message& message)
+    {
+        std::string out("{\"time\":");
+        out += std::to_string(message.TimeStamp);
+        out += ",\"module\":";
+        Escaped(out, message.Module);
+        out += ",\"category\":";
+        Escaped(out, message.Category);
+        out += ",\"message\":";
+        Escaped(out, message.Text);
+        out += '}';
+        return (out);
+    }
+
+    std::string Base64(const uint8_t data[], const uint16_t length)
+    {
+        static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string out;
+        out.reserve(((length + 2) / 3) * 4);
+
+        uint16_t index = 0;
+        for (; (index + 2) < length; index += 3) {
+            const uint32_t value = (data[index] << 16) | (data[index + 1] << 8) | data[index + 2];
+            out += table[(value >> 18) & 0x3F];
+            out += table[(value >> 12) & 0x3F];
+            out += table[(value >> 6) & 0x3F];
+            out += table[value & 0x3F];
+        }
+        if (index < length) {
+            const uint32_t value = (data[index] << 16) | ((index + 1) < length ? (data[index + 1] << 8) : 0);
+            out += table[(value >> 18) & 0x3F];
+            out += table[(value >> 12) & 0x3F];
+            out += ((index + 1) < length ? table[(value >> 6) & 0x3F] : '=');
+            out += '=';
+        }
+        return (out);
+    }
+
+    Result RunText(const std::vector<Message>& messages, const uint32_t channels)
+    {
+        Loopback loopback;
+        uint8_t buffer[4096];
+        Result result = { 0, 0, 0 };
+
+        const double start = CpuSeconds();
+        for (const Message& message : messages) {
+            loopback.Send(buffer, SerializeText(message, buffer, sizeof(buffer)));
+            result.Datagrams++;
+
+            for (uint32_t channel = 0; channel < channels; channel++) {
+                result.WebSocketBytes += Json(message).length();
+            }
+        }
+        result.CpuSeconds = CpuSeconds() - start;
+
+        return (result);
+    }
+
+    Result RunBinary(const std::vector<Message>& messages, const uint32_t channels, const uint16_t frameSize)
+    {
+        Loopback loopback;
+        std::vector<uint8_t> buffer(frameSize);
+        Frame::Writer frame(buffer.data(), frameSize);
+        Result result = { 0, 0, 0 };
+
+        auto flush = [&]() {
+            if (frame.Count() != 0) {
+                loopback.Send(frame.Data(), frame.Length());
+                result.Datagrams++;
+
+                const std::string encoded = Base64(frame.Data(), frame.Length());
+                for (uint32_t channel = 0; channel < channels; channel++) {
+                    const std::string element = "{\"frame\":\"" + encoded + "\"}";
+                    result.WebSocketBytes += element.length();
+                }
+                frame.Reset();
+            }
+        };
+
+        const double start = CpuSeconds();
+        for (const Message& message : messages) {
+            if (frame.Append(message.TimeStamp, 1, message.Module, message.Category, message.Text) == false) {
+                flush();
+                frame.Append(message.TimeStamp, 1, message.Module, message.Category, message.Text);
+            }
+        }
+        flush();
+        result.CpuSeconds = CpuSeconds() - start;
+
+        return (result);
+    }
+
+    void Report(const char name[], const Result& result, const uint32_t count)
+    {
+        ::printf("  %-8s %7.3f s cpu, %7.1f ns per message, %8llu datagrams, %6.1f MB to WebSocket channels\n",
+            name, result.CpuSeconds, (result.CpuSeconds * 1e9) / count,
+            static_cast<unsigned long long>(result.Datagrams), result.WebSocketBytes / (1024.0 * 1024.0));
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t count = 500000;
+    uint32_t size = 120;
+    uint32_t channels = 2;
+    uint32_t frameSize = 1400;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "n:s:c:f:")) != -1) {
+        switch (option) {
+        case 'n': count = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 's': size = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'c': channels = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'f': frameSize = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        default:
+            ::fprintf(stderr, "usage: %s [-n messages] [-s message bytes] [-c channels] [-f frame size]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if ((count == 0) || (frameSize <= Frame::HeaderSize) || (frameSize > Frame::MaxSize)) {
+        ::fprintf(stderr, "messages must be at least 1, frame size between %u and %u\n", Frame::HeaderSize + 1, Frame::MaxSize);
+        return (1);
+    }
+
+    ::printf("%u messages of %u bytes, %u WebSocket channels, %u byte frames\n", count, size, channels, frameSize);
+
+    std::vector<Message> messages;
+    messages.reserve(count);
+    for (uint32_t index = 0; index < count; index++) {
+        messages.push_back(Message { 1700000000000000ULL + index, "Plugin_MessageControl", "Information",
+            "MessageControl.cpp", static_cast<uint16_t>(index % 1000), "MessageControl", std::string(size, 'a' + (index % 26)) });
+    }
+
+    Report("text", RunText(messages, channels), count);
+    Report("binary", RunBinary(messages, channels, static_cast<uint16_t>(frameSize)), count);
+
+    return (0);
+}
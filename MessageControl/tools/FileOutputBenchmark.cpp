@@ -0,0 +1,210 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Cost of the message file output for the thread that dispatches messages: one write per message
+// as FileOutput did before, against Publishers::FileOutput itself, batching on its writer thread
+// and, with -c, compressing rotated segments on its compressor thread.
+//
+//   MessageControlFileOutputBenchmark [-d directory] [-n messages] [-s message bytes] [-r rotate KB] [-p messages per ms] [-i idle s] [-c]
+//
+// Messages are produced at the given rate, the rate of a busy box with tracing enabled, and go
+// through the same formatting as in the plugin. Reported is the latency of handing one message to
+// the output, and the CPU the process uses while the output sits idle afterwards. That stays close
+// to zero unless the writer or the compressor spins instead of waiting for work.
+
+#include "../MessageOutput.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WPEFramework;
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::vector<double> Latencies; // us per message
+        double Seconds;
+        double IdleCpu; // % of one core
+    };
+
+    double CpuSeconds()
+    {
+        struct rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+        return ((usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + ((usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0));
+    }
+
+    // FileOutput before: the dispatching thread formats and writes every message itself
+    class DirectOutput : public Publishers::IPublish {
+    public:
+        DirectOutput(const string& path)
+            : _convertor(Core::Messaging::MessageInfo::abbreviate::ABBREVIATED)
+            , _file(path)
+        {
+            _file.Create();
+        }
+        ~DirectOutput() override
+        {
+            _file.Close();
+        }
+
+        void Message(const Core::Messaging::MessageInfo& metadata, const string& text) override
+        {
+            const string line = _convertor.Convert(metadata, text);
+            _file.Write(reinterpret_cast<const uint8_t*>(line.c_str()), static_cast<uint32_t>(line.length()));
+        }
+
+    private:
+        Publishers::Text _convertor;
+        Core::File _file;
+    };
+
+    Result Run(Publishers::IPublish& output, const uint32_t messages, const uint32_t size, const uint32_t rate, const uint32_t idle)
+    {
+        Result result;
+        const string payload(size, 'x');
+        const Core::Messaging::Metadata metadata(Core::Messaging::Metadata::type::LOGGING, _T("Category"), _T("Module"));
+
+        result.Latencies.reserve(messages);
+
+        const Clock::time_point start = Clock::now();
+        Clock::time_point slot = start;
+
+        for (uint32_t count = 0; count < messages; count++) {
+            const Core::Messaging::MessageInfo info(metadata, Core::Time::Now().Ticks());
+
+            const Clock::time_point before = Clock::now();
+            output.Message(info, payload);
+            result.Latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+
+            if (((count + 1) % rate) == 0) {
+                slot += std::chrono::milliseconds(1);
+                std::this_thread::sleep_until(slot);
+            }
+        }
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Only the output's own threads can use CPU while this one sleeps
+        const double cpu = CpuSeconds();
+        std::this_thread::sleep_for(std::chrono::seconds(idle));
+        result.IdleCpu = ((CpuSeconds() - cpu) * 100.0) / idle;
+
+        return (result);
+    }
+
+    double Percentile(std::vector<double>& values, const double fraction)
+    {
+        std::sort(values.begin(), values.end());
+        return (values.empty() ? 0 : values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))]);
+    }
+
+    void Report(const char name[], Result& result)
+    {
+        ::printf("  %-18s %7.3f s, message p50 %7.2f us  p99 %7.2f us  max %9.2f us, idle cpu %5.1f %%\n",
+            name, result.Seconds, Percentile(result.Latencies, 0.50), Percentile(result.Latencies, 0.99), Percentile(result.Latencies, 1.0),
+            result.IdleCpu);
+    }
+
+    void Remove(const string& path, const uint8_t segments)
+    {
+        Core::File(path).Destroy();
+        for (uint8_t index = 1; index <= segments; index++) {
+            Core::File(path + '.' + Core::NumberType<uint8_t>(index).Text()).Destroy();
+            Core::File(path + '.' + Core::NumberType<uint8_t>(index).Text() + _T(".gz")).Destroy();
+        }
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    string directory(_T("/tmp"));
+    uint32_t messages = 200000;
+    uint32_t size = 120;
+    uint32_t rotateSize = 4096;
+    uint32_t rate = 50;
+    uint32_t idle = 2;
+    bool compress = false;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "d:n:s:r:p:i:c")) != -1) {
+        switch (option) {
+        case 'd': directory = optarg; break;
+        case 'n': messages = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 's': size = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'r': rotateSize = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'p': rate = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'i': idle = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'c': compress = true; break;
+        default:
+            ::fprintf(stderr, "usage: %s [-d directory] [-n messages] [-s message bytes] [-r rotate KB] [-p messages per ms] [-i idle s] [-c]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if ((rate == 0) || (rotateSize == 0) || (idle == 0)) {
+        ::fprintf(stderr, "rotate KB, messages per ms and idle seconds must be at least 1\n");
+        return (1);
+    }
+    if ((compress == true) && (Publishers::FileOutput::CompressionSupported() == false)) {
+        ::fprintf(stderr, "built without zlib, rotated segments cannot be compressed\n");
+        return (1);
+    }
+
+    const string path(directory + _T("/MessageControlFileOutputBenchmark.") + Core::NumberType<pid_t>(::getpid()).Text() + _T(".log"));
+
+    Publishers::FileOutput::Rotation rotation;
+    rotation.MaxSize = static_cast<uint64_t>(rotateSize) * 1024;
+    rotation.Period = 0;
+    rotation.Segments = Publishers::FileOutput::DefaultSegments;
+    rotation.Compress = compress;
+
+    ::printf("%u messages of %u bytes, %u per ms, rotating every %u KB into %u %ssegments, %u s idle\n",
+        messages, size, rate, rotateSize, rotation.Segments, (compress == true ? "compressed " : ""), idle);
+
+    {
+        DirectOutput direct(path);
+        Result result = Run(direct, messages, size, rate, idle);
+        Report("write per message", result);
+    }
+    Remove(path, rotation.Segments);
+    {
+        Publishers::FileOutput batched(Core::Messaging::MessageInfo::abbreviate::ABBREVIATED, path, rotation);
+        Result result = Run(batched, messages, size, rate, idle);
+        Report("FileOutput", result);
+    }
+    Remove(path, rotation.Segments);
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
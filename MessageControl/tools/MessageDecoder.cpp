@@ -0,0 +1,207 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Turns MessageControl binary export frames back into text.
+//
+//   MessageDecoder -u <port>      listen for datagrams of a binary "remote" output
+//   MessageDecoder -b [file]      base64 frames, one per line, as sent to binary WebSocket channels
+//   MessageDecoder [file]         raw frames back to back, for example a capture of the datagrams
+//
+// Without a file, input is read from stdin.
+
+#include "../MessageFrame.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace WPEFramework::Publishers;
+
+namespace {
+
+    void Print(const Frame::Record& record)
+    {
+        const time_t seconds = static_cast<time_t>(record.TimeStamp / 1000000);
+        struct tm local;
+        char stamp[32];
+
+        localtime_r(&seconds, &local);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        printf("[%s.%06u]:[%s]:[%s]: %s\n", stamp, static_cast<unsigned>(record.TimeStamp % 1000000),
+            record.Module.c_str(), record.Category.c_str(), record.Payload.c_str());
+    }
+
+    // Decodes all frames in the buffer, returns the number of bytes consumed
+    size_t Decode(const uint8_t data[], const size_t length)
+    {
+        size_t offset = 0;
+
+        while (offset < length) {
+            Frame::Reader reader(&data[offset], static_cast<uint32_t>(length - offset));
+
+            if (reader.IsValid() == false) {
+                fprintf(stderr, "Invalid frame at offset %zu, skipping %zu bytes\n", offset, length - offset);
+                offset = length;
+            }
+            else {
+                Frame::Record record;
+
+                while (reader.Next(record) == true) {
+                    Print(record);
+                }
+                offset += reader.Length();
+            }
+        }
+
+        fflush(stdout);
+
+        return (offset);
+    }
+
+    bool Base64(const std::string& input, std::vector<uint8_t>& output)
+    {
+        static const std::string alphabet("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+        uint32_t accumulator = 0;
+        int bits = 0;
+
+        output.clear();
+
+        for (const char c : input) {
+            if ((c == '=') || (c == '\r') || (c == '\n') || (c == '"')) {
+                continue;
+            }
+
+            const size_t value = alphabet.find(c);
+            if (value == std::string::npos) {
+                return (false);
+            }
+
+            accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8) {
+                bits -= 8;
+                output.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+            }
+        }
+
+        return (true);
+    }
+
+    int ListenUDP(const uint16_t port)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            perror("socket");
+            return (1);
+        }
+
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+
+        if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0) {
+            perror("bind");
+            close(fd);
+            return (1);
+        }
+
+        std::vector<uint8_t> buffer(Frame::MaxSize);
+        ssize_t received;
+
+        while ((received = recv(fd, buffer.data(), buffer.size(), 0)) >= 0) {
+            Decode(buffer.data(), static_cast<size_t>(received));
+        }
+
+        perror("recv");
+        close(fd);
+        return (1);
+    }
+
+    void Usage(const char* name)
+    {
+        fprintf(stderr, "Usage: %s [-u <port> | -b [file] | file]\n", name);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool base64 = false;
+    const char* path = nullptr;
+
+    for (int index = 1; index < argc; index++) {
+        const std::string argument(argv[index]);
+
+        if ((argument == "-u") && ((index + 1) < argc)) {
+            return (ListenUDP(static_cast<uint16_t>(atoi(argv[index + 1]))));
+        }
+        else if (argument == "-b") {
+            base64 = true;
+        }
+        else if ((argument[0] != '-') && (path == nullptr)) {
+            path = argv[index];
+        }
+        else {
+            Usage(argv[0]);
+            return (1);
+        }
+    }
+
+    std::ifstream file;
+    if (path != nullptr) {
+        file.open(path, std::ios::binary);
+        if (file.is_open() == false) {
+            fprintf(stderr, "Could not open %s\n", path);
+            return (1);
+        }
+    }
+    std::istream& input = (path != nullptr ? static_cast<std::istream&>(file) : std::cin);
+
+    if (base64 == true) {
+        std::string line;
+        std::vector<uint8_t> frame;
+
+        while (std::getline(input, line)) {
+            if (line.empty() == false) {
+                if (Base64(line, frame) == true) {
+                    Decode(frame.data(), frame.size());
+                }
+                else {
+                    fprintf(stderr, "Skipping line that is not base64\n");
+                }
+            }
+        }
+    }
+    else {
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        Decode(data.data(), data.size());
+    }
+
+    return (0);
+}
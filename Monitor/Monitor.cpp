@@ -40,6 +40,8 @@ namespace Plugin {
         );
     }
 
+    constexpr uint16_t Monitor::DefaultHistory;
+
     static Core::ProxyPoolType<Web::JSONBodyType<Core::JSON::ArrayType<Monitor::Data>>> jsonBodyDataFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data>> jsonBodyParamFactory(2);
     static Core::ProxyPoolType<Web::JSONBodyType<Monitor::Data::MetaData>> jsonMemoryBodyDataFactory(2);
@@ -54,7 +56,7 @@ namespace Plugin {
         Core::JSON::ArrayType<Config::Entry>::Iterator index(_config.Observables.Elements());
 
         // Create a list of plugins to monitor..
-        _monitor.Open(service, index);
+        _monitor.Open(service, index, _config.History.Value(), _config.Adaptive.Value());
 
         // During the registartion, all Plugins, currently active are reported to the sink.
         service->Register(&_monitor);
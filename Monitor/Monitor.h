@@ -21,10 +21,13 @@
 #define __MONITOR_H
 
 #include "Module.h"
+#include "ProcessSampler.h"
 #include <interfaces/IMemory.h>
 #include <interfaces/json/JsonData_Monitor.h>
+#include <algorithm>
 #include <limits>
 #include <string>
+#include <vector>
 
 static uint32_t gcd(uint32_t a, uint32_t b)
 {
@@ -67,6 +70,7 @@ namespace Plugin {
         public:
             MetaData()
                 : _resident()
+                , _proportional()
                 , _allocated()
                 , _shared()
                 , _process()
@@ -74,6 +78,7 @@ namespace Plugin {
             }
             MetaData(const MetaData& copy)
                 : _resident(copy._resident)
+                , _proportional(copy._proportional)
                 , _allocated(copy._allocated)
                 , _shared(copy._shared)
                 , _process(copy._process)
@@ -86,6 +91,7 @@ namespace Plugin {
             MetaData& operator= (const MetaData& rhs)
             {
                 _resident = rhs._resident;
+                _proportional = rhs._proportional;
                 _allocated = rhs._allocated;
                 _shared = rhs._shared;
                 _process = rhs._process;
@@ -98,8 +104,9 @@ namespace Plugin {
                 return ((_resident.Measurements() != 0) || (_allocated.Measurements() != 0) || (_shared.Measurements() != 0) || (_process.Measurements() != 0));
             }
 
-            void AddMeasurements(const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint64_t process) {
+            void AddMeasurements(const uint64_t resident, const uint64_t proportional, const uint64_t allocated, const uint64_t shared, const uint64_t process) {
                 _resident.Set(resident);
+                _proportional.Set(proportional);
                 _allocated.Set(allocated);
                 _shared.Set(shared);
                 _process.Set(process);
@@ -108,6 +115,7 @@ namespace Plugin {
             void Measure(Exchange::IMemory* memInterface)
             {
                 _resident.Set(memInterface->Resident());
+                _proportional.Set(_resident.Last());
                 _allocated.Set(memInterface->Allocated());
                 _shared.Set(memInterface->Shared());
                 _process.Set(memInterface->Processes());
@@ -115,6 +123,7 @@ namespace Plugin {
             void Reset()
             {
                 _resident.Reset();
+                _proportional.Reset();
                 _allocated.Reset();
                 _shared.Reset();
                 _process.Reset();
@@ -125,6 +134,11 @@ namespace Plugin {
             {
                 return (_resident);
             }
+            // PSS, equal to Resident() when it could not be read from /proc
+            inline const Core::MeasurementType<uint64_t>& Proportional() const
+            {
+                return (_proportional);
+            }
             inline const Core::MeasurementType<uint64_t>& Allocated() const
             {
                 return (_allocated);
@@ -139,11 +153,139 @@ namespace Plugin {
             }
         private:
             Core::MeasurementType<uint64_t> _resident;
+            Core::MeasurementType<uint64_t> _proportional;
             Core::MeasurementType<uint64_t> _allocated;
             Core::MeasurementType<uint64_t> _shared;
             Core::MeasurementType<uint8_t> _process;
         };
 
+        // Ring of the most recent memory samples of one observable. The capacity is fixed at
+        // construction, so the memory cost is bounded to capacity * sizeof(Sample).
+        class History {
+        public:
+            struct Sample {
+                uint64_t TimeStamp; // Core::Time ticks
+                uint64_t Resident;
+                uint64_t Proportional;
+                uint64_t Allocated;
+                uint64_t Shared;
+                uint8_t Process;
+            };
+
+            struct Trend {
+                uint64_t P50;
+                uint64_t P95;
+                uint64_t P99;
+                int64_t Slope; // bytes per hour, least squares fit over the samples
+            };
+
+        public:
+            History() = delete;
+            History(const History&) = delete;
+            History& operator=(const History&) = delete;
+
+            explicit History(const uint16_t capacity)
+                : _samples(capacity)
+                , _head(0)
+                , _count(0)
+            {
+            }
+            ~History() = default;
+
+        public:
+            inline uint16_t Capacity() const
+            {
+                return (static_cast<uint16_t>(_samples.size()));
+            }
+            inline void Add(const Sample& sample)
+            {
+                if (_samples.empty() == false) {
+                    _samples[_head] = sample;
+                    _head = static_cast<uint16_t>((_head + 1) % _samples.size());
+                    if (_count < _samples.size()) {
+                        _count++;
+                    }
+                }
+            }
+            inline void Reset()
+            {
+                _head = 0;
+                _count = 0;
+            }
+            // Copies the samples taken at or after since, oldest first.
+            void Samples(const uint64_t since, std::vector<Sample>& samples) const
+            {
+                const uint32_t capacity = static_cast<uint32_t>(_samples.size());
+
+                samples.clear();
+                samples.reserve(_count);
+
+                for (uint32_t index = 0; index < _count; index++) {
+                    const Sample& sample(_samples[(_head + capacity - _count + index) % capacity]);
+                    if (sample.TimeStamp >= since) {
+                        samples.push_back(sample);
+                    }
+                }
+            }
+
+            static Trend Analyze(const std::vector<Sample>& samples, uint64_t Sample::*field)
+            {
+                Trend result = { 0, 0, 0, 0 };
+
+                if (samples.empty() == false) {
+                    std::vector<uint64_t> values;
+                    values.reserve(samples.size());
+                    for (const Sample& sample : samples) {
+                        values.push_back(sample.*field);
+                    }
+
+                    result.P50 = Percentile(values, 50);
+                    result.P95 = Percentile(values, 95);
+                    result.P99 = Percentile(values, 99);
+
+                    // Least squares over (seconds since first sample, bytes)
+                    const double count = static_cast<double>(samples.size());
+                    const uint64_t start = samples.front().TimeStamp;
+                    double meanX = 0;
+                    double meanY = 0;
+                    for (const Sample& sample : samples) {
+                        meanX += static_cast<double>(sample.TimeStamp - start) / (1000 * 1000);
+                        meanY += static_cast<double>(sample.*field);
+                    }
+                    meanX /= count;
+                    meanY /= count;
+
+                    double covariance = 0;
+                    double variance = 0;
+                    for (const Sample& sample : samples) {
+                        const double x = (static_cast<double>(sample.TimeStamp - start) / (1000 * 1000)) - meanX;
+                        covariance += x * (static_cast<double>(sample.*field) - meanY);
+                        variance += x * x;
+                    }
+                    if (variance > 0) {
+                        result.Slope = static_cast<int64_t>((covariance / variance) * 3600);
+                    }
+                }
+
+                return (result);
+            }
+
+        private:
+            // Nearest rank, reorders values.
+            static uint64_t Percentile(std::vector<uint64_t>& values, const uint8_t percentile)
+            {
+                const size_t rank = ((percentile * values.size()) + 99) / 100;
+                std::vector<uint64_t>::iterator nth = values.begin() + (rank > 0 ? rank - 1 : 0);
+                std::nth_element(values.begin(), nth, values.end());
+                return (*nth);
+            }
+
+        private:
+            std::vector<Sample> _samples;
+            uint16_t _head;
+            uint16_t _count;
+        };
+
         class Data : public Core::JSON::Container {
         public:
             class MetaData : public Core::JSON::Container {
@@ -245,6 +387,7 @@ namespace Plugin {
                     : Core::JSON::Container()
                     , Allocated()
                     , Resident()
+                    , Proportional()
                     , Shared()
                     , Process()
                     , Operational()
@@ -252,6 +395,7 @@ namespace Plugin {
                 {
                     Add(_T("allocated"), &Allocated);
                     Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
@@ -262,6 +406,7 @@ namespace Plugin {
                 {
                     Add(_T("allocated"), &Allocated);
                     Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
@@ -269,6 +414,7 @@ namespace Plugin {
 
                     Allocated = input.Allocated();
                     Resident = input.Resident();
+                    Proportional = input.Proportional();
                     Shared = input.Shared();
                     Process = input.Process();
                     Operational = operational;
@@ -278,6 +424,7 @@ namespace Plugin {
                     : Core::JSON::Container()
                     , Allocated(copy.Allocated)
                     , Resident(copy.Resident)
+                    , Proportional(copy.Proportional)
                     , Shared(copy.Shared)
                     , Process(copy.Process)
                     , Operational(copy.Operational)
@@ -285,6 +432,7 @@ namespace Plugin {
                 {
                     Add(_T("allocated"), &Allocated);
                     Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
                     Add(_T("shared"), &Shared);
                     Add(_T("process"), &Process);
                     Add(_T("operational"), &Operational);
@@ -298,6 +446,7 @@ namespace Plugin {
                 {
                     Allocated = RHS.Allocated;
                     Resident = RHS.Resident;
+                    Proportional = RHS.Proportional;
                     Shared = RHS.Shared;
                     Process = RHS.Process;
                     Operational = RHS.Operational;
@@ -309,6 +458,7 @@ namespace Plugin {
             public:
                 Measurement Allocated;
                 Measurement Resident;
+                Measurement Proportional;
                 Measurement Shared;
                 Measurement Process;
                 Core::JSON::Boolean Operational;
@@ -368,6 +518,159 @@ namespace Plugin {
             RestartInfo Restart;
         };
 
+        class HistoryParams : public Core::JSON::Container {
+        public:
+            HistoryParams(const HistoryParams&) = delete;
+            HistoryParams& operator=(const HistoryParams&) = delete;
+
+            HistoryParams()
+                : Core::JSON::Container()
+                , Callsign()
+                , Window(0)
+                , Samples(false)
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("window"), &Window);
+                Add(_T("samples"), &Samples);
+            }
+            ~HistoryParams() override = default;
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt32 Window; // seconds back from now, 0 for all samples kept
+            Core::JSON::Boolean Samples;
+        };
+
+        class HistoryData : public Core::JSON::Container {
+        public:
+            class Trend : public Core::JSON::Container {
+            public:
+                Trend& operator=(const Trend&) = delete;
+
+                Trend()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                    Add(_T("slope"), &Slope);
+                }
+                Trend(const Trend& copy)
+                    : Core::JSON::Container()
+                    , P50(copy.P50)
+                    , P95(copy.P95)
+                    , P99(copy.P99)
+                    , Slope(copy.Slope)
+                {
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                    Add(_T("slope"), &Slope);
+                }
+                ~Trend() override = default;
+
+                void Set(const History::Trend& trend)
+                {
+                    P50 = trend.P50;
+                    P95 = trend.P95;
+                    P99 = trend.P99;
+                    Slope = trend.Slope;
+                }
+
+            public:
+                Core::JSON::DecUInt64 P50;
+                Core::JSON::DecUInt64 P95;
+                Core::JSON::DecUInt64 P99;
+                Core::JSON::DecSInt64 Slope; // bytes per hour
+            };
+
+            class Sample : public Core::JSON::Container {
+            public:
+                Sample& operator=(const Sample&) = delete;
+
+                Sample()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("timestamp"), &TimeStamp);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+                }
+                Sample(const History::Sample& sample)
+                    : Core::JSON::Container()
+                {
+                    Add(_T("timestamp"), &TimeStamp);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+
+                    TimeStamp = sample.TimeStamp / Core::Time::TicksPerMillisecond;
+                    Resident = sample.Resident;
+                    Proportional = sample.Proportional;
+                    Allocated = sample.Allocated;
+                    Shared = sample.Shared;
+                    Process = sample.Process;
+                }
+                Sample(const Sample& copy)
+                    : Core::JSON::Container()
+                    , TimeStamp(copy.TimeStamp)
+                    , Resident(copy.Resident)
+                    , Proportional(copy.Proportional)
+                    , Allocated(copy.Allocated)
+                    , Shared(copy.Shared)
+                    , Process(copy.Process)
+                {
+                    Add(_T("timestamp"), &TimeStamp);
+                    Add(_T("resident"), &Resident);
+                    Add(_T("pss"), &Proportional);
+                    Add(_T("allocated"), &Allocated);
+                    Add(_T("shared"), &Shared);
+                    Add(_T("process"), &Process);
+                }
+                ~Sample() override = default;
+
+            public:
+                Core::JSON::DecUInt64 TimeStamp; // milliseconds since epoch
+                Core::JSON::DecUInt64 Resident;
+                Core::JSON::DecUInt64 Proportional;
+                Core::JSON::DecUInt64 Allocated;
+                Core::JSON::DecUInt64 Shared;
+                Core::JSON::DecUInt8 Process;
+            };
+
+        public:
+            HistoryData(const HistoryData&) = delete;
+            HistoryData& operator=(const HistoryData&) = delete;
+
+            HistoryData()
+                : Core::JSON::Container()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("capacity"), &Capacity);
+                Add(_T("count"), &Count);
+                Add(_T("resident"), &Resident);
+                Add(_T("pss"), &Proportional);
+                Add(_T("allocated"), &Allocated);
+                Add(_T("shared"), &Shared);
+                Add(_T("samples"), &Samples);
+            }
+            ~HistoryData() override = default;
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt16 Capacity;
+            Core::JSON::DecUInt32 Count;
+            Trend Resident;
+            Trend Proportional;
+            Trend Allocated;
+            Trend Shared;
+            Core::JSON::ArrayType<Sample> Samples;
+        };
+
     private:
         Monitor(const Monitor&);
         Monitor& operator=(const Monitor&);
@@ -421,8 +724,12 @@ namespace Plugin {
         public:
             Config()
                 : Core::JSON::Container()
+                , History(DefaultHistory)
+                , Adaptive(true)
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("history"), &History);
+                Add(_T("adaptive"), &Adaptive);
             }
             ~Config()
             {
@@ -430,6 +737,8 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            Core::JSON::DecUInt16 History; // memory samples kept per observable
+            Core::JSON::Boolean Adaptive; // adapt the memory interval to the usage trend
         };
 
         class MonitorObjects : public PluginHost::IPlugin::INotification, public PluginHost::IPlugin::ILifeTime {
@@ -460,23 +769,33 @@ namespace Plugin {
                     const uint64_t memoryThreshold,
                     const uint64_t absTime,
                     const uint16_t restartWindow,
-                    const uint8_t restartLimit)
+                    const uint8_t restartLimit,
+                    const uint16_t history,
+                    const bool adaptive)
                     : _operationalInterval(operationalInterval)
                     , _memoryInterval(memoryInterval)
                     , _memoryThreshold(memoryThreshold * 1024)
                     , _operationalSlots(operationalInterval)
                     , _memorySlots(memoryInterval)
+                    , _currentMemoryInterval(memoryInterval)
+                    , _adaptive(adaptive)
+                    , _stableSamples(0)
+                    , _previousResident(0)
                     , _nextSlot(absTime)
                     , _restartWindow(restartWindow)
                     , _restartWindowStart()
                     , _restartCount(0)
                     , _restartLimit(restartLimit)
                     , _measurement()
+                    , _history(history)
                     , _operational(false)
                     , _operationalEvaluate(actOnOperational)
                     , _source(nullptr)
                     , _interval( ((operationalInterval != 0) || (_memoryInterval != 0)) ? gcd(_operationalInterval, _memoryInterval) : 0 )
                     , _active{ false }
+                    , _pid(0)
+                    , _started(0)
+                    , _usage()
                     , _adminLock()
                 {
                     ASSERT((_operationalInterval != 0) || (_memoryInterval != 0));
@@ -538,6 +857,28 @@ namespace Plugin {
                 {
                     return (_interval);
                 }
+                // Process hosting the plugin out of process, Id 0 if unknown, in process or not
+                // measured from /proc.
+                inline ProcessSampler::Process Host() const
+                {
+                    return (ProcessSampler::Process { _pid, _started });
+                }
+                inline void Host(const ProcessSampler::Process& host)
+                {
+                    _pid = 0;
+                    _started = host.Started;
+                    _pid = host.Id;
+                }
+                // True if the next Evaluate takes a memory measurement.
+                inline bool MemoryDue() const
+                {
+                    return ((_memoryInterval != 0) && (_memorySlots <= _interval));
+                }
+                // Reading of the batched /proc pass, consumed by the next Evaluate.
+                inline void Sampled(const ProcessSampler::Usage& usage)
+                {
+                    _usage = usage;
+                }
                 inline uint32_t Operational() const
                 {
                     return (_operational);
@@ -555,6 +896,16 @@ namespace Plugin {
                 {
                     Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
                     _measurement.Reset();
+                    _history.Reset();
+                }
+                inline uint16_t HistoryCapacity() const
+                {
+                    return (_history.Capacity());
+                }
+                inline void Samples(const uint64_t since, std::vector<History::Sample>& samples) const
+                {
+                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+                    _history.Samples(since, samples);
                 }
                 inline void Retrigger(uint64_t currentSlot)
                 {
@@ -596,8 +947,8 @@ namespace Plugin {
 
                     uint32_t status(SUCCESFULL);
                     if (source.IsValid() == true) {
-                        _operationalSlots -= _interval;
-                        _memorySlots -= _interval;
+                        _operationalSlots = (_operationalSlots > _interval ? _operationalSlots - _interval : 0);
+                        _memorySlots = (_memorySlots > _interval ? _memorySlots - _interval : 0);
 
                         if ((_operationalInterval != 0) && (_operationalSlots == 0)) {
                             _operational = source->IsOperational();
@@ -609,20 +960,43 @@ namespace Plugin {
                         }
                         if ((_memoryInterval != 0) && (_memorySlots == 0)) {
 
-                            uint64_t resident = source->Resident();
-                            uint64_t allocated = source->Allocated();
-                            uint64_t shared = source->Shared();
+                            uint64_t resident, proportional, allocated, shared;
                             uint64_t  process = source->Processes();
 
+                            // The /proc reading covers the host process only. IMemory also counts
+                            // the processes it spawned, e.g. WPEWebProcess, so it stays the measure
+                            // for those plugins.
+                            if ((_usage.Valid == true) && (process <= 1)) {
+                                resident = _usage.Resident;
+                                proportional = _usage.Proportional;
+                                allocated = _usage.Allocated;
+                                shared = _usage.Shared;
+                            } else {
+                                resident = source->Resident();
+                                proportional = resident;
+                                allocated = source->Allocated();
+                                shared = source->Shared();
+                            }
+                            if (process > 1) {
+                                _pid = 0;
+                            }
+                            _usage.Valid = false;
+
+                            const History::Sample sample = { Core::Time::Now().Ticks(), resident, proportional, allocated, shared, static_cast<uint8_t>(process) };
+
                             _adminLock.Lock();
-                            _measurement.AddMeasurements(resident, allocated, shared, process);
+                            _measurement.AddMeasurements(resident, proportional, allocated, shared, process);
+                            _history.Add(sample);
                             _adminLock.Unlock();
 
                             if ((_memoryThreshold != 0) && (resident > _memoryThreshold)) {
                                 status |= EXCEEDED_MEMORY;
                                 TRACE(Trace::Error, (_T("Status MetaData Exceeded. %d"), __LINE__));
                             }
-                            _memorySlots = _memoryInterval;
+                            if (_adaptive == true) {
+                                Adapt(resident);
+                            }
+                            _memorySlots = _currentMemoryInterval;
                         }
                     }
                     return (status);
@@ -631,23 +1005,63 @@ namespace Plugin {
                 bool IsActive() const { return _active; }
                 void Active(bool active) { _active = active; }
 
+            private:
+                // Measure more often when closing in on the limit, less often while the usage is flat.
+                void Adapt(const uint64_t resident)
+                {
+                    static constexpr uint32_t MinimumInterval = 1000 * 1000;
+                    static constexpr uint8_t StableThreshold = 3;
+
+                    const uint64_t change = (resident > _previousResident ? resident - _previousResident : _previousResident - resident);
+                    uint32_t interval = _memoryInterval;
+
+                    if ((_memoryThreshold != 0) && (resident >= ((_memoryThreshold / 4) * 3))) {
+                        _stableSamples = 0;
+                        interval = std::max(_memoryInterval / 4, std::min(_memoryInterval, MinimumInterval));
+                    } else if ((change * 100) <= resident) {
+                        if (_stableSamples < StableThreshold) {
+                            _stableSamples++;
+                        } else {
+                            const uint64_t ceiling = std::min(static_cast<uint64_t>(_memoryInterval) * 4, static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()));
+                            interval = static_cast<uint32_t>(std::min(static_cast<uint64_t>(_currentMemoryInterval) * 2, ceiling));
+                        }
+                    } else {
+                        _stableSamples = 0;
+                    }
+
+                    _previousResident = resident;
+
+                    if (interval != _currentMemoryInterval) {
+                        _currentMemoryInterval = interval;
+                        _interval = gcd(_operationalInterval, _currentMemoryInterval);
+                    }
+                }
+
             private:
                 const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
                 const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
                 const uint64_t _memoryThreshold; //!< MetaData threshold in bytes for all processes.
                 uint32_t _operationalSlots; // does not need protection, only touched in job evaluate
                 uint32_t _memorySlots; // does not need protection, only touched in job evaluate
+                uint32_t _currentMemoryInterval; // adapted memory interval, only touched in job evaluate
+                const bool _adaptive;
+                uint8_t _stableSamples; // only touched in job evaluate
+                uint64_t _previousResident; // only touched in job evaluate
                 std::atomic<uint64_t> _nextSlot; // no ordering needed, atomic should suffice
                 std::atomic<uint16_t> _restartWindow; // no ordering needed, atomic should suffice
                 Core::Time _restartWindowStart; // only used in job (indirectly), no protection needed
                 uint32_t _restartCount; // only used in job (indirectly), no protection needed
                 std::atomic<uint8_t> _restartLimit;  // no ordering needed, atomic should suffice
                 MetaData _measurement;
+                History _history;
                 std::atomic<bool> _operational; // no ordering needed, atomic should suffice
                 const bool _operationalEvaluate;
                 Exchange::IMemory* _source;
-                const uint32_t _interval; //!< The greatest possible interval to check both memory and processes.
+                std::atomic<uint32_t> _interval; //!< The greatest possible interval to check both memory and processes.
                 std::atomic<bool> _active;
+                std::atomic<uint32_t> _pid;
+                std::atomic<uint64_t> _started; // of _pid, written before it
+                ProcessSampler::Usage _usage; // only touched in job
                 mutable Core::CriticalSection _adminLock;
             };
 
@@ -658,6 +1072,10 @@ namespace Plugin {
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
             MonitorObjects(Monitor* parent)
                 : _monitor()
+                , _sampler()
+                , _hosts()
+                , _sampled()
+                , _usage()
                 , _job(*this)
                 , _service(nullptr)
                 , _parent(*parent)
@@ -686,7 +1104,7 @@ POP_WARNING()
                         restartLimit);
                 }
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
+            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index, const uint16_t history, const bool adaptive)
             {
                 ASSERT((service != nullptr) && (_service == nullptr));
 
@@ -721,7 +1139,9 @@ POP_WARNING()
                                             memoryThreshold, 
                                             baseTime, 
                                             restartWindow, 
-                                            restartLimit)
+                                            restartLimit,
+                                            history,
+                                            adaptive)
                                     );
                     }
                 }
@@ -755,6 +1175,11 @@ POP_WARNING()
                         memory->Release();
                     }
 
+                    // Out of process plugins are measured straight from /proc, see Dispatch
+                    std::vector<ProcessSampler::Process> hosts;
+                    ProcessSampler::Find(_T("/proc"), callsign, hosts);
+                    index->second.Host(hosts.size() == 1 ? hosts.front() : ProcessSampler::Process { 0, 0 });
+
                     if (_job.Submit() == true) {
                         TRACE(Trace::Information, (_T("Starting to probe as active observee appeared.")));
                     }
@@ -777,6 +1202,7 @@ POP_WARNING()
 
                     index->second.Set(nullptr);
                     index->second.Active(false);
+                    index->second.Host(ProcessSampler::Process { 0, 0 });
 
                     PluginHost::IShell::reason reason = service->Reason();
 
@@ -904,6 +1330,23 @@ POP_WARNING()
                 return (found);
             }
 
+            bool Samples(const string& name, const uint32_t window, uint16_t& capacity, std::vector<History::Sample>& samples) const
+            {
+                bool found = false;
+
+                MonitorObjectContainer::const_iterator index(_monitor.find(name));
+
+                if (index != _monitor.cend()) {
+                    const uint64_t now = Core::Time::Now().Ticks();
+                    const uint64_t span = static_cast<uint64_t>(window) * Core::Time::TicksPerMillisecond * 1000;
+                    capacity = index->second.HistoryCapacity();
+                    index->second.Samples(((window != 0) && (span < now)) ? (now - span) : 0, samples);
+                    found = true;
+                }
+
+                return (found);
+            }
+
             BEGIN_INTERFACE_MAP(MonitorObjects)
             INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
             INTERFACE_ENTRY(PluginHost::IPlugin::ILifeTime)
@@ -917,6 +1360,8 @@ POP_WARNING()
                 uint64_t scheduledTime(Core::Time::Now().Ticks());
                 uint64_t nextSlot(static_cast<uint64_t>(~0));
 
+                Sample(scheduledTime);
+
                 MonitorObjectContainer::iterator index(_monitor.begin());
 
                 // Go through the list of pending observations...
@@ -970,6 +1415,37 @@ POP_WARNING()
                 }
             }
 
+            // Reads the memory of every process due for a measurement in a single pass.
+            void Sample(const uint64_t scheduledTime)
+            {
+                _hosts.clear();
+                _sampled.clear();
+
+                for (MonitorObjectContainer::iterator index(_monitor.begin()); index != _monitor.end(); ++index) {
+                    MonitorObject& info(index->second);
+                    if ((info.IsActive() == true) && (info.TimeSlot() <= scheduledTime) && (info.MemoryDue() == true)) {
+                        const ProcessSampler::Process host(info.Host());
+                        if (host.Id != 0) {
+                            _hosts.push_back(host);
+                            _sampled.push_back(&info);
+                        }
+                    }
+                }
+
+                if (_hosts.empty() == false) {
+                    _sampler.Sample(_hosts, _usage);
+
+                    for (size_t index = 0; index < _sampled.size(); index++) {
+                        if (_usage[index].Valid == true) {
+                            _sampled[index]->Sampled(_usage[index]);
+                        } else {
+                            // Gone or its pid reused, fall back to Exchange::IMemory until the next activation
+                            _sampled[index]->Host(ProcessSampler::Process { 0, 0 });
+                        }
+                    }
+                }
+            }
+
         private:
             template <typename T>
             void translate(const Core::MeasurementType<T>& from, JsonData::Monitor::MeasurementInfo* to) const
@@ -985,12 +1461,19 @@ POP_WARNING()
             using MonitorObjectContainer = std::unordered_map<string, MonitorObject>;
 
             MonitorObjectContainer _monitor;
+            // sampler and buffers for the batched /proc pass, only touched in the job
+            ProcessSampler _sampler;
+            std::vector<ProcessSampler::Process> _hosts;
+            std::vector<MonitorObject*> _sampled;
+            std::vector<ProcessSampler::Usage> _usage;
             Core::WorkerPool::JobType<MonitorObjects&> _job;
             PluginHost::IShell* _service;
             Monitor& _parent;
         };
 
     public:
+        static constexpr uint16_t DefaultHistory = 120;
+
 PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
         Monitor()
             : _skipURL(0)
@@ -1051,6 +1534,7 @@ POP_WARNING()
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
         uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
         uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t endpoint_history(const HistoryParams& params, HistoryData& response);
         void event_action(const string& callsign, const string& action, const string& reason);
     };
 }
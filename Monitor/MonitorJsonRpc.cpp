@@ -35,6 +35,7 @@ namespace Plugin {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
         Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
         Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Register<HistoryParams,HistoryData>(_T("history"), &Monitor::endpoint_history, this);
     }
 
     void Monitor::UnregisterAll()
@@ -42,6 +43,7 @@ namespace Plugin {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
         Unregister(_T("status"));
+        Unregister(_T("history"));
     }
 
     // API implementation
@@ -85,6 +87,36 @@ namespace Plugin {
         return Core::ERROR_NONE;
     }
 
+    // Method: history - Percentiles and growth rate of the memory samples kept for a plugin, over a time window
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: The plugin is not watched by the Monitor
+    uint32_t Monitor::endpoint_history(const HistoryParams& params, HistoryData& response)
+    {
+        const string& callsign = params.Callsign.Value();
+        uint16_t capacity = 0;
+        std::vector<History::Sample> samples;
+
+        if (_monitor.Samples(callsign, params.Window.Value(), capacity, samples) == false) {
+            return Core::ERROR_UNKNOWN_KEY;
+        }
+
+        response.Callsign = callsign;
+        response.Capacity = capacity;
+        response.Count = static_cast<uint32_t>(samples.size());
+        response.Resident.Set(History::Analyze(samples, &History::Sample::Resident));
+        response.Proportional.Set(History::Analyze(samples, &History::Sample::Proportional));
+        response.Allocated.Set(History::Analyze(samples, &History::Sample::Allocated));
+        response.Shared.Set(History::Analyze(samples, &History::Sample::Shared));
+
+        if (params.Samples.Value() == true) {
+            for (const History::Sample& sample : samples) {
+                response.Samples.Add(HistoryData::Sample(sample));
+            }
+        }
+        return Core::ERROR_NONE;
+    }
+
     // Event: action - Signals action taken by the monitor
     void Monitor::event_action(const string& callsign, const string& action, const string& reason)
     {
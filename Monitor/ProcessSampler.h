@@ -0,0 +1,275 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_PROCESSSAMPLER_H
+#define __MONITOR_PROCESSSAMPLER_H
+
+// Reads the memory usage of all watched processes straight from /proc in one pass,
+// instead of a round trip through Exchange::IMemory per value and per plugin.
+// Kept free of framework dependencies so tools/SamplerBenchmark builds standalone.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class ProcessSampler {
+    public:
+        struct Usage {
+            uint64_t Resident; // bytes
+            uint64_t Proportional; // PSS in bytes, equal to Resident when smaps_rollup is not available
+            uint64_t Shared; // bytes
+            uint64_t Allocated; // virtual size in bytes
+            bool Valid;
+        };
+
+        struct Process {
+            uint32_t Id;
+            uint64_t Started; // clock ticks after boot, tells a reused pid apart
+        };
+
+        static constexpr uint32_t BufferSize = 4096;
+
+    public:
+        ProcessSampler(const ProcessSampler&) = delete;
+        ProcessSampler& operator=(const ProcessSampler&) = delete;
+
+        explicit ProcessSampler(const std::string& root = "/proc")
+            : _root(root)
+            , _path()
+            , _buffer(BufferSize)
+            , _pageSize(static_cast<uint64_t>(::sysconf(_SC_PAGESIZE)))
+            , _rollup(true)
+        {
+            _path.reserve(_root.length() + 32);
+        }
+        ~ProcessSampler() = default;
+
+    public:
+        // usage[n] receives the reading of processes[n]; buffers are reused from call to call.
+        // A process that is gone, or whose pid now belongs to another process, reads as not valid.
+        void Sample(const std::vector<Process>& processes, std::vector<Usage>& usage)
+        {
+            usage.resize(processes.size());
+
+            for (size_t index = 0; index < processes.size(); index++) {
+                Read(processes[index], usage[index]);
+            }
+        }
+
+        // Processes hosting callsign out of process, i.e. started as "<...>Process ... -C <callsign>".
+        static void Find(const std::string& root, const std::string& callsign, std::vector<Process>& processes)
+        {
+            processes.clear();
+
+            DIR* dir = ::opendir(root.c_str());
+            if (dir != nullptr) {
+                std::vector<char> buffer(BufferSize);
+                struct dirent* entry;
+
+                while ((entry = ::readdir(dir)) != nullptr) {
+                    char* end = nullptr;
+                    const unsigned long pid = ::strtoul(entry->d_name, &end, 10);
+
+                    if ((pid != 0) && (*end == '\0')) {
+                        const std::string path(root + '/' + entry->d_name + "/cmdline");
+                        const ssize_t length = Load(path.c_str(), buffer);
+
+                        if ((length > 0) && (IsHost(buffer.data(), static_cast<size_t>(length), callsign) == true)) {
+                            const std::string stat(root + '/' + entry->d_name + "/stat");
+                            Process process { static_cast<uint32_t>(pid), 0 };
+
+                            if ((Load(stat.c_str(), buffer) > 0) && (StartTime(buffer.data(), process.Started) == true)) {
+                                processes.push_back(process);
+                            }
+                        }
+                    }
+                }
+                ::closedir(dir);
+            }
+        }
+
+    private:
+        void Read(const Process& process, Usage& usage)
+        {
+            const uint32_t pid = process.Id;
+            uint64_t started = 0;
+
+            usage.Resident = 0;
+            usage.Proportional = 0;
+            usage.Shared = 0;
+            usage.Allocated = 0;
+            usage.Valid = false;
+
+            if ((Load(Path(pid, "/stat"), _buffer) <= 0) || (StartTime(_buffer.data(), started) == false) || (started != process.Started)) {
+                return;
+            }
+
+            // statm: size resident shared text lib data dt, in pages
+            if (Load(Path(pid, "/statm"), _buffer) > 0) {
+                char* cursor = _buffer.data();
+                usage.Allocated = ::strtoull(cursor, &cursor, 10) * _pageSize;
+                usage.Resident = ::strtoull(cursor, &cursor, 10) * _pageSize;
+                usage.Shared = ::strtoull(cursor, &cursor, 10) * _pageSize;
+                usage.Proportional = usage.Resident;
+                usage.Valid = true;
+
+                if (_rollup == true) {
+                    const ssize_t length = Load(Path(pid, "/smaps_rollup"), _buffer);
+
+                    if (length > 0) {
+                        Rollup(static_cast<size_t>(length), usage);
+                    } else if ((errno == ENOENT) && (::access(Path(pid, ""), F_OK) == 0)) {
+                        // The process still exists, so the kernel predates smaps_rollup (4.14)
+                        _rollup = false;
+                    }
+                }
+            }
+        }
+
+        // Lines look like "Pss:                 1234 kB"
+        void Rollup(const size_t length, Usage& usage) const
+        {
+            uint64_t shared = 0;
+            const char* line = _buffer.data();
+            const char* const end = line + length;
+
+            while (line < end) {
+                const char* next = static_cast<const char*>(::memchr(line, '\n', end - line));
+                next = (next == nullptr ? end : next + 1);
+
+                if (::strncmp(line, "Rss:", 4) == 0) {
+                    usage.Resident = ::strtoull(line + 4, nullptr, 10) * 1024;
+                } else if (::strncmp(line, "Pss:", 4) == 0) {
+                    usage.Proportional = ::strtoull(line + 4, nullptr, 10) * 1024;
+                } else if (::strncmp(line, "Shared_Clean:", 13) == 0) {
+                    shared += ::strtoull(line + 13, nullptr, 10) * 1024;
+                } else if (::strncmp(line, "Shared_Dirty:", 13) == 0) {
+                    shared += ::strtoull(line + 13, nullptr, 10) * 1024;
+                }
+                line = next;
+            }
+            usage.Shared = shared;
+        }
+
+        const char* Path(const uint32_t pid, const char file[])
+        {
+            char number[16];
+            char* cursor = &number[sizeof(number) - 1];
+            uint32_t value = pid;
+
+            *cursor = '\0';
+            do {
+                *--cursor = static_cast<char>('0' + (value % 10));
+                value /= 10;
+            } while (value != 0);
+
+            _path.assign(_root).append(1, '/').append(cursor).append(file);
+            return (_path.c_str());
+        }
+
+        // Reads the whole file, null terminated, into buffer. Returns the length or -1 with errno set.
+        static ssize_t Load(const char path[], std::vector<char>& buffer)
+        {
+            ssize_t result = -1;
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+            if (fd >= 0) {
+                ssize_t length = 0;
+                ssize_t bytes;
+
+                while ((bytes = ::read(fd, &buffer[length], buffer.size() - length - 1)) > 0) {
+                    length += bytes;
+                    if (static_cast<size_t>(length + 1) == buffer.size()) {
+                        buffer.resize(buffer.size() * 2);
+                    }
+                }
+                if (bytes == 0) {
+                    buffer[length] = '\0';
+                    result = length;
+                }
+                ::close(fd);
+            }
+
+            return (result);
+        }
+
+        // stat: "pid (comm) state ppid ...", starttime is field 22. comm may hold spaces and
+        // parentheses, so fields are counted from the last ')'.
+        static bool StartTime(const char stat[], uint64_t& started)
+        {
+            const char* cursor = ::strrchr(stat, ')');
+            uint8_t field = 2;
+
+            while ((cursor != nullptr) && (field < 22)) {
+                cursor = ::strchr(cursor + 1, ' ');
+                field++;
+            }
+            if (cursor != nullptr) {
+                char* end = nullptr;
+                started = ::strtoull(cursor + 1, &end, 10);
+                cursor = ((end != cursor + 1) ? end : nullptr);
+            }
+
+            return (cursor != nullptr);
+        }
+
+        static bool IsHost(const char cmdline[], const size_t length, const std::string& callsign)
+        {
+            const char* argument = cmdline;
+            const char* const end = cmdline + length;
+            const char* name = ::strrchr(argument, '/');
+            name = (name == nullptr ? argument : name + 1);
+
+            if (::strstr(name, "Process") == nullptr) {
+                return (false);
+            }
+
+            while (argument < end) {
+                const char* next = argument + ::strlen(argument) + 1;
+                if ((::strcmp(argument, "-C") == 0) && (next < end)) {
+                    return (callsign == next);
+                }
+                argument = next;
+            }
+
+            return (false);
+        }
+
+    private:
+        const std::string _root;
+        std::string _path;
+        std::vector<char> _buffer;
+        const uint64_t _pageSize;
+        bool _rollup;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_PROCESSSAMPLER_H
@@ -0,0 +1,149 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost of one Monitor sampling tick over a synthetic /proc tree.
+//
+//   MonitorSamplerBenchmark [-n processes] [-t ticks] [-s]
+//
+// -s leaves out smaps_rollup, as on kernels before 4.14, to time the statm fallback.
+
+#include "../ProcessSampler.h"
+
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    const char SmapsRollup[] =
+        "00400000-7ffd5e1f4000 ---p 00000000 00:00 0                          [rollup]\n"
+        "Rss:              184320 kB\n"
+        "Pss:              121856 kB\n"
+        "Pss_Anon:          98304 kB\n"
+        "Pss_File:          23040 kB\n"
+        "Pss_Shmem:           512 kB\n"
+        "Shared_Clean:      61440 kB\n"
+        "Shared_Dirty:       2048 kB\n"
+        "Private_Clean:     20480 kB\n"
+        "Private_Dirty:    100352 kB\n"
+        "Referenced:       180224 kB\n"
+        "Anonymous:         98304 kB\n"
+        "LazyFree:              0 kB\n"
+        "AnonHugePages:         0 kB\n"
+        "ShmemPmdMapped:        0 kB\n"
+        "FilePmdMapped:         0 kB\n"
+        "Shared_Hugetlb:        0 kB\n"
+        "Private_Hugetlb:       0 kB\n"
+        "Swap:                  0 kB\n"
+        "SwapPss:               0 kB\n"
+        "Locked:                0 kB\n";
+
+    void Write(const std::string& path, const std::string& content)
+    {
+        std::ofstream file(path.c_str());
+        file << content;
+    }
+
+    void Remove(const std::string& root, const uint32_t processes)
+    {
+        for (uint32_t pid = 1; pid <= processes; pid++) {
+            const std::string directory(root + '/' + std::to_string(pid));
+            ::unlink((directory + "/stat").c_str());
+            ::unlink((directory + "/statm").c_str());
+            ::unlink((directory + "/smaps_rollup").c_str());
+            ::rmdir(directory.c_str());
+        }
+        ::rmdir(root.c_str());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t processes = 32;
+    uint32_t ticks = 10000;
+    bool rollup = true;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "n:t:s")) != -1) {
+        switch (option) {
+        case 'n':
+            processes = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10));
+            break;
+        case 't':
+            ticks = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10));
+            break;
+        case 's':
+            rollup = false;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n processes] [-t ticks] [-s]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    char pattern[] = "/tmp/monitor-proc-XXXXXX";
+    if ((processes == 0) || (ticks == 0) || (::mkdtemp(pattern) == nullptr)) {
+        fprintf(stderr, "Nothing to measure\n");
+        return (1);
+    }
+
+    const std::string root(pattern);
+    std::vector<ProcessSampler::Process> hosts;
+
+    for (uint32_t pid = 1; pid <= processes; pid++) {
+        const std::string directory(root + '/' + std::to_string(pid));
+        ::mkdir(directory.c_str(), 0755);
+        Write(directory + "/stat", std::to_string(pid) + " (WPEProcess) S 1 1 1 0 -1 4194560 1200 0 0 0 300 40 0 0 20 0 12 0 4711 491520000 46080\n");
+        Write(directory + "/statm", "120000 46080 16000 300 0 60000 0\n");
+        if (rollup == true) {
+            Write(directory + "/smaps_rollup", SmapsRollup);
+        }
+        hosts.push_back(ProcessSampler::Process { pid, 4711 });
+    }
+
+    ProcessSampler sampler(root);
+    std::vector<ProcessSampler::Usage> usage;
+
+    // First pass sizes the buffers and settles the smaps_rollup detection
+    sampler.Sample(hosts, usage);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t tick = 0; tick < ticks; tick++) {
+        sampler.Sample(hosts, usage);
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    const double total = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / 1000;
+    printf("%u processes, %u ticks, %s: %.1f us per tick, %.2f us per process\n", processes, ticks,
+        (rollup == true ? "smaps_rollup" : "statm only"), total / ticks, total / ticks / processes);
+    printf("last reading: rss %llu pss %llu shared %llu allocated %llu\n",
+        static_cast<unsigned long long>(usage.back().Resident), static_cast<unsigned long long>(usage.back().Proportional),
+        static_cast<unsigned long long>(usage.back().Shared), static_cast<unsigned long long>(usage.back().Allocated));
+
+    Remove(root, processes);
+
+    return (0);
+}
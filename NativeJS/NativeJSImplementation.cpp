@@ -26,13 +26,81 @@ namespace WPEFramework
     namespace Plugin
     {
 
-        std::string gPendingIdRequest("");
-        std::string gPendingIdOptionsRequest("");
-	std::string gPendingUrl("");
 	SERVICE_REGISTRATION(NativeJSImplementation, 1, 0);
 
+        void NativeJSImplementation::RenderContext::Start(const std::string& waylandDisplay)
+        {
+            mThread = std::thread([=](std::string waylandDisplay) {
+                std::shared_ptr<NativeJSRenderer> renderer = std::make_shared<NativeJSRenderer>(waylandDisplay);
+                {
+                    std::lock_guard<std::mutex> lock(mStateLock);
+                    mRenderer = renderer;
+                }
+
+                // Launches that came in while the renderer was being built run first, in order
+                if (mQueue.Attach(renderer))
+                {
+                    renderer->run();
+                }
+
+                printf("After launch application execution ... \n"); fflush(stdout);
+
+                // Once no request is running on it this thread holds the last reference, the
+                // renderer is destroyed where it was built
+                mQueue.Detach();
+                {
+                    std::lock_guard<std::mutex> lock(mStateLock);
+                    mRenderer.reset();
+                }
+                renderer.reset();
+
+                std::lock_guard<std::mutex> lock(mStateLock);
+                mFinished = true;
+                mStateChanged.notify_all();
+            }, waylandDisplay);
+        }
+
+        void NativeJSImplementation::RenderContext::Terminate()
+        {
+            std::lock_guard<std::mutex> lock(mStateLock);
+            mQueue.Close();
+            if (mRenderer)
+            {
+                mRenderer->terminate();
+            }
+        }
+
+        void NativeJSImplementation::RenderContext::Stop()
+        {
+            Terminate();
+            if (mThread.joinable())
+            {
+                std::unique_lock<std::mutex> lock(mStateLock);
+                while (!mStateChanged.wait_for(lock, std::chrono::milliseconds(100), [this]() { return mFinished; }))
+                {
+                    lock.unlock();
+                    Terminate();
+                    lock.lock();
+                }
+                lock.unlock();
+                mThread.join();
+            }
+        }
+
+        bool NativeJSImplementation::RenderContext::Finished()
+        {
+            std::lock_guard<std::mutex> lock(mStateLock);
+            return mFinished;
+        }
+
+        bool NativeJSImplementation::RenderContext::Submit(RenderQueue<NativeJSRenderer>::Request request)
+        {
+            return mQueue.Submit(std::move(request));
+        }
+
         NativeJSImplementation::NativeJSImplementation()
-            : mRunning(true)
+            : mIsolated(false)
+            , mNextId(0)
         {
             TRACE(Trace::Information, (_T("Constructing NativeJSImplementation Service: %p"), this));
         }
@@ -40,104 +108,205 @@ namespace WPEFramework
         NativeJSImplementation::~NativeJSImplementation()
         {
             TRACE(Trace::Information, (_T("Destructing NativeJSImplementation Service: %p"), this));
-            mNativeJSRenderer = nullptr;
+        }
+
+        uint32_t NativeJSImplementation::Configure(PluginHost::IShell* service)
+        {
+            if (service != nullptr)
+            {
+                Config config;
+                config.FromString(service->ConfigLine());
+                mIsolated = (config.InstanceMode.Value() == _T("isolated"));
+            }
+            LOGINFO("NativeJS instance mode: %s", mIsolated ? "isolated" : "shared");
+            return (Core::ERROR_NONE);
         }
 
         Core::hresult NativeJSImplementation::Initialize(string waylandDisplay)
         {   
             std::cout << "initialize called on nativejs implementation " << std::endl;
-            mRenderThread = std::thread([=](std::string waylandDisplay) {
-                mNativeJSRenderer = std::make_shared<NativeJSRenderer>(waylandDisplay);
-                //if (!gPendingUrlRequest.empty())
-                //{
-		//    ModuleSettings moduleSettings;
-                //    moduleSettings.fromString(gPendingUrlOptionsRequest);
-                //    mNativeJSRenderer->launchApplication(gPendingUrlRequest, moduleSettings);
-		//    gPendingUrlRequest = "";
-                //    gPendingUrlOptionsRequest = "";
-                //}
-		
-		mNativeJSRenderer->run();
-		
-		printf("After launch application execution ... \n"); fflush(stdout);
-		mNativeJSRenderer.reset();
-
-            }, waylandDisplay);
+            mWaylandDisplay = waylandDisplay;
+            if (!mIsolated)
+            {
+                mSharedContext = std::make_shared<RenderContext>();
+                mSharedContext->Start(mWaylandDisplay);
+            }
             return (Core::ERROR_NONE);
         }
 
         Core::hresult NativeJSImplementation::Deinitialize()
         {
            LOGINFO("deinitializing NativeJS process");
-           if (mNativeJSRenderer)
+           std::set<std::shared_ptr<RenderContext>> contexts;
            {
-               mNativeJSRenderer->terminate();
-               if (mRenderThread.joinable())
+               std::lock_guard<std::mutex> lock(mLock);
+               for (auto& application : mApplications)
                {
-                   mRenderThread.join();
+                   contexts.insert(application.second.context);
                }
+               mApplications.clear();
+               contexts.insert(mTerminatedContexts.begin(), mTerminatedContexts.end());
+               mTerminatedContexts.clear();
+           }
+           if (mSharedContext)
+           {
+               contexts.insert(mSharedContext);
+               mSharedContext.reset();
+           }
+           for (auto& context : contexts)
+           {
+               context->Stop();
            }
 	   return (Core::ERROR_NONE);
         }
 
+        std::shared_ptr<NativeJSImplementation::RenderContext> NativeJSImplementation::contextOf(uint32_t id)
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            auto application = mApplications.find(id);
+            return (application != mApplications.end() ? application->second.context : nullptr);
+        }
+
+        // Resolved on the render thread when a request runs, the create before it has run by then
+        bool NativeJSImplementation::rendererIdOf(uint32_t id, uint32_t& rendererId)
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            auto application = mApplications.find(id);
+            if (application == mApplications.end() || !application->second.created)
+            {
+                return false;
+            }
+            rendererId = application->second.rendererId;
+            return true;
+        }
+
+        // Isolated mode: joins the render threads of terminated applications that have ended and
+        // repeats the terminate for the others, so a JSON-RPC call never waits for a render loop
+        void NativeJSImplementation::reapContexts()
+        {
+            std::list<std::shared_ptr<RenderContext>> contexts;
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                contexts.swap(mTerminatedContexts);
+            }
+            for (auto context = contexts.begin(); context != contexts.end();)
+            {
+                if ((*context)->Finished())
+                {
+                    (*context)->Stop();
+                    context = contexts.erase(context);
+                }
+                else
+                {
+                    (*context)->Terminate();
+                    ++context;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mLock);
+            mTerminatedContexts.splice(mTerminatedContexts.end(), contexts);
+        }
+
 	Core::hresult NativeJSImplementation::CreateApplication(const std::string options, uint32_t& id)
 	{
 		LOGINFO("createApplication invoked");
-		if(mNativeJSRenderer)
+		std::shared_ptr<RenderContext> context(mSharedContext);
+		if (mIsolated)
 		{
-			std::string optionsVal(options);
-			ModuleSettings moduleSettings;
-			moduleSettings.fromString(optionsVal);
-			id = mNativeJSRenderer->createApplication(moduleSettings);
+			reapContexts();
+			context = std::make_shared<RenderContext>();
+			context->Start(mWaylandDisplay);
+		}
+		if (!context)
+		{
+			LOGERR("createApplication called before initialize");
+			return (Core::ERROR_ILLEGAL_STATE);
 		}
-		else 
+
+		// The id is handed out right away, the renderer may still be starting up
 		{
-			gPendingIdOptionsRequest = options;
+			std::lock_guard<std::mutex> lock(mLock);
+			id = ++mNextId;
+			mApplications[id] = Application { context, 0, false };
 		}
+
+		const uint32_t applicationId = id;
+		context->Submit([this, applicationId, options](NativeJSRenderer& renderer) {
+			std::string optionsVal(options);
+			ModuleSettings moduleSettings;
+			moduleSettings.fromString(optionsVal);
+			uint32_t rendererId = renderer.createApplication(moduleSettings);
+
+			std::lock_guard<std::mutex> lock(mLock);
+			auto application = mApplications.find(applicationId);
+			if (application != mApplications.end())
+			{
+				application->second.rendererId = rendererId;
+				application->second.created = true;
+			}
+		});
 		return (Core::ERROR_NONE);
 	}
 
 	Core::hresult NativeJSImplementation::RunApplication(uint32_t id, const std::string url)
 	{
 		LOGINFO("runApplication invoked");
-		if(mNativeJSRenderer)
+		std::shared_ptr<RenderContext> context = contextOf(id);
+		if (!context)
 		{
-			std::string Url(url);
-			mNativeJSRenderer->runApplication(id, Url);
-		}
-		else
-		{
-			gPendingUrl = url;
-			LOGINFO("runApplication Couldn't execute");
+			LOGERR("runApplication: unknown application %u", id);
+			return (Core::ERROR_UNKNOWN_KEY);
 		}
+		context->Submit([this, id, url](NativeJSRenderer& renderer) {
+			uint32_t rendererId;
+			if (rendererIdOf(id, rendererId))
+			{
+				std::string Url(url);
+				renderer.runApplication(rendererId, Url);
+			}
+		});
 		return (Core::ERROR_NONE);
 	}
 
 	Core::hresult NativeJSImplementation::RunJavaScript(uint32_t id, const std::string code)
 	{
 		LOGINFO("runJavaScript invoked");
-		if(mNativeJSRenderer)
-		{
-			std::string Code(code);
-			mNativeJSRenderer->runJavaScript(id, Code);
-		}
-		else
+		std::shared_ptr<RenderContext> context = contextOf(id);
+		if (!context)
 		{
-			LOGINFO("runJavaScript couldn't execute");
+			LOGERR("runJavaScript: unknown application %u", id);
+			return (Core::ERROR_UNKNOWN_KEY);
 		}
+		context->Submit([this, id, code](NativeJSRenderer& renderer) {
+			uint32_t rendererId;
+			if (rendererIdOf(id, rendererId))
+			{
+				std::string Code(code);
+				renderer.runJavaScript(rendererId, Code);
+			}
+		});
 		return (Core::ERROR_NONE);
 	}
 
 	Core::hresult NativeJSImplementation::GetApplications()
 	{
 		LOGINFO("getApplication invoked");
-		if(mNativeJSRenderer)
+		std::set<std::shared_ptr<RenderContext>> contexts;
 		{
-			mNativeJSRenderer->getApplications();
+			std::lock_guard<std::mutex> lock(mLock);
+			for (auto& application : mApplications)
+			{
+				contexts.insert(application.second.context);
+			}
 		}
-		else
+		if (mSharedContext)
 		{
-			LOGINFO("getApplication couldn't execute");
+			contexts.insert(mSharedContext);
+		}
+		for (auto& context : contexts)
+		{
+			context->Submit([](NativeJSRenderer& renderer) {
+				renderer.getApplications();
+			});
 		}
 		return (Core::ERROR_NONE);
 	}
@@ -145,13 +314,33 @@ namespace WPEFramework
 	Core::hresult NativeJSImplementation::TerminateApplication(uint32_t id)
 	{
 		LOGINFO("terminateApplication invoked");
-		if(mNativeJSRenderer)
+		std::shared_ptr<RenderContext> context = contextOf(id);
+		if (!context)
 		{
-			mNativeJSRenderer->terminateApplication(id);
+			LOGERR("terminateApplication: unknown application %u", id);
+			return (Core::ERROR_UNKNOWN_KEY);
 		}
-		else
+		context->Submit([this, id](NativeJSRenderer& renderer) {
+			uint32_t rendererId;
+			if (rendererIdOf(id, rendererId))
+			{
+				renderer.terminateApplication(rendererId);
+			}
+			std::lock_guard<std::mutex> lock(mLock);
+			mApplications.erase(id);
+		});
+
+		if (mIsolated)
 		{
-			LOGINFO("Application couldn't be terminated");
+			// The application had its renderer to itself, it goes with it. Its render thread is
+			// joined by a later call or Deinitialize, not here.
+			{
+				std::lock_guard<std::mutex> lock(mLock);
+				mApplications.erase(id);
+				mTerminatedContexts.push_back(context);
+			}
+			context->Terminate();
+			reapContexts();
 		}
 		return (Core::ERROR_NONE);
 	}
@@ -22,10 +22,18 @@
 #include "Module.h"
 #include "UtilsLogging.h"
 #include <interfaces/INativeJS.h>
+#include <interfaces/IConfiguration.h>
 #include <interfaces/Ids.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <set>
+#include <memory>
 #include <mutex>
 #include "NativeJSRenderer.h"
+#include "RenderQueue.h"
 #include <thread>
 #include <vector>
 using namespace JsRuntime;
@@ -35,8 +43,65 @@ namespace WPEFramework
     namespace Plugin
     {
 
-        class NativeJSImplementation : public Exchange::INativeJS
+        class NativeJSImplementation : public Exchange::INativeJS, public Exchange::IConfiguration
         {
+        private:
+            class Config : public Core::JSON::Container
+            {
+                private:
+                    Config(const Config&) = delete;
+                    Config& operator=(const Config&) = delete;
+
+                public:
+                    Config()
+                        : Core::JSON::Container()
+                          , InstanceMode(_T("shared"))
+                    {
+                        Add(_T("instancemode"), &InstanceMode);
+                    }
+                    ~Config()
+                    {
+                    }
+
+                public:
+                    // "shared": all applications in one renderer, "isolated": a renderer and render thread per application
+                    Core::JSON::String InstanceMode;
+            };
+
+            // A renderer and the thread running its render loop
+            class RenderContext
+            {
+                public:
+                    RenderContext() : mFinished(false) {}
+                    ~RenderContext() { Stop(); }
+                    RenderContext(const RenderContext&) = delete;
+                    RenderContext& operator=(const RenderContext&) = delete;
+
+                    void Start(const std::string& waylandDisplay);
+                    // Drops new requests and asks the render loop to end, without waiting for it
+                    void Terminate();
+                    // Terminates and joins the render thread. A terminate that comes before the
+                    // render loop has started is lost, so it is repeated until the thread ends.
+                    void Stop();
+                    bool Finished();
+                    bool Submit(RenderQueue<NativeJSRenderer>::Request request);
+
+                private:
+                    std::thread mThread;
+                    RenderQueue<NativeJSRenderer> mQueue;
+                    std::mutex mStateLock;
+                    std::condition_variable mStateChanged;
+                    std::shared_ptr<NativeJSRenderer> mRenderer; // set by the render thread while it lives
+                    bool mFinished;
+            };
+
+            struct Application
+            {
+                std::shared_ptr<RenderContext> context;
+                uint32_t rendererId;
+                bool created;
+            };
+
         public:
             NativeJSImplementation();
             virtual ~NativeJSImplementation();
@@ -47,15 +112,27 @@ namespace WPEFramework
 	    virtual Core::hresult RunApplication(uint32_t id, const std::string url) override;
 	    virtual Core::hresult RunJavaScript(uint32_t id, const std::string code) override;
 	    virtual Core::hresult TerminateApplication(uint32_t id) override;
+
+            // IConfiguration methods
+            uint32_t Configure(PluginHost::IShell* service) override;
             
 	    BEGIN_INTERFACE_MAP(NativeJSImplementation)
             INTERFACE_ENTRY(Exchange::INativeJS)
+            INTERFACE_ENTRY(Exchange::IConfiguration)
             END_INTERFACE_MAP
 
         private:
-            std::thread mRenderThread;
-            bool mRunning;
-            std::shared_ptr<NativeJSRenderer> mNativeJSRenderer;
+            std::shared_ptr<RenderContext> contextOf(uint32_t id);
+            bool rendererIdOf(uint32_t id, uint32_t& rendererId);
+            void reapContexts();
+
+            bool mIsolated;
+            std::string mWaylandDisplay;
+            std::shared_ptr<RenderContext> mSharedContext;
+            std::mutex mLock;
+            uint32_t mNextId;
+            std::map<uint32_t, Application> mApplications;
+            std::list<std::shared_ptr<RenderContext>> mTerminatedContexts; // isolated mode, joined once their render loop ended
         };
     } // namespace Plugin
 } // namespace WPEFramework
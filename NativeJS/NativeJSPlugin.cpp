@@ -72,6 +72,12 @@ namespace WPEFramework {
                    waylandDisplay = display;
                 }
             }
+            Exchange::IConfiguration* configuration = mNativeJS->QueryInterface<Exchange::IConfiguration>();
+            if (configuration != nullptr)
+            {
+                configuration->Configure(service);
+                configuration->Release();
+            }
             mNativeJS->Initialize(waylandDisplay);
 	    Exchange::JNativeJS::Register(*this, mNativeJS);
             return "";
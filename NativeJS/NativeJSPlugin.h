@@ -25,6 +25,7 @@
 #include <interfaces/json/JsonData_NativeJS.h>
 #include <interfaces/json/JNativeJS.h>
 #include <interfaces/INativeJS.h>
+#include <interfaces/IConfiguration.h>
 
 namespace WPEFramework {
 
@@ -0,0 +1,149 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2020 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+// Requests for one renderer, taken from any thread. Until the render thread has built its
+// renderer they wait in arrival order; the render thread replays them before it enters the render
+// loop, after that requests go to the renderer right away, on the thread submitting them. Those
+// calls are not synchronized with the render loop, just like the plugin always called into the
+// renderer; the renderer has no hook to run work inside its loop. Kept free of framework and
+// renderer dependencies so the L1 tests drive it with a fake renderer.
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    template <typename RENDERER>
+    class RenderQueue {
+    public:
+        typedef std::function<void(RENDERER&)> Request;
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        RenderQueue()
+            : _lock()
+            , _idle()
+            , _pending()
+            , _renderer()
+            , _calls(0)
+            , _closed(false)
+        {
+        }
+        ~RenderQueue() = default;
+
+    public:
+        // Runs request on the calling thread once the renderer is up, concurrently with the render
+        // loop, queues it before. Returns false if the queue is closed and the request was dropped.
+        bool Submit(Request request)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            if (_closed == true) {
+                return (false);
+            }
+            if (_renderer == nullptr) {
+                _pending.push_back(std::move(request));
+                return (true);
+            }
+
+            std::shared_ptr<RENDERER> renderer(_renderer);
+            _calls++;
+            lock.unlock();
+            request(*renderer);
+            lock.lock();
+            if (--_calls == 0) {
+                _idle.notify_all();
+            }
+            return (true);
+        }
+
+        // On the render thread, before its render loop: replays everything queued, including what
+        // arrives meanwhile, and only then lets requests through directly. Returns false if the
+        // queue was closed, the render loop should not start then.
+        bool Attach(const std::shared_ptr<RENDERER>& renderer)
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            while ((_pending.empty() == false) && (_closed == false)) {
+                std::deque<Request> batch;
+                batch.swap(_pending);
+                lock.unlock();
+                for (Request& request : batch) {
+                    request(*renderer);
+                }
+                lock.lock();
+            }
+
+            if (_closed == false) {
+                _renderer = renderer;
+            }
+            return (_closed == false);
+        }
+
+        // Drops what is still queued and hands out the renderer, if attached, to terminate it
+        std::shared_ptr<RENDERER> Close()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            std::shared_ptr<RENDERER> renderer;
+
+            _closed = true;
+            _pending.clear();
+            renderer.swap(_renderer);
+            return (renderer);
+        }
+
+        // On the render thread, once its render loop has ended: closes the queue and waits for the
+        // requests still running on the renderer, so the last reference is the caller's and the
+        // renderer is destroyed on the thread that built it.
+        void Detach()
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+
+            _closed = true;
+            _pending.clear();
+            _idle.wait(lock, [this]() { return (_calls == 0); });
+            _renderer.reset();
+        }
+
+        size_t Pending() const
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            return (_pending.size());
+        }
+
+    private:
+        mutable std::mutex _lock;
+        std::condition_variable _idle;
+        std::deque<Request> _pending;
+        std::shared_ptr<RENDERER> _renderer;
+        uint32_t _calls; // requests running on the renderer from Submit
+        bool _closed;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
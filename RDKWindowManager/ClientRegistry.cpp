@@ -0,0 +1,123 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "ClientRegistry.h"
+#include <algorithm>
+#include <cctype>
+
+namespace WPEFramework {
+namespace Plugin {
+
+size_t CaseInsensitiveHash::operator()(const std::string& value) const
+{
+    /* FNV-1a over the lowercased bytes */
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        hash ^= static_cast<uint64_t>(std::tolower(static_cast<unsigned char>(value[i])));
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool CaseInsensitiveEqual::operator()(const std::string& lhs, const std::string& rhs) const
+{
+    if (lhs.size() != rhs.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); i++)
+    {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ClientRegistry::ClientRegistry()
+: mClients()
+, mClientNames()
+{
+}
+
+bool ClientRegistry::add(const std::string& client)
+{
+    if (mClients.find(client) != mClients.end())
+    {
+        return false;
+    }
+
+    /* the compositor reports client names in lowercase */
+    std::string name(client);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c){ return std::tolower(c); });
+    mClients.insert(name);
+    mClientNames.push_back(std::move(name));
+    return true;
+}
+
+bool ClientRegistry::remove(const std::string& client)
+{
+    ClientSet::iterator it = mClients.find(client);
+    if (it == mClients.end())
+    {
+        return false;
+    }
+
+    CaseInsensitiveEqual equal;
+    for (std::vector<std::string>::iterator name = mClientNames.begin(); name != mClientNames.end(); ++name)
+    {
+        if (equal(*name, client))
+        {
+            mClientNames.erase(name);
+            break;
+        }
+    }
+    mClients.erase(it);
+    return true;
+}
+
+bool ClientRegistry::exists(const std::string& client) const
+{
+    return (mClients.find(client) != mClients.end());
+}
+
+bool ClientRegistry::assign(const std::vector<std::string>& clients)
+{
+    ClientSet updated(clients.begin(), clients.end());
+    bool changed = (updated.size() != mClients.size());
+
+    for (ClientSet::const_iterator it = updated.begin(); !changed && (it != updated.end()); ++it)
+    {
+        changed = (mClients.find(*it) == mClients.end());
+    }
+
+    mClients.swap(updated);
+    mClientNames = clients;
+    return changed;
+}
+
+const std::vector<std::string>& ClientRegistry::clients() const
+{
+    return mClientNames;
+}
+
+} /* namespace Plugin */
+} /* namespace WPEFramework */
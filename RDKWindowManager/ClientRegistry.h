@@ -0,0 +1,65 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2024 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    /* Hash and equality that ignore ASCII case, so lookups never build a lowercase copy of the name */
+    struct CaseInsensitiveHash
+    {
+        size_t operator()(const std::string& value) const;
+    };
+
+    struct CaseInsensitiveEqual
+    {
+        bool operator()(const std::string& lhs, const std::string& rhs) const;
+    };
+
+    /*
+     * Compositor clients known to the plugin. Owned and modified by the render thread only;
+     * API threads read an immutable copy published in the RenderSnapshot.
+     */
+    class ClientRegistry
+    {
+    public:
+        ClientRegistry();
+
+        bool add(const std::string& client);
+        bool remove(const std::string& client);
+        bool exists(const std::string& client) const;
+        /* Replaces the client set with the compositor's list */
+        bool assign(const std::vector<std::string>& clients);
+        const std::vector<std::string>& clients() const;
+
+    private:
+        typedef std::unordered_set<std::string, CaseInsensitiveHash, CaseInsensitiveEqual> ClientSet;
+
+        ClientSet mClients;
+        /* compositor order, used for GetClients */
+        std::vector<std::string> mClientNames;
+    };
+
+} /* namespace Plugin */
+} /* namespace WPEFramework */
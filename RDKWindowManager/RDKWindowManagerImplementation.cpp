@@ -20,6 +20,7 @@
 #include "RDKWindowManagerImplementation.h"
 #include <sys/prctl.h>
 #include <mutex>
+#include <atomic>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <rdkwindowmanager/include/compositorcontroller.h>
@@ -34,11 +35,11 @@ using namespace RdkWindowManager;
 using namespace Utils;
 
 extern int gCurrentFramerate;
-static bool sRunning = true;
+static std::atomic<bool> sRunning(true);
 
 #define ANY_KEY                  65536
 #define KEYCODE_INVALID          -1
-#define TRY_LOCK_WAIT_TIME_IN_MS 250
+#define CLIENT_REGISTRY_RESYNC_INTERVAL_IN_MS 5000
 
 namespace WPEFramework {
 namespace Plugin {
@@ -78,9 +79,18 @@ uint32_t getKeyFlag(std::string modifier)
     return flag;
 }
 
+/* Held by the render thread for the whole frame; API threads never take it */
 static std::mutex gRdkWindowManagerMutex;
 static std::thread shellThread;
+/* Protects only the request queues below, so enqueueing never waits for a frame to finish */
+static std::mutex gRenderThreadQueueMutex;
+static bool gRenderThreadAcceptingCommands = false;
 static std::vector<std::shared_ptr<CreateDisplayRequest>> gCreateDisplayRequests;
+static std::vector<std::shared_ptr<RenderThreadCommand>> gRenderThreadCommands;
+static std::shared_ptr<const RenderSnapshot> gRenderSnapshot;
+/* Render thread only; copied into the next snapshot when gClientRegistryChanged is set */
+static ClientRegistry gClientRegistry;
+static bool gClientRegistryChanged = true;
 
 CreateDisplayRequest::CreateDisplayRequest(std::string client, std::string displayName, uint32_t displayWidth, uint32_t displayHeight, bool virtualDisplayEnabled,
                                            uint32_t virtualWidth, uint32_t virtualHeight, bool topmost, bool focus)
@@ -110,30 +120,128 @@ CreateDisplayRequest::~CreateDisplayRequest()
     }
 }
 
-bool lockRdkWindowManagerMutex()
+RenderThreadCommand::RenderThreadCommand(std::function<bool()> command)
+: mCommand(std::move(command))
+, mResult(false)
+{
+    if (0 != sem_init(&mSemaphore, 0, 0))
+    {
+        LOGERR("Failed to initialize semaphore: %s", strerror(errno));
+    }
+}
+
+RenderThreadCommand::~RenderThreadCommand()
+{
+    if (0 != sem_destroy(&mSemaphore))
+    {
+        LOGERR("Failed to destroy semaphore: %s", strerror(errno));
+    }
+}
+
+RenderSnapshot::RenderSnapshot()
+: mClients(std::make_shared<const ClientRegistry>())
+, mKeyRepeatsEnabled(false)
+, mFrame(0)
+{
+}
+
+/***
+ * @brief Queue a compositor call for the render thread.
+ * The command runs under gRdkWindowManagerMutex at the start of the next frame.
+ *
+ * @command[in]       : compositor call to execute, returns its result
+ * @waitForResult[in] : block until the frame executed the command
+ * @return            : result of the command, or true if not waiting for it
+ */
+static bool submitRenderThreadCommand(std::function<bool()> command, bool waitForResult = true)
+{
+    std::shared_ptr<RenderThreadCommand> request = std::make_shared<RenderThreadCommand>(std::move(command));
+
+    gRenderThreadQueueMutex.lock();
+    if (!gRenderThreadAcceptingCommands)
+    {
+        gRenderThreadQueueMutex.unlock();
+        LOGERR("render thread is not running");
+        return false;
+    }
+    gRenderThreadCommands.push_back(request);
+    gRenderThreadQueueMutex.unlock();
+
+    if (!waitForResult)
+    {
+        return true;
+    }
+
+    while (-1 == sem_wait(&request->mSemaphore))
+    {
+        if (EINTR != errno)
+        {
+            LOGERR("RenderThreadCommand: sem_wait failed: %s", strerror(errno));
+            return false;
+        }
+    }
+    return request->mResult;
+}
+
+static std::shared_ptr<const RenderSnapshot> getRenderSnapshot()
+{
+    return std::atomic_load(&gRenderSnapshot);
+}
+
+/* Called by the render thread with gRdkWindowManagerMutex held, after the frame applied all queued requests */
+static void publishRenderSnapshot(uint64_t frame)
+{
+    bool keyRepeatsEnabled = false;
+    if (false == CompositorController::getKeyRepeatsEnabled(keyRepeatsEnabled))
+    {
+        keyRepeatsEnabled = false;
+    }
+
+    /* Nothing observable changed, keep the current snapshot and skip the allocation */
+    std::shared_ptr<const RenderSnapshot> current = getRenderSnapshot();
+    if ((nullptr != current) && !gClientRegistryChanged && (current->mKeyRepeatsEnabled == keyRepeatsEnabled))
+    {
+        return;
+    }
+
+    std::shared_ptr<RenderSnapshot> snapshot = std::make_shared<RenderSnapshot>();
+    if (gClientRegistryChanged || (nullptr == current))
+    {
+        snapshot->mClients = std::make_shared<const ClientRegistry>(gClientRegistry);
+        gClientRegistryChanged = false;
+    }
+    else
+    {
+        snapshot->mClients = current->mClients;
+    }
+    snapshot->mKeyRepeatsEnabled = keyRepeatsEnabled;
+    snapshot->mFrame = frame;
+
+    std::atomic_store(&gRenderSnapshot, std::shared_ptr<const RenderSnapshot>(std::move(snapshot)));
+}
+
+/* Called by the render thread with gRdkWindowManagerMutex held; catches clients whose create/destroy event was missed */
+static void resyncClientRegistry(std::vector<std::string>& clientList)
 {
-    bool lockAcquired = false;
-    double startTime = RdkWindowManager::milliseconds();
-    while (!lockAcquired && (RdkWindowManager::milliseconds() - startTime) < TRY_LOCK_WAIT_TIME_IN_MS)
+    clientList.clear();
+    if (CompositorController::getClients(clientList))
     {
-        lockAcquired = gRdkWindowManagerMutex.try_lock();
+        if (gClientRegistry.assign(clientList))
+        {
+            gClientRegistryChanged = true;
+        }
     }
-    if (!lockAcquired)
+    else
     {
-        LOGERR("unable to get lock for defaulting to normal lock");
-        gRdkWindowManagerMutex.lock();
-        lockAcquired = true;
+        LOGERR("getClients Failed");
     }
-    return lockAcquired;
 }
 
-static bool isClientExists(std::string client)
+static bool isClientExists(const std::string& client)
 {
     bool exist = false;
-    bool retValue = false;
-    bool lockAcquired = false;
 
-    gRdkWindowManagerMutex.lock();
+    gRenderThreadQueueMutex.lock();
     for (unsigned int i=0; i<gCreateDisplayRequests.size(); i++)
     {
         if (gCreateDisplayRequests[i]->mClient.compare(client) == 0)
@@ -142,32 +250,19 @@ static bool isClientExists(std::string client)
             break;
         }
     }
-    gRdkWindowManagerMutex.unlock();
+    gRenderThreadQueueMutex.unlock();
 
     if (!exist)
     {
-        std::vector<std::string> clientList;
-        lockAcquired = lockRdkWindowManagerMutex();
-        if (lockAcquired)
+        std::shared_ptr<const RenderSnapshot> snapshot = getRenderSnapshot();
+        if (nullptr != snapshot)
         {
-            retValue = CompositorController::getClients(clientList);
-            gRdkWindowManagerMutex.unlock();
-            if (true == retValue)
-            {
-                std::string newClient(std::move(client));
-                transform(newClient.begin(), newClient.end(), newClient.begin(), ::tolower);
-
-                if (std::find(clientList.begin(), clientList.end(), newClient) != clientList.end())
-                {
-                    exist = true;
-                }
-            }
-            else
-            {
-                LOGERR("getClients Failed");
-            }
+            exist = snapshot->mClients->exists(client);
+        }
+        else
+        {
+            LOGERR("client snapshot not yet available");
         }
-
     }
     return exist;
 }
@@ -209,6 +304,11 @@ Core::hresult RDKWindowManagerImplementation::Initialize(PluginHost::IShell* ser
 
         CompositorController::setEventListener(mEventListener);
 
+        gRenderThreadQueueMutex.lock();
+        gRenderThreadAcceptingCommands = true;
+        gRenderThreadQueueMutex.unlock();
+        sRunning = true;
+
         enableInactivityReporting(true);
 
         static PluginHost::IShell* pluginService = nullptr;
@@ -216,6 +316,13 @@ Core::hresult RDKWindowManagerImplementation::Initialize(PluginHost::IShell* ser
 
         shellThread = std::thread([=]() {
             bool isRunning = true;
+            uint64_t frame = 0;
+            /* Swapped with the shared queues every frame so their capacity is reused */
+            std::vector<std::shared_ptr<CreateDisplayRequest>> createDisplayRequests;
+            std::vector<std::shared_ptr<RenderThreadCommand>> commands;
+            std::vector<std::string> clientList;
+            double lastRegistryResyncTime = 0;
+
             gRdkWindowManagerMutex.lock();
             RdkWindowManager::initialize();
             PluginHost::ISubSystem* subSystems(pluginService->SubSystems());
@@ -227,33 +334,85 @@ Core::hresult RDKWindowManagerImplementation::Initialize(PluginHost::IShell* ser
                 subSystems->Set(PluginHost::ISubSystem::GRAPHICS, nullptr);
                 subSystems->Release();
             }
+            resyncClientRegistry(clientList);
+            lastRegistryResyncTime = RdkWindowManager::milliseconds();
+            publishRenderSnapshot(frame);
             isRunning = sRunning;
             gRdkWindowManagerMutex.unlock();
             while(isRunning) {
               const double maxSleepTime = (1000 / gCurrentFramerate) * 1000;
               double startFrameTime = RdkWindowManager::microseconds();
+
+              gRenderThreadQueueMutex.lock();
+              createDisplayRequests.swap(gCreateDisplayRequests);
+              commands.swap(gRenderThreadCommands);
+              gRenderThreadQueueMutex.unlock();
+
               gRdkWindowManagerMutex.lock();
 
-              while (gCreateDisplayRequests.size() > 0)
+              for (size_t i = 0; i < createDisplayRequests.size(); i++)
               {
-                  std::shared_ptr<CreateDisplayRequest> request = gCreateDisplayRequests.front();
+                  std::shared_ptr<CreateDisplayRequest>& request = createDisplayRequests[i];
                   if (!request)
                   {
-                      gCreateDisplayRequests.erase(gCreateDisplayRequests.begin());
+                      continue;
+                  }
+                  /* isClientExists on the API thread cannot see requests already taken off the queue,
+                     so two quick calls for one client can both get here; the registry is current */
+                  if (gClientRegistry.exists(request->mClient))
+                  {
+                      LOGERR("Client: %s already exist", request->mClient.c_str());
+                      request->mResult = false;
                       continue;
                   }
                   request->mResult = CompositorController::createDisplay(request->mClient, request->mDisplayName, request->mDisplayWidth, request->mDisplayHeight, request->mVirtualDisplayEnabled, request->mVirtualWidth, request->mVirtualHeight, request->mTopmost, request->mFocus , request->mAutoDestroy);
-                  gCreateDisplayRequests.erase(gCreateDisplayRequests.begin());
-                  if (0 != sem_post(&request->mSemaphore))
+                  if (request->mResult)
                   {
-                      LOGERR("Failed to release CreateDisplayRequest semaphore: %s", strerror(errno));
+                      if (gClientRegistry.add(request->mClient))
+                      {
+                          gClientRegistryChanged = true;
+                      }
+                      if (false == CompositorController::addListener(request->mClient, mEventListener))
+                      {
+                          LOGERR("CompositorController::addListener Failed");
+                      }
                   }
               }
 
+              for (size_t i = 0; i < commands.size(); i++)
+              {
+                  commands[i]->mResult = commands[i]->mCommand();
+              }
+
               RdkWindowManager::draw();
               RdkWindowManager::update();
+              if ((RdkWindowManager::milliseconds() - lastRegistryResyncTime) >= CLIENT_REGISTRY_RESYNC_INTERVAL_IN_MS)
+              {
+                  resyncClientRegistry(clientList);
+                  lastRegistryResyncTime = RdkWindowManager::milliseconds();
+              }
+              publishRenderSnapshot(++frame);
               isRunning = sRunning;
               gRdkWindowManagerMutex.unlock();
+
+              /* Waiters are released only after the snapshot reflects their request */
+              for (size_t i = 0; i < createDisplayRequests.size(); i++)
+              {
+                  if (createDisplayRequests[i] && (0 != sem_post(&createDisplayRequests[i]->mSemaphore)))
+                  {
+                      LOGERR("Failed to release CreateDisplayRequest semaphore: %s", strerror(errno));
+                  }
+              }
+              for (size_t i = 0; i < commands.size(); i++)
+              {
+                  if (0 != sem_post(&commands[i]->mSemaphore))
+                  {
+                      LOGERR("Failed to release RenderThreadCommand semaphore: %s", strerror(errno));
+                  }
+              }
+              createDisplayRequests.clear();
+              commands.clear();
+
               double frameTime = (int)RdkWindowManager::microseconds() - (int)startFrameTime;
               if (frameTime < maxSleepTime)
               {
@@ -311,21 +470,36 @@ void RDKWindowManagerImplementation::Deinitialize(PluginHost::IShell* service)
     CompositorController::setEventListener(nullptr);
     mEventListener = nullptr;
 
-    gRdkWindowManagerMutex.lock();
+    /* Fail whatever the last frame did not pick up, so no API thread stays blocked */
+    gRenderThreadQueueMutex.lock();
+    gRenderThreadAcceptingCommands = false;
     for (unsigned int i=0; i<gCreateDisplayRequests.size(); i++)
     {
         if(gCreateDisplayRequests[i] != nullptr)
         {
-            if (0 != sem_destroy(&gCreateDisplayRequests[i]->mSemaphore))
+            gCreateDisplayRequests[i]->mResult = false;
+            if (0 != sem_post(&gCreateDisplayRequests[i]->mSemaphore))
             {
-                LOGERR("Failed to destroy semaphore: %s", strerror(errno));
+                LOGERR("Failed to release CreateDisplayRequest semaphore: %s", strerror(errno));
             }
             gCreateDisplayRequests[i] = nullptr;
         }
     }
     gCreateDisplayRequests.clear();
+    for (unsigned int i=0; i<gRenderThreadCommands.size(); i++)
+    {
+        gRenderThreadCommands[i]->mResult = false;
+        if (0 != sem_post(&gRenderThreadCommands[i]->mSemaphore))
+        {
+            LOGERR("Failed to release RenderThreadCommand semaphore: %s", strerror(errno));
+        }
+    }
+    gRenderThreadCommands.clear();
+    gRenderThreadQueueMutex.unlock();
 
-    gRdkWindowManagerMutex.unlock();
+    std::atomic_store(&gRenderSnapshot, std::shared_ptr<const RenderSnapshot>());
+    gClientRegistry = ClientRegistry();
+    gClientRegistryChanged = true;
 
     LOGINFO("RDKWindowManagerImplementation::Deinitialized");
 }
@@ -382,6 +556,46 @@ Core::hresult RDKWindowManagerImplementation::Unregister(INotification *notifica
     return status;
 }
 
+void RDKWindowManagerImplementation::RdkWindowManagerListener::onApplicationConnected(const std::string& client)
+{
+    LOGINFO("RDKWindowManager onApplicationConnected event received client: %s", client.c_str());
+
+    /* Applied on the render thread, which owns the registry, whichever thread raised the event */
+    submitRenderThreadCommand([=]() {
+        if (gClientRegistry.add(client))
+        {
+            gClientRegistryChanged = true;
+        }
+        return true;
+    }, false);
+}
+
+void RDKWindowManagerImplementation::RdkWindowManagerListener::onApplicationDisconnected(const std::string& client)
+{
+    LOGINFO("RDKWindowManager onApplicationDisconnected event received client: %s", client.c_str());
+
+    submitRenderThreadCommand([=]() {
+        if (gClientRegistry.remove(client))
+        {
+            gClientRegistryChanged = true;
+        }
+        return true;
+    }, false);
+}
+
+void RDKWindowManagerImplementation::RdkWindowManagerListener::onApplicationTerminated(const std::string& client)
+{
+    LOGINFO("RDKWindowManager onApplicationTerminated event received client: %s", client.c_str());
+
+    submitRenderThreadCommand([=]() {
+        if (gClientRegistry.remove(client))
+        {
+            gClientRegistryChanged = true;
+        }
+        return true;
+    }, false);
+}
+
 void RDKWindowManagerImplementation::RdkWindowManagerListener::onUserInactive(const double minutes)
 {
     LOGINFO("RDKWindowManager onUserInactive event received minutes: %f", minutes);
@@ -544,20 +758,12 @@ Core::hresult RDKWindowManagerImplementation::CreateDisplay(const string &displa
 Core::hresult RDKWindowManagerImplementation::GetClients(string &clients) const
 {
     Core::hresult status = Core::ERROR_GENERAL;
-    bool retValue = false;
-    std::vector<std::string> clientList;
     JsonArray clientsArray;
-    bool lockAcquired = false;
+    std::shared_ptr<const RenderSnapshot> snapshot = getRenderSnapshot();
 
-    lockAcquired = lockRdkWindowManagerMutex();
-    if (lockAcquired)
-    {
-        retValue = CompositorController::getClients(clientList);
-        gRdkWindowManagerMutex.unlock();
-    }
-
-    if (true == retValue)
+    if (nullptr != snapshot)
     {
+        const std::vector<std::string>& clientList = snapshot->mClients->clients();
         for (size_t i = 0; i < clientList.size(); i++)
         {
             clientsArray.Add(clientList[i]);
@@ -999,20 +1205,14 @@ Core::hresult RDKWindowManagerImplementation::ResetInactivityTime()
 Core::hresult RDKWindowManagerImplementation::EnableKeyRepeats(bool enable)
 {
     Core::hresult status = Core::ERROR_GENERAL;
-    bool lockAcquired = false;
 
-    lockAcquired = lockRdkWindowManagerMutex();
-    if (lockAcquired)
+    if (submitRenderThreadCommand([=]() { return CompositorController::enableKeyRepeats(enable); }))
     {
-        if (CompositorController::enableKeyRepeats(enable))
-        {
-            status = Core::ERROR_NONE;
-        }
-        else
-        {
-            LOGERR("Failed to enabled key repeats");
-        }
-        gRdkWindowManagerMutex.unlock();
+        status = Core::ERROR_NONE;
+    }
+    else
+    {
+        LOGERR("Failed to enabled key repeats");
     }
 
     return status;
@@ -1028,20 +1228,16 @@ Core::hresult RDKWindowManagerImplementation::EnableKeyRepeats(bool enable)
 Core::hresult RDKWindowManagerImplementation::GetKeyRepeatsEnabled(bool &keyRepeat) const
 {
     Core::hresult status = Core::ERROR_GENERAL;
-    bool lockAcquired = false;
+    std::shared_ptr<const RenderSnapshot> snapshot = getRenderSnapshot();
 
-    lockAcquired = lockRdkWindowManagerMutex();
-    if (lockAcquired)
+    if (nullptr != snapshot)
     {
-        if (CompositorController::getKeyRepeatsEnabled(keyRepeat))
-        {
-            status = Core::ERROR_NONE;
-        }
-        else
-        {
-            LOGERR("Failed to retrieve key repeat status");
-        }
-        gRdkWindowManagerMutex.unlock();
+        keyRepeat = snapshot->mKeyRepeatsEnabled;
+        status = Core::ERROR_NONE;
+    }
+    else
+    {
+        LOGERR("Failed to retrieve key repeat status");
     }
 
     return status;
@@ -1057,20 +1253,14 @@ Core::hresult RDKWindowManagerImplementation::GetKeyRepeatsEnabled(bool &keyRepe
 Core::hresult RDKWindowManagerImplementation::IgnoreKeyInputs(bool ignore)
 {
     Core::hresult status = Core::ERROR_GENERAL;
-    bool lockAcquired = false;
 
-    lockAcquired = lockRdkWindowManagerMutex();
-    if (lockAcquired)
+    if (submitRenderThreadCommand([=]() { return CompositorController::ignoreKeyInputs(ignore); }))
     {
-        if (CompositorController::ignoreKeyInputs(ignore))
-        {
-            status = Core::ERROR_NONE;
-        }
-        else
-        {
-            LOGERR("Failed to ignore key inputs");
-        }
-        gRdkWindowManagerMutex.unlock();
+        status = Core::ERROR_NONE;
+    }
+    else
+    {
+        LOGERR("Failed to ignore key inputs");
     }
     return status;
 }
@@ -1105,7 +1295,8 @@ Core::hresult RDKWindowManagerImplementation::EnableInputEvents(const string &cl
     else
     {
         const JsonArray clientArray = parameters.HasLabel("clients") ? parameters["clients"].Array() : JsonArray();
-        gRdkWindowManagerMutex.lock();
+        std::vector<std::string> clientNames;
+        bool allClients = false;
         if (clientArray.Length() > 0)
         {
             for (int i = 0; i < clientArray.Length(); i++)
@@ -1121,19 +1312,33 @@ Core::hresult RDKWindowManagerImplementation::EnableInputEvents(const string &cl
 
                 if (clientName == "*")
                 {
-                    std::vector<std::string> clientList;
-                    CompositorController::getClients(clientList);
-                    for (const auto& client : clientList)
-                    {
-                        result = result && CompositorController::enableInputEvents(client, enable);
-                    }
+                    allClients = true;
                     break;
                 }
                 else
                 {
-                    result = result && CompositorController::enableInputEvents(clientName, enable);
+                    clientNames.push_back(clientName);
                 }
             }
+
+            /* "*" is resolved by the render thread so it covers the clients present in that frame */
+            result = submitRenderThreadCommand([=]() {
+                bool commandResult = result;
+                for (const auto& client : clientNames)
+                {
+                    commandResult = commandResult && CompositorController::enableInputEvents(client, enable);
+                }
+                if (allClients)
+                {
+                    std::vector<std::string> clientList;
+                    CompositorController::getClients(clientList);
+                    for (const auto& client : clientList)
+                    {
+                        commandResult = commandResult && CompositorController::enableInputEvents(client, enable);
+                    }
+                }
+                return commandResult;
+            });
         }
         else
         {
@@ -1141,8 +1346,6 @@ Core::hresult RDKWindowManagerImplementation::EnableInputEvents(const string &cl
             result = false;
         }
 
-        gRdkWindowManagerMutex.unlock();
-
         if (!result)
         {
             LOGERR("Failed to Enable/Disable input events");
@@ -1197,11 +1400,13 @@ Core::hresult RDKWindowManagerImplementation::KeyRepeatConfig(const string &inpu
         initialDelay = config["initialDelay"].Number();
         repeatInterval = config["repeatInterval"].Number();
 
-        gRdkWindowManagerMutex.lock();
-        CompositorController::setKeyRepeatConfig(enabled, initialDelay, repeatInterval);
-        gRdkWindowManagerMutex.unlock();
-
-        status = Core::ERROR_NONE;
+        if (submitRenderThreadCommand([=]() {
+                CompositorController::setKeyRepeatConfig(enabled, initialDelay, repeatInterval);
+                return true;
+            }, false))
+        {
+            status = Core::ERROR_NONE;
+        }
     }
 
     return status;
@@ -1231,29 +1436,28 @@ bool RDKWindowManagerImplementation::createDisplay(const string& client, const s
 
     if (!isClientExists(client))
     {
-        bool lockAcquired = false;
-        gRdkWindowManagerMutex.lock();
         std::shared_ptr<CreateDisplayRequest> request = std::make_shared<CreateDisplayRequest>(client, displayName, displayWidth, displayHeight, virtualDisplay, virtualWidth, virtualHeight, topmost, focus);
-        gCreateDisplayRequests.push_back(request);
-        gRdkWindowManagerMutex.unlock();
-
-        if (-1 == sem_wait(&request->mSemaphore))
+        gRenderThreadQueueMutex.lock();
+        if (gRenderThreadAcceptingCommands)
         {
-            LOGERR("CreateDisplayRequest: sem_wait failed: %s", strerror(errno));
-        }
-        ret = request->mResult;
+            gCreateDisplayRequests.push_back(request);
+            gRenderThreadQueueMutex.unlock();
 
-        if (ret)
-        {
-            lockAcquired = lockRdkWindowManagerMutex();
-            if (lockAcquired)
+            /* The render thread also registers mEventListener for the client once the display exists */
+            while (-1 == sem_wait(&request->mSemaphore))
             {
-                if (false == RdkWindowManager::CompositorController::addListener(client, mEventListener))
+                if (EINTR != errno)
                 {
-                    LOGERR("CompositorController::addListener Failed");
+                    LOGERR("CreateDisplayRequest: sem_wait failed: %s", strerror(errno));
+                    break;
                 }
-                gRdkWindowManagerMutex.unlock();
             }
+            ret = request->mResult;
+        }
+        else
+        {
+            gRenderThreadQueueMutex.unlock();
+            LOGERR("render thread is not running");
         }
     }
     else
@@ -1266,33 +1470,46 @@ bool RDKWindowManagerImplementation::createDisplay(const string& client, const s
 
 bool RDKWindowManagerImplementation::enableInactivityReporting(const bool enable)
 {
-    bool lockAcquired = false;
-
-    lockAcquired = lockRdkWindowManagerMutex();
-    if (lockAcquired)
-    {
-       RdkWindowManager::CompositorController::enableInactivityReporting(enable);
-       gRdkWindowManagerMutex.unlock();
-    }
+    submitRenderThreadCommand([=]() {
+        RdkWindowManager::CompositorController::enableInactivityReporting(enable);
+        return true;
+    }, false);
     return true;
 }
 
+struct KeyInterceptEntry
+{
+    std::string mClient;
+    uint32_t mKeyCode;
+    uint32_t mFlags;
+};
+
+/* Registers all intercepts in one frame; returns the result of the last one, like the per key calls did */
+static bool applyKeyIntercepts(const std::vector<KeyInterceptEntry>& entries)
+{
+    return submitRenderThreadCommand([=]() {
+        bool added = false;
+        for (const auto& entry : entries)
+        {
+            added = RdkWindowManager::CompositorController::addKeyIntercept(entry.mClient, entry.mKeyCode, entry.mFlags);
+        }
+        return added;
+    });
+}
+
 bool RDKWindowManagerImplementation::addKeyIntercept(const uint32_t& keyCode, const JsonArray& modifiers, const string& client)
 {
     uint32_t flags = 0;
     for (unsigned int i=0; i<modifiers.Length(); i++) {
         flags |= getKeyFlag(modifiers[i].String());
     }
-    bool ret = false;
-    gRdkWindowManagerMutex.lock();
-    ret = RdkWindowManager::CompositorController::addKeyIntercept(client, keyCode, flags);
-    gRdkWindowManagerMutex.unlock();
-    return ret;
+    KeyInterceptEntry entry = { client, keyCode, flags };
+    return applyKeyIntercepts(std::vector<KeyInterceptEntry>(1, entry));
 }
 
 bool RDKWindowManagerImplementation::addKeyIntercepts(const JsonArray& intercepts)
 {
-    bool ret = false;
+    std::vector<KeyInterceptEntry> entries;
     for (unsigned int i=0; i<intercepts.Length(); i++)
     {
         if (!(intercepts[i].Content() == JsonValue::type::OBJECT))
@@ -1322,11 +1539,16 @@ bool RDKWindowManagerImplementation::addKeyIntercepts(const JsonArray& intercept
                 continue;
             }
             const JsonArray modifiers = keyEntry.HasLabel("modifiers") ? keyEntry["modifiers"].Array() : JsonArray();
-            const uint32_t keyCode = keyEntry["keyCode"].Number();
-            ret = addKeyIntercept(keyCode, modifiers, client);
+            uint32_t flags = 0;
+            for (unsigned int m=0; m<modifiers.Length(); m++)
+            {
+                flags |= getKeyFlag(modifiers[m].String());
+            }
+            KeyInterceptEntry entry = { client, static_cast<uint32_t>(keyEntry["keyCode"].Number()), flags };
+            entries.push_back(std::move(entry));
         }
     }
-    return ret;
+    return entries.empty() ? false : applyKeyIntercepts(entries);
 }
 
 bool RDKWindowManagerImplementation::removeKeyIntercept(const uint32_t& keyCode, const JsonArray& modifiers, const string& client)
@@ -1336,181 +1558,150 @@ bool RDKWindowManagerImplementation::removeKeyIntercept(const uint32_t& keyCode,
     {
         flags |= getKeyFlag(modifiers[i].String());
     }
-    bool ret = false;
-    gRdkWindowManagerMutex.lock();
-    ret = RdkWindowManager::CompositorController::removeKeyIntercept(client, keyCode, flags);
-    gRdkWindowManagerMutex.unlock();
-    return ret;
+    const uint32_t interceptKeyCode = keyCode;
+    return submitRenderThreadCommand([=]() {
+        return RdkWindowManager::CompositorController::removeKeyIntercept(client, interceptKeyCode, flags);
+    });
 }
 
-bool RDKWindowManagerImplementation::addKeyListeners(const string& client, const JsonArray& keys)
+struct KeyListenerEntry
+{
+    uint32_t mKeyCode;
+    uint32_t mFlags;
+    bool mNative;
+    std::map<std::string, RdkWindowManagerData> mProperties;
+};
+
+/* Parses the listener keys in order; stops at the first invalid entry like the compositor loop did */
+static bool parseKeyListeners(const JsonArray& keys, std::vector<KeyListenerEntry>& entries)
 {
-    gRdkWindowManagerMutex.lock();
-
-    bool result = true;
-
     for (unsigned int i=0; i<keys.Length(); i++)
     {
-        result = false;
         const JsonObject& keyInfo = keys[i].Object();
 
         if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
         {
             LOGERR("keyCode and nativeKeyCode can't be set both at the same time");
+            return false;
         }
         else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
         {
-            uint32_t keyCode = 0;
-
-            if (keyInfo.HasLabel("keyCode"))
+            KeyListenerEntry entry;
+            entry.mNative = !keyInfo.HasLabel("keyCode");
+            entry.mKeyCode = 0;
+            entry.mFlags = 0;
+
+            const char* label = entry.mNative ? "nativeKeyCode" : "keyCode";
+            std::string keystring = keyInfo[label].String();
+            if (keystring.compare("*") == 0)
             {
-                std::string keystring = keyInfo["keyCode"].String();
-                if (keystring.compare("*") == 0)
-                {
-                    keyCode = ANY_KEY;
-                }
-                else
-                {
-                    keyCode = keyInfo["keyCode"].Number();
-                }
+                entry.mKeyCode = ANY_KEY;
             }
             else
             {
-                std::string keystring = keyInfo["nativeKeyCode"].String();
-                if (keystring.compare("*") == 0)
-                {
-                    keyCode = ANY_KEY;
-                }
-                else
-                {
-                    keyCode = keyInfo["nativeKeyCode"].Number();
-                }
+                entry.mKeyCode = keyInfo[label].Number();
             }
+
             const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
-            uint32_t flags = 0;
-            for (unsigned int i=0; i<modifiers.Length(); i++)
+            for (unsigned int k=0; k<modifiers.Length(); k++)
             {
-                flags |= getKeyFlag(modifiers[i].String());
+                entry.mFlags |= getKeyFlag(modifiers[k].String());
             }
-            std::map<std::string, RdkWindowManagerData> properties;
             if (keyInfo.HasLabel("activate"))
             {
                 bool activate = keyInfo["activate"].Boolean();
-                properties["activate"] = activate;
+                entry.mProperties["activate"] = activate;
             }
             if (keyInfo.HasLabel("propagate"))
             {
                 bool propagate = keyInfo["propagate"].Boolean();
-                properties["propagate"] = propagate;
-            }
-
-            if (keyInfo.HasLabel("keyCode"))
-            {
-                result = RdkWindowManager::CompositorController::addKeyListener(client, keyCode, flags, properties);
-            }
-            else
-            {
-                result = RdkWindowManager::CompositorController::addNativeKeyListener(client, keyCode, flags, properties);
+                entry.mProperties["propagate"] = propagate;
             }
+            entries.push_back(std::move(entry));
         }
         else
         {
             LOGERR("Neither keyCode nor nativeKeyCode provided");
-        }
-
-        if (result == false)
-        {
-            break;
+            return false;
         }
     }
-    gRdkWindowManagerMutex.unlock();
-    return result;
+    return true;
 }
 
-bool RDKWindowManagerImplementation::removeKeyListeners(const string& client, const JsonArray& keys)
+bool RDKWindowManagerImplementation::addKeyListeners(const string& client, const JsonArray& keys)
 {
-    gRdkWindowManagerMutex.lock();
+    std::vector<KeyListenerEntry> entries;
+    const bool parsed = parseKeyListeners(keys, entries);
 
-    bool result = true;
-
-    for (unsigned int i=0; i<keys.Length(); i++)
+    if (entries.empty())
     {
-        result = false;
-        const JsonObject& keyInfo = keys[i].Object();
+        return parsed;
+    }
 
-        if (keyInfo.HasLabel("keyCode") && keyInfo.HasLabel("nativeKeyCode"))
-        {
-            LOGERR("keyCode and nativeKeyCode can't be set both at the same time");
-        }
-        else if (keyInfo.HasLabel("keyCode") || keyInfo.HasLabel("nativeKeyCode"))
+    /* mutable: the compositor takes the listener properties by non-const reference */
+    const bool result = submitRenderThreadCommand([=]() mutable {
+        for (auto& entry : entries)
         {
-            uint32_t keyCode = 0;
-            if (keyInfo.HasLabel("keyCode"))
+            bool added = false;
+            if (!entry.mNative)
             {
-                std::string keystring = keyInfo["keyCode"].String();
-                if (keystring.compare("*") == 0)
-                {
-                    keyCode = ANY_KEY;
-                }
-                else
-                {
-                    keyCode = keyInfo["keyCode"].Number();
-                }
+                added = RdkWindowManager::CompositorController::addKeyListener(client, entry.mKeyCode, entry.mFlags, entry.mProperties);
             }
             else
             {
-                std::string keystring = keyInfo["nativeKeyCode"].String();
-                if (keystring.compare("*") == 0)
-                {
-                    keyCode = ANY_KEY;
-                }
-                else
-                {
-                    keyCode = keyInfo["nativeKeyCode"].Number();
-                }
+                added = RdkWindowManager::CompositorController::addNativeKeyListener(client, entry.mKeyCode, entry.mFlags, entry.mProperties);
             }
-
-            const JsonArray modifiers = keyInfo.HasLabel("modifiers") ? keyInfo["modifiers"].Array() : JsonArray();
-            uint32_t flags = 0;
-            for (unsigned int i=0; i<modifiers.Length(); i++) {
-                flags |= getKeyFlag(modifiers[i].String());
+            if (added == false)
+            {
+                return false;
             }
+        }
+        return true;
+    });
+    return parsed && result;
+}
+
+bool RDKWindowManagerImplementation::removeKeyListeners(const string& client, const JsonArray& keys)
+{
+    std::vector<KeyListenerEntry> entries;
+    const bool parsed = parseKeyListeners(keys, entries);
 
-            if (keyInfo.HasLabel("keyCode"))
+    if (entries.empty())
+    {
+        return parsed;
+    }
+
+    const bool result = submitRenderThreadCommand([=]() {
+        for (const auto& entry : entries)
+        {
+            bool removed = false;
+            if (!entry.mNative)
             {
-                result = RdkWindowManager::CompositorController::removeKeyListener(client, keyCode, flags);
+                removed = RdkWindowManager::CompositorController::removeKeyListener(client, entry.mKeyCode, entry.mFlags);
             }
             else
             {
-                result = RdkWindowManager::CompositorController::removeNativeKeyListener(client, keyCode, flags);
+                removed = RdkWindowManager::CompositorController::removeNativeKeyListener(client, entry.mKeyCode, entry.mFlags);
+            }
+            if (removed == false)
+            {
+                return false;
             }
         }
-        else
-        {
-            LOGERR("Neither keyCode nor nativeKeyCode provided");
-        }
-
-        if (result == false)
-        {
-            break;
-        }
-    }
-    gRdkWindowManagerMutex.unlock();
-    return result;
+        return true;
+    });
+    return parsed && result;
 }
 
 bool RDKWindowManagerImplementation::injectKey(const uint32_t& keyCode, const JsonArray& modifiers)
 {
-    bool ret = false;
     uint32_t flags = 0;
     for (unsigned int i=0; i<modifiers.Length(); i++)
     {
         flags |= getKeyFlag(modifiers[i].String());
     }
-    gRdkWindowManagerMutex.lock();
-    ret = RdkWindowManager::CompositorController::injectKey(keyCode, flags);
-    gRdkWindowManagerMutex.unlock();
-    return ret;
+    const uint32_t injectKeyCode = keyCode;
+    return submitRenderThreadCommand([=]() { return RdkWindowManager::CompositorController::injectKey(injectKeyCode, flags); });
 }
 
 bool RDKWindowManagerImplementation::generateKey(const string& client, const JsonArray& keyInputs)
@@ -1521,7 +1712,6 @@ bool RDKWindowManagerImplementation::generateKey(const string& client, const Jso
         const JsonObject& keyInputInfo = keyInputs[i].Object();
         uint32_t keyCode = 0, flags = 0;
         std::string virtualKey("");
-        bool lockAcquired = false;
 
         if (keyInputInfo.HasLabel("key"))
         {
@@ -1549,25 +1739,19 @@ bool RDKWindowManagerImplementation::generateKey(const string& client, const Jso
         {
             keyClient = keyInputInfo.HasLabel("callsign")? keyInputInfo["callsign"].String(): "";
         }
-        lockAcquired = lockRdkWindowManagerMutex();
-        if (lockAcquired)
+        bool targetFound = false;
+        if (keyClient != "")
         {
-            bool targetFound = false;
-            if (keyClient != "")
+            std::shared_ptr<const RenderSnapshot> snapshot = getRenderSnapshot();
+            std::transform(keyClient.begin(), keyClient.end(), keyClient.begin(), ::tolower);
+            if ((nullptr != snapshot) && snapshot->mClients->exists(keyClient))
             {
-                std::vector<std::string> clientList;
-                RdkWindowManager::CompositorController::getClients(clientList);
-                std::transform(keyClient.begin(), keyClient.end(), keyClient.begin(), ::tolower);
-                if (std::find(clientList.begin(), clientList.end(), keyClient) != clientList.end())
-                {
-                    targetFound = true;
-                }
+                targetFound = true;
             }
-            if (targetFound || keyClient == "")
-            {
-                ret = RdkWindowManager::CompositorController::generateKey(keyClient, keyCode, flags, std::move(virtualKey));
-            }
-            gRdkWindowManagerMutex.unlock();
+        }
+        if (targetFound || keyClient == "")
+        {
+            ret = submitRenderThreadCommand([=]() { return RdkWindowManager::CompositorController::generateKey(keyClient, keyCode, flags, virtualKey); });
         }
     }
     return ret;
@@ -1575,43 +1759,35 @@ bool RDKWindowManagerImplementation::generateKey(const string& client, const Jso
 
 bool RDKWindowManagerImplementation::setInactivityInterval(const uint32_t interval)
 {
-    bool lockAcquired = false;
-
-    lockAcquired = lockRdkWindowManagerMutex();
-    try
-    {
-        RdkWindowManager::CompositorController::setInactivityInterval((double)interval);
-        LOGINFO("RDKWindowManager setInactivity for Interval:%d",interval);
-    }
-    catch (...)
-    {
-        LOGERR("RDKWindowManager unable to set inactivity interval  ");
-    }
-    if (lockAcquired)
-    {
-        gRdkWindowManagerMutex.unlock();
-    }
+    submitRenderThreadCommand([=]() {
+        try
+        {
+            RdkWindowManager::CompositorController::setInactivityInterval((double)interval);
+            LOGINFO("RDKWindowManager setInactivity for Interval:%d",interval);
+        }
+        catch (...)
+        {
+            LOGERR("RDKWindowManager unable to set inactivity interval  ");
+        }
+        return true;
+    }, false);
     return true;
 }
 
 bool RDKWindowManagerImplementation::resetInactivityTime()
 {
-    bool lockAcquired = false;
-
-    lockAcquired = lockRdkWindowManagerMutex();
-    try
-    {
-        RdkWindowManager::CompositorController::resetInactivityTime();
-        LOGINFO("RDKWindowManager inactivity time reset");
-    }
-    catch (...)
-    {
-        LOGERR("RDKWindowManager unable to reset inactivity time  ");
-    }
-    if (lockAcquired)
-    {
-        gRdkWindowManagerMutex.unlock();
-    }
+    submitRenderThreadCommand([=]() {
+        try
+        {
+            RdkWindowManager::CompositorController::resetInactivityTime();
+            LOGINFO("RDKWindowManager inactivity time reset");
+        }
+        catch (...)
+        {
+            LOGERR("RDKWindowManager unable to reset inactivity time  ");
+        }
+        return true;
+    }, false);
     return true;
 }
 } /* namespace Plugin */
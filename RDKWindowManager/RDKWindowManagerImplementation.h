@@ -20,12 +20,15 @@
 #pragma once
 
 #include "Module.h"
+#include "ClientRegistry.h"
 #include <interfaces/Ids.h>
 #include <interfaces/IRDKWindowManager.h>
 #include "tracing/Logging.h"
 #include <vector>
 #include <thread>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <com/com.h>
 #include <core/core.h>
 #include <rdkwindowmanager/include/rdkwindowmanagerevents.h>
@@ -56,6 +59,28 @@ namespace Plugin {
         bool mAutoDestroy;
     };
 
+    /* Compositor call queued by an API thread and executed by the render thread at the start of the next frame */
+    struct RenderThreadCommand
+    {
+        explicit RenderThreadCommand(std::function<bool()> command);
+
+        ~RenderThreadCommand();
+
+        std::function<bool()> mCommand;
+        sem_t mSemaphore;
+        bool mResult;
+    };
+
+    /* Immutable compositor state published by the render thread once per frame, read by queries without locking */
+    struct RenderSnapshot
+    {
+        RenderSnapshot();
+
+        std::shared_ptr<const ClientRegistry> mClients;
+        bool mKeyRepeatsEnabled;
+        uint64_t mFrame;
+    };
+
     class RDKWindowManagerImplementation : public Exchange::IRDKWindowManager{
     public:
         RDKWindowManagerImplementation();
@@ -168,6 +193,9 @@ namespace Plugin {
             }
 
             /* Events listeners */
+            virtual void onApplicationConnected(const std::string& client);
+            virtual void onApplicationDisconnected(const std::string& client);
+            virtual void onApplicationTerminated(const std::string& client);
             virtual void onUserInactive(const double minutes);
 
           private:
@@ -0,0 +1,311 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * API call latency against a busy render thread: the try_lock spin on the frame mutex the plugin
+ * used before, against the request queue served at the start of each frame with queries answered
+ * from the per-frame snapshot.
+ *
+ *   RDKWindowManagerRenderQueueBenchmark [-f fps] [-d draw ms] [-t api threads] [-n calls per thread] [-q query per mille]
+ *
+ * The compositor is simulated: the render thread holds the frame mutex for the draw time of every
+ * frame and sleeps for the rest of it. API threads issue calls at random intervals, most of them
+ * queries (getClients and the like), the rest mutations that have to run on the render thread.
+ * Besides the call latencies the longest frame shows how much the callers delay rendering.
+ */
+
+#include <semaphore.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const int TryLockWaitTimeInMs = 250;
+
+    struct Command
+    {
+        Command() { sem_init(&mSemaphore, 0, 0); }
+        ~Command() { sem_destroy(&mSemaphore); }
+        sem_t mSemaphore;
+    };
+
+    struct Snapshot
+    {
+        std::vector<std::string> mClients;
+    };
+
+    class Compositor
+    {
+    public:
+        Compositor(const bool queued, const int fps, const int drawMs)
+        : mQueued(queued)
+        , mFrameUs(1000000 / fps)
+        , mDrawUs(drawMs * 1000)
+        , mRunning(true)
+        , mLongestFrameUs(0)
+        , mClients()
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                mClients.push_back("client" + std::to_string(i));
+            }
+            publish();
+            mThread = std::thread(&Compositor::run, this);
+        }
+        ~Compositor()
+        {
+            mRunning = false;
+            mThread.join();
+        }
+
+        /* What getClients did before: spin on try_lock, then block */
+        void lockedQuery()
+        {
+            lockFrameMutex();
+            std::vector<std::string> clients(mClients);
+            mFrameMutex.unlock();
+        }
+        void lockedMutation()
+        {
+            lockFrameMutex();
+            mClients[0].swap(mClients[1]);
+            mFrameMutex.unlock();
+        }
+
+        void snapshotQuery()
+        {
+            std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&mSnapshot);
+            std::vector<std::string> clients(snapshot->mClients);
+        }
+        void queuedMutation()
+        {
+            std::shared_ptr<Command> command = std::make_shared<Command>();
+            mQueueMutex.lock();
+            mCommands.push_back(command);
+            mQueueMutex.unlock();
+            while ((-1 == sem_wait(&command->mSemaphore)) && (EINTR == errno))
+            {
+            }
+        }
+
+        long longestFrameUs() const { return mLongestFrameUs; }
+
+    private:
+        void lockFrameMutex()
+        {
+            bool lockAcquired = false;
+            const Clock::time_point start = Clock::now();
+            while (!lockAcquired && (Clock::now() - start) < std::chrono::milliseconds(TryLockWaitTimeInMs))
+            {
+                lockAcquired = mFrameMutex.try_lock();
+            }
+            if (!lockAcquired)
+            {
+                mFrameMutex.lock();
+            }
+        }
+
+        void publish()
+        {
+            std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+            snapshot->mClients = mClients;
+            std::atomic_store(&mSnapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+        }
+
+        void busy(const long us)
+        {
+            const Clock::time_point end = Clock::now() + std::chrono::microseconds(us);
+            while (Clock::now() < end)
+            {
+            }
+        }
+
+        void run()
+        {
+            std::vector<std::shared_ptr<Command>> commands;
+            while (mRunning)
+            {
+                const Clock::time_point start = Clock::now();
+
+                if (mQueued)
+                {
+                    mQueueMutex.lock();
+                    commands.swap(mCommands);
+                    mQueueMutex.unlock();
+                }
+
+                mFrameMutex.lock();
+                for (size_t i = 0; i < commands.size(); i++)
+                {
+                    mClients[0].swap(mClients[1]);
+                }
+                busy(mDrawUs);
+                if (mQueued)
+                {
+                    publish();
+                }
+                mFrameMutex.unlock();
+
+                for (size_t i = 0; i < commands.size(); i++)
+                {
+                    sem_post(&commands[i]->mSemaphore);
+                }
+                commands.clear();
+
+                const long frameUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+                mLongestFrameUs = std::max(mLongestFrameUs.load(), frameUs);
+                if (frameUs < mFrameUs)
+                {
+                    usleep(mFrameUs - frameUs);
+                }
+            }
+        }
+
+        const bool mQueued;
+        const long mFrameUs;
+        const long mDrawUs;
+        std::atomic<bool> mRunning;
+        std::atomic<long> mLongestFrameUs;
+        std::mutex mFrameMutex;
+        std::mutex mQueueMutex;
+        std::vector<std::shared_ptr<Command>> mCommands;
+        std::vector<std::string> mClients;
+        std::shared_ptr<const Snapshot> mSnapshot;
+        std::thread mThread;
+    };
+
+    struct Latencies
+    {
+        std::vector<double> mQueries;
+        std::vector<double> mMutations;
+    };
+
+    double percentile(std::vector<double>& values, const double fraction)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+    }
+
+    void report(const char name[], Latencies& latencies, const long longestFrameUs)
+    {
+        printf("  %-8s query p50 %9.1f us  p99 %9.1f us  max %9.1f us | mutation p50 %9.1f us  p99 %9.1f us  max %9.1f us | longest frame %6.1f ms\n",
+            name,
+            percentile(latencies.mQueries, 0.50), percentile(latencies.mQueries, 0.99), percentile(latencies.mQueries, 1.0),
+            percentile(latencies.mMutations, 0.50), percentile(latencies.mMutations, 0.99), percentile(latencies.mMutations, 1.0),
+            longestFrameUs / 1000.0);
+    }
+
+    void run(const bool queued, const int fps, const int drawMs, const int threads, const int calls, const int queryPerMille, Latencies& latencies)
+    {
+        Compositor compositor(queued, fps, drawMs);
+        std::vector<std::thread> callers;
+        std::vector<Latencies> perThread(threads);
+
+        for (int t = 0; t < threads; t++)
+        {
+            callers.emplace_back([&, t]() {
+                std::mt19937 random(42 + t);
+                for (int i = 0; i < calls; i++)
+                {
+                    usleep(1000 + (random() % 4000));
+                    const bool query = (static_cast<int>(random() % 1000) < queryPerMille);
+                    const Clock::time_point start = Clock::now();
+                    if (query)
+                    {
+                        queued ? compositor.snapshotQuery() : compositor.lockedQuery();
+                    }
+                    else
+                    {
+                        queued ? compositor.queuedMutation() : compositor.lockedMutation();
+                    }
+                    const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                    (query ? perThread[t].mQueries : perThread[t].mMutations).push_back(us);
+                }
+            });
+        }
+        for (std::thread& caller : callers)
+        {
+            caller.join();
+        }
+
+        for (const Latencies& one : perThread)
+        {
+            latencies.mQueries.insert(latencies.mQueries.end(), one.mQueries.begin(), one.mQueries.end());
+            latencies.mMutations.insert(latencies.mMutations.end(), one.mMutations.begin(), one.mMutations.end());
+        }
+        report(queued ? "queued" : "try_lock", latencies, compositor.longestFrameUs());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int fps = 60;
+    int drawMs = 10;
+    int threads = 4;
+    int calls = 200;
+    int queryPerMille = 800;
+    int option;
+
+    while ((option = getopt(argc, argv, "f:d:t:n:q:")) != -1)
+    {
+        switch (option)
+        {
+        case 'f': fps = atoi(optarg); break;
+        case 'd': drawMs = atoi(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'n': calls = atoi(optarg); break;
+        case 'q': queryPerMille = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-f fps] [-d draw ms] [-t api threads] [-n calls per thread] [-q query per mille]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if ((fps <= 0) || (drawMs < 0) || (threads <= 0) || (calls <= 0))
+    {
+        fprintf(stderr, "fps, api threads and calls must be at least 1\n");
+        return 1;
+    }
+
+    printf("%d fps, %d ms draw, %d api threads x %d calls, %d per mille queries\n", fps, drawMs, threads, calls, queryPerMille);
+
+    Latencies locked;
+    Latencies queued;
+    run(false, fps, drawMs, threads, calls, queryPerMille, locked);
+    run(true, fps, drawMs, threads, calls, queryPerMille, queued);
+    return 0;
+}
@@ -21,6 +21,7 @@
 #include "SocketServer.h"
 #include "Logger.h"
 #include <plugins/Channel.h>
+#include <fcntl.h>
 
 namespace WPEFramework {
 namespace Plugin {
@@ -50,6 +51,18 @@ RemotePlugin::Initialize(PluginHost::IShell *shell)
     return string("RustAdapter RemotePlugin couldn't open socket stream");
   }
 
+  if (m_config.SharedMemory.Value() > 0)
+  {
+    if (!m_config.AutoExec)
+    {
+      LOGWARN("RustAdapter RemotePlugin shared memory needs autoexec, staying on the socket");
+    }
+    else if (m_stream.OpenSharedMemory(m_config.SharedMemory.Value()) < 0)
+    {
+      LOGWARN("RustAdapter RemotePlugin no shared memory rings, staying on the socket");
+    }
+  }
+
   if (m_stream.RunThread() < 0)
   {
     return string("RustAdapter RemotePlugin failed to run stream thread");
@@ -233,6 +246,22 @@ int RemotePlugin::LaunchRemoteProcess(const string& rust_shared_lib, const strin
     if (!m_auth_token.empty())
       setenv("THUNDER_SECURITY_TOKEN", m_auth_token.c_str(), 1);
 
+    // Hand the ring pair down, see SharedRing.h for the layout. A WPEHost that does not know
+    // these keeps using the socket.
+    const ::SharedMemory& shared = m_stream.GetSharedMemory();
+    if (shared.IsOpen())
+    {
+      const int fds[] = { shared.GetFd(), shared.Requests().Doorbell(), shared.Responses().Doorbell(), shared.GetLifeline() };
+      for (int fd : fds)
+        fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) & ~FD_CLOEXEC);
+
+      setenv("WPEHOST_SHM_FD", std::to_string(fds[0]).c_str(), 1);
+      setenv("WPEHOST_SHM_SIZE", std::to_string(shared.GetSize()).c_str(), 1);
+      setenv("WPEHOST_SHM_REQUEST_EVENTFD", std::to_string(fds[1]).c_str(), 1);
+      setenv("WPEHOST_SHM_RESPONSE_EVENTFD", std::to_string(fds[2]).c_str(), 1);
+      setenv("WPEHOST_SHM_LIFELINE_FD", std::to_string(fds[3]).c_str(), 1);
+    }
+
     if (execvp(appName.c_str(), (char**)argv) < 0)
     {
       LOGERR("Failed launch remote app %s: %s", appName.c_str(), strerror(errno));
@@ -246,6 +275,9 @@ int RemotePlugin::LaunchRemoteProcess(const string& rust_shared_lib, const strin
   else
   {
     //TODO: verify child is running
+
+    // From now on only the host holds the lifeline, its exit detaches the rings
+    m_stream.ReleaseSharedLifeline();
   }
 
   return pid;
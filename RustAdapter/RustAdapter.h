@@ -45,20 +45,23 @@ public:
       Add(_T("port"), &Port);
       Add(_T("autoexec"), &AutoExec);
       Add(_T("libname"), &LibName);
+      Add(_T("sharedmemory"), &SharedMemory);
       OutOfProcess = rhs.OutOfProcess;;
       Address = rhs.Address;
       Port = rhs.Port;
       AutoExec = rhs.AutoExec;
       LibName = rhs.LibName;
+      SharedMemory = rhs.SharedMemory;
     }
 
-    Config() : Core::JSON::Container(), OutOfProcess(false)
+    Config() : Core::JSON::Container(), OutOfProcess(false), SharedMemory(0)
     {
       Add(_T("outofprocess"), &OutOfProcess);
       Add(_T("address"), &Address);
       Add(_T("port"), &Port);
       Add(_T("autoexec"), &AutoExec);
       Add(_T("libname"), &LibName);
+      Add(_T("sharedmemory"), &SharedMemory);
     }
     ~Config()
     {
@@ -69,6 +72,8 @@ public:
     Core::JSON::DecUInt16 Port;
     Core::JSON::Boolean AutoExec;
     Core::JSON::String LibName;
+    // Bytes per shared memory ring offered to an autoexec'd WPEHost, 0 keeps it on the socket
+    Core::JSON::DecUInt32 SharedMemory;
   };
 
   /**
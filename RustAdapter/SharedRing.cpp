@@ -0,0 +1,339 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "SharedRing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+#define SHARED_RING_MAX_SIZE (64 * 1024 * 1024)
+
+const size_t SharedRing::ControlSize;
+
+SharedRing::SharedRing()
+: m_control(nullptr)
+, m_data(nullptr)
+, m_mask(0)
+, m_doorbell(-1)
+{
+}
+
+void SharedRing::Bind(void* base, uint32_t size, int doorbell)
+{
+  m_control = static_cast<Control*>(base);
+  m_data = (base != nullptr ? static_cast<char*>(base) + ControlSize : nullptr);
+  m_mask = size - 1;
+  m_doorbell = doorbell;
+}
+
+void SharedRing::Reset()
+{
+  m_control->head.store(0);
+  m_control->tail.store(0);
+  m_control->sleeping.store(1);
+  m_control->peer.store(0);
+  m_control->size = m_mask + 1;
+}
+
+int SharedRing::Write(const struct iovec* iov, int iovcnt)
+{
+  const uint32_t head = m_control->head.load(std::memory_order_relaxed);
+  const uint32_t tail = m_control->tail.load(std::memory_order_acquire);
+  size_t len = 0;
+
+  for (int i = 0; i < iovcnt; i++)
+    len += iov[i].iov_len;
+
+  if (len > (m_mask + 1) - (head - tail))
+    return -1;
+
+  uint32_t position = head;
+  for (int i = 0; i < iovcnt; i++)
+  {
+    const char* p = static_cast<const char*>(iov[i].iov_base);
+    size_t left = iov[i].iov_len;
+
+    while (left > 0)
+    {
+      const uint32_t offset = position & m_mask;
+      const size_t part = (left < (m_mask + 1) - offset ? left : (m_mask + 1) - offset);
+      memcpy(m_data + offset, p, part);
+      p += part;
+      left -= part;
+      position += part;
+    }
+  }
+
+  // Publishing head and checking sleeping pairs with Idle, both sequentially consistent, so
+  // either the consumer sees the frame or the producer sees it sleeping
+  m_control->head.store(position);
+  if (m_control->sleeping.exchange(0) == 0)
+    return 0;
+
+  uint64_t one = 1;
+  while (write(m_doorbell, &one, sizeof(one)) < 0 && errno == EINTR)
+    ;
+  return 1;
+}
+
+ssize_t SharedRing::Read(char* buffer, size_t len)
+{
+  const uint32_t tail = m_control->tail.load(std::memory_order_relaxed);
+  const uint32_t head = m_control->head.load(std::memory_order_acquire);
+  const size_t available = (uint32_t)(head - tail);
+
+  // tail is ours, so only a head the producer should never have written gets here
+  if (available > (size_t)m_mask + 1)
+    return -1;
+
+  const size_t count = (len < available ? len : available);
+  const uint32_t offset = tail & m_mask;
+  const size_t first = (count < (m_mask + 1) - offset ? count : (m_mask + 1) - offset);
+
+  memcpy(buffer, m_data + offset, first);
+  memcpy(buffer + first, m_data, count - first);
+  m_control->tail.store(tail + count, std::memory_order_release);
+
+  return (ssize_t)count;
+}
+
+bool SharedRing::Idle()
+{
+  m_control->sleeping.store(1);
+  if (m_control->head.load() != m_control->tail.load(std::memory_order_relaxed))
+  {
+    // A frame slipped in, keep reading. A doorbell rung for it meanwhile only wakes us once more.
+    m_control->sleeping.store(0);
+    return false;
+  }
+  return true;
+}
+
+void SharedRing::Attach(uint32_t pid)
+{
+  m_control->peer.store(pid);
+}
+
+void SharedRing::Detach()
+{
+  m_control->peer.store(0);
+}
+
+uint32_t SharedRing::Peer() const
+{
+  return (m_control != nullptr ? m_control->peer.load(std::memory_order_acquire) : 0);
+}
+
+uint32_t SharedRing::Size() const
+{
+  return m_mask + 1;
+}
+
+int SharedRing::Doorbell() const
+{
+  return m_doorbell;
+}
+
+SharedMemory::SharedMemory()
+: m_fd(-1)
+, m_lifeline(-1)
+, m_hangup(-1)
+, m_size(0)
+, m_base(MAP_FAILED)
+, m_length(0)
+, m_owner(false)
+, m_requests()
+, m_responses()
+{
+}
+
+SharedMemory::~SharedMemory()
+{
+  Close();
+}
+
+int SharedMemory::Create(uint32_t size)
+{
+  uint32_t rounded = 4096;
+
+  if (size > SHARED_RING_MAX_SIZE)
+    size = SHARED_RING_MAX_SIZE;
+  while (rounded < size)
+    rounded <<= 1;
+
+  // memfd_create through syscall, older C libraries do not wrap it
+  m_fd = (int)syscall(SYS_memfd_create, "RustAdapter", MFD_CLOEXEC);
+  m_size = rounded;
+  m_owner = true;
+
+  if (m_fd < 0)
+    return -1;
+
+  int requestBell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  int responseBell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  int lifeline[2] = { -1, -1 };
+  int rc = pipe2(lifeline, O_CLOEXEC | O_NONBLOCK);
+
+  m_requests.Bind(nullptr, m_size, requestBell);
+  m_responses.Bind(nullptr, m_size, responseBell);
+  m_hangup = lifeline[0];
+  m_lifeline = lifeline[1];
+
+  if (requestBell < 0 || responseBell < 0 || rc < 0 || Setup(true) < 0)
+  {
+    Close();
+    return -1;
+  }
+  return 0;
+}
+
+int SharedMemory::Map(int fd, uint32_t size, int requestBell, int responseBell)
+{
+  if (size == 0 || size > SHARED_RING_MAX_SIZE || (size & (size - 1)) != 0)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  m_fd = fd;
+  m_size = size;
+  m_owner = false;
+  m_requests.Bind(nullptr, m_size, requestBell);
+  m_responses.Bind(nullptr, m_size, responseBell);
+
+  if (Setup(false) < 0)
+  {
+    Close();
+    return -1;
+  }
+  return 0;
+}
+
+int SharedMemory::Setup(bool create)
+{
+  m_length = 2 * (SharedRing::ControlSize + m_size);
+
+  if (create && ftruncate(m_fd, m_length) < 0)
+    return -1;
+
+  m_base = mmap(nullptr, m_length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (m_base == MAP_FAILED)
+    return -1;
+
+  char* base = static_cast<char*>(m_base);
+  m_requests.Bind(base, m_size, m_requests.Doorbell());
+  m_responses.Bind(base + SharedRing::ControlSize + m_size, m_size, m_responses.Doorbell());
+
+  if (create)
+  {
+    m_requests.Reset();
+    m_responses.Reset();
+  }
+  return 0;
+}
+
+void SharedMemory::Close()
+{
+  if (m_base != MAP_FAILED)
+  {
+    munmap(m_base, m_length);
+    m_base = MAP_FAILED;
+  }
+
+  // Descriptors handed to Map belong to the caller
+  if (m_owner)
+  {
+    if (m_fd >= 0)
+      close(m_fd);
+    if (m_requests.Doorbell() >= 0)
+      close(m_requests.Doorbell());
+    if (m_responses.Doorbell() >= 0)
+      close(m_responses.Doorbell());
+    if (m_hangup >= 0)
+      close(m_hangup);
+    ReleaseLifeline();
+  }
+
+  m_fd = -1;
+  m_hangup = -1;
+  m_owner = false;
+  m_requests.Bind(nullptr, 0, -1);
+  m_responses.Bind(nullptr, 0, -1);
+}
+
+bool SharedMemory::IsOpen() const
+{
+  return m_base != MAP_FAILED;
+}
+
+SharedRing& SharedMemory::Requests()
+{
+  return m_requests;
+}
+
+SharedRing& SharedMemory::Responses()
+{
+  return m_responses;
+}
+
+const SharedRing& SharedMemory::Requests() const
+{
+  return m_requests;
+}
+
+const SharedRing& SharedMemory::Responses() const
+{
+  return m_responses;
+}
+
+int SharedMemory::GetFd() const
+{
+  return m_fd;
+}
+
+uint32_t SharedMemory::GetSize() const
+{
+  return m_size;
+}
+
+int SharedMemory::GetLifeline() const
+{
+  return m_lifeline;
+}
+
+int SharedMemory::GetHangup() const
+{
+  return m_hangup;
+}
+
+void SharedMemory::ReleaseLifeline()
+{
+  if (m_lifeline >= 0)
+  {
+    close(m_lifeline);
+    m_lifeline = -1;
+  }
+}
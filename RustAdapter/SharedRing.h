@@ -0,0 +1,136 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// Single producer, single consumer byte ring living in shared memory. It carries the very same
+// frames as the socket, so a peer parses both alike. Producer and consumer only share the head
+// and tail counters: a frame costs two copies into and out of the mapping and no syscall, unless
+// the consumer announced it is going to sleep, in which case the producer rings its doorbell, an
+// eventfd, once.
+//
+// Layout of a ring, which the WPEHost side maps as well. Counters are native endian uint32 and
+// only ever grow, wrapping around; size is a power of two.
+//
+//   0    head      bytes ever written, stored by the producer
+//   64   tail      bytes ever read, stored by the consumer
+//   128  sleeping  non zero while the consumer waits on the doorbell, starts at 1
+//   132  peer      pid of the consumer once it serves the ring, 0 before and after
+//   136  size      data bytes
+//   256  data
+class SharedRing
+{
+public:
+  static const size_t ControlSize = 256;
+
+  SharedRing();
+  SharedRing(const SharedRing&) = delete;
+  SharedRing& operator=(const SharedRing&) = delete;
+
+  void Bind(void* base, uint32_t size, int doorbell);
+  void Reset();
+
+  // Producer side. Writes the whole frame or nothing: returns -1 when it does not fit, 1 when the
+  // doorbell had to be rung and 0 otherwise.
+  int Write(const struct iovec* iov, int iovcnt);
+
+  // Consumer side. Read copies out up to len bytes and returns how many, or -1 when head is
+  // further ahead than the ring holds: the producer broke the layout and nothing in the ring can
+  // be trusted anymore. Idle arms the doorbell and returns true when the ring is really empty, the
+  // consumer may wait on the doorbell then.
+  ssize_t Read(char* buffer, size_t len);
+  bool Idle();
+  void Attach(uint32_t pid);
+  void Detach();
+
+  uint32_t Peer() const;
+  uint32_t Size() const;
+  int Doorbell() const;
+
+private:
+  struct Control
+  {
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) std::atomic<uint32_t> sleeping;
+    std::atomic<uint32_t> peer;
+    uint32_t size;
+  };
+
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "ring counters are shared between processes");
+  static_assert(sizeof(Control) <= ControlSize, "ring control does not fit its slot");
+
+  Control* m_control;
+  char* m_data;
+  uint32_t m_mask;
+  int m_doorbell;
+};
+
+// The ring pair of one adapter and its WPEHost in one memfd mapping: requests at offset 0,
+// responses right after them, each ring ControlSize + size bytes. Every ring has its own eventfd
+// doorbell, so each side only ever waits on one.
+//
+// The adapter also creates a lifeline pipe. Only the WPEHost keeps its write end, open and
+// untouched, so the read end hangs up the moment the host exits, zombie or not. A host that forks
+// must not let its children inherit it.
+class SharedMemory
+{
+public:
+  SharedMemory();
+  ~SharedMemory();
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  // Adapter side, size is rounded up to a power of two
+  int Create(uint32_t size);
+  // WPEHost side, for the descriptors it inherited
+  int Map(int fd, uint32_t size, int requestBell, int responseBell);
+  void Close();
+
+  bool IsOpen() const;
+  SharedRing& Requests();
+  SharedRing& Responses();
+  const SharedRing& Requests() const;
+  const SharedRing& Responses() const;
+  int GetFd() const;
+  uint32_t GetSize() const;
+  // Adapter side: the write end goes to the host, the read end is watched for its hangup
+  int GetLifeline() const;
+  int GetHangup() const;
+  // Drops the adapter's own copy of the write end once the host was spawned
+  void ReleaseLifeline();
+
+private:
+  int Setup(bool create);
+
+  int m_fd;
+  int m_lifeline;
+  int m_hangup;
+  uint32_t m_size;
+  void* m_base;
+  size_t m_length;
+  bool m_owner;
+  SharedRing m_requests;
+  SharedRing m_responses;
+};
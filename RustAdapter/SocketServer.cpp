@@ -20,7 +20,10 @@
 #include "Logger.h"
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/ip.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <string.h>
 #include <unistd.h>
@@ -70,12 +73,34 @@ Response::Response(uint32_t channel, const string& json_str)
 {
 }
 
-#define CLIENT_DISCONNECT -2
+#define MAX_RESPONSE_SIZE (16 * 1024 * 1024)
+#define MAX_EVENTS 32
+#define MAX_IOV 64
+#define RECEIVE_BUFFER_SIZE (64 * 1024)
+
+const size_t SocketServer::MaxPending;
+const size_t SocketServer::CoalesceSize;
+const int SocketServer::SharedRetryMs;
 
 SocketServer::SocketServer()
-: m_serverSocket(0)
-, m_clientSocket(0)
+: m_serverSocket(-1)
+, m_epoll(-1)
+, m_wakeup(-1)
+, m_lock()
+, m_clients()
+, m_channels()
+, m_shared()
+, m_sharedPeer()
+, m_receiveBuffer(RECEIVE_BUFFER_SIZE)
+, m_responses()
+, m_responseCount(0)
+, m_frames(0)
+, m_sendCalls(0)
+, m_responsesDelivered(0)
+, m_receiveCalls(0)
 , m_running(false)
+, m_stop(false)
+, m_threadStarted(false)
 , m_address()
 , m_port(0)
 {
@@ -91,9 +116,10 @@ int SocketServer::Open(const string& address, int port, const function<void (con
 {
   int sock;
   struct sockaddr_in addr;
+  struct epoll_event ev;
   int rc;
 
-  sock = socket(AF_INET, SOCK_STREAM, 0);
+  sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
 
   if (sock < 0)
   {
@@ -122,40 +148,48 @@ int SocketServer::Open(const string& address, int port, const function<void (con
   
   LOGDBG("SocketServer::Open host_ip=%s sin_addr=%d (note that INADDR_ANY=%d)", address.c_str(), addr.sin_addr.s_addr, INADDR_ANY);
 
-  int sock_flags = fcntl (sock, F_GETFD, 0);
-  if (sock_flags < 0)
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
   {
-    LOGERR("SocketServer::Open fcntl get failed: %s", strerror(errno));
+    LOGERR("SocketServer::Open bind failed: %s", strerror(errno));
     close(sock);
     return -1;
   }
 
-  sock_flags |= FD_CLOEXEC;
-
-  if (fcntl(sock, F_SETFD, sock_flags) < 0)
+  if (listen(sock, 64) < 0)
   {
-    LOGERR("SocketServer::Open fcntl set failed: %s", strerror(errno));
+    LOGERR("SocketServer::Open listen failed: %s", strerror(errno));
     close(sock);
     return -1;
   }
 
-  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  if (m_epoll < 0 || m_wakeup < 0)
   {
-    LOGERR("SocketServer::Open bind failed: %s", strerror(errno));
+    LOGERR("SocketServer::Open epoll setup failed: %s", strerror(errno));
     close(sock);
+    Close();
     return -1;
   }
 
-  if (listen(sock, 4) < 0)
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = sock;
+  rc = epoll_ctl(m_epoll, EPOLL_CTL_ADD, sock, &ev);
+  ev.data.fd = m_wakeup;
+  if (rc < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &ev) < 0)
   {
-    LOGERR("SocketServer::Open listen failed: %s", strerror(errno));
+    LOGERR("SocketServer::Open epoll_ctl failed: %s", strerror(errno));
     close(sock);
+    Close();
     return -1;
   }
 
   m_reader = reader;
   m_serverSocket = sock;
   m_address = address;
+  m_stop = false;
 
   if (port)
   {
@@ -179,6 +213,45 @@ int SocketServer::Open(const string& address, int port, const function<void (con
   return 0;
 }
 
+// Called after Open and before RunThread. The rings stay unused until a host attaches to them.
+int SocketServer::OpenSharedMemory(uint32_t size)
+{
+  struct epoll_event ev;
+
+  if (m_epoll < 0 || m_shared.Create(size) < 0)
+  {
+    LOGERR("SocketServer::OpenSharedMemory failed: %s", strerror(errno));
+    m_shared.Close();
+    return -1;
+  }
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = m_shared.Responses().Doorbell();
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, ev.data.fd, &ev) < 0)
+  {
+    LOGERR("SocketServer::OpenSharedMemory epoll_ctl failed: %s", strerror(errno));
+    m_shared.Close();
+    return -1;
+  }
+
+  // The host's end of the lifeline is the only one left once it was spawned, its exit hangs up
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = m_shared.GetHangup();
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, ev.data.fd, &ev) < 0)
+  {
+    LOGERR("SocketServer::OpenSharedMemory epoll_ctl failed: %s", strerror(errno));
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, m_shared.Responses().Doorbell(), nullptr);
+    m_shared.Close();
+    return -1;
+  }
+
+  m_sharedPeer.fd = m_shared.Responses().Doorbell();
+  LOGDBG("SocketServer::OpenSharedMemory %u byte rings on fd %d", m_shared.GetSize(), m_shared.GetFd());
+  return 0;
+}
+
 int SocketServer::RunThread()
 {
   if (pthread_create(&m_thread, nullptr, SocketServer::RunThreadFunc, this) != 0)
@@ -186,6 +259,7 @@ int SocketServer::RunThread()
     LOGERR("SocketServer::Open failed to create thread: %s",strerror(errno));
     return -1;
   }
+  m_threadStarted = true;
   return 0;
 }
 
@@ -198,86 +272,383 @@ void* SocketServer::RunThreadFunc(void* arg)
 
 int SocketServer::Run()
 {
-  if (m_serverSocket <= 0 || m_running)
+  bool running = false;
+
+  if (m_serverSocket < 0 || !m_running.compare_exchange_strong(running, true))
     return -1;
 
-  m_running = true;
+  struct epoll_event events[MAX_EVENTS];
+  int rc = 0;
 
-  while (m_running)
+  while (!m_stop)
   {
-    fd_set m_readSet;
-    fd_set m_exceptSet;
-    struct timeval tv;
-    int res;
-
-    FD_ZERO(&m_readSet);
-    FD_ZERO(&m_exceptSet);
-    FD_SET(m_serverSocket, &m_readSet);
-    FD_SET(m_serverSocket, &m_exceptSet);    
-    if (m_clientSocket)
+    int timeout = -1;
     {
-      FD_SET(m_clientSocket, &m_readSet);
-      FD_SET(m_clientSocket, &m_exceptSet);    
+      std::lock_guard<std::mutex> guard(m_lock);
+      if (!m_sharedPeer.outbound.empty())
+        timeout = SharedRetryMs;
     }
 
-    tv.tv_sec = 10;
-    tv.tv_usec = 0;
-    res = select((m_clientSocket > m_serverSocket ? m_clientSocket : m_serverSocket) + 1, 
-                 &m_readSet, NULL, &m_exceptSet, &tv);
+    int res = epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
 
-    if (!m_running)
+    if (m_stop)
       break;
 
     if (res < 0)
     {
-      LOGERR("SocketServer::Open select failed: %s", strerror(errno));
-      return -1;
+      if (errno == EINTR)
+        continue;
+
+      LOGERR("SocketServer::Run epoll_wait failed: %s", strerror(errno));
+      rc = -1;
+      break;
     }
 
-    if (res == 0)
-      continue;
+    for (int i = 0; i < res; i++)
+    {
+      int fd = events[i].data.fd;
 
-    if (FD_ISSET(m_serverSocket, &m_readSet))
-    {
-      int clsock;
-      struct sockaddr_in claddr;
-      socklen_t cllen;
-      
-      cllen = sizeof(claddr);
-      memset(&claddr, 0, cllen);
-      
-      clsock = accept(m_serverSocket, (struct sockaddr*)&claddr, &cllen);
-      if (clsock < 0)
+      if (fd == m_serverSocket)
       {
-        LOGERR("SocketServer::Open accept failed: %s", strerror(errno));
+        Accept();
+      }
+      else if (fd == m_shared.Responses().Doorbell())
+      {
+        ReceiveShared();
+      }
+      else if (fd == m_shared.GetHangup())
+      {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        DetachShared("host exited", false);
+      }
+      else if (fd == m_wakeup)
+      {
+        uint64_t count;
+        if (read(m_wakeup, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+          LOGERR("SocketServer::Run wakeup read failed: %s", strerror(errno));
+        }
       }
       else
       {
-        LOGDBG("SocketServer::Open client connected");
-        m_clientSocket = clsock;
+        Client* client = nullptr;
+        bool connected = true;
+
+        // Clients are only added and removed on this thread, the lock guards against senders
+        {
+          std::lock_guard<std::mutex> guard(m_lock);
+          auto it = m_clients.find(fd);
+          if (it != m_clients.end())
+          {
+            client = it->second.get();
+            if (events[i].events & EPOLLOUT)
+            {
+              Flush(*client);
+            }
+          }
+        }
+
+        if (client == nullptr)
+          continue;
+
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+          connected = Receive(*client);
+        }
+
+        {
+          std::lock_guard<std::mutex> guard(m_lock);
+          connected = connected && !client->broken;
+        }
+
+        if (!connected)
+        {
+          Remove(fd);
+        }
       }
     }
 
-    if (m_clientSocket)
+    if (timeout >= 0)
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      FlushShared();
+    }
+
+    for (size_t i = 0; i < m_responseCount; i++)
     {
-      if (FD_ISSET(m_clientSocket, &m_readSet))
+      m_reader(m_responses[i]);
+    }
+    m_responsesDelivered += m_responseCount;
+    m_responseCount = 0;
+  }
+
+  // Give what is still queued, e.g. the exit command, a bounded last chance to go out
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    FlushShared();
+    for (auto& entry : m_clients)
+    {
+      Client& client = *entry.second;
+      if (!client.outbound.empty() && !client.broken)
       {
-        Response rsp;
-        int rc = ReadResponse(rsp);
-        if (rc >= 0)
-        {
-          m_reader(rsp);
-        }
-        else if (rc == CLIENT_DISCONNECT)
+        struct timeval tv = { 1, 0 };
+        fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL, 0) & ~O_NONBLOCK);
+        setsockopt(client.fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        Flush(client);
+      }
+    }
+  }
+
+  m_running = false;
+  return rc;
+}
+
+void SocketServer::Accept()
+{
+  for (;;)
+  {
+    int clsock = accept4(m_serverSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (clsock < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        LOGERR("SocketServer::Accept accept failed: %s", strerror(errno));
+      break;
+    }
+
+    // Frames are small and answered one by one, do not let Nagle hold them back
+    int one = 1;
+    setsockopt(clsock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = clsock;
+
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, clsock, &ev) < 0)
+    {
+      LOGERR("SocketServer::Accept epoll_ctl failed: %s", strerror(errno));
+      close(clsock);
+      continue;
+    }
+
+    std::unique_ptr<Client> client(new Client());
+    client->fd = clsock;
+    client->channels = 0;
+    client->outboundOffset = 0;
+    client->pending = 0;
+    client->broken = false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_clients[clsock] = std::move(client);
+    LOGDBG("SocketServer::Accept client %d connected, %zu clients", clsock, m_clients.size());
+  }
+}
+
+// Reads whatever the peer has sent into the shared receive buffer and consumes it from there
+bool SocketServer::Receive(Client& client)
+{
+  bool connected = true;
+
+  for (;;)
+  {
+    ssize_t num = recv(client.fd, m_receiveBuffer.data(), m_receiveBuffer.size(), 0);
+    m_receiveCalls++;
+
+    if (num > 0)
+    {
+      connected = Consume(client, m_receiveBuffer.data(), num);
+
+      if (!connected || (size_t)num < m_receiveBuffer.size())
+        break;
+    }
+    else if (num == 0)
+    {
+      connected = false;
+      break;
+    }
+    else if (errno == EINTR)
+    {
+      continue;
+    }
+    else
+    {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+      {
+        LOGERR("SocketServer::Receive client %d failed: %s", client.fd, strerror(errno));
+        connected = false;
+      }
+      break;
+    }
+  }
+
+  return connected;
+}
+
+// Whole responses are parsed straight into the reused response slots, only a trailing partial one
+// is kept in the client until the rest arrives
+bool SocketServer::Consume(Client& client, const char* data, size_t len)
+{
+  size_t consumed;
+  bool ok;
+
+  if (client.inbound.empty())
+  {
+    ok = Parse(client, data, len, consumed);
+    client.inbound.assign(data + consumed, len - consumed);
+  }
+  else
+  {
+    client.inbound.append(data, len);
+    ok = Parse(client, client.inbound.data(), client.inbound.length(), consumed);
+    client.inbound.erase(0, consumed);
+  }
+  return ok;
+}
+
+// Drains the response ring through the same parser as the sockets. At most one ring worth is
+// taken per wakeup, then the doorbell is rung for ourselves so the sockets get their turn too.
+void SocketServer::ReceiveShared()
+{
+  SharedRing& ring = m_shared.Responses();
+  size_t budget = ring.Size();
+  uint64_t count;
+
+  if (read(ring.Doorbell(), &count, sizeof(count)) < 0 && errno != EAGAIN)
+  {
+    LOGERR("SocketServer::ReceiveShared doorbell read failed: %s", strerror(errno));
+  }
+  m_receiveCalls++;
+
+  for (;;)
+  {
+    ssize_t num = ring.Read(m_receiveBuffer.data(), m_receiveBuffer.size());
+
+    if (num < 0)
+    {
+      DetachShared("response ring head is out of range", true);
+      return;
+    }
+    else if (num > 0)
+    {
+      if (!Consume(m_sharedPeer, m_receiveBuffer.data(), num))
+      {
+        DetachShared("response ring is out of sync", true);
+        return;
+      }
+
+      budget = ((size_t)num < budget ? budget - num : 0);
+      if (budget == 0)
+      {
+        uint64_t one = 1;
+        if (write(ring.Doorbell(), &one, sizeof(one)) < 0)
         {
-          LOGDBG("SocketServer::Open client disconnected");
-          close(m_clientSocket);
-          m_clientSocket = 0;
+          LOGERR("SocketServer::ReceiveShared doorbell write failed: %s", strerror(errno));
         }
+        break;
       }
     }
+    else if (ring.Idle())
+    {
+      break;
+    }
+  }
+
+  // The host is reading too, most likely there is room for what waits for the request ring
+  std::lock_guard<std::mutex> guard(m_lock);
+  FlushShared();
+}
+
+// Server thread only. The host broke the ring layout or exited: frames go back to the sockets.
+// Reading from the response ring stops as well if it can not be trusted anymore.
+void SocketServer::DetachShared(const char* reason, bool stopReading)
+{
+  if (stopReading)
+  {
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, m_shared.Responses().Doorbell(), nullptr);
+    m_sharedPeer.inbound.clear();
+  }
+
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (m_shared.Requests().Peer() != 0)
+  {
+    LOGERR("SocketServer::DetachShared %s, falling back to sockets", reason);
+    m_shared.Requests().Detach();
+  }
+  if (m_sharedPeer.pending > 0)
+  {
+    LOGERR("SocketServer::DetachShared dropping %zu queued bytes", m_sharedPeer.pending);
+  }
+  m_sharedPeer.outbound.clear();
+  m_sharedPeer.pending = 0;
+}
+
+bool SocketServer::Parse(Client& client, const char* data, size_t len, size_t& consumed)
+{
+  consumed = 0;
+
+  while (len - consumed >= sizeof(ResponseHeader))
+  {
+    ResponseHeader header;
+    memcpy(&header, data + consumed, sizeof(header));
+    header.json_len = ntohl(header.json_len);
+
+    if (header.json_len > MAX_RESPONSE_SIZE)
+    {
+      LOGERR("SocketServer::Parse client %d sent a %u byte response, dropping it", client.fd, header.json_len);
+      return false;
+    }
+
+    if (len - consumed - sizeof(header) < header.json_len)
+      break;
+
+    if (m_responseCount == m_responses.size())
+    {
+      m_responses.emplace_back();
+    }
+
+    Response& rsp = m_responses[m_responseCount++];
+    rsp.channel_id = ntohl(header.channel_id);
+    rsp.json.assign(data + consumed + sizeof(header), header.json_len);
+    consumed += sizeof(header) + header.json_len;
+  }
+
+  return true;
+}
+
+void SocketServer::Remove(int fd)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (auto it = m_channels.begin(); it != m_channels.end(); )
+    {
+      if (it->second == fd)
+        it = m_channels.erase(it);
+      else
+        ++it;
+    }
+    m_clients.erase(fd);
+    LOGDBG("SocketServer::Remove client %d disconnected, %zu clients", fd, m_clients.size());
+  }
+
+  epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+}
+
+void SocketServer::Wake()
+{
+  if (m_wakeup >= 0)
+  {
+    uint64_t one = 1;
+    if (write(m_wakeup, &one, sizeof(one)) < 0)
+    {
+      LOGERR("SocketServer::Wake failed: %s", strerror(errno));
+    }
   }
-  return 0;
 }
 
 string SocketServer::GetAddress() const
@@ -290,169 +661,433 @@ int SocketServer::GetPort() const
   return m_port; 
 }
 
+size_t SocketServer::GetClientCount() const
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_clients.size();
+}
+
+const SharedMemory& SocketServer::GetSharedMemory() const
+{
+  return m_shared;
+}
+
+// Called once the host holding the other end of the lifeline was spawned
+void SocketServer::ReleaseSharedLifeline()
+{
+  m_shared.ReleaseLifeline();
+}
+
+SocketServer::Statistics SocketServer::GetStatistics() const
+{
+  Statistics stats;
+  stats.frames = m_frames;
+  stats.send_calls = m_sendCalls;
+  stats.responses = m_responsesDelivered;
+  stats.receive_calls = m_receiveCalls;
+  return stats;
+}
+
 void SocketServer::Close()
 {
-  if (m_serverSocket > 0)
+  m_stop = true;
+  Wake();
+
+  if (m_threadStarted)
   {
-    if (m_running)
+    if (pthread_equal(pthread_self(), m_thread))
+      pthread_detach(m_thread);
+    else
+      pthread_join(m_thread, nullptr);
+    m_threadStarted = false;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (auto& entry : m_clients)
     {
-      m_running = false;
+      close(entry.first);
     }
-    close(m_clientSocket);
+    m_clients.clear();
+    m_channels.clear();
+    m_shared.Close();
+  }
+
+  if (m_serverSocket >= 0)
+  {
     close(m_serverSocket);
-    m_serverSocket = 0;
+    m_serverSocket = -1;
+  }
+  if (m_epoll >= 0)
+  {
+    close(m_epoll);
+    m_epoll = -1;
+  }
+  if (m_wakeup >= 0)
+  {
+    close(m_wakeup);
+    m_wakeup = -1;
   }
 }
 
-int SocketServer::ReadExact(uint8_t* p, int len)
+// Called with m_lock held
+SocketServer::Client* SocketServer::ClientFor(uint32_t channel_id, bool bind)
 {
-  if (m_serverSocket <= 0 || m_clientSocket <= 0)
+  auto it = m_channels.find(channel_id);
+  if (it != m_channels.end())
+  {
+    return m_clients[it->second].get();
+  }
+
+  Client* client = nullptr;
+
+  if (bind)
+  {
+    for (auto& entry : m_clients)
+    {
+      if (!entry.second->broken && (client == nullptr || entry.second->channels < client->channels))
+        client = entry.second.get();
+    }
+
+    if (client != nullptr)
+    {
+      m_channels[channel_id] = client->fd;
+      client->channels++;
+    }
+  }
+  return client;
+}
+
+// Called with m_lock held. A frame is sent with one sendmsg while nothing is queued for the peer.
+// What does not fit in the socket buffer, and every frame behind it, is appended to the queue and
+// sent by the server thread once the socket is writable again.
+int SocketServer::Send(Client& client, const struct iovec* iov, int iovcnt)
+{
+  size_t len = 0;
+  size_t sent = 0;
+
+  if (client.broken)
     return -1;
 
-  int remaining = len;
+  for (int i = 0; i < iovcnt; i++)
+    len += iov[i].iov_len;
+
+  m_frames++;
 
-  while (remaining > 0)
+  if (client.outbound.empty())
   {
-    int num = (int)read(m_clientSocket, p, remaining);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
 
-    if (num <= 0)
+    for (;;)
     {
-        LOGERR("SocketServer::ReadExact failed: num=%d", num);
+      ssize_t num = sendmsg(client.fd, &msg, MSG_NOSIGNAL);
+      m_sendCalls++;
 
-        if (num == 0)
-          return CLIENT_DISCONNECT;
+      if (num >= 0)
+      {
+        sent = num;
+        break;
+      }
+      else if (errno == EINTR)
+      {
+        continue;
+      }
+      else if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        break;
+      }
 
-        return -1;
+      LOGERR("SocketServer::Send client %d failed: %s", client.fd, strerror(errno));
+      client.broken = true;
+      Wake();
+      return -1;
     }
-    else
+  }
+
+  if (sent < len)
+  {
+    if (client.outbound.empty())
     {
-      p += num;
-      remaining -= num;
+      struct epoll_event ev;
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+      ev.data.fd = client.fd;
+      epoll_ctl(m_epoll, EPOLL_CTL_MOD, client.fd, &ev);
+    }
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+      const char* p = (const char*)iov[i].iov_base;
+      size_t part = iov[i].iov_len;
+
+      if (sent >= part)
+      {
+        sent -= part;
+        continue;
+      }
+      p += sent;
+      part -= sent;
+      sent = 0;
+
+      if (client.outbound.empty() || client.outbound.back().length() + part > CoalesceSize)
+        client.outbound.emplace_back(p, part);
+      else
+        client.outbound.back().append(p, part);
+      client.pending += part;
     }
   }
+  return 0;
+}
+
+// Called with m_lock held
+bool SocketServer::SharedAttached()
+{
+  return m_shared.Requests().Peer() != 0;
+}
+
+// Called with m_lock held. A frame goes straight into the ring while nothing waits for it. What
+// does not fit, and every frame behind it, is queued like for a socket and written by the server
+// thread as soon as the host made room.
+int SocketServer::SendShared(const struct iovec* iov, int iovcnt)
+{
+  SharedRing& ring = m_shared.Requests();
+  size_t len = 0;
+
+  for (int i = 0; i < iovcnt; i++)
+    len += iov[i].iov_len;
+
+  m_frames++;
 
-  if (remaining != 0)
+  if (m_sharedPeer.outbound.empty())
   {
-    LOGERR("SocketServer::ReadExact: failed: remaining=%d", remaining);
+    int rc = ring.Write(iov, iovcnt);
+
+    if (rc > 0)
+      m_sendCalls++;
+    if (rc >= 0)
+      return 0;
+  }
+
+  if (len > ring.Size() || m_sharedPeer.pending + len > MaxPending)
     return -1;
+
+  string frame;
+  frame.reserve(len);
+  for (int i = 0; i < iovcnt; i++)
+    frame.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+
+  if (m_sharedPeer.outbound.empty())
+    Wake();
+  m_sharedPeer.outbound.push_back(std::move(frame));
+  m_sharedPeer.pending += len;
+  return 0;
+}
+
+// Called with m_lock held. Writes queued frames in order until the ring is full again.
+void SocketServer::FlushShared()
+{
+  SharedRing& ring = m_shared.Requests();
+
+  while (!m_sharedPeer.outbound.empty())
+  {
+    const string& frame = m_sharedPeer.outbound.front();
+    struct iovec iov = { const_cast<char*>(frame.data()), frame.length() };
+    int rc = ring.Write(&iov, 1);
+
+    if (rc < 0)
+      break;
+    if (rc > 0)
+      m_sendCalls++;
+
+    m_sharedPeer.pending -= frame.length();
+    m_sharedPeer.outbound.pop_front();
   }
+}
+
+// Called with m_lock held. Sends the queue with one writev per MAX_IOV segments.
+void SocketServer::Flush(Client& client)
+{
+  while (!client.outbound.empty() && !client.broken)
+  {
+    struct iovec iov[MAX_IOV];
+    int iovcnt = 0;
+
+    for (auto it = client.outbound.begin(); it != client.outbound.end() && iovcnt < MAX_IOV; ++it, ++iovcnt)
+    {
+      size_t offset = (iovcnt == 0 ? client.outboundOffset : 0);
+      iov[iovcnt].iov_base = const_cast<char*>(it->data() + offset);
+      iov[iovcnt].iov_len = it->length() - offset;
+    }
 
-  return len;
+    ssize_t num = writev(client.fd, iov, iovcnt);
+    m_sendCalls++;
+
+    if (num > 0)
+    {
+      size_t sent = num;
+      client.pending -= sent;
+
+      while (sent > 0)
+      {
+        size_t left = client.outbound.front().length() - client.outboundOffset;
+        if (sent < left)
+        {
+          client.outboundOffset += sent;
+          break;
+        }
+        sent -= left;
+        client.outbound.pop_front();
+        client.outboundOffset = 0;
+      }
+    }
+    else if (num < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else if (num < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      return;
+    }
+    else
+    {
+      LOGERR("SocketServer::Flush client %d failed: %s", client.fd, strerror(errno));
+      client.broken = true;
+    }
+  }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.fd = client.fd;
+  epoll_ctl(m_epoll, EPOLL_CTL_MOD, client.fd, &ev);
 }
 
 int SocketServer::SendInvoke(uint32_t channel_id, const string& token, const string& json)
 {
-  if (m_serverSocket <= 0 || m_clientSocket <= 0)
-    return -1;
-  
   InvoketHeader header = {
     htonl(ID_INVOKE),
     htonl(channel_id),
     htonl((uint32_t)token.length()),
     htonl((uint32_t)json.length())
   };
+  struct iovec iov[3];
+  int iovcnt = 0;
 
-  int num = send(m_clientSocket, &header, sizeof(header), MSG_NOSIGNAL);
-  if (num != sizeof(header))
+  iov[iovcnt].iov_base = &header;
+  iov[iovcnt++].iov_len = sizeof(header);
+  if (token.length() > 0)
   {
-    LOGERR("SocketServer::SendInvoke failed to send header: num=%d", num);
-    return -1;
+    iov[iovcnt].iov_base = const_cast<char*>(token.data());
+    iov[iovcnt++].iov_len = token.length();
+  }
+  if (json.length() > 0)
+  {
+    iov[iovcnt].iov_base = const_cast<char*>(json.data());
+    iov[iovcnt++].iov_len = json.length();
   }
 
-  if (token.length() > 0)
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (SharedAttached())
   {
-    num = send(m_clientSocket, token.c_str(), token.length(), MSG_NOSIGNAL);
-    if (num != (ssize_t)token.length())
+    if (SendShared(iov, iovcnt) < 0)
     {
-      LOGERR("SocketServer::SendInvoke failed to send token: num=%d", num);
+      LOGERR("SocketServer::SendInvoke host is not reading the shared ring, dropping invoke on channel %u", channel_id);
       return -1;
     }
+    return 0;
   }
 
-  if (json.length() > 0)
+  Client* client = ClientFor(channel_id, true);
+
+  if (client == nullptr)
+    return -1;
+
+  if (client->pending + sizeof(InvoketHeader) + token.length() + json.length() > MaxPending)
   {
-    num = send(m_clientSocket, json.c_str(), json.length(), MSG_NOSIGNAL);
-    if (num != (ssize_t)json.length())
-    {
-      LOGERR("SocketServer::SendInvoke failed to send json: num=%d", num);
-      return -1;
-    }
+    LOGERR("SocketServer::SendInvoke client %d is not reading, dropping invoke on channel %u", client->fd, channel_id);
+    return -1;
+  }
+
+  if (Send(*client, iov, iovcnt) < 0)
+  {
+    LOGERR("SocketServer::SendInvoke failed to send on channel %u", channel_id);
+    return -1;
   }
   return 0;
 }
 
 int SocketServer::SendAttach(uint32_t channel_id, bool attach)
 {
-  if (m_serverSocket <= 0 || m_clientSocket <= 0)
-    return -1;
-
   AttachHeader header = {
     htonl(ID_ATTACH),
     htonl(channel_id),
     attach ? (uint8_t)1 : (uint8_t)0
   };
+  struct iovec iov = { &header, sizeof(header) };
 
-  int num = send(m_clientSocket, &header, sizeof(header), MSG_NOSIGNAL);
-  if (num != sizeof(header))
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (SharedAttached())
   {
-    LOGERR("SocketServer::SendAttach failed to send header: num=%d", num);
-    return -1;
+    int rc = SendShared(&iov, 1);
+    if (rc < 0)
+    {
+      LOGERR("SocketServer::SendAttach host is not reading the shared ring, dropping attach on channel %u", channel_id);
+    }
+    return rc;
   }
-  return 0;
-}
 
-int SocketServer::SendExit()
-{
-  if (m_serverSocket <= 0 || m_clientSocket <= 0)
+  Client* client = ClientFor(channel_id, attach);
+
+  if (client == nullptr)
     return -1;
 
-  uint32_t command_id = htonl(ID_EXIT);
-  int num = send(m_clientSocket, &command_id, sizeof(command_id), MSG_NOSIGNAL);
-  if (num != sizeof(command_id))
+  int rc = Send(*client, &iov, 1);
+  if (rc < 0)
   {
-    LOGERR("SocketServer::SendExit failed: num=%d", num);
-    return -1;
+    LOGERR("SocketServer::SendAttach failed to send header");
   }
 
-  /*break out of reader thread*/
-  m_running = false;
-
-  return 0;
+  if (!attach)
+  {
+    m_channels.erase(channel_id);
+    client->channels--;
+  }
+  return rc;
 }
 
-int SocketServer::ReadResponse(Response& rsp)
+int SocketServer::SendExit()
 {
-  if (m_serverSocket <= 0 || m_clientSocket <= 0)
-    return -1;
-
-  ResponseHeader header;
-  int rc;
-
-  if ((rc = ReadExact((uint8_t*)&header, (int)sizeof(ResponseHeader))) <= 0)
   {
-    return rc;
-  }
+    std::lock_guard<std::mutex> guard(m_lock);
+    bool shared = SharedAttached();
 
-  rsp.channel_id = ntohl(header.channel_id);
-  header.json_len = ntohl(header.json_len);
-
-  LOGDBG("SocketServer::ReadResponse read header: channel_id=%u, json_len=%u", 
-    rsp.channel_id, header.json_len);
+    if (m_clients.empty() && !shared)
+      return -1;
 
-  if (header.json_len > 0)
-  {
-    uint8_t* buffer;
-    buffer = (uint8_t*)malloc(header.json_len+1);
+    uint32_t command_id = htonl(ID_EXIT);
+    struct iovec iov = { &command_id, sizeof(command_id) };
 
-    if ((rc = ReadExact(buffer, (int)header.json_len)) <= 0)
+    if (shared && SendShared(&iov, 1) < 0)
+    {
+      LOGERR("SocketServer::SendExit failed for the shared ring");
+    }
+    for (auto& entry : m_clients)
     {
-      free(buffer);
-      return rc;
+      if (Send(*entry.second, &iov, 1) < 0)
+      {
+        LOGERR("SocketServer::SendExit failed for client %d", entry.first);
+      }
     }
-    
-    buffer[header.json_len] = 0;
-    rsp.json = (char*)buffer;
-    free(buffer);
   }
+
+  /*break out of reader thread*/
+  m_stop = true;
+  Wake();
+
   return 0;
 }
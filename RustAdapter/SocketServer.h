@@ -20,7 +20,15 @@
 
 #include <string>
 #include <functional>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <pthread.h>
+#include <sys/uio.h>
+#include "SharedRing.h"
 
 using std::string;
 using std::function;
@@ -34,29 +42,98 @@ struct Response
   Response(uint32_t channel, const string& json_str);
 };
 
+// Serves any number of Rust peers from one epoll loop. Every channel is bound to one peer, the
+// one with the fewest channels at the time the channel is first used, and stays there until the
+// peer disconnects. Sockets are non-blocking and what a peer can not take right away is queued
+// for it, up to MaxPending bytes, so a slow peer never stalls the others.
+//
+// A frame goes out with a single sendmsg. Frames queued for a peer are packed into segments of
+// up to CoalesceSize bytes and flushed together with one writev per wakeup.
+//
+// With OpenSharedMemory a WPEHost on the same box can take its frames from a shared memory ring
+// pair instead. As soon as it attached to the request ring every frame goes there, the sockets
+// stay as the fallback for hosts that do not map the rings, or when the attached one exits or
+// breaks the ring layout. What does not fit in a full request ring is queued like for a socket,
+// up to MaxPending bytes, and retried every SharedRetryMs until the host made room.
 class SocketServer
 {
 public:
+  static const size_t MaxPending = 4 * 1024 * 1024;
+  static const size_t CoalesceSize = 64 * 1024;
+  static const int SharedRetryMs = 5;
+
+  struct Statistics
+  {
+    uint64_t frames;        // frames handed to Send*
+    uint64_t send_calls;    // sendmsg/writev calls, or doorbells rung, made for them
+    uint64_t responses;     // responses delivered to the reader
+    uint64_t receive_calls; // recv calls, or doorbells taken, made for them
+  };
+
   SocketServer();
   ~SocketServer();
   int Open(const string& address, int port, const function<void (const Response&)>& reader);
+  int OpenSharedMemory(uint32_t size);
   int RunThread();
   int Run();
   void Close();
   string GetAddress() const;
   int GetPort() const;
+  size_t GetClientCount() const;
+  Statistics GetStatistics() const;
+  const SharedMemory& GetSharedMemory() const;
+  void ReleaseSharedLifeline();
   int SendInvoke(uint32_t channel_id, const string& token, const string& json);
   int SendAttach(uint32_t channel_id, bool attach);
   int SendExit();
-  int ReadResponse(Response& cmd);
 private:
-  int ReadExact(uint8_t* p, int len);
+  struct Client
+  {
+    int fd;
+    uint32_t channels;
+    string inbound;                // received bytes not yet forming a whole response
+    std::deque<string> outbound;   // segments still to be sent, the first one from outboundOffset
+    size_t outboundOffset;
+    size_t pending;
+    bool broken;
+  };
+
+  Client* ClientFor(uint32_t channel_id, bool bind);
+  int Send(Client& client, const struct iovec* iov, int iovcnt);
+  void Flush(Client& client);
+  void Accept();
+  bool Receive(Client& client);
+  bool Consume(Client& client, const char* data, size_t len);
+  bool SharedAttached();
+  int SendShared(const struct iovec* iov, int iovcnt);
+  void FlushShared();
+  void ReceiveShared();
+  void DetachShared(const char* reason, bool stopReading);
+  bool Parse(Client& client, const char* data, size_t len, size_t& consumed);
+  void Remove(int fd);
+  void Wake();
   static void* RunThreadFunc(void* arg);
 
   int m_serverSocket;
-  int m_clientSocket;  
+  int m_epoll;
+  int m_wakeup;
+  mutable std::mutex m_lock;
+  std::unordered_map<int, std::unique_ptr<Client>> m_clients;
+  std::unordered_map<uint32_t, int> m_channels;
+  SharedMemory m_shared;
+  Client m_sharedPeer;                // partial response carried over between ring reads, and
+                                      // request frames waiting for room in the ring
   function<void (const Response&)> m_reader;
-  bool m_running;
+  std::vector<char> m_receiveBuffer;  // server thread only, reused for every recv
+  std::vector<Response> m_responses;  // server thread only, json capacity is kept between batches
+  size_t m_responseCount;
+  std::atomic<uint64_t> m_frames;
+  std::atomic<uint64_t> m_sendCalls;
+  std::atomic<uint64_t> m_responsesDelivered;
+  std::atomic<uint64_t> m_receiveCalls;
+  std::atomic<bool> m_running;
+  std::atomic<bool> m_stop;
+  bool m_threadStarted;
   pthread_t m_thread;
   string m_address;
   int m_port;
@@ -0,0 +1,364 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2022 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Request/response throughput of SocketServer over loopback with several Rust peers connected,
+// or with one peer on the shared memory ring pair.
+//
+//   RustAdapterSocketBenchmark [-c clients] [-n channels] [-r requests per channel] [-s payload bytes] [-w window] [-m ring bytes]
+//
+// Each peer is a thread that answers every invoke with its own payload. Each channel is driven by
+// a thread that keeps up to window requests outstanding, so channels run concurrently across the
+// peers. A large window floods the peers the way a burst of events does, and shows how well
+// frames are coalesced. Syscalls per message are counted by the server itself.
+//
+// With -m the one peer maps the rings like WPEHost does and the sockets stay idle. With a window
+// of 1 every request is timed, "-n 1 -w 1" with and without -m compares round trip latencies.
+
+#include "../SocketServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    bool ReadExact(int fd, void* data, size_t len)
+    {
+        char* p = static_cast<char*>(data);
+        while (len > 0) {
+            ssize_t num = ::read(fd, p, len);
+            if (num <= 0) {
+                return (false);
+            }
+            p += num;
+            len -= num;
+        }
+        return (true);
+    }
+
+    bool WriteExact(int fd, const void* data, size_t len)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (len > 0) {
+            ssize_t num = ::send(fd, p, len, MSG_NOSIGNAL);
+            if (num <= 0) {
+                return (false);
+            }
+            p += num;
+            len -= num;
+        }
+        return (true);
+    }
+
+    // Speaks the WPEHost side of the protocol: invoke and attach in, responses out, until exit
+    void Peer(const int port)
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        int one = 1;
+
+        ::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::perror("connect");
+            ::close(fd);
+            return;
+        }
+
+        std::string buffer;
+        uint32_t command;
+
+        while (ReadExact(fd, &command, sizeof(command)) == true) {
+            command = ntohl(command);
+            if (command == 1) {
+                uint32_t header[3];
+                if (ReadExact(fd, header, sizeof(header)) == false) {
+                    break;
+                }
+                const uint32_t channel = ntohl(header[0]);
+                const size_t length = ntohl(header[1]) + ntohl(header[2]);
+                buffer.resize(8 + length);
+                if ((length > 0) && (ReadExact(fd, &buffer[8], length) == false)) {
+                    break;
+                }
+                // Echo token and payload back as the response body
+                const uint32_t response[2] = { htonl(channel), htonl(static_cast<uint32_t>(length)) };
+                ::memcpy(&buffer[0], response, sizeof(response));
+                if (WriteExact(fd, buffer.data(), buffer.length()) == false) {
+                    break;
+                }
+            } else if (command == 2) {
+                uint8_t attach[5];
+                if (ReadExact(fd, attach, sizeof(attach)) == false) {
+                    break;
+                }
+            } else {
+                break;
+            }
+        }
+        ::close(fd);
+    }
+
+    // The same protocol over the ring pair: requests are consumed, responses produced, and the
+    // doorbell is only waited on once the request ring is drained
+    void SharedPeer(const SharedMemory& server)
+    {
+        SharedMemory shared;
+
+        if (shared.Map(server.GetFd(), server.GetSize(), server.Requests().Doorbell(), server.Responses().Doorbell()) != 0) {
+            ::perror("map");
+            return;
+        }
+
+        SharedRing& requests = shared.Requests();
+        SharedRing& responses = shared.Responses();
+        std::vector<char> chunk(64 * 1024);
+        std::string buffer;
+        size_t offset = 0;
+        bool running = true;
+
+        requests.Attach(static_cast<uint32_t>(::getpid()));
+
+        while (running == true) {
+            const ssize_t num = requests.Read(chunk.data(), chunk.size());
+
+            if (num < 0) {
+                ::fprintf(stderr, "request ring is out of range\n");
+                break;
+            }
+            if (num == 0) {
+                if (requests.Idle() == true) {
+                    struct pollfd bell = { requests.Doorbell(), POLLIN, 0 };
+                    uint64_t count;
+                    ::poll(&bell, 1, -1);
+                    if (::read(requests.Doorbell(), &count, sizeof(count)) < 0) {
+                        // Only the wakeup matters
+                    }
+                }
+                continue;
+            }
+
+            buffer.erase(0, offset);
+            buffer.append(chunk.data(), num);
+            offset = 0;
+
+            while ((running == true) && (buffer.length() - offset >= sizeof(uint32_t))) {
+                uint32_t command;
+                ::memcpy(&command, &buffer[offset], sizeof(command));
+                command = ntohl(command);
+
+                if (command == 1) {
+                    uint32_t header[4];
+                    if (buffer.length() - offset < sizeof(header)) {
+                        break;
+                    }
+                    ::memcpy(header, &buffer[offset], sizeof(header));
+                    const size_t length = ntohl(header[2]) + ntohl(header[3]);
+                    if (buffer.length() - offset < sizeof(header) + length) {
+                        break;
+                    }
+                    const uint32_t response[2] = { header[1], htonl(static_cast<uint32_t>(length)) };
+                    const struct iovec iov[2] = { { const_cast<uint32_t*>(response), sizeof(response) }, { &buffer[offset + sizeof(header)], length } };
+                    while (responses.Write(iov, 2) < 0) {
+                        std::this_thread::yield();
+                    }
+                    offset += sizeof(header) + length;
+                } else if (command == 2) {
+                    if (buffer.length() - offset < 9) {
+                        break;
+                    }
+                    offset += 9;
+                } else {
+                    running = false;
+                }
+            }
+        }
+
+        requests.Detach();
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t clients = 4;
+    uint32_t channels = 16;
+    uint32_t requests = 10000;
+    uint32_t payload = 256;
+    uint32_t window = 1;
+    uint32_t ring = 0;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "c:n:r:s:w:m:")) != -1) {
+        switch (option) {
+        case 'c': clients = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'n': channels = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'r': requests = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 's': payload = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'w': window = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'm': ring = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        default:
+            ::fprintf(stderr, "usage: %s [-c clients] [-n channels] [-r requests per channel] [-s payload bytes] [-w window] [-m ring bytes]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if ((clients == 0) || (channels == 0) || (window == 0)) {
+        ::fprintf(stderr, "clients, channels and window must be at least 1\n");
+        return (1);
+    }
+
+    std::vector<sem_t> answered(channels + 1);
+    for (sem_t& semaphore : answered) {
+        ::sem_init(&semaphore, 0, 0);
+    }
+
+    SocketServer server;
+    if (server.Open("127.0.0.1", 0, [&answered](const Response& response) {
+            if (response.channel_id < answered.size()) {
+                ::sem_post(&answered[response.channel_id]);
+            }
+        }) != 0) {
+        return (1);
+    }
+    if ((ring != 0) && (server.OpenSharedMemory(ring) != 0)) {
+        return (1);
+    }
+    server.RunThread();
+
+    std::vector<std::thread> peers;
+    if (ring != 0) {
+        clients = 1;
+        peers.emplace_back(SharedPeer, std::cref(server.GetSharedMemory()));
+        while (server.GetSharedMemory().Requests().Peer() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } else {
+        for (uint32_t index = 0; index < clients; index++) {
+            peers.emplace_back(Peer, server.GetPort());
+        }
+        while (server.GetClientCount() < clients) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    const std::string token("benchmark-token");
+    const std::string json(std::string("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"echo\",\"params\":\"") + std::string(payload, 'x') + "\"}");
+    std::vector<std::thread> senders;
+    std::vector<uint32_t> failures(channels + 1, 0);
+    std::vector<std::vector<double>> latencies(channels + 1);
+
+    const SocketServer::Statistics before = server.GetStatistics();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t channel = 1; channel <= channels; channel++) {
+        senders.emplace_back([&, channel]() {
+            uint32_t outstanding = 0;
+            server.SendAttach(channel, true);
+            if (window == 1) {
+                latencies[channel].reserve(requests);
+            }
+            for (uint32_t count = 0; count < requests; count++) {
+                if (outstanding == window) {
+                    ::sem_wait(&answered[channel]);
+                    outstanding--;
+                }
+                const auto sent = std::chrono::steady_clock::now();
+                if (server.SendInvoke(channel, token, json) != 0) {
+                    failures[channel]++;
+                    continue;
+                }
+                outstanding++;
+                if (window == 1) {
+                    ::sem_wait(&answered[channel]);
+                    outstanding--;
+                    latencies[channel].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+                }
+            }
+            while (outstanding-- > 0) {
+                ::sem_wait(&answered[channel]);
+            }
+        });
+    }
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const SocketServer::Statistics after = server.GetStatistics();
+    uint64_t failed = 0;
+    for (uint32_t count : failures) {
+        failed += count;
+    }
+    const uint64_t total = (static_cast<uint64_t>(channels) * requests) - failed;
+
+    server.SendExit();
+    for (std::thread& peer : peers) {
+        peer.join();
+    }
+    server.Close();
+
+    const uint64_t frames = after.frames - before.frames;
+    const uint64_t responses = after.responses - before.responses;
+
+    ::printf("%s, clients %u, channels %u, requests per channel %u, window %u, payload %zu bytes\n",
+        (ring != 0 ? "shared memory" : "socket"), clients, channels, requests, window, json.length());
+    ::printf("  %llu round trips in %.3f s: %.0f requests/s, %.1f us per round trip per channel\n",
+        static_cast<unsigned long long>(total), seconds, total / seconds, (seconds * 1e6 * channels) / (total != 0 ? total : 1));
+    ::printf("  %.3f send syscalls per frame, %.3f receive syscalls per response\n",
+        static_cast<double>(after.send_calls - before.send_calls) / (frames != 0 ? frames : 1),
+        static_cast<double>(after.receive_calls - before.receive_calls) / (responses != 0 ? responses : 1));
+    if (window == 1) {
+        std::vector<double> all;
+        for (const std::vector<double>& samples : latencies) {
+            all.insert(all.end(), samples.begin(), samples.end());
+        }
+        if (all.empty() == false) {
+            std::sort(all.begin(), all.end());
+            ::printf("  round trip latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+                all[all.size() / 2], all[(all.size() * 99) / 100], all.back());
+        }
+    }
+    if (failed != 0) {
+        ::printf("  %llu invokes failed\n", static_cast<unsigned long long>(failed));
+    }
+
+    for (sem_t& semaphore : answered) {
+        ::sem_destroy(&semaphore);
+    }
+
+    return (failed == 0 ? 0 : 2);
+}
@@ -0,0 +1,104 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2025 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+// Loads the default report profiles file in one mapping and escapes it for the RFC string
+// parameter. Kept free of framework dependencies so tools/ProfileBenchmark builds standalone.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class ProfileLoader {
+    public:
+        enum Result {
+            LOADED,
+            OPEN_FAILED,
+            EMPTY,
+            READ_FAILED
+        };
+
+    public:
+        ProfileLoader() = delete;
+        ProfileLoader(const ProfileLoader&) = delete;
+        ProfileLoader& operator=(const ProfileLoader&) = delete;
+
+        // escaped receives the file with every '"' turned into '\"'
+        static Result Load(const std::string& path, std::string& escaped)
+        {
+            Result result = OPEN_FAILED;
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+            if (fd >= 0) {
+                struct stat info;
+
+                if (::fstat(fd, &info) != 0) {
+                    result = READ_FAILED;
+                } else if (info.st_size == 0) {
+                    result = EMPTY;
+                } else {
+                    const size_t length = static_cast<size_t>(info.st_size);
+                    void* data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                    if (data == MAP_FAILED) {
+                        result = READ_FAILED;
+                    } else {
+                        Escape(static_cast<const char*>(data), length, escaped);
+                        result = LOADED;
+                        ::munmap(data, length);
+                    }
+                }
+                ::close(fd);
+            }
+
+            return (result);
+        }
+
+        // Copies the runs between quotes in bulk, sized up front so the string is allocated once
+        static void Escape(const char data[], const size_t length, std::string& escaped)
+        {
+            const char* const end = data + length;
+            size_t quotes = 0;
+
+            for (const char* quote = data; (quote = static_cast<const char*>(::memchr(quote, '"', end - quote))) != nullptr; quote++) {
+                quotes++;
+            }
+
+            escaped.clear();
+            escaped.reserve(length + quotes);
+
+            const char* run = data;
+            for (const char* quote; (quote = static_cast<const char*>(::memchr(run, '"', end - run))) != nullptr; run = quote + 1) {
+                escaped.append(run, quote - run).append("\\\"", 2);
+            }
+            escaped.append(run, end - run);
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
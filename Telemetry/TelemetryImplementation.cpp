@@ -18,6 +18,7 @@
 **/
 
 #include "TelemetryImplementation.h"
+#include "ProfileLoader.h"
 
 #include "UtilsJsonRpc.h"
 #include "UtilsTelemetry.h"
@@ -25,12 +26,15 @@
 
 #include "rfcapi.h"
 
+#include <inttypes.h>
+
 #ifdef HAS_RBUS
 #include "rbus.h"
 
 #define RBUS_COMPONENT_NAME "TelemetryThunderPlugin"
 #define T2_ON_DEMAND_REPORT "Device.X_RDKCENTRAL-COM_T2.UploadDCMReport"
 #define T2_ABORT_ON_DEMAND_REPORT "Device.X_RDKCENTRAL-COM_T2.AbortDCMReport"
+#define RBUS_REOPEN_INTERVAL_MS 1000
 #endif
 
 #define RFC_CALLERID "Telemetry"
@@ -41,6 +45,9 @@
 
 #define USERSETTINGS_CALLSIGN "org.rdk.UserSettings"
 
+#define MARKER_QUEUE_SIZE 256
+#define MARKER_BATCH_SIZE 32
+
 #define API_VERSION_NUMBER_MAJOR 1
 #define API_VERSION_NUMBER_MINOR 2
 #define API_VERSION_NUMBER_PATCH 2
@@ -48,15 +55,107 @@
 #ifdef HAS_RBUS
 #define RBUS_PRIVACY_MODE_EVENT_NAME "Device.X_RDKCENTRAL-COM_Privacy.PrivacyMode"
 
-static rbusError_t rbusHandleStatus = RBUS_ERROR_NOT_INITIALIZED;
-static rbusHandle_t rbusHandle;
-
 #endif
 using PowerState = WPEFramework::Exchange::IPowerManager::PowerState;
 
 namespace WPEFramework {
 namespace Plugin {
 
+#ifdef HAS_RBUS
+    // One rbus connection for the lifetime of the plugin, opened on first use instead of per
+    // request. A failed open is not retried before RBUS_REOPEN_INTERVAL_MS has passed, and a
+    // call failing with a bus error drops the handle so the next call reconnects.
+    class RBusConnection {
+    public:
+        RBusConnection(const RBusConnection&) = delete;
+        RBusConnection& operator=(const RBusConnection&) = delete;
+
+        RBusConnection()
+            : _lock()
+            , _handle()
+            , _status(RBUS_ERROR_NOT_INITIALIZED)
+            , _reopenTime(0)
+            , _opened(0)
+        {
+        }
+        ~RBusConnection() = default;
+
+    public:
+        // Runs call on the open handle, rc receives its result. Returns the status of the connection.
+        rbusError_t Call(const std::function<int(rbusHandle_t)>& call, int& rc)
+        {
+            _lock.Lock();
+
+            if (RBUS_ERROR_SUCCESS != _status)
+            {
+                const uint64_t now = Core::Time::Now().Ticks();
+
+                if (now >= _reopenTime)
+                {
+                    _status = rbus_open(&_handle, RBUS_COMPONENT_NAME);
+
+                    if (RBUS_ERROR_SUCCESS == _status)
+                    {
+                        if (++_opened > 1)
+                        {
+                            LOGINFO("rbus connection reopened (%u)", _opened);
+                        }
+                    }
+                    else
+                    {
+                        _reopenTime = now + (RBUS_REOPEN_INTERVAL_MS * Core::Time::TicksPerMillisecond);
+                    }
+                }
+            }
+
+            const rbusError_t status = _status;
+
+            if (RBUS_ERROR_SUCCESS == status)
+            {
+                rc = call(_handle);
+
+                if (RBUS_ERROR_BUS_ERROR == rc)
+                {
+                    LOGWARN("rbus call failed with a bus error, dropping the connection");
+                    Drop();
+                }
+            }
+
+            _lock.Unlock();
+
+            return status;
+        }
+
+        void Close()
+        {
+            _lock.Lock();
+            Drop();
+            _reopenTime = 0;
+            _opened = 0;
+            _lock.Unlock();
+        }
+
+    private:
+        void Drop()
+        {
+            if (RBUS_ERROR_SUCCESS == _status)
+            {
+                rbus_close(_handle);
+            }
+            _status = RBUS_ERROR_NOT_INITIALIZED;
+        }
+
+    private:
+        Core::CriticalSection _lock;
+        rbusHandle_t _handle;
+        rbusError_t _status;
+        uint64_t _reopenTime;
+        uint32_t _opened;
+    };
+
+    static RBusConnection rbusConnection;
+#endif
+
     SERVICE_REGISTRATION(TelemetryImplementation, 1, 0);
     TelemetryImplementation* TelemetryImplementation::_instance = nullptr;
     
@@ -69,6 +168,12 @@ namespace Plugin {
     , _userSettingsNotification(*this)
 #endif
     , _registeredEventHandlers(false)
+    , _markerLock()
+    , _markers()
+    , _publishing(false)
+    , _markerQueueSize(MARKER_QUEUE_SIZE)
+    , _markerBatchSize(MARKER_BATCH_SIZE)
+    , _markerStatistics()
     {
         LOGINFO("Create TelemetryImplementation Instance");
         TelemetryImplementation::_instance = this;
@@ -86,13 +191,16 @@ namespace Plugin {
             LOGINFO("Call TelemetryImplementation destructor\n");
             _registeredEventHandlers = false;
 
+            // A publishing job holds a reference, so nothing can be left in flight here
+            MarkerStatistics statistics;
+            markerStatistics(statistics);
+            LOGINFO("Markers sent: %u, dropped: %u, batches: %u, max latency: %" PRIu64 "us",
+                statistics.Sent, statistics.Dropped, statistics.Batches, statistics.MaxLatency);
+
             TelemetryImplementation::_instance = nullptr;
             _service = nullptr;
 #ifdef HAS_RBUS
-            if (RBUS_ERROR_SUCCESS == rbusHandleStatus) {
-                rbus_close(rbusHandle);
-                rbusHandleStatus = RBUS_ERROR_NOT_INITIALIZED;
-            }
+            rbusConnection.Close();
 
             if (_userSettingsPlugin) {
                  _userSettingsPlugin->Unregister(&_userSettingsNotification);
@@ -225,30 +333,29 @@ namespace Plugin {
     void TelemetryImplementation::notifyT2PrivacyMode(std::string privacyMode)
     {
         LOGINFO("Privacy mode is %s", privacyMode.c_str());
-        if (RBUS_ERROR_SUCCESS != rbusHandleStatus)
-        {
-            rbusHandleStatus = rbus_open(&rbusHandle, RBUS_COMPONENT_NAME);
-        }
 
-        if (RBUS_ERROR_SUCCESS == rbusHandleStatus)
-        {
+        int rc = RBUS_ERROR_SUCCESS;
+        rbusError_t status = rbusConnection.Call([&privacyMode](rbusHandle_t handle) {
             rbusValue_t value;
             rbusSetOptions_t opts = {true, 0};
 
             rbusValue_Init(&value);
             rbusValue_SetString(value, privacyMode.c_str());
-            int rc = rbus_set(rbusHandle, RBUS_PRIVACY_MODE_EVENT_NAME, value, &opts);
-            if (rc != RBUS_ERROR_SUCCESS)
-            {
-                std::stringstream str;
-                str << "Failed to set property " << RBUS_PRIVACY_MODE_EVENT_NAME << ": " << rc;
-                LOGERR("%s", str.str().c_str());
-            }
+            int result = rbus_set(handle, RBUS_PRIVACY_MODE_EVENT_NAME, value, &opts);
             rbusValue_Release(value);
+
+            return result;
+        }, rc);
+
+        if (RBUS_ERROR_SUCCESS != status)
+        {
+            LOGERR("rbus_open failed with error code %d", status);
         }
-        else
+        else if (RBUS_ERROR_SUCCESS != rc)
         {
-            LOGERR("rbus_open failed with error code %d", rbusHandleStatus);
+            std::stringstream str;
+            str << "Failed to set property " << RBUS_PRIVACY_MODE_EVENT_NAME << ": " << rc;
+            LOGERR("%s", str.str().c_str());
         }
     }
     
@@ -285,50 +392,30 @@ namespace Plugin {
 
         if (isEMpty)
         {
-            Core::File file;
             std::string defaultProfilesFile = config.HasLabel("defaultProfilesFile") ? config["defaultProfilesFile"].String() : DEFAULT_PROFILES_FILE;
-            file = defaultProfilesFile.c_str();
-            file.Open();
-            if (file.IsOpen())
+            std::string profiles;
+
+            // T2 has no profiles persisted, so they are published every time, even if unchanged
+            switch (ProfileLoader::Load(defaultProfilesFile, profiles))
             {
-                if (file.Size() > 0)
+                case ProfileLoader::LOADED:
                 {
-                    std::vector <char> defaultProfile;
-                    defaultProfile.resize(file.Size() + 1);
-                    uint32_t rs = file.Read((uint8_t *)defaultProfile.data(), file.Size());
-                    defaultProfile.data()[rs] = 0;
-                    if (file.Size() == rs)
+                    WDMP_STATUS wdmpStatus = setRFCParameter((char *)RFC_CALLERID, RFC_REPORT_PROFILES, profiles.c_str(), WDMP_STRING);
+                    if (WDMP_SUCCESS != wdmpStatus)
                     {
-
-                        std::stringstream ss;
-                        // Escaping quotes
-                        for (uint32_t n = 0; n < rs; n++)
-                        {
-                            char ch = defaultProfile.data()[n];
-                            if ('\"' == ch)
-                                ss << "\\";
-                            ss << ch;
-                        }
-
-                        WDMP_STATUS wdmpStatus = setRFCParameter((char *)RFC_CALLERID, RFC_REPORT_PROFILES, ss.str().c_str(), WDMP_STRING);
-                        if (WDMP_SUCCESS != wdmpStatus)
-                        {
-                            LOGERR("Failed to set Device.X_RDKCENTRAL-COM_T2.ReportProfiles: %d", wdmpStatus);
-                        }
-                    }
-                    else
-                    {
-                        LOGERR("Got wrong number of bytes, %d instead of %d", rs, (int)file.Size());
+                        LOGERR("Failed to set Device.X_RDKCENTRAL-COM_T2.ReportProfiles: %d", wdmpStatus);
                     }
+                    break;
                 }
-                else
-                {
+                case ProfileLoader::EMPTY:
                     LOGERR("%s is 0 size", defaultProfilesFile.c_str());
-                }
-            }
-            else
-            {
-                LOGERR("Failed to open %s", defaultProfilesFile.c_str());
+                    break;
+                case ProfileLoader::READ_FAILED:
+                    LOGERR("Failed to read %s", defaultProfilesFile.c_str());
+                    break;
+                default:
+                    LOGERR("Failed to open %s", defaultProfilesFile.c_str());
+                    break;
             }
         }
     }
@@ -339,6 +426,18 @@ namespace Plugin {
         ASSERT(service != nullptr);
         _service = service;
         _service->AddRef();
+
+        JsonObject config;
+        config.FromString(_service->ConfigLine());
+        if (config.HasLabel("markerQueueSize") && (config["markerQueueSize"].Number() > 0))
+        {
+            _markerQueueSize = static_cast<uint32_t>(config["markerQueueSize"].Number());
+        }
+        if (config.HasLabel("markerBatchSize") && (config["markerBatchSize"].Number() > 0))
+        {
+            _markerBatchSize = static_cast<uint32_t>(config["markerBatchSize"].Number());
+        }
+
         InitializePowerManager();
 
 #ifdef HAS_RBUS        
@@ -412,6 +511,10 @@ namespace Plugin {
                 TelemetryImplementation::_instance->AbortReport();
                 break;
 
+            case TELEMETRY_EVENT_PUBLISHMARKERS:
+                publishMarkers();
+                break;
+
             case TELEMETRY_EVENT_ONREPORTUPLOAD:
                 while (index != _telemetryNotification.end())
                 {
@@ -462,38 +565,121 @@ namespace Plugin {
         }
         
         LOGINFO("eventName:%s, eventValue:%s", eventName.c_str(), eventValue.c_str());
-        Utils::Telemetry::sendMessage((char *)eventName.c_str(), (char *)eventValue.c_str());
+
+        _markerLock.Lock();
+
+        if (_markers.size() >= _markerQueueSize)
+        {
+            // Keep the most recent markers, report the first drop of every burst
+            _markers.pop_front();
+            if (_markerStatistics.Dropped++ == _markerStatistics.Reported)
+            {
+                LOGWARN("Marker queue full (%u), dropping the oldest marker", _markerQueueSize);
+            }
+        }
+        else if (_markerStatistics.Reported != _markerStatistics.Dropped)
+        {
+            // End of a burst, say how bad it was while it still matters
+            LOGWARN("Marker queue accepting again, markers sent: %u, dropped: %u (%u in this burst), max latency: %" PRIu64 "us",
+                _markerStatistics.Sent, _markerStatistics.Dropped, _markerStatistics.Dropped - _markerStatistics.Reported, _markerStatistics.MaxLatency);
+            _markerStatistics.Reported = _markerStatistics.Dropped;
+        }
+
+        _markers.emplace_back(eventName, eventValue, Core::Time::Now().Ticks());
+
+        const bool publish = (_publishing == false);
+        _publishing = true;
+
+        _markerLock.Unlock();
+
+        // With nobody publishing the marker goes out right away on this thread. Markers logged
+        // while a batch is being sent pile up and leave together in the next one.
+        if (publish == true)
+        {
+            publishMarkers();
+        }
+
         return Core::ERROR_NONE;  
     }
-    
-    Core::hresult TelemetryImplementation::UploadReport()
+
+    void TelemetryImplementation::publishMarkers()
     {
-        LOGINFO("");
-#ifdef HAS_RBUS
-        if (RBUS_ERROR_SUCCESS != rbusHandleStatus)
+        std::vector<Marker> batch;
+
+        _markerLock.Lock();
+        const uint32_t count = std::min(static_cast<uint32_t>(_markers.size()), _markerBatchSize);
+        batch.reserve(count);
+        for (uint32_t index = 0; index < count; index++)
         {
-            rbusHandleStatus = rbus_open(&rbusHandle, RBUS_COMPONENT_NAME);
+            batch.push_back(std::move(_markers.front()));
+            _markers.pop_front();
         }
+        _markerLock.Unlock();
 
-        if (RBUS_ERROR_SUCCESS == rbusHandleStatus)
+        for (Marker& marker : batch)
         {
-            int rc = rbusMethod_InvokeAsync(rbusHandle, T2_ON_DEMAND_REPORT, NULL, t2EventHandler, 0);
-            if (RBUS_ERROR_SUCCESS != rc)
-            {
-                std::stringstream str;
-                str << "Failed to call " << T2_ON_DEMAND_REPORT << ": " << rc;
-                LOGERR("%s", str.str().c_str());
+            Utils::Telemetry::sendMessage((char *)marker.Name.c_str(), (char *)marker.Value.c_str());
+        }
+
+        const uint64_t now = Core::Time::Now().Ticks();
+
+        _markerLock.Lock();
 
-                return Core::ERROR_RPC_CALL_FAILED;
+        for (const Marker& marker : batch)
+        {
+            const uint64_t latency = (now > marker.Queued ? now - marker.Queued : 0);
+            _markerStatistics.TotalLatency += latency;
+            if (latency > _markerStatistics.MaxLatency)
+            {
+                _markerStatistics.MaxLatency = latency;
             }
         }
-        else
+        _markerStatistics.Sent += count;
+        _markerStatistics.Batches += (count != 0 ? 1 : 0);
+
+        // Whatever arrived meanwhile is sent from the worker pool, the caller has waited long enough
+        _publishing = (_markers.empty() == false);
+        const bool more = _publishing;
+
+        _markerLock.Unlock();
+
+        if (more == true)
+        {
+            JsonObject params;
+            Core::IWorkerPool::Instance().Submit(Job::Create(this, TELEMETRY_EVENT_PUBLISHMARKERS, params));
+        }
+    }
+
+    void TelemetryImplementation::markerStatistics(MarkerStatistics& statistics) const
+    {
+        _markerLock.Lock();
+        statistics = _markerStatistics;
+        _markerLock.Unlock();
+    }
+    
+    Core::hresult TelemetryImplementation::UploadReport()
+    {
+        LOGINFO("");
+#ifdef HAS_RBUS
+        int rc = RBUS_ERROR_SUCCESS;
+        rbusError_t status = rbusConnection.Call([](rbusHandle_t handle) {
+            return rbusMethod_InvokeAsync(handle, T2_ON_DEMAND_REPORT, NULL, t2EventHandler, 0);
+        }, rc);
+
+        if (RBUS_ERROR_SUCCESS != status)
         {
             std::stringstream str;
-            str << "rbus_open failed with error code " << rbusHandleStatus;
+            str << "rbus_open failed with error code " << status;
             LOGERR("%s", str.str().c_str());
             return Core::ERROR_OPENING_FAILED;
         }
+        else if (RBUS_ERROR_SUCCESS != rc)
+        {
+            std::stringstream str;
+            str << "Failed to call " << T2_ON_DEMAND_REPORT << ": " << rc;
+            LOGERR("%s", str.str().c_str());
+            return Core::ERROR_RPC_CALL_FAILED;
+        }
 #else
         LOGERR("No RBus support");
         return Core::ERROR_NOT_EXIST;
@@ -505,28 +691,24 @@ namespace Plugin {
     {
         LOGINFO("");
 #ifdef HAS_RBUS
-        if (RBUS_ERROR_SUCCESS != rbusHandleStatus)
-        {
-            rbusHandleStatus = rbus_open(&rbusHandle, RBUS_COMPONENT_NAME);
-        }
+        int rc = RBUS_ERROR_SUCCESS;
+        rbusError_t status = rbusConnection.Call([](rbusHandle_t handle) {
+            return rbusMethod_InvokeAsync(handle, T2_ABORT_ON_DEMAND_REPORT, NULL, t2OnAbortEventHandler, 0);
+        }, rc);
 
-        if (RBUS_ERROR_SUCCESS == rbusHandleStatus)
+        if (RBUS_ERROR_SUCCESS != status)
         {
-            int rc = rbusMethod_InvokeAsync(rbusHandle, T2_ABORT_ON_DEMAND_REPORT, NULL, t2OnAbortEventHandler, 0);
-            if (RBUS_ERROR_SUCCESS != rc)
-            {
-                std::stringstream str;
-                str << "Failed to call " << T2_ABORT_ON_DEMAND_REPORT << ": " << rc;
-                LOGERR("%s", str.str().c_str());
-                return Core::ERROR_RPC_CALL_FAILED;
-            }
+            std::stringstream str;
+            str << "rbus_open failed with error code " << status;
+            LOGERR("%s", str.str().c_str());
+            return Core::ERROR_OPENING_FAILED;
         }
-        else
+        else if (RBUS_ERROR_SUCCESS != rc)
         {
             std::stringstream str;
-            str << "rbus_open failed with error code " << rbusHandleStatus;
+            str << "Failed to call " << T2_ABORT_ON_DEMAND_REPORT << ": " << rc;
             LOGERR("%s", str.str().c_str());
-            return Core::ERROR_OPENING_FAILED;
+            return Core::ERROR_RPC_CALL_FAILED;
         }
 #else
         LOGERR("No RBus support");
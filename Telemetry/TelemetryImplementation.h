@@ -33,6 +33,8 @@
 #include <com/com.h>
 #include <core/core.h>
 
+#include <deque>
+
 using namespace WPEFramework;
 using PowerState = WPEFramework::Exchange::IPowerManager::PowerState;
 using ThermalTemperature = WPEFramework::Exchange::IPowerManager::ThermalTemperature;
@@ -124,8 +126,29 @@ namespace Plugin {
         {
             TELEMETRY_EVENT_ONREPORTUPLOAD,
             TELEMETRY_EVENT_UPLOADREPORT,
-            TELEMETRY_EVENT_ABORTREPORT
+            TELEMETRY_EVENT_ABORTREPORT,
+            TELEMETRY_EVENT_PUBLISHMARKERS
+        };
+
+        struct MarkerStatistics {
+            MarkerStatistics()
+                : Sent(0)
+                , Dropped(0)
+                , Reported(0)
+                , Batches(0)
+                , MaxLatency(0)
+                , TotalLatency(0)
+            {
+            }
+
+            uint32_t Sent;
+            uint32_t Dropped;
+            uint32_t Reported; // Dropped at the time the last drop was logged
+            uint32_t Batches;
+            uint64_t MaxLatency; // us from LogApplicationEvent to t2_event_s
+            uint64_t TotalLatency; // us
         };
+
         class EXTERNAL Job : public Core::IDispatch {
         protected:
             Job(TelemetryImplementation* TelemetryImplementation, Event event, JsonValue &params)
@@ -177,6 +200,8 @@ namespace Plugin {
         void InitializePowerManager();
         void onPowerModeChanged(const PowerState currentState, const PowerState newState);
         void registerEventHandlers();
+        // Counters of the marker queue since activation, also logged at the end of every drop burst
+        void markerStatistics(MarkerStatistics& statistics) const;
 
         // IConfiguration interface
         uint32_t Configure(PluginHost::IShell* service) override;
@@ -199,7 +224,28 @@ namespace Plugin {
         Core::Sink<UserSettingsNotification> _userSettingsNotification;
 #endif
         bool _registeredEventHandlers;
-        
+
+        struct Marker {
+            Marker(const string& name, const string& value, const uint64_t queued)
+                : Name(name)
+                , Value(value)
+                , Queued(queued)
+            {
+            }
+
+            string Name;
+            string Value;
+            uint64_t Queued;
+        };
+
+        mutable Core::CriticalSection _markerLock;
+        std::deque<Marker> _markers;
+        bool _publishing;
+        uint32_t _markerQueueSize;
+        uint32_t _markerBatchSize;
+        MarkerStatistics _markerStatistics;
+
+        void publishMarkers();
         void dispatchEvent(Event, const JsonValue &params);
         void Dispatch(Event event, const JsonValue params);
     public:
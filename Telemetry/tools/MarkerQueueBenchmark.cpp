@@ -0,0 +1,348 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2025 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+// Measures what LogApplicationEvent costs its callers when t2_event_s is slow: every marker sent
+// on the calling thread, as before, against the bounded marker queue drained in batches from the
+// worker pool.
+//
+//   TelemetryMarkerQueueBenchmark [-t threads] [-n markers per thread] [-i interval us] [-s send us] [-q queue size] [-b batch size]
+//
+// t2_event_s is simulated by sleeping for the send time, the worker pool by a single thread. Callers
+// log at random intervals around the given mean. Besides the call latency the report shows the
+// longest time from logging a marker to sending it, and how many markers the queue dropped.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Marker {
+        std::string Name;
+        std::string Value;
+        Clock::time_point Queued;
+    };
+
+    struct Statistics {
+        uint32_t Sent;
+        uint32_t Dropped;
+        uint32_t Batches;
+        double MaxDelivery; // us from logging to t2_event_s
+    };
+
+    class Sender {
+    public:
+        explicit Sender(const uint32_t sendUs)
+            : _sendUs(sendUs)
+        {
+        }
+
+        // t2_event_s: one IPC round trip per marker
+        void Send(const Marker&) const
+        {
+            ::usleep(_sendUs);
+        }
+
+    private:
+        const uint32_t _sendUs;
+    };
+
+    // Stand-in for Core::IWorkerPool, a single thread running submitted jobs in order
+    class WorkerPool {
+    public:
+        WorkerPool()
+            : _running(true)
+            , _thread(&WorkerPool::Run, this)
+        {
+        }
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _running = false;
+            }
+            _signal.notify_one();
+            _thread.join();
+        }
+
+        void Submit(const std::function<void()>& job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _jobs.push_back(job);
+            }
+            _signal.notify_one();
+        }
+
+    private:
+        void Run()
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            while ((_running == true) || (_jobs.empty() == false)) {
+                if (_jobs.empty() == true) {
+                    _signal.wait(lock);
+                } else {
+                    std::function<void()> job(std::move(_jobs.front()));
+                    _jobs.pop_front();
+                    lock.unlock();
+                    job();
+                    lock.lock();
+                }
+            }
+        }
+
+        std::mutex _lock;
+        std::condition_variable _signal;
+        std::deque<std::function<void()>> _jobs;
+        bool _running;
+        std::thread _thread;
+    };
+
+    class Telemetry {
+    public:
+        virtual ~Telemetry() = default;
+        virtual void LogApplicationEvent(const std::string& name, const std::string& value) = 0;
+        virtual void Flush() = 0;
+        virtual Statistics Get() = 0;
+    };
+
+    // What the plugin did before: t2_event_s on the calling thread for every marker
+    class Direct : public Telemetry {
+    public:
+        explicit Direct(const Sender& sender)
+            : _sender(sender)
+            , _statistics { 0, 0, 0, 0 }
+        {
+        }
+
+        void LogApplicationEvent(const std::string& name, const std::string& value) override
+        {
+            const Marker marker { name, value, Clock::now() };
+            _sender.Send(marker);
+
+            const double delivery = std::chrono::duration<double, std::micro>(Clock::now() - marker.Queued).count();
+            std::lock_guard<std::mutex> lock(_lock);
+            _statistics.Sent++;
+            _statistics.Batches++;
+            _statistics.MaxDelivery = std::max(_statistics.MaxDelivery, delivery);
+        }
+        void Flush() override
+        {
+        }
+        Statistics Get() override
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            return (_statistics);
+        }
+
+    private:
+        const Sender& _sender;
+        std::mutex _lock;
+        Statistics _statistics;
+    };
+
+    // The plugin now: sent right away when idle, otherwise queued and drained in batches
+    class Queued : public Telemetry {
+    public:
+        Queued(const Sender& sender, const uint32_t queueSize, const uint32_t batchSize)
+            : _sender(sender)
+            , _queueSize(queueSize)
+            , _batchSize(batchSize)
+            , _publishing(false)
+            , _statistics { 0, 0, 0, 0 }
+        {
+        }
+
+        void LogApplicationEvent(const std::string& name, const std::string& value) override
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            if (_markers.size() >= _queueSize) {
+                _markers.pop_front();
+                _statistics.Dropped++;
+            }
+            _markers.push_back(Marker { name, value, Clock::now() });
+
+            const bool publish = (_publishing == false);
+            _publishing = true;
+            lock.unlock();
+
+            if (publish == true) {
+                Publish();
+            }
+        }
+        void Flush() override
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            _idle.wait(lock, [this]() { return (_publishing == false); });
+        }
+        Statistics Get() override
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            return (_statistics);
+        }
+
+    private:
+        void Publish()
+        {
+            std::vector<Marker> batch;
+
+            std::unique_lock<std::mutex> lock(_lock);
+            const uint32_t count = std::min(static_cast<uint32_t>(_markers.size()), _batchSize);
+            for (uint32_t index = 0; index < count; index++) {
+                batch.push_back(std::move(_markers.front()));
+                _markers.pop_front();
+            }
+            lock.unlock();
+
+            for (const Marker& marker : batch) {
+                _sender.Send(marker);
+            }
+            const Clock::time_point now = Clock::now();
+
+            lock.lock();
+            for (const Marker& marker : batch) {
+                _statistics.MaxDelivery = std::max(_statistics.MaxDelivery, std::chrono::duration<double, std::micro>(now - marker.Queued).count());
+            }
+            _statistics.Sent += count;
+            _statistics.Batches += (count != 0 ? 1 : 0);
+            _publishing = (_markers.empty() == false);
+            const bool more = _publishing;
+            lock.unlock();
+
+            if (more == true) {
+                _pool.Submit([this]() { Publish(); });
+            } else {
+                _idle.notify_all();
+            }
+        }
+
+        const Sender& _sender;
+        const uint32_t _queueSize;
+        const uint32_t _batchSize;
+        std::mutex _lock;
+        std::condition_variable _idle;
+        std::deque<Marker> _markers;
+        bool _publishing;
+        Statistics _statistics;
+        WorkerPool _pool;
+    };
+
+    double Percentile(std::vector<double>& values, const double fraction)
+    {
+        if (values.empty() == true) {
+            return (0);
+        }
+        std::sort(values.begin(), values.end());
+        return (values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))]);
+    }
+
+    void Run(const char name[], Telemetry& telemetry, const uint32_t threads, const uint32_t markers, const uint32_t intervalUs)
+    {
+        std::vector<std::vector<double>> perThread(threads);
+        std::vector<std::thread> callers;
+
+        const Clock::time_point start = Clock::now();
+        for (uint32_t thread = 0; thread < threads; thread++) {
+            callers.emplace_back([&, thread]() {
+                std::mt19937 random(42 + thread);
+                std::uniform_int_distribution<uint32_t> pause(0, 2 * intervalUs);
+                for (uint32_t index = 0; index < markers; index++) {
+                    ::usleep(pause(random));
+                    const Clock::time_point called = Clock::now();
+                    telemetry.LogApplicationEvent("APP_EVENT_" + std::to_string(thread), std::to_string(index));
+                    perThread[thread].push_back(std::chrono::duration<double, std::micro>(Clock::now() - called).count());
+                }
+            });
+        }
+        for (std::thread& caller : callers) {
+            caller.join();
+        }
+        telemetry.Flush();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<double> latencies;
+        for (const std::vector<double>& one : perThread) {
+            latencies.insert(latencies.end(), one.begin(), one.end());
+        }
+
+        const Statistics statistics = telemetry.Get();
+        ::printf("  %-7s call p50 %8.1f us  p99 %8.1f us  max %8.1f us | delivery max %9.1f us | sent %6u  dropped %6u  batches %6u | %5.2f s\n",
+            name, Percentile(latencies, 0.50), Percentile(latencies, 0.99), Percentile(latencies, 1.0),
+            statistics.MaxDelivery, statistics.Sent, statistics.Dropped, statistics.Batches, seconds);
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t threads = 4;
+    uint32_t markers = 2000;
+    uint32_t intervalUs = 500;
+    uint32_t sendUs = 200;
+    uint32_t queueSize = 256;
+    uint32_t batchSize = 32;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "t:n:i:s:q:b:")) != -1) {
+        switch (option) {
+        case 't': threads = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'n': markers = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'i': intervalUs = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 's': sendUs = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'q': queueSize = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'b': batchSize = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        default:
+            ::fprintf(stderr, "usage: %s [-t threads] [-n markers per thread] [-i interval us] [-s send us] [-q queue size] [-b batch size]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if ((threads == 0) || (markers == 0) || (queueSize == 0) || (batchSize == 0)) {
+        ::fprintf(stderr, "threads, markers, queue size and batch size must be at least 1\n");
+        return (1);
+    }
+
+    ::printf("%u threads x %u markers, %u us mean interval, %u us per t2_event_s, queue %u, batch %u\n",
+        threads, markers, intervalUs, sendUs, queueSize, batchSize);
+
+    const Sender sender(sendUs);
+    {
+        Direct direct(sender);
+        Run("direct", direct, threads, markers, intervalUs);
+    }
+    {
+        Queued queued(sender, queueSize, batchSize);
+        Run("queued", queued, threads, markers, intervalUs);
+    }
+
+    return (0);
+}
@@ -0,0 +1,151 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2025 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+// Measures how long loading the default report profiles takes at activation, for a generated
+// profiles file of the given size.
+//
+//   TelemetryProfileBenchmark [-m megabytes] [-r runs]
+//
+// Compares the former read plus per character stringstream escaping with ProfileLoader.
+
+#include "../ProfileLoader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    // A report profile as shipped in default.json, repeated until the file reaches the requested size
+    const char Profile[] =
+        "{\"name\":\"RDK_Profile_%u\",\"hash\":\"%08x\",\"value\":{\"Name\":\"RDK_Profile_%u\","
+        "\"Description\":\"Generated profile\",\"Version\":\"0.1\",\"Protocol\":\"HTTP\","
+        "\"EncodingType\":\"JSON\",\"ReportingInterval\":900,\"TimeReference\":\"0001-01-01T00:00:00Z\","
+        "\"Parameter\":[{\"type\":\"dataModel\",\"name\":\"mac\",\"reference\":\"Device.DeviceInfo.X_COMCAST-COM_STB_MAC\"},"
+        "{\"type\":\"grep\",\"marker\":\"SYST_ERR_%u\",\"search\":\"Failed to connect\",\"logFile\":\"core_log.txt\",\"use\":\"count\"},"
+        "{\"type\":\"event\",\"eventName\":\"APP_LAUNCH_%u\",\"component\":\"Thunder_Plugins\",\"use\":\"absolute\"}],"
+        "\"HTTP\":{\"URL\":\"https://telemetry.example.com/report\",\"Compression\":\"None\",\"Method\":\"POST\"},"
+        "\"JSONEncoding\":{\"ReportFormat\":\"NameValuePair\",\"ReportTimestamp\":\"Unix-Epoch\"}}}";
+
+    void Generate(const std::string& path, const size_t size)
+    {
+        std::ofstream file(path.c_str(), std::ios::binary);
+        std::vector<char> entry(sizeof(Profile) + 64);
+        size_t written = 0;
+
+        file << "{\"profiles\":[";
+        for (uint32_t index = 0; written < size; index++) {
+            const int length = snprintf(entry.data(), entry.size(), Profile, index, index * 2654435761u, index, index, index);
+            if (index != 0) {
+                file << ',';
+            }
+            file.write(entry.data(), length);
+            written += length + 1;
+        }
+        file << "]}";
+    }
+
+    // What setRFCReportProfiles did before ProfileLoader
+    size_t Stream(const std::string& path)
+    {
+        std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+        std::vector<char> content(static_cast<size_t>(file.tellg()) + 1);
+        file.seekg(0);
+        file.read(content.data(), content.size() - 1);
+
+        std::stringstream ss;
+        for (size_t n = 0; n < content.size() - 1; n++) {
+            char ch = content[n];
+            if ('\"' == ch)
+                ss << "\\";
+            ss << ch;
+        }
+        return (ss.str().length());
+    }
+
+    template <typename FUNCTION>
+    double Measure(const uint32_t runs, FUNCTION function)
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t run = 0; run < runs; run++) {
+            function();
+        }
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        return (static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) / 1000 / runs);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t megabytes = 4;
+    uint32_t runs = 10;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "m:r:")) != -1) {
+        switch (option) {
+        case 'm':
+            megabytes = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10));
+            break;
+        case 'r':
+            runs = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10));
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m megabytes] [-r runs]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    char pattern[] = "/tmp/telemetry-profiles-XXXXXX";
+    const int fd = ::mkstemp(pattern);
+    if ((megabytes == 0) || (runs == 0) || (fd < 0)) {
+        fprintf(stderr, "Nothing to measure\n");
+        return (1);
+    }
+    ::close(fd);
+
+    const std::string path(pattern);
+    Generate(path, static_cast<size_t>(megabytes) * 1024 * 1024);
+
+    std::string escaped;
+    size_t streamed = 0;
+
+    // Warm the page cache so all variants read from memory
+    ProfileLoader::Load(path, escaped);
+
+    const double before = Measure(runs, [&]() { streamed = Stream(path); });
+    const double loaded = Measure(runs, [&]() { ProfileLoader::Load(path, escaped); });
+
+    printf("%u MB profiles, %u runs: stringstream %.2f ms, ProfileLoader %.2f ms\n",
+        megabytes, runs, before, loaded);
+
+    if (streamed != escaped.length()) {
+        fprintf(stderr, "Escaped lengths differ: %zu vs %zu\n", streamed, escaped.length());
+    }
+
+    ::unlink(path.c_str());
+
+    return (streamed == escaped.length() ? 0 : 1);
+}
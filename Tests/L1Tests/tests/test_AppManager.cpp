@@ -23,6 +23,8 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <chrono>
+#include <thread>
 
 #include "AppManager.h"
 #include "AppManagerImplementation.h"
@@ -69,6 +71,7 @@ protected:
     PackageManagerMock* mPackageManagerMock = nullptr;
     PackageInstallerMock* mPackageInstallerMock = nullptr;
     Store2Mock* mStore2Mock = nullptr;
+    Exchange::ILifecycleManagerState::INotification* mLifecycleStateNotification = nullptr;
 
     Core::ProxyType<Plugin::AppManager> mAppManagerPlugin;
     Plugin::AppManagerImplementation *mAppManagerImpl;
@@ -108,6 +111,14 @@ protected:
 
         TEST_LOG("In createResources!");
 
+        /* Keep the notification AppManager registers, so tests can deliver lifecycle state events */
+        ON_CALL(*mLifecycleManagerStateMock, Register(::testing::_))
+          .WillByDefault(::testing::Invoke(
+              [&](Exchange::ILifecycleManagerState::INotification* notification) {
+                mLifecycleStateNotification = notification;
+                return Core::ERROR_NONE;
+        }));
+
         EXPECT_CALL(*mServiceMock, QueryInterfaceByCallsign(::testing::_, ::testing::_))
           .Times(::testing::AnyNumber())
           .WillRepeatedly(::testing::Invoke(
@@ -458,6 +469,76 @@ TEST_F(AppManagerTest, GetInstalledAppsUsingComRpcFailureListPackagesReturnError
     }
 }
 
+/*
+ * Test Case for GetLoadedAppsUsingComRpcSnapshotReused
+ * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
+ * Setting Mock for GetLoadedApps() to return 50 loaded apps, expected to be called only once
+ * Calling GetLoadedApps twice without any lifecycle change in between
+ * Verifying the second call is served from the snapshot with the same result and logging the per call cost
+ * Releasing the AppManager Interface object and all related test resources
+ */
+TEST_F(AppManagerTest, GetLoadedAppsUsingComRpcSnapshotReused)
+{
+    Core::hresult status;
+    const int loadedAppCount = 50;
+    JsonArray loadedApps;
+    string loadedAppsStr = "";
+    string firstApps = "";
+    string secondApps = "";
+
+    status = createResources();
+    EXPECT_EQ(Core::ERROR_NONE, status);
+
+    for (int index = 0; index < loadedAppCount; index++)
+    {
+        JsonObject loadedApp;
+        loadedApp["appInstanceID"] = APPMANAGER_APP_INSTANCE + std::to_string(index);
+        loadedApp["appId"] = APPMANAGER_APP_ID + std::to_string(index);
+        loadedApp["currentLifecycleState"] = static_cast<uint32_t>(Exchange::ILifecycleManager::LifecycleState::ACTIVE);
+        loadedApp["timeOfLastLifecycleStateChange"] = "01/01/25 00:00:00.000000000";
+        loadedApp["activeSessionId"] = "";
+        loadedApp["targetLifecycleState"] = static_cast<uint32_t>(Exchange::ILifecycleManager::LifecycleState::ACTIVE);
+        loadedApp["mostRecentIntent"] = APPMANAGER_APP_INTENT;
+        loadedApps.Add(loadedApp);
+    }
+    loadedApps.ToString(loadedAppsStr);
+
+    EXPECT_CALL(*mLifecycleManagerMock, GetLoadedApps(::testing::_, ::testing::_))
+    .Times(1)
+    .WillOnce([&](const bool verbose, string& apps) {
+        apps = loadedAppsStr;
+        return Core::ERROR_NONE;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->GetLoadedApps(firstApps));
+    auto first = std::chrono::steady_clock::now();
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->GetLoadedApps(secondApps));
+    auto second = std::chrono::steady_clock::now();
+
+    TEST_LOG("GetLoadedApps with %d apps: first call %lld us, snapshot call %lld us", loadedAppCount,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(first - start).count()),
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(second - first).count()));
+
+    EXPECT_STREQ(firstApps.c_str(), secondApps.c_str());
+
+    JsonArray result;
+    EXPECT_TRUE(result.FromString(secondApps));
+    EXPECT_EQ(loadedAppCount, static_cast<int>(result.Length()));
+    if (result.Length() > 0)
+    {
+        JsonObject app = result[0].Object();
+        EXPECT_STREQ(APPMANAGER_APP_ID "0", app["appId"].String().c_str());
+        EXPECT_STREQ(APPMANAGER_APP_INSTANCE "0", app["appInstanceId"].String().c_str());
+        EXPECT_EQ(static_cast<int>(Exchange::IAppManager::AppLifecycleState::APP_STATE_ACTIVE), static_cast<int>(app["currentLifecycleState"].Number()));
+    }
+
+    if(status == Core::ERROR_NONE)
+    {
+        releaseResources();
+    }
+}
+
 /*
  * Test Case for IsInstalledUsingComRpcSuccess
  * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
@@ -846,6 +927,53 @@ TEST_F(AppManagerTest, PreloadAppUsingComRpcFailureLifecycleManagerRemoteObjectI
     releaseAppManagerImpl();
 }
 
+/*
+ * Test Case for LaunchAppUsingComRpcLoadedStateFromEvents
+ * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
+ * Setting Mock for IsAppLoaded() to report the app as not loaded, expected to be called only once
+ * Preloading the app, which spawns it, and delivering the PAUSED and SUSPENDED state events
+ * Launching the app again, the loaded state must come from the spawn and the events without asking LifecycleManager
+ * Verifying that the suspended app is resumed with SetTargetAppState() instead of being spawned again
+ * Releasing the AppManager interface and all related test resources
+ */
+TEST_F(AppManagerTest, LaunchAppUsingComRpcLoadedStateFromEvents)
+{
+    Core::hresult status;
+    std::string error = "";
+
+    status = createResources();
+    EXPECT_EQ(Core::ERROR_NONE, status);
+    ASSERT_NE(nullptr, mLifecycleStateNotification);
+
+    LaunchAppPreRequisite(Exchange::ILifecycleManager::LifecycleState::PAUSED);
+    EXPECT_CALL(*mLifecycleManagerMock, IsAppLoaded(APPMANAGER_APP_ID, ::testing::_))
+    .Times(1)
+    .WillOnce([&](const std::string &appId, bool &loaded) {
+        loaded = false;
+        return Core::ERROR_NONE;
+    });
+
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->PreloadApp(APPMANAGER_APP_ID, APPMANAGER_APP_LAUNCHARGS, error));
+
+    mLifecycleStateNotification->OnAppLifecycleStateChanged(APPMANAGER_APP_ID, APPMANAGER_APP_INSTANCE,
+        Exchange::ILifecycleManager::LifecycleState::LOADING, Exchange::ILifecycleManager::LifecycleState::PAUSED, "");
+    mLifecycleStateNotification->OnAppLifecycleStateChanged(APPMANAGER_APP_ID, APPMANAGER_APP_INSTANCE,
+        Exchange::ILifecycleManager::LifecycleState::PAUSED, Exchange::ILifecycleManager::LifecycleState::SUSPENDED, "");
+
+    EXPECT_CALL(*mLifecycleManagerMock, SpawnApp(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+    .Times(0);
+    EXPECT_CALL(*mLifecycleManagerMock, SetTargetAppState(APPMANAGER_APP_INSTANCE, Exchange::ILifecycleManager::LifecycleState::ACTIVE, APPMANAGER_APP_INTENT))
+    .Times(1)
+    .WillOnce(::testing::Return(Core::ERROR_NONE));
+
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->LaunchApp(APPMANAGER_APP_ID, APPMANAGER_APP_INTENT, APPMANAGER_APP_LAUNCHARGS));
+
+    if(status == Core::ERROR_NONE)
+    {
+        releaseResources();
+    }
+}
+
 /*
  * Test Case for CloseAppUsingComRpcSuccess
  * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
@@ -960,6 +1088,58 @@ TEST_F(AppManagerTest, CloseAppUsingComRpcFailureLifecycleManagerRemoteObjectIsN
     releaseAppManagerImpl();
 }
 
+/*
+ * Test Case for CloseAppUsingComRpcWaitsForPausedEvent
+ * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
+ * Launching the app and delivering the ACTIVE state event
+ * Setting Mock for SetTargetAppState() to deliver the PAUSED state event from another thread, like LifecycleManager does
+ * Setting Mock for UnloadApp() to simulate unloading the app once it is paused
+ * Verifying that CloseApp is released by the PAUSED event and unloads the app
+ * Releasing the AppManager interface and all related test resources
+ */
+TEST_F(AppManagerTest, CloseAppUsingComRpcWaitsForPausedEvent)
+{
+    Core::hresult status;
+    std::thread lifecycleManager;
+
+    status = createResources();
+    EXPECT_EQ(Core::ERROR_NONE, status);
+    ASSERT_NE(nullptr, mLifecycleStateNotification);
+
+    LaunchAppPreRequisite(Exchange::ILifecycleManager::LifecycleState::ACTIVE);
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->LaunchApp(APPMANAGER_APP_ID, APPMANAGER_APP_INTENT, APPMANAGER_APP_LAUNCHARGS));
+
+    mLifecycleStateNotification->OnAppLifecycleStateChanged(APPMANAGER_APP_ID, APPMANAGER_APP_INSTANCE,
+        Exchange::ILifecycleManager::LifecycleState::LOADING, Exchange::ILifecycleManager::LifecycleState::ACTIVE, APPMANAGER_APP_INTENT);
+
+    EXPECT_CALL(*mLifecycleManagerMock, SetTargetAppState(APPMANAGER_APP_INSTANCE, Exchange::ILifecycleManager::LifecycleState::PAUSED, ::testing::_))
+    .WillOnce([&](const string& appInstanceId , const Exchange::ILifecycleManager::LifecycleState targetLifecycleState , const string& launchIntent) {
+        lifecycleManager = std::thread([this]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            mLifecycleStateNotification->OnAppLifecycleStateChanged(APPMANAGER_APP_ID, APPMANAGER_APP_INSTANCE,
+                Exchange::ILifecycleManager::LifecycleState::ACTIVE, Exchange::ILifecycleManager::LifecycleState::PAUSED, APPMANAGER_APP_INTENT);
+        });
+        return Core::ERROR_NONE;
+    });
+    EXPECT_CALL(*mLifecycleManagerMock, UnloadApp(APPMANAGER_APP_INSTANCE, ::testing::_, ::testing::_))
+    .WillOnce([&](const string& appInstanceId, string& errorReason, bool& success) {
+        success = true;
+        return Core::ERROR_NONE;
+    });
+
+    EXPECT_EQ(Core::ERROR_NONE, mAppManagerImpl->CloseApp(APPMANAGER_APP_ID));
+
+    if (lifecycleManager.joinable())
+    {
+        lifecycleManager.join();
+    }
+
+    if(status == Core::ERROR_NONE)
+    {
+        releaseResources();
+    }
+}
+
 /*
  * Test Case for TerminateAppUsingComRpcSuccess
  * Setting up AppManager/LifecycleManager/LifecycleManagerState/PersistentStore/PackageManagerRDKEMS Plugin and creating required COM-RPC resources
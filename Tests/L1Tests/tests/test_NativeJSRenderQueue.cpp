@@ -0,0 +1,183 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RenderQueue.h"
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+// Headless stand-in for NativeJSRenderer, it only records what it was asked to do
+class FakeRenderer {
+public:
+    struct Launch {
+        int Source;
+        int Sequence;
+    };
+
+    void launchApplication(const int source, const int sequence)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _launches.push_back(Launch { source, sequence });
+    }
+    std::vector<Launch> Launches()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return (_launches);
+    }
+
+private:
+    std::mutex _lock;
+    std::vector<Launch> _launches;
+};
+
+}
+
+TEST(NativeJSRenderQueueTest, BurstsDuringStartupAreNotLost)
+{
+    const int sources = 8;
+    const int burst = 250;
+    RenderQueue<FakeRenderer> queue;
+    std::shared_ptr<FakeRenderer> renderer = std::make_shared<FakeRenderer>();
+    std::atomic<int> started(0);
+    std::vector<std::thread> callers;
+
+    for (int source = 0; source < sources; source++) {
+        callers.emplace_back([&queue, &started, source]() {
+            started++;
+            for (int sequence = 0; sequence < burst; sequence++) {
+                EXPECT_TRUE(queue.Submit([source, sequence](FakeRenderer& target) {
+                    target.launchApplication(source, sequence);
+                }));
+                if (sequence == (burst / 2)) {
+                    // Let the renderer come up in the middle of the burst
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+        });
+    }
+
+    // The render thread builds its renderer while the requests pour in
+    std::thread render([&queue, &renderer, &started]() {
+        while (started < sources) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        EXPECT_TRUE(queue.Attach(renderer));
+    });
+
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    render.join();
+
+    EXPECT_EQ(0u, queue.Pending());
+
+    const std::vector<FakeRenderer::Launch> launches = renderer->Launches();
+    ASSERT_EQ(static_cast<size_t>(sources * burst), launches.size());
+
+    // Every caller's launches arrive complete and in the order it made them
+    std::vector<int> next(sources, 0);
+    for (const FakeRenderer::Launch& launch : launches) {
+        EXPECT_EQ(next[launch.Source], launch.Sequence) << "source " << launch.Source;
+        next[launch.Source] = launch.Sequence + 1;
+    }
+    for (int source = 0; source < sources; source++) {
+        EXPECT_EQ(burst, next[source]) << "source " << source;
+    }
+}
+
+TEST(NativeJSRenderQueueTest, AttachedRendererRunsRequestsDirectly)
+{
+    RenderQueue<FakeRenderer> queue;
+    std::shared_ptr<FakeRenderer> renderer = std::make_shared<FakeRenderer>();
+
+    EXPECT_TRUE(queue.Attach(renderer));
+    EXPECT_TRUE(queue.Submit([](FakeRenderer& target) { target.launchApplication(0, 1); }));
+
+    EXPECT_EQ(0u, queue.Pending());
+    EXPECT_EQ(1u, renderer->Launches().size());
+    EXPECT_EQ(renderer, queue.Close());
+}
+
+TEST(NativeJSRenderQueueTest, CloseBeforeStartupDropsQueuedRequests)
+{
+    RenderQueue<FakeRenderer> queue;
+    std::shared_ptr<FakeRenderer> renderer = std::make_shared<FakeRenderer>();
+
+    EXPECT_TRUE(queue.Submit([](FakeRenderer& target) { target.launchApplication(0, 1); }));
+    EXPECT_TRUE(queue.Submit([](FakeRenderer& target) { target.launchApplication(0, 2); }));
+    EXPECT_EQ(2u, queue.Pending());
+
+    EXPECT_EQ(nullptr, queue.Close());
+    EXPECT_FALSE(queue.Attach(renderer));
+    EXPECT_FALSE(queue.Submit([](FakeRenderer& target) { target.launchApplication(0, 3); }));
+
+    EXPECT_EQ(0u, queue.Pending());
+    EXPECT_TRUE(renderer->Launches().empty());
+}
+
+TEST(NativeJSRenderQueueTest, DetachWaitsForRunningRequests)
+{
+    RenderQueue<FakeRenderer> queue;
+    std::shared_ptr<FakeRenderer> renderer = std::make_shared<FakeRenderer>();
+    std::atomic<bool> running(false);
+    std::atomic<bool> release(false);
+
+    EXPECT_TRUE(queue.Attach(renderer));
+    std::thread caller([&queue, &running, &release]() {
+        EXPECT_TRUE(queue.Submit([&running, &release](FakeRenderer& target) {
+            running = true;
+            while (release == false) {
+                std::this_thread::yield();
+            }
+            target.launchApplication(0, 1);
+        }));
+    });
+    while (running == false) {
+        std::this_thread::yield();
+    }
+
+    // The render loop has ended while a request is still on the renderer
+    std::atomic<bool> detached(false);
+    std::thread render([&queue, &detached]() {
+        queue.Detach();
+        detached = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(detached);
+
+    release = true;
+    caller.join();
+    render.join();
+
+    EXPECT_TRUE(detached);
+    EXPECT_EQ(1, renderer.use_count());
+    EXPECT_EQ(1u, renderer->Launches().size());
+    EXPECT_FALSE(queue.Submit([](FakeRenderer& target) { target.launchApplication(0, 2); }));
+}
@@ -34,6 +34,11 @@
 #include "WrapsMock.h"
 #include "ThunderPortability.h"
 
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
 namespace {
 const string profileFN = _T("/tmp/DefaultProfile.json");
 const string t2PpersistentFolder = _T("/tmp/.t2reportprofiles/");
@@ -306,6 +311,92 @@ TEST_F(TelemetryTest, Plugin)
 
 }
 
+TEST_F(TelemetryTest, logApplicationEventSequence)
+{
+    std::vector<string> values;
+
+    EXPECT_CALL(*p_telemetryApiImplMock, t2_event_s(::testing::_, ::testing::_))
+        .Times(20)
+        .WillRepeatedly(::testing::Invoke(
+            [&](char* marker, char* value) {
+                EXPECT_EQ(string(marker), _T("NAME"));
+                values.push_back(value);
+                return T2ERROR_SUCCESS;
+            }));
+
+    for (int index = 0; index < 20; index++) {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("logApplicationEvent"), _T("{\"eventName\":\"NAME\", \"eventValue\":\"") + std::to_string(index) + _T("\"}"), response));
+    }
+
+    // Markers go out in the order they were logged
+    ASSERT_EQ(values.size(), 20u);
+    for (int index = 0; index < 20; index++) {
+        EXPECT_EQ(values[index], std::to_string(index));
+    }
+}
+
+TEST_F(TelemetryTest, logApplicationEventQueueFull)
+{
+    std::promise<void> entered;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future().share());
+    std::mutex valuesLock;
+    std::vector<string> values;
+
+    // The first marker blocks the publisher, the ones logged meanwhile have to fit in the queue
+    EXPECT_CALL(*p_telemetryApiImplMock, t2_event_s(::testing::_, ::testing::_))
+        .WillOnce(::testing::Invoke(
+            [&](char* marker, char* value) {
+                entered.set_value();
+                released.wait();
+                std::lock_guard<std::mutex> lock(valuesLock);
+                values.push_back(value);
+                return T2ERROR_SUCCESS;
+            }))
+        .WillRepeatedly(::testing::Invoke(
+            [&](char* marker, char* value) {
+                std::lock_guard<std::mutex> lock(valuesLock);
+                values.push_back(value);
+                return T2ERROR_SUCCESS;
+            }));
+
+    Plugin::TelemetryImplementation* implementation = Plugin::TelemetryImplementation::_instance;
+    ASSERT_NE(implementation, nullptr);
+
+    std::thread publisher([&]() {
+        EXPECT_EQ(Core::ERROR_NONE, implementation->LogApplicationEvent(_T("NAME"), _T("blocked")));
+    });
+    entered.get_future().wait();
+
+    // Default markerQueueSize is 256, the 10 oldest of these are dropped
+    for (int index = 0; index < 266; index++) {
+        EXPECT_EQ(Core::ERROR_NONE, implementation->LogApplicationEvent(_T("NAME"), std::to_string(index)));
+    }
+
+    Plugin::TelemetryImplementation::MarkerStatistics statistics;
+    implementation->markerStatistics(statistics);
+    EXPECT_EQ(statistics.Dropped, 10u);
+    EXPECT_EQ(statistics.Sent, 0u);
+
+    release.set_value();
+    publisher.join();
+
+    for (int wait = 0; (wait < 500) && (statistics.Sent < 257); wait++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        implementation->markerStatistics(statistics);
+    }
+
+    EXPECT_EQ(statistics.Sent, 257u);
+    EXPECT_EQ(statistics.Dropped, 10u);
+    EXPECT_GT(statistics.Batches, 1u);
+
+    std::lock_guard<std::mutex> lock(valuesLock);
+    ASSERT_EQ(values.size(), 257u);
+    EXPECT_EQ(values[0], _T("blocked"));
+    EXPECT_EQ(values[1], _T("10"));
+    EXPECT_EQ(values[256], _T("265"));
+}
+
 TEST_F(TelemetryTest, uploadLogsRbusOpenFailure)
 {
     EXPECT_CALL(*p_rBusApiImplMock, rbus_open(::testing::_, ::testing::_))
@@ -341,6 +432,40 @@ TEST_F(TelemetryTest, uploadLogsRbusMethodFailure)
 
 }
 
+TEST_F(TelemetryTest, uploadLogsRbusOpenBackoff)
+{
+    EXPECT_CALL(*p_rBusApiImplMock, rbus_open(::testing::_, ::testing::_))
+        .Times(1)
+        .WillOnce(::testing::Return(RBUS_ERROR_BUS_ERROR));
+
+    EXPECT_EQ(Core::ERROR_OPENING_FAILED, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_OPENING_FAILED, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+}
+
+TEST_F(TelemetryTest, uploadLogsRbusReconnect)
+{
+    EXPECT_CALL(*p_rBusApiImplMock, rbus_open(::testing::_, ::testing::_))
+        .Times(2)
+        .WillRepeatedly(::testing::Return(RBUS_ERROR_SUCCESS));
+
+    EXPECT_CALL(*p_rBusApiImplMock, rbus_close(::testing::_))
+        .Times(::testing::AtLeast(1))
+        .WillRepeatedly(::testing::Return(RBUS_ERROR_SUCCESS));
+
+    EXPECT_CALL(*p_rBusApiImplMock, rbusMethod_InvokeAsync(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(4)
+        .WillOnce(::testing::Return(RBUS_ERROR_SUCCESS))
+        .WillOnce(::testing::Return(RBUS_ERROR_SUCCESS))
+        .WillOnce(::testing::Return(RBUS_ERROR_BUS_ERROR))
+        .WillOnce(::testing::Return(RBUS_ERROR_SUCCESS));
+
+    // The connection is kept across calls and only reopened after a bus error
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_RPC_CALL_FAILED, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("uploadReport"), _T("{}"), response));
+}
+
 TEST_F(TelemetryTest, uploadLogsCallbackFailed)
 {
     Core::Event onReportUpload(false, true);
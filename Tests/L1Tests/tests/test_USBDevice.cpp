@@ -17,6 +17,7 @@
 * limitations under the License.
 **/
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <mntent.h>
 #include <fstream>
@@ -29,6 +30,7 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <chrono>
 #include "COMLinkMock.h"
 #include "WorkerPoolImplementation.h"
 #include "WrapsMock.h"
@@ -52,6 +54,8 @@ using namespace WPEFramework;
 #define MOCK_USB_DEVICE_MANUFACTURER "USB"
 #define MOCK_USB_DEVICE_PRODUCT "SanDisk 3.2Gen1"
 #define LIBUSB_CONFIG_ATT_BUS_POWERED 0x80
+#define MOCK_USB_DEVICE_CLASS_HID 0x03
+#define MOCK_USB_DEVICE_COUNT 20
 namespace {
 const string callSign = _T("USBDevice");
 }
@@ -924,7 +928,7 @@ TEST_F(USBDeviceTest, getDeviceInfoSuccessCase)
     ON_CALL(*p_libUSBImplMock, libusb_free_device_list(::testing::_, ::testing::_))
     .WillByDefault(
     [](libusb_device **list, int unref_devices) {
-        for (int index = 0; index < 2; ++index)
+        for (int index = 0; index < 1; ++index)
         {
             free(list[index]);
         }
@@ -1024,8 +1028,130 @@ TEST_F(USBDeviceTest, getDeviceInfoSuccessCase)
         }
         return (int)data[0];
     });
+    /* The block device is not mapped yet, so the reading is not cached and the second call reads the bus again */
+    EXPECT_CALL(*p_libUSBImplMock, libusb_get_device_list(::testing::_, ::testing::_))
+    .Times(2);
     /* Call getDeviceInfo method */
     TEST_LOG("call getDeviceInfo");
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceInfo"), _T("{\"deviceName\":\"100\\/001\"}"), response));
     EXPECT_EQ(response, string("{\"parentId\":0,\"deviceStatus\":1,\"deviceLevel\":0,\"portNumber\":1,\"vendorId\":4660,\"productId\":22136,\"protocol\":0,\"serialNumber\":\"\",\"device\":{\"deviceClass\":8,\"deviceSubclass\":8,\"deviceName\":\"100\\/001\",\"devicePath\":\"\"},\"flags\":\"AVAILABLE\",\"features\":0,\"busSpeed\":\"High\",\"numLanguageIds\":1,\"productInfo1\":{\"languageId\":1033,\"serialNumber\":\"0401805e4532973503374df52a239c898397d348\",\"manufacturer\":\"USB\",\"product\":\"SanDisk 3.2Gen1\"},\"productInfo2\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"},\"productInfo3\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"},\"productInfo4\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"}}"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceInfo"), _T("{\"deviceName\":\"100\\/001\"}"), response));
+    EXPECT_EQ(response, string("{\"parentId\":0,\"deviceStatus\":1,\"deviceLevel\":0,\"portNumber\":1,\"vendorId\":4660,\"productId\":22136,\"protocol\":0,\"serialNumber\":\"\",\"device\":{\"deviceClass\":8,\"deviceSubclass\":8,\"deviceName\":\"100\\/001\",\"devicePath\":\"\"},\"flags\":\"AVAILABLE\",\"features\":0,\"busSpeed\":\"High\",\"numLanguageIds\":1,\"productInfo1\":{\"languageId\":1033,\"serialNumber\":\"0401805e4532973503374df52a239c898397d348\",\"manufacturer\":\"USB\",\"product\":\"SanDisk 3.2Gen1\"},\"productInfo2\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"},\"productInfo3\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"},\"productInfo4\":{\"languageId\":0,\"serialNumber\":\"\",\"manufacturer\":\"\",\"product\":\"\"}}"));
+}
+
+/*******************************************************************************************************************
+ * Test function for the device table
+ *                The bus is enumerated by the first query only, afterwards the hotplug callbacks keep the table
+ *                current and queries are answered without touching libusb
+ * Use case coverage:
+ *                @Success :2
+ ********************************************************************************************************************/
+
+static void Mock_SetDeviceTable(libUSBImplMock* mock, const uint8_t count)
+{
+    /* NULL terminated like the list libusb hands out, so it can be freed without knowing its length */
+    ON_CALL(*mock, libusb_get_device_list(::testing::_, ::testing::_))
+    .WillByDefault(
+    [count](libusb_context *ctx, libusb_device ***list) {
+        struct libusb_device **ret = (struct libusb_device **)calloc(count + 1, sizeof(struct libusb_device *));
+
+        for (uint8_t index = 0; index < count; ++index)
+        {
+            ret[index] = (struct libusb_device *)calloc(1, sizeof(struct libusb_device));
+            ret[index]->bus_number = MOCK_USB_DEVICE_BUS_NUMBER_1;
+            ret[index]->device_address = index + 1;
+            ret[index]->port_number = index + 1;
+        }
+        *list = ret;
+
+        return (ssize_t)count;
+    });
+
+    ON_CALL(*mock, libusb_free_device_list(::testing::_, ::testing::_))
+    .WillByDefault(
+    [](libusb_device **list, int unref_devices) {
+        for (int index = 0; list[index] != nullptr; ++index)
+        {
+            free(list[index]);
+        }
+        free(list);
+    });
+
+    ON_CALL(*mock, libusb_get_device_descriptor(::testing::_, ::testing::_))
+    .WillByDefault(
+    [](libusb_device *dev, struct libusb_device_descriptor *desc) {
+        desc->bDeviceClass = MOCK_USB_DEVICE_CLASS_HID;
+        desc->bDeviceSubClass = 0;
+        return LIBUSB_SUCCESS;
+    });
+
+    ON_CALL(*mock, libusb_get_device_address(::testing::_))
+    .WillByDefault(
+    [](libusb_device *dev) {
+        return dev->device_address;
+    });
+
+    ON_CALL(*mock, libusb_get_bus_number(::testing::_))
+    .WillByDefault(
+    [](libusb_device *dev) {
+        return dev->bus_number;
+    });
+}
+
+TEST_F(USBDeviceTest, getDeviceListServedFromDeviceTableWithTwentyDevices)
+{
+    const int queries = 100;
+
+    Mock_SetDeviceTable(p_libUSBImplMock, MOCK_USB_DEVICE_COUNT);
+
+    EXPECT_CALL(*p_libUSBImplMock, libusb_get_device_list(::testing::_, ::testing::_))
+        .Times(1);
+    EXPECT_CALL(*p_libUSBImplMock, libusb_open(::testing::_, ::testing::_))
+        .Times(0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"deviceName\":\"100\\/020\""));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int index = 0; index < queries; ++index)
+    {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    TEST_LOG("getDeviceList with %d devices: %lld us per query", MOCK_USB_DEVICE_COUNT, static_cast<long long>(elapsed.count() / queries));
+
+    JsonArray devices;
+    devices.FromString(response);
+    EXPECT_EQ(MOCK_USB_DEVICE_COUNT, static_cast<int>(devices.Length()));
+}
+
+TEST_F(USBDeviceTest, getDeviceListFollowsHotplug)
+{
+    Mock_SetDeviceTable(p_libUSBImplMock, 2);
+
+    EXPECT_CALL(*p_libUSBImplMock, libusb_get_device_list(::testing::_, ::testing::_))
+        .Times(1);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"deviceName\":\"100\\/001\""));
+
+    libusb_device dev = {0};
+    dev.bus_number = MOCK_USB_DEVICE_BUS_NUMBER_1;
+    dev.device_address = 1;
+    dev.port_number = 1;
+
+    libUSBHotPlugCbDeviceDetached(nullptr, &dev, LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT, 0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::Not(::testing::HasSubstr("\"deviceName\":\"100\\/001\"")));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"deviceName\":\"100\\/002\""));
+
+    dev.device_address = 3;
+    dev.port_number = 3;
+
+    libUSBHotPlugCbDeviceAttached(nullptr, &dev, LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, 0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"deviceName\":\"100\\/003\""));
 }
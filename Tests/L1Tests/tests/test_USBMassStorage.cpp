@@ -25,6 +25,10 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <chrono>
+#include <thread>
+#include <future>
+#include <dirent.h>
 #include "USBMassStorage.h"
 #include "USBMassStorageImplementation.h"
 #include "WorkerPoolImplementation.h"
@@ -33,6 +37,7 @@
 #include "COMLinkMock.h"
 #include "WrapsMock.h"
 #include "ThunderPortability.h"
+#include "FileSystemProbe.h"
 #define TEST_LOG(x, ...) fprintf(stderr, "\033[1;32m[%s:%d](%s)<PID:%d><TID:%d>" x "\n\033[0m", __FILE__, __LINE__, __FUNCTION__, getpid(), gettid(), ##__VA_ARGS__); fflush(stderr);
 
 using ::testing::NiceMock;
@@ -1131,3 +1136,347 @@ TEST_F(USBMassStorageTest, USBMassStorage_Succeed_MountPoints)
 
 }
 
+/* Repeated getPartitionInfo calls are served from the partition metrics cache */
+TEST_F(USBMassStorageTest, getPartitionInfo_ServedFromCache)
+{
+    std::list<Exchange::IUSBDevice::USBDevice> usbDeviceList;
+    Exchange::IUSBDevice::USBDevice usbDevice1;
+    usbDevice1.deviceClass = LIBUSB_CLASS_MASS_STORAGE;
+    usbDevice1.deviceSubclass = 0x12;
+    usbDevice1.deviceName = "001/006";
+    usbDevice1.devicePath = "/dev/sdy";
+    usbDeviceList.emplace_back(usbDevice1);
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+
+    auto mockIterator = Core::Service<RPC::IteratorType<Exchange::IUSBDevice::IUSBDeviceIterator>>::Create<Exchange::IUSBDevice::IUSBDeviceIterator>(usbDeviceList);
+
+    EXPECT_CALL(*p_usbDeviceMock, GetDeviceList(testing::_))
+    .WillOnce([&](Exchange::IUSBDevice::IUSBDeviceIterator*& devices) {
+        devices = mockIterator;
+        return Core::ERROR_NONE;
+    });
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+
+    /* No sysfs, the device is its own partition */
+    ON_CALL(*p_wrapsImplMock, opendir(::testing::_))
+    .WillByDefault([](const char* pathname) {
+        static int sysBlockDir = 0;
+        return reinterpret_cast<DIR*>(&sysBlockDir);
+    });
+
+    ON_CALL(*p_wrapsImplMock, readdir(::testing::_))
+    .WillByDefault([](DIR* dirp) -> struct dirent* {
+        return nullptr;
+    });
+
+    ON_CALL(*p_wrapsImplMock, mount(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+    .WillByDefault([](const char* source, const char* target, const char* filesystemtype, unsigned long mountflags, const void* data) {
+        return 0;
+    });
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getMountPoints"), _T("{\"deviceName\": \"001/006\"}"), response));
+
+    EXPECT_CALL(*p_wrapsImplMock, statfs(::testing::_, ::testing::_))
+    .Times(1)
+    .WillOnce([](const char* path, struct statfs* buf) -> int {
+        buf->f_type = 0x565a;
+        return 0;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, statvfs(::testing::_, ::testing::_))
+    .Times(1)
+    .WillOnce([](const char* path, struct statvfs* stat) -> int {
+        stat->f_blocks = 1024000;
+        stat->f_frsize = 4096;
+        stat->f_bfree = 256000;
+        return 0;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, open(::testing::_, ::testing::_, ::testing::_))
+    .Times(1)
+    .WillOnce([](const char* pathname, int flags, mode_t mode) {
+        return 0;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, ioctl(::testing::_, ::testing::_, ::testing::_))
+    .Times(3)
+    .WillRepeatedly([](int fd, unsigned long request, void* argp) -> int {
+        if (request == BLKGETSIZE64) {
+            *(reinterpret_cast<uint64_t*>(argp)) = 8ULL * 1024 * 1024 * 1024;
+        }
+        else if (request == BLKGETSIZE) {
+            *(reinterpret_cast<unsigned long*>(argp)) = 1024;
+        }
+        else if (request == BLKSSZGET) {
+            *(reinterpret_cast<uint32_t*>(argp)) = 512;
+        }
+        return 0;
+    });
+
+    string first;
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPartitionInfo"), _T("{\"mountPath\": \"/tmp/media/usb1\"}"), first));
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPartitionInfo"), _T("{\"mountPath\": \"/tmp/media/usb1\"}"), response));
+        EXPECT_EQ(first, response);
+    }
+
+    USBMassStorageImpl->PartitionMetricsStatistics(hits, misses);
+    EXPECT_EQ(10u, hits);
+    EXPECT_EQ(1u, misses);
+
+    usbDeviceList.clear();
+}
+
+/* A synthetic device with four partitions, found through sysfs and mounted side by side */
+TEST_F(USBMassStorageTest, getMountPoints_FourPartitionsMountedConcurrently)
+{
+    static const uint32_t mountDelayMs = 100;
+    static int sysBlockDir = 0;
+    std::list<Exchange::IUSBDevice::USBDevice> usbDeviceList;
+    Exchange::IUSBDevice::USBDevice usbDevice1;
+    usbDevice1.deviceClass = LIBUSB_CLASS_MASS_STORAGE;
+    usbDevice1.deviceSubclass = 0x12;
+    usbDevice1.deviceName = "001/005";
+    usbDevice1.devicePath = "/dev/sdz";
+    usbDeviceList.emplace_back(usbDevice1);
+
+    auto mockIterator = Core::Service<RPC::IteratorType<Exchange::IUSBDevice::IUSBDeviceIterator>>::Create<Exchange::IUSBDevice::IUSBDeviceIterator>(usbDeviceList);
+
+    EXPECT_CALL(*p_usbDeviceMock, GetDeviceList(testing::_))
+    .WillOnce([&](Exchange::IUSBDevice::IUSBDeviceIterator*& devices) {
+        devices = mockIterator;
+        return Core::ERROR_NONE;
+    });
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getDeviceList"), _T("{}"), response));
+
+    EXPECT_CALL(*p_wrapsImplMock, opendir(::testing::StrEq("/sys/block/sdz")))
+    .WillOnce([](const char* pathname) {
+        return reinterpret_cast<DIR*>(&sysBlockDir);
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, readdir(::testing::_))
+    .WillRepeatedly([](DIR* dirp) -> struct dirent* {
+        static const char* entries[] = { ".", "..", "sdz4", "queue", "sdz1", "sdz3", "holders", "sdz2" };
+        static size_t call_count = 0;
+        static struct dirent entry;
+
+        if (call_count < (sizeof(entries) / sizeof(entries[0]))) {
+            std::strncpy(entry.d_name, entries[call_count++], sizeof(entry.d_name) - 1);
+            entry.d_type = DT_DIR;
+            return &entry;
+        }
+        call_count = 0;
+        return nullptr;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, closedir(::testing::_))
+    .WillOnce([](DIR* dirp) {
+        return 0;
+    });
+
+    /* Superblock can not be read, so each partition costs one (vfat) mount */
+    ON_CALL(*p_wrapsImplMock, open(::testing::_, ::testing::_, ::testing::_))
+    .WillByDefault([](const char* pathname, int flags, mode_t mode) {
+        return -1;
+    });
+
+    ON_CALL(*p_wrapsImplMock, mkdir(::testing::_, ::testing::_))
+    .WillByDefault([](const char* path, mode_t mode) {
+        return 0;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, mount(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+    .Times(4)
+    .WillRepeatedly([](const char* source, const char* target, const char* filesystemtype, unsigned long mountflags, const void* data) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(mountDelayMs));
+        return 0;
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getMountPoints"), _T("{\"deviceName\": \"001/005\"}"), response));
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    TEST_LOG("Time to mounted for 4 partitions: %lld ms, %u ms per mount", static_cast<long long>(elapsed), mountDelayMs);
+
+    /* Serially this takes four mount delays */
+    EXPECT_LT(elapsed, static_cast<long long>(4 * mountDelayMs));
+
+    for (const char* partition : { "/dev/sdz1", "/dev/sdz2", "/dev/sdz3", "/dev/sdz4" })
+    {
+        EXPECT_NE(response.find(partition), std::string::npos);
+    }
+    for (const char* mountPath : { "/tmp/media/usb1", "/tmp/media/usb2", "/tmp/media/usb3", "/tmp/media/usb4" })
+    {
+        EXPECT_NE(response.find(mountPath), std::string::npos);
+    }
+    EXPECT_LT(response.find("/dev/sdz1"), response.find("/dev/sdz2"));
+    EXPECT_LT(response.find("/dev/sdz3"), response.find("/dev/sdz4"));
+
+    usbDeviceList.clear();
+}
+
+TEST_F(USBMassStorageTest, OnDevicePluggedOut_WhileMounting)
+{
+    static int sysBlockDir = 0;
+    Exchange::IUSBDevice::USBDevice usbDevice1;
+    usbDevice1.deviceClass = LIBUSB_CLASS_MASS_STORAGE;
+    usbDevice1.deviceSubclass = 0x12;
+    usbDevice1.deviceName = "001/006";
+    usbDevice1.devicePath = "/dev/sdy";
+
+    std::promise<void> mounting;
+    std::promise<void> unplugged;
+    std::promise<std::string> unmounted;
+    std::shared_future<void> unpluggedDone(unplugged.get_future());
+
+    EXPECT_CALL(*p_wrapsImplMock, opendir(::testing::StrEq("/sys/block/sdy")))
+    .WillOnce([](const char* pathname) {
+        return reinterpret_cast<DIR*>(&sysBlockDir);
+    });
+
+    /* No partition table, the device itself is mounted */
+    EXPECT_CALL(*p_wrapsImplMock, readdir(::testing::_))
+    .WillRepeatedly([](DIR* dirp) -> struct dirent* {
+        static const char* entries[] = { ".", "..", "queue" };
+        static size_t call_count = 0;
+        static struct dirent entry;
+
+        if (call_count < (sizeof(entries) / sizeof(entries[0]))) {
+            std::strncpy(entry.d_name, entries[call_count++], sizeof(entry.d_name) - 1);
+            entry.d_type = DT_DIR;
+            return &entry;
+        }
+        call_count = 0;
+        return nullptr;
+    });
+
+    ON_CALL(*p_wrapsImplMock, open(::testing::_, ::testing::_, ::testing::_))
+    .WillByDefault([](const char* pathname, int flags, mode_t mode) {
+        return -1;
+    });
+
+    ON_CALL(*p_wrapsImplMock, mkdir(::testing::_, ::testing::_))
+    .WillByDefault([](const char* path, mode_t mode) {
+        return 0;
+    });
+
+    /* The device goes away while its mount is still running */
+    EXPECT_CALL(*p_wrapsImplMock, mount(::testing::StrEq("/dev/sdy"), ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+    .WillOnce([&](const char* source, const char* target, const char* filesystemtype, unsigned long mountflags, const void* data) {
+        mounting.set_value();
+        unpluggedDone.wait();
+        return 0;
+    });
+
+    EXPECT_CALL(*p_wrapsImplMock, umount(::testing::_))
+    .WillOnce([&](const char* path) {
+        unmounted.set_value(path);
+        return 0;
+    });
+
+    USBMassStorageImpl->OnDevicePluggedIn(usbDevice1);
+    ASSERT_EQ(std::future_status::ready, mounting.get_future().wait_for(std::chrono::seconds(5)));
+
+    USBMassStorageImpl->OnDevicePluggedOut(usbDevice1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    unplugged.set_value();
+
+    /* Whichever job gets the lock first, the partition that was mounted is unmounted once */
+    std::future<std::string> unmountedPath = unmounted.get_future();
+    ASSERT_EQ(std::future_status::ready, unmountedPath.wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ(0u, unmountedPath.get().find("/tmp/media/usb"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    /* Neither mounted nor listed anymore */
+    EXPECT_EQ(Core::ERROR_INVALID_DEVICENAME, handler.Invoke(connection, _T("getMountPoints"), _T("{\"deviceName\": \"001/006\"}"), response));
+}
+
+/* Disk image fixtures: the first sectors of a freshly formatted partition, written to /tmp and probed as a file. */
+static std::vector<uint8_t> Mock_BootSector(const uint8_t jump, const char oemName[], const uint8_t sectorsPerCluster, const uint8_t fats)
+{
+    std::vector<uint8_t> image(4096, 0);
+
+    image[0] = jump;
+    image[1] = 0x3C;
+    image[2] = 0x90;
+    memcpy(&image[3], oemName, 8);
+    image[11] = 0x00; /* 512 bytes per sector */
+    image[12] = 0x02;
+    image[13] = sectorsPerCluster;
+    image[14] = 0x01; /* reserved sectors */
+    image[16] = fats;
+    image[510] = 0x55;
+    image[511] = 0xAA;
+
+    return image;
+}
+
+static Plugin::FileSystemProbe::Type Mock_ProbeImage(const std::vector<uint8_t>& image)
+{
+    const char* path = "/tmp/usbmassstorage_probe.img";
+    Plugin::FileSystemProbe::Type type = Plugin::FileSystemProbe::UNREADABLE;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(image.data()), image.size());
+    file.close();
+
+    FILE* fp = fopen(path, "rb");
+    if (fp != nullptr)
+    {
+        type = Plugin::FileSystemProbe::Probe(fileno(fp));
+        fclose(fp);
+    }
+    std::remove(path);
+
+    return type;
+}
+
+TEST(USBMassStorageProbeTest, identifiesFatImages)
+{
+    std::vector<uint8_t> fat12 = Mock_BootSector(0xEB, "mkfs.fat", 4, 2);
+    memcpy(&fat12[54], "FAT12   ", 8);
+    EXPECT_EQ(Plugin::FileSystemProbe::FAT, Mock_ProbeImage(fat12));
+
+    std::vector<uint8_t> fat16 = Mock_BootSector(0xEB, "MSDOS5.0", 8, 2);
+    memcpy(&fat16[54], "FAT16   ", 8);
+    EXPECT_EQ(Plugin::FileSystemProbe::FAT, Mock_ProbeImage(fat16));
+
+    std::vector<uint8_t> fat32 = Mock_BootSector(0xEB, "mkfs.fat", 8, 2);
+    fat32[14] = 0x20;
+    memcpy(&fat32[82], "FAT32   ", 8);
+    EXPECT_EQ(Plugin::FileSystemProbe::FAT, Mock_ProbeImage(fat32));
+
+    /* The type label is optional, a valid parameter block is enough */
+    EXPECT_EQ(Plugin::FileSystemProbe::FAT, Mock_ProbeImage(Mock_BootSector(0xE9, "        ", 1, 1)));
+}
+
+TEST(USBMassStorageProbeTest, identifiesExfatNtfsAndExtImages)
+{
+    EXPECT_EQ(Plugin::FileSystemProbe::EXFAT, Mock_ProbeImage(Mock_BootSector(0xEB, "EXFAT   ", 0, 0)));
+    EXPECT_EQ(Plugin::FileSystemProbe::NTFS, Mock_ProbeImage(Mock_BootSector(0xEB, "NTFS    ", 8, 0)));
+
+    std::vector<uint8_t> ext4(4096, 0);
+    ext4[1080] = 0x53;
+    ext4[1081] = 0xEF;
+    EXPECT_EQ(Plugin::FileSystemProbe::EXT, Mock_ProbeImage(ext4));
+}
+
+TEST(USBMassStorageProbeTest, rejectsUnrecognizedImages)
+{
+    /* Blank partition */
+    EXPECT_EQ(Plugin::FileSystemProbe::UNKNOWN, Mock_ProbeImage(std::vector<uint8_t>(4096, 0)));
+
+    /* Boot signature without a sane parameter block, e.g. a partition table */
+    EXPECT_EQ(Plugin::FileSystemProbe::UNKNOWN, Mock_ProbeImage(Mock_BootSector(0xEB, "mkfs.fat", 3, 2)));
+    EXPECT_EQ(Plugin::FileSystemProbe::UNKNOWN, Mock_ProbeImage(Mock_BootSector(0x00, "mkfs.fat", 4, 2)));
+
+    /* Less than a sector */
+    std::vector<uint8_t> truncated = Mock_BootSector(0xEB, "mkfs.fat", 4, 2);
+    truncated.resize(100);
+    EXPECT_EQ(Plugin::FileSystemProbe::UNREADABLE, Mock_ProbeImage(truncated));
+}
@@ -12,6 +12,7 @@
 #include "Store2Mock.h"
 #include "COMLinkMock.h"
 #include "WrapsMock.h"
+#include "WorkerPoolImplementation.h"
 #include "ThunderPortability.h"
 #define TEST_LOG(x, ...) fprintf(stderr, "\033[1;32m[%s:%d](%s)<PID:%d><TID:%d>" x "\n\033[0m", __FILE__, __LINE__, __FUNCTION__, getpid(), gettid(), ##__VA_ARGS__); fflush(stderr);
 
@@ -26,6 +27,7 @@ protected:
     Core::JSONRPC::Message message;
     NiceMock<ServiceMock> service;
     NiceMock<COMLinkMock> comLinkMock;
+    Core::ProxyType<WorkerPoolImplementation> workerPool;
     Core::ProxyType<Plugin::UserSettingsImplementation> UserSettingsImpl;
     //Exchange::IUserSettings::INotification *notification = nullptr;
     string response;
@@ -36,6 +38,8 @@ protected:
         : plugin(Core::ProxyType<Plugin::UserSettings>::Create())
         , handler(*plugin)
         , connection(1,0,"")
+        , workerPool(Core::ProxyType<WorkerPoolImplementation>::Create(
+            2, Core::Thread::DefaultStackSize(), 16))
     {
         p_serviceMock = new NiceMock <ServiceMock>;
 
@@ -47,6 +51,13 @@ protected:
         EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
             .WillOnce(testing::Return(p_store2Mock));
 
+        // The store is empty when the snapshot loads at activation (one read per setting), so the
+        // getters below go to the store. Retired afterwards, the tests see the usual mock defaults.
+        EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(19)
+            .WillRepeatedly(::testing::Return(Core::ERROR_NOT_EXIST))
+            .RetiresOnSaturation();
+
         ON_CALL(comLinkMock, Instantiate(::testing::_, ::testing::_, ::testing::_))
             .WillByDefault(::testing::Invoke(
             [&](const RPC::Object& object, const uint32_t waitTime, uint32_t& connectionId) {
@@ -54,6 +65,9 @@ protected:
                 return &UserSettingsImpl;
                 }));
 
+        Core::IWorkerPool::Assign(&(*workerPool));
+        workerPool->Run();
+
         plugin->Initialize(&service);
     }
 
@@ -62,6 +76,9 @@ protected:
 
         plugin->Deinitialize(&service);
 
+        Core::IWorkerPool::Assign(nullptr);
+        workerPool.Release();
+
         if (p_serviceMock != nullptr)
         {
             delete p_serviceMock;
@@ -119,6 +136,7 @@ TEST_F(UserSettingsTest, RegisteredMethods)
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getVoiceGuidanceRate")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setVoiceGuidanceHints")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getVoiceGuidanceHints")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getAll")));
 }
 
 TEST_F(UserSettingsTest, SetAudioDescription_Failure)
@@ -757,3 +775,264 @@ TEST_F(UserSettingsTest, GetMigrationStates_Success)
     EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getMigrationStates"), _T("{}"), response));
 }
 
+TEST_F(UserSettingsTest, GetHighContrast_FromSnapshotAfterSet)
+{
+    EXPECT_CALL(*p_store2Mock, SetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::Return(Core::ERROR_NONE));
+    EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setHighContrast"), _T("{\"enabled\":true}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getHighContrast"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("true"));
+}
+
+TEST_F(UserSettingsTest, GetHighContrast_MissingKeyNotCached)
+{
+    // A default is served but not cached, a key deleted in the store can not leave a stale value behind
+    EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::Return(Core::ERROR_NOT_EXIST))
+        .WillOnce(::testing::Return(Core::ERROR_UNKNOWN_KEY))
+        .WillOnce(::testing::Invoke(
+            [](const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, string& value, uint32_t& ttl) {
+                value = "true";
+                return Core::ERROR_NONE;
+            }));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getHighContrast"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("false"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getHighContrast"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("false"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getHighContrast"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("true"));
+
+    // Stored values are cached
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getHighContrast"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("true"));
+}
+
+TEST_F(UserSettingsTest, GetAll_Success)
+{
+    EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(18)
+        .WillRepeatedly(::testing::Invoke(
+            [](const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, string& value, uint32_t& ttl) {
+                value = (key == "voiceGuidanceRate") ? "1" : "true";
+                return Core::ERROR_NONE;
+            }));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getAll"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"highContrast\":true"));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"privacyMode\":\"SHARE\""));
+    EXPECT_THAT(response, ::testing::Not(::testing::HasSubstr("contentPin")));
+
+    // Every setting is in the snapshot now, a second call does not touch the store
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getAll"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"captions\":true"));
+}
+
+TEST_F(UserSettingsTest, GetAll_Failure)
+{
+    EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::Return(Core::ERROR_GENERAL));
+
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("getAll"), _T("{}"), response));
+}
+
+TEST_F(UserSettingsTest, ValueChanged_UpdatesEverySetting)
+{
+    // Every key reaches its setting and event, tools/DispatchBenchmark measures that the lookup costs the same for all
+    static const std::pair<const char*, const char*> changes[] = {
+        { "audioDescription", "true" },
+        { "preferredAudioLanguages", "eng" },
+        { "presentationLanguage", "en-US" },
+        { "captions", "true" },
+        { "preferredCaptionsLanguages", "fra" },
+        { "preferredClosedCaptionsService", "CC3" },
+        { "privacyMode", "DO_NOT_SHARE" },
+        { "pinControl", "true" },
+        { "viewingRestrictions", "{}" },
+        { "viewingRestrictionsWindow", "ALWAYS" },
+        { "liveWaterShed", "true" },
+        { "playbackWaterShed", "true" },
+        { "blockNotRatedContent", "true" },
+        { "pinOnPurchase", "true" },
+        { "highContrast", "true" },
+        { "voiceGuidance", "true" },
+        { "voiceGuidanceRate", "2.5" },
+        { "voiceGuidanceHints", "true" },
+        { "contentPin", "1234" }
+    };
+
+    EXPECT_CALL(*p_store2Mock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(0);
+
+    for (const auto& change : changes) {
+        UserSettingsImpl->ValueChanged(Exchange::IStore2::ScopeType::DEVICE, "UserSettings", change.first, change.second);
+    }
+
+    // Neither a key of another namespace nor an unknown key touch the settings
+    UserSettingsImpl->ValueChanged(Exchange::IStore2::ScopeType::DEVICE, "Other", "highContrast", "false");
+    UserSettingsImpl->ValueChanged(Exchange::IStore2::ScopeType::DEVICE, "UserSettings", "unknownKey", "false");
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getAll"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"highContrast\":true"));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"privacyMode\":\"DO_NOT_SHARE\""));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"preferredClosedCaptionsService\":\"CC3\""));
+    EXPECT_THAT(response, ::testing::HasSubstr("\"voiceGuidanceRate\":2.5"));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getContentPin"), _T("{}"), response));
+    EXPECT_THAT(response, ::testing::HasSubstr("1234"));
+}
+
+class Store2InspectorMock : public Exchange::IStore2, public Exchange::IStoreInspector {
+public:
+    MOCK_METHOD(uint32_t, Release, (), (const, override));
+    MOCK_METHOD(void, AddRef, (), (const, override));
+    MOCK_METHOD(uint32_t, Register, (Exchange::IStore2::INotification* notification), (override));
+    MOCK_METHOD(uint32_t, Unregister, (Exchange::IStore2::INotification* notification), (override));
+    MOCK_METHOD(uint32_t, SetValue, (const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, const string& value, const uint32_t ttl), (override));
+    MOCK_METHOD(uint32_t, GetValue, (const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, string& value, uint32_t& ttl), (override));
+    MOCK_METHOD(uint32_t, DeleteKey, (const Exchange::IStore2::ScopeType scope, const string& ns, const string& key), (override));
+    MOCK_METHOD(uint32_t, DeleteNamespace, (const Exchange::IStore2::ScopeType scope, const string& ns), (override));
+    MOCK_METHOD(uint32_t, GetKeys, (const Exchange::IStoreInspector::ScopeType scope, const string& ns, RPC::IStringIterator*& keys), (override));
+    MOCK_METHOD(uint32_t, GetNamespaces, (const Exchange::IStoreInspector::ScopeType scope, RPC::IStringIterator*& namespaces), (override));
+    MOCK_METHOD(uint32_t, GetStorageSizes, (const Exchange::IStoreInspector::ScopeType scope, Exchange::IStoreInspector::INamespaceSizeIterator*& storageList), (override));
+
+    BEGIN_INTERFACE_MAP(Store2InspectorMock)
+        INTERFACE_ENTRY(Exchange::IStore2)
+        INTERFACE_ENTRY(Exchange::IStoreInspector)
+    END_INTERFACE_MAP
+};
+
+// Same set up as UserSettingsTest, with a store that also offers IStoreInspector
+class UserSettingsInspectorTest : public ::testing::Test {
+protected:
+    Core::ProxyType<Plugin::UserSettings> plugin;
+    Core::JSONRPC::Handler& handler;
+    Core::JSONRPC::Context connection;
+    NiceMock<ServiceMock> service;
+    NiceMock<COMLinkMock> comLinkMock;
+    Core::ProxyType<WorkerPoolImplementation> workerPool;
+    Core::ProxyType<Plugin::UserSettingsImplementation> UserSettingsImpl;
+    string response;
+    WrapsImplMock *p_wrapsImplMock   = nullptr;
+    NiceMock<Store2InspectorMock> *p_storeMock = nullptr;
+    UserSettingsInspectorTest()
+        : plugin(Core::ProxyType<Plugin::UserSettings>::Create())
+        , handler(*plugin)
+        , connection(1,0,"")
+        , workerPool(Core::ProxyType<WorkerPoolImplementation>::Create(
+            2, Core::Thread::DefaultStackSize(), 16))
+    {
+        p_storeMock = new NiceMock <Store2InspectorMock>;
+
+        p_wrapsImplMock  = new NiceMock <WrapsImplMock>;
+        Wraps::setImpl(p_wrapsImplMock);
+
+        EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
+            .WillOnce(testing::Return(static_cast<Exchange::IStore2*>(p_storeMock)));
+
+        EXPECT_CALL(*p_storeMock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(19)
+            .WillRepeatedly(::testing::Return(Core::ERROR_NOT_EXIST))
+            .RetiresOnSaturation();
+
+        ON_CALL(comLinkMock, Instantiate(::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::Invoke(
+            [&](const RPC::Object& object, const uint32_t waitTime, uint32_t& connectionId) {
+                UserSettingsImpl = Core::ProxyType<Plugin::UserSettingsImplementation>::Create();
+                return &UserSettingsImpl;
+                }));
+
+        Core::IWorkerPool::Assign(&(*workerPool));
+        workerPool->Run();
+
+        plugin->Initialize(&service);
+    }
+
+    virtual ~UserSettingsInspectorTest() override
+    {
+        plugin->Deinitialize(&service);
+
+        Core::IWorkerPool::Assign(nullptr);
+        workerPool.Release();
+
+        if (p_storeMock != nullptr)
+        {
+            delete p_storeMock;
+            p_storeMock = nullptr;
+        }
+
+        Wraps::setImpl(nullptr);
+        if (p_wrapsImplMock != nullptr)
+        {
+            delete p_wrapsImplMock;
+            p_wrapsImplMock = nullptr;
+        }
+    }
+
+    std::map<Exchange::IUserSettingsInspector::SettingsKey, bool> GetMigrationStates()
+    {
+        std::map<Exchange::IUserSettingsInspector::SettingsKey, bool> result;
+        Exchange::IUserSettingsInspector::IUserSettingsMigrationStateIterator* states = nullptr;
+
+        EXPECT_EQ(Core::ERROR_NONE, UserSettingsImpl->GetMigrationStates(states));
+        if (states != nullptr)
+        {
+            Exchange::IUserSettingsInspector::SettingsMigrationState state;
+            while (states->Next(state))
+            {
+                result[state.key] = state.requiresMigration;
+            }
+            states->Release();
+        }
+        return result;
+    }
+};
+
+TEST_F(UserSettingsInspectorTest, GetMigrationStates_FromGetKeys)
+{
+    EXPECT_CALL(*p_storeMock, GetKeys(Exchange::IStoreInspector::ScopeType::DEVICE, string("UserSettings"), ::testing::_))
+        .WillOnce(::testing::Invoke(
+            [](const Exchange::IStoreInspector::ScopeType scope, const string& ns, RPC::IStringIterator*& keys) {
+                std::list<string> stored = { "highContrast", "voiceGuidanceRate", "someOtherKey" };
+                keys = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(stored);
+                return Core::ERROR_NONE;
+            }));
+    // One query for the namespace instead of a read per setting
+    EXPECT_CALL(*p_storeMock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(0);
+
+    std::map<Exchange::IUserSettingsInspector::SettingsKey, bool> states = GetMigrationStates();
+
+    EXPECT_EQ(states.size(), 18u);
+    EXPECT_FALSE(states[Exchange::IUserSettingsInspector::SettingsKey::HIGH_CONTRAST]);
+    EXPECT_FALSE(states[Exchange::IUserSettingsInspector::SettingsKey::VOICE_GUIDANCE_RATE]);
+    EXPECT_TRUE(states[Exchange::IUserSettingsInspector::SettingsKey::CAPTIONS]);
+    EXPECT_TRUE(states[Exchange::IUserSettingsInspector::SettingsKey::CONTENT_PIN]);
+}
+
+TEST_F(UserSettingsInspectorTest, GetMigrationStates_GetKeysFailure)
+{
+    // Without the key list every setting is read on its own, like a store without IStoreInspector
+    EXPECT_CALL(*p_storeMock, GetKeys(::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::Return(Core::ERROR_GENERAL));
+    EXPECT_CALL(*p_storeMock, GetValue(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(18)
+        .WillRepeatedly(::testing::Invoke(
+            [](const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, string& value, uint32_t& ttl) {
+                if (key == "highContrast")
+                {
+                    value = "true";
+                    return static_cast<uint32_t>(Core::ERROR_NONE);
+                }
+                return static_cast<uint32_t>(Core::ERROR_NOT_EXIST);
+            }));
+
+    std::map<Exchange::IUserSettingsInspector::SettingsKey, bool> states = GetMigrationStates();
+
+    EXPECT_EQ(states.size(), 18u);
+    EXPECT_FALSE(states[Exchange::IUserSettingsInspector::SettingsKey::HIGH_CONTRAST]);
+    EXPECT_TRUE(states[Exchange::IUserSettingsInspector::SettingsKey::CAPTIONS]);
+}
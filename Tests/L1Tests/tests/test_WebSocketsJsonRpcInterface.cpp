@@ -0,0 +1,248 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <websocketpp/common/asio.hpp>
+#include <websocketpp/common/memory.hpp>
+#include <websocketpp/transport/base/connection.hpp>
+
+#include "WebSockets/CommunicationInterface/JsonRpcInterface.h"
+
+using namespace WebSockets;
+
+namespace {
+
+// Stand-in for the websocketpp asio endpoint, only the timer part JsonRpcInterface uses
+class FakeEndpoint {
+public:
+    using timer_ptr = websocketpp::lib::shared_ptr<websocketpp::lib::asio::steady_timer>;
+
+    timer_ptr set_timer(long duration, std::function<void(websocketpp::lib::error_code const&)> callback)
+    {
+        timer_ptr timer = websocketpp::lib::make_shared<websocketpp::lib::asio::steady_timer>(_service, std::chrono::milliseconds(duration));
+        timer->async_wait([timer, callback](websocketpp::lib::asio::error_code const& ec) {
+            // Reported like the websocketpp asio transport does
+            if (ec == websocketpp::lib::asio::error::operation_aborted) {
+                callback(websocketpp::transport::error::make_error_code(websocketpp::transport::error::operation_aborted));
+            } else if (ec) {
+                callback(websocketpp::transport::error::make_error_code(websocketpp::transport::error::pass_through));
+            } else {
+                callback(websocketpp::lib::error_code());
+            }
+        });
+        return timer;
+    }
+    websocketpp::lib::asio::io_service& get_io_service()
+    {
+        return _service;
+    }
+
+private:
+    websocketpp::lib::asio::io_service _service;
+};
+
+// Runs the event loop like WSEndpoint does, with the wire replaced by a list of sent messages
+class FakeClient : public JsonRpcInterface<FakeClient> {
+    friend JsonRpcInterface<FakeClient>;
+
+public:
+    FakeClient()
+        : _work(new websocketpp::lib::asio::io_service::work(endpointImpl_.get_io_service()))
+        , _loop([this]() { endpointImpl_.get_io_service().run(); })
+    {
+    }
+    ~FakeClient()
+    {
+        Stop();
+    }
+
+    // Same order as ~WSEndpoint, returns how long the event loop took to end
+    std::chrono::milliseconds Stop()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (_loop.joinable()) {
+            _work.reset();
+            shutdown();
+            _loop.join();
+        }
+        return (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+    }
+    // Delivered on the event loop thread, as websocketpp does
+    void Deliver(const std::string& message)
+    {
+        endpointImpl_.get_io_service().post([this, message]() { onMessage(message); });
+    }
+    void Connected(const bool connected)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _connected = connected;
+    }
+    std::vector<std::string> Sent()
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return (_sent);
+    }
+
+private:
+    bool send(const std::string& message)
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_connected) {
+            _sent.push_back(message);
+        }
+        return (_connected);
+    }
+
+    FakeEndpoint endpointImpl_;
+    std::unique_ptr<websocketpp::lib::asio::io_service::work> _work;
+    std::mutex _lock;
+    bool _connected { true };
+    std::vector<std::string> _sent;
+    std::thread _loop;
+};
+
+struct Outcome {
+    bool Success;
+    uint32_t Id;
+    std::thread::id Thread;
+};
+
+JsonRpcInterface<FakeClient>::ResponseCallback Completion(std::shared_ptr<std::promise<Outcome>> result)
+{
+    return ([result](bool success, const JsonRpc::Response& response) {
+        result->set_value(Outcome { success, response.getId(), std::this_thread::get_id() });
+    });
+}
+
+std::string Answer(const uint32_t id, const bool success)
+{
+    return ("{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) + ",\"result\":{\"success\":" + (success ? "true" : "false") + "}}");
+}
+
+}
+
+TEST(WebSocketsJsonRpcInterfaceTest, InvokeAsyncCompletesOnResponse)
+{
+    FakeClient client;
+    JsonRpc::Request request;
+    ASSERT_TRUE(request.create("org.rdk.Test.1.ping", JsonObject()));
+
+    auto result = std::make_shared<std::promise<Outcome>>();
+    auto outcome = result->get_future();
+    EXPECT_TRUE(client.invokeAsync(request, Completion(result)));
+    ASSERT_EQ(1u, client.Sent().size());
+    EXPECT_EQ(request.toString(), client.Sent()[0]);
+
+    client.Deliver(Answer(request.getId(), true));
+    ASSERT_EQ(std::future_status::ready, outcome.wait_for(std::chrono::seconds(1)));
+    Outcome completed = outcome.get();
+    EXPECT_TRUE(completed.Success);
+    EXPECT_EQ(request.getId(), completed.Id);
+    EXPECT_NE(std::this_thread::get_id(), completed.Thread);
+
+    // The answered request's timer is cancelled, the event loop does not wait out the default timeout
+    EXPECT_LT(client.Stop().count(), 1000);
+}
+
+TEST(WebSocketsJsonRpcInterfaceTest, InvokeAsyncTimesOutWithoutResponse)
+{
+    FakeClient client;
+    JsonRpc::Request request;
+    ASSERT_TRUE(request.create("org.rdk.Test.1.ping", JsonObject()));
+
+    auto result = std::make_shared<std::promise<Outcome>>();
+    auto outcome = result->get_future();
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(client.invokeAsync(request, Completion(result), 50));
+
+    ASSERT_EQ(std::future_status::ready, outcome.wait_for(std::chrono::seconds(2)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    EXPECT_FALSE(outcome.get().Success);
+
+    // A response after the timeout is dropped, the callback already ran
+    client.Deliver(Answer(request.getId(), true));
+    EXPECT_LT(client.Stop().count(), 1000);
+}
+
+TEST(WebSocketsJsonRpcInterfaceTest, EarlierDeadlineSupersedesArmedTimer)
+{
+    FakeClient client;
+    JsonRpc::Request slow;
+    JsonRpc::Request fast;
+    ASSERT_TRUE(slow.create("org.rdk.Test.1.slow", JsonObject()));
+    ASSERT_TRUE(fast.create("org.rdk.Test.1.fast", JsonObject()));
+
+    auto slowResult = std::make_shared<std::promise<Outcome>>();
+    auto fastResult = std::make_shared<std::promise<Outcome>>();
+    auto slowOutcome = slowResult->get_future();
+    auto fastOutcome = fastResult->get_future();
+    EXPECT_TRUE(client.invokeAsync(slow, Completion(slowResult), 5000));
+    EXPECT_TRUE(client.invokeAsync(fast, Completion(fastResult), 50));
+
+    ASSERT_EQ(std::future_status::ready, fastOutcome.wait_for(std::chrono::seconds(1)));
+    EXPECT_FALSE(fastOutcome.get().Success);
+    EXPECT_EQ(std::future_status::timeout, slowOutcome.wait_for(std::chrono::milliseconds(0)));
+
+    client.Deliver(Answer(slow.getId(), false));
+    ASSERT_EQ(std::future_status::ready, slowOutcome.wait_for(std::chrono::seconds(1)));
+    Outcome completed = slowOutcome.get();
+    EXPECT_FALSE(completed.Success);
+    EXPECT_EQ(slow.getId(), completed.Id);
+    EXPECT_LT(client.Stop().count(), 1000);
+}
+
+TEST(WebSocketsJsonRpcInterfaceTest, ShutdownFailsRequestsInFlight)
+{
+    FakeClient client;
+    JsonRpc::Request request;
+    ASSERT_TRUE(request.create("org.rdk.Test.1.ping", JsonObject()));
+
+    auto result = std::make_shared<std::promise<Outcome>>();
+    auto outcome = result->get_future();
+    EXPECT_TRUE(client.invokeAsync(request, Completion(result)));
+
+    EXPECT_LT(client.Stop().count(), 1000);
+    ASSERT_EQ(std::future_status::ready, outcome.wait_for(std::chrono::milliseconds(0)));
+    EXPECT_FALSE(outcome.get().Success);
+
+    JsonRpc::Request late;
+    ASSERT_TRUE(late.create("org.rdk.Test.1.ping", JsonObject()));
+    EXPECT_FALSE(client.invokeAsync(late, Completion(std::make_shared<std::promise<Outcome>>())));
+}
+
+TEST(WebSocketsJsonRpcInterfaceTest, InvokeAsyncFailsWhenNotSent)
+{
+    FakeClient client;
+    JsonRpc::Request request;
+    ASSERT_TRUE(request.create("org.rdk.Test.1.ping", JsonObject()));
+    client.Connected(false);
+
+    bool called = false;
+    EXPECT_FALSE(client.invokeAsync(request, [&called](bool, const JsonRpc::Response&) { called = true; }));
+    EXPECT_LT(client.Stop().count(), 1000);
+    EXPECT_FALSE(called);
+}
@@ -54,6 +54,10 @@ USBDeviceImplementation::USBDeviceImplementation()
 : _adminLock()
 , _libUSBDeviceThread(nullptr)
 ,_handlingUSBDeviceEvents(false)
+, _deviceCacheEnabled(false)
+, _devicesEnumerated(false)
+, _devices()
+, _deviceInfos()
 {
     LOGINFO("Create USBDeviceImplementation Instance");
     USBDeviceImplementation::instance(this);
@@ -62,6 +66,10 @@ USBDeviceImplementation::USBDeviceImplementation()
     {
         LOGERR("libUSBInit Failed");
     }
+    else
+    {
+        _deviceCacheEnabled = true;
+    }
 }
 
 USBDeviceImplementation* USBDeviceImplementation::instance(USBDeviceImplementation *USBDeviceImpl)
@@ -216,6 +224,7 @@ int USBDeviceImplementation::libUSBHotPlugCallbackDeviceAttached(libusb_context
 			  	                       usbDevice.deviceName.c_str(),
 			  	                       usbDevice.devicePath.c_str());
 
+              USBDeviceImplementation::instance()->deviceAttached(usbDevice);
               USBDeviceImplementation::instance()->dispatchEvent(USBDeviceImplementation::Event::USBDEVICE_HOTPLUG_EVENT_DEVICE_ARRIVED, usbDevice);
           }
           else
@@ -243,7 +252,13 @@ int USBDeviceImplementation::libUSBHotPlugCallbackDeviceDetached(libusb_context
 
       if (nullptr != dev)
       {
-          if (Core::ERROR_NONE == USBDeviceImplementation::instance()->getUSBDeviceStructFromDeviceDescriptor(dev, &usbDevice))
+          char deviceName[16] = {0};
+
+          (void)snprintf(deviceName, sizeof(deviceName), "%03d/%03d", libusb_get_bus_number(dev), libusb_get_device_address(dev));
+
+          /* The block device of a known device is gone by now, so report what was cached at arrival */
+          if ((true == USBDeviceImplementation::instance()->deviceDetached(string(deviceName), usbDevice)) ||
+              (Core::ERROR_NONE == USBDeviceImplementation::instance()->getUSBDeviceStructFromDeviceDescriptor(dev, &usbDevice)))
           {
               LOGINFO ("usbDevice.deviceClass: %u usbDevice.deviceSubclass:%u usbDevice.deviceName:%s devicePath:%s", 
 			  	                       usbDevice.deviceClass,
@@ -266,6 +281,102 @@ int USBDeviceImplementation::libUSBHotPlugCallbackDeviceDetached(libusb_context
       return 0;
 }
 
+void USBDeviceImplementation::deviceAttached(const Exchange::IUSBDevice::USBDevice &usbDevice)
+{
+    _adminLock.Lock();
+
+    /* Addresses are reused, whatever was known under this name belonged to another device */
+    _deviceInfos.erase(usbDevice.deviceName);
+
+    if (true == _devicesEnumerated)
+    {
+        if ((LIBUSB_CLASS_MASS_STORAGE == usbDevice.deviceClass) && (usbDevice.devicePath.empty()))
+        {
+            /* Block device not mapped yet, the next query enumerates again */
+            _devicesEnumerated = false;
+        }
+        else
+        {
+            _devices[usbDevice.deviceName] = usbDevice;
+        }
+    }
+
+    _adminLock.Unlock();
+}
+
+bool USBDeviceImplementation::deviceDetached(const string &deviceName, Exchange::IUSBDevice::USBDevice &usbDevice)
+{
+    bool found = false;
+
+    _adminLock.Lock();
+
+    _deviceInfos.erase(deviceName);
+
+    auto entry = _devices.find(deviceName);
+    if (entry != _devices.end())
+    {
+        usbDevice = entry->second;
+        _devices.erase(entry);
+        found = true;
+    }
+
+    _adminLock.Unlock();
+
+    return found;
+}
+
+/* Rebuilds the device table from the bus, called with _adminLock held */
+void USBDeviceImplementation::enumerateDevices(void) const
+{
+    libusb_device **devs = nullptr;
+    ssize_t devCount = 0;
+    bool complete = true;
+
+    _devices.clear();
+    _devicesEnumerated = false;
+
+    devCount = libusb_get_device_list(NULL, &devs);
+
+    LOGINFO("devCount:%zd", devCount);
+
+    if (devCount > 0)
+    {
+        for (int index = 0; index < devCount; index++)
+        {
+            Exchange::IUSBDevice::USBDevice usbDevice = {0};
+
+            if (Core::ERROR_NONE == USBDeviceImplementation::instance()->getUSBDeviceStructFromDeviceDescriptor(devs[index], &usbDevice))
+            {
+                LOGINFO ("usbDevice.deviceClass: %u usbDevice.deviceSubclass:%u usbDevice.deviceName:%s devicePath:%s", 
+                                       usbDevice.deviceClass,
+                                       usbDevice.deviceSubclass,
+                                       usbDevice.deviceName.c_str(),
+                                       usbDevice.devicePath.c_str());
+
+                _devices[usbDevice.deviceName] = usbDevice;
+
+                if ((LIBUSB_CLASS_MASS_STORAGE == usbDevice.deviceClass) && (usbDevice.devicePath.empty()))
+                {
+                    complete = false;
+                }
+            }
+            else
+            {
+                LOGWARN ("getUSBDeviceStructFromDeviceDescriptor Failed");
+                complete = false;
+            }
+        }
+
+        libusb_free_device_list(devs, 1);
+    }
+
+    if (devCount >= 0)
+    {
+        /* Anything missing is retried by the next query rather than cached */
+        _devicesEnumerated = (_deviceCacheEnabled && complete);
+    }
+}
+
 void USBDeviceImplementation::getDeviceSerialNumber(libusb_device *pDev, string &serialNumber)
 {
     uint8_t devPath[8] = {0};
@@ -953,57 +1064,33 @@ void USBDeviceImplementation::Dispatch(Event event, const Exchange::IUSBDevice::
 
 Core::hresult USBDeviceImplementation::GetDeviceList(IUSBDeviceIterator*& devices) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
     std::list<Exchange::IUSBDevice::USBDevice> usbDeviceList;
-    libusb_device **devs = nullptr;
-    ssize_t devCount = 0;
 
     _adminLock.Lock();
 
     LOGINFO("GetDeviceList");
 
-    devCount = libusb_get_device_list(NULL, &devs);
-
-    LOGINFO("devCount:%zd", devCount);
-
-    if (devCount > 0) 
+    if (false == _devicesEnumerated)
     {
-        for (int index = 0; index < devCount; index++)
-        {
-            Exchange::IUSBDevice::USBDevice usbDevice = {0};
-
-            status = USBDeviceImplementation::instance()->getUSBDeviceStructFromDeviceDescriptor(devs[index], &usbDevice);
-
-            if (Core::ERROR_NONE == status)
-            {
-                LOGINFO ("usbDevice.deviceClass: %u usbDevice.deviceSubclass:%u usbDevice.deviceName:%s devicePath:%s", 
-                                       usbDevice.deviceClass,
-                                       usbDevice.deviceSubclass,
-                                       usbDevice.deviceName.c_str(),
-                                       usbDevice.devicePath.c_str());
+        enumerateDevices();
+    }
 
-                usbDeviceList.emplace_back(usbDevice);
-            }
-          else
-            {
-                LOGWARN ("getUSBDeviceStructFromDeviceDescriptor Failed");
-            }
-        }
+    for (auto const& entry : _devices)
+    {
+        usbDeviceList.emplace_back(entry.second);
+    }
 
-        libusb_free_device_list(devs, 1);
-        if (Core::ERROR_NONE == status)
-        {
-            devices = (Core::Service<RPC::IteratorType<Exchange::IUSBDevice::IUSBDeviceIterator>>::Create<Exchange::IUSBDevice::IUSBDeviceIterator>(usbDeviceList));
-        }
+    if (false == usbDeviceList.empty())
+    {
+        devices = (Core::Service<RPC::IteratorType<Exchange::IUSBDevice::IUSBDeviceIterator>>::Create<Exchange::IUSBDevice::IUSBDeviceIterator>(usbDeviceList));
     }
     else
     {
         LOGWARN("USBDevice Not found");
-        status = Core::ERROR_NONE;
     }
     _adminLock.Unlock();
 
-    return status;
+    return Core::ERROR_NONE;
 }
 
 Core::hresult USBDeviceImplementation::GetDeviceInfo(const string &deviceName, USBDeviceInfo& deviceInfo) const
@@ -1016,12 +1103,17 @@ Core::hresult USBDeviceImplementation::GetDeviceInfo(const string &deviceName, U
 
     LOGINFO("GetDeviceInfo");
 
-    devCount = libusb_get_device_list(NULL, &devs);
-
-    LOGINFO("devCount:%zd", devCount);
+    auto cached = _deviceInfos.find(deviceName);
 
-    if (devCount > 0)
+    if (cached != _deviceInfos.end())
+    {
+        deviceInfo = cached->second;
+        status = Core::ERROR_NONE;
+    }
+    else if ((devCount = libusb_get_device_list(NULL, &devs)) > 0)
     {
+        LOGINFO("devCount:%zd", devCount);
+
         for (int index = 0; index < devCount; index++)
         {
             char usbDeviceName[10] = {0};
@@ -1064,6 +1156,16 @@ Core::hresult USBDeviceImplementation::GetDeviceInfo(const string &deviceName, U
             }
         }
         libusb_free_device_list(devs, 1);
+
+        /* Like the device table, a reading that is not final yet is taken again by the next query:
+           a mass storage device whose block node is not mapped or a device whose configuration
+           could not be read */
+        if ((Core::ERROR_NONE == status) && (true == _deviceCacheEnabled) &&
+            ((LIBUSB_CLASS_MASS_STORAGE != deviceInfo.device.deviceClass) || (false == deviceInfo.device.devicePath.empty())) &&
+            (WPEFramework::Exchange::IUSBDevice::USBDeviceStatus::DEVICE_STATUS_NO_DEVICE_CONNECTED != deviceInfo.deviceStatus))
+        {
+            _deviceInfos[deviceName] = deviceInfo;
+        }
     }
     else
     {
@@ -1143,6 +1245,13 @@ Core::hresult USBDeviceImplementation::BindDriver(const string &deviceName) cons
                     // Always close the device handle
                     libusb_close(devHandle);
                     devHandle = nullptr;
+
+                    if (Core::ERROR_NONE == status)
+                    {
+                        /* The block device comes or goes with the driver */
+                        _devicesEnumerated = false;
+                        _deviceInfos.erase(deviceName);
+                    }
                 }
                 break;
             }
@@ -1228,6 +1337,13 @@ Core::hresult USBDeviceImplementation::UnbindDriver(const string &deviceName) co
                     // Always close the device handle
                     libusb_close(devHandle);
                     devHandle = nullptr;
+
+                    if (Core::ERROR_NONE == status)
+                    {
+                        /* The block device comes or goes with the driver */
+                        _devicesEnumerated = false;
+                        _deviceInfos.erase(deviceName);
+                    }
                 }
                 break;
             }
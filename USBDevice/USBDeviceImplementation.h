@@ -24,6 +24,7 @@
 #include <interfaces/IUSBDevice.h>
 #include "tracing/Logging.h"
 #include <vector>
+#include <map>
 #include <thread>
 #include <fstream>
 #include <com/com.h>
@@ -153,6 +154,9 @@ namespace Plugin {
         static int libUSBHotPlugCallbackDeviceAttached(libusb_context *ctx, libusb_device *dev, libusb_hotplug_event event, void *user_data);
         static int libUSBHotPlugCallbackDeviceDetached(libusb_context *ctx, libusb_device *dev, libusb_hotplug_event event, void *user_data);
         void libUSBEventsHandlingThread(void);
+        void enumerateDevices(void) const;
+        void deviceAttached(const Exchange::IUSBDevice::USBDevice &usbDevice);
+        bool deviceDetached(const string &deviceName, Exchange::IUSBDevice::USBDevice &usbDevice);
 
     private:
         mutable Core::CriticalSection _adminLock;
@@ -161,6 +165,12 @@ namespace Plugin {
         bool _handlingUSBDeviceEvents;
         libusb_hotplug_callback_handle _hotPlugHandle[2];
 
+        // Kept current by the hotplug callbacks, so only valid while they are registered
+        bool _deviceCacheEnabled;
+        mutable bool _devicesEnumerated;
+        mutable std::map<string, Exchange::IUSBDevice::USBDevice> _devices;
+        mutable std::map<string, Exchange::IUSBDevice::USBDeviceInfo> _deviceInfos;
+
         friend class Job;
     };
 } // namespace Plugin
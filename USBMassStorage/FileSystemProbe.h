@@ -0,0 +1,143 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2025 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+// Tells the filesystem of a partition from the signatures in its first sectors, so the mount
+// type is known up front instead of found by failing mounts. Kept free of framework
+// dependencies so it can be tested on plain image files.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class FileSystemProbe {
+    public:
+        enum Type {
+            UNREADABLE, // nothing could be read, the type is unknown
+            UNKNOWN, // readable, but no signature recognized
+            FAT,
+            EXFAT,
+            NTFS,
+            EXT
+        };
+
+        // Boot sector plus the ext superblock, which starts at 1024
+        static constexpr uint32_t ProbeSize = 2048;
+
+    public:
+        FileSystemProbe() = delete;
+        FileSystemProbe(const FileSystemProbe&) = delete;
+        FileSystemProbe& operator=(const FileSystemProbe&) = delete;
+
+        // Only block devices are probed, anything else is reported UNREADABLE
+        static Type Probe(const char path[])
+        {
+            Type result = UNREADABLE;
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+            if (fd >= 0) {
+                struct stat info;
+
+                if ((::fstat(fd, &info) == 0) && (S_ISBLK(info.st_mode))) {
+                    result = Probe(fd);
+                }
+                ::close(fd);
+            }
+
+            return (result);
+        }
+
+        static Type Probe(const int fd)
+        {
+            uint8_t buffer[ProbeSize];
+            size_t length = 0;
+            ssize_t bytes;
+
+            while ((length < sizeof(buffer)) && (((bytes = ::pread(fd, &buffer[length], sizeof(buffer) - length, length)) > 0) || ((bytes < 0) && (errno == EINTR)))) {
+                length += (bytes > 0 ? bytes : 0);
+            }
+
+            return (length < 512 ? UNREADABLE : Identify(buffer, length));
+        }
+
+        static Type Identify(const uint8_t data[], const size_t length)
+        {
+            Type result = UNKNOWN;
+
+            if (length < 512) {
+                result = UNREADABLE;
+            } else if (::memcmp(&data[3], "EXFAT   ", 8) == 0) {
+                result = EXFAT;
+            } else if (::memcmp(&data[3], "NTFS    ", 8) == 0) {
+                result = NTFS;
+            } else if ((length >= 1082) && (LE16(&data[1080]) == 0xEF53)) {
+                result = EXT;
+            } else if (IsFAT(data) == true) {
+                result = FAT;
+            }
+
+            return (result);
+        }
+
+        static const char* Name(const Type type)
+        {
+            switch (type) {
+            case UNKNOWN: return ("unknown");
+            case FAT: return ("fat");
+            case EXFAT: return ("exfat");
+            case NTFS: return ("ntfs");
+            case EXT: return ("ext");
+            default: return ("unreadable");
+            }
+        }
+
+    private:
+        static uint16_t LE16(const uint8_t data[])
+        {
+            return (static_cast<uint16_t>(data[0] | (data[1] << 8)));
+        }
+
+        // FAT12/16/32 boot sector: jump, a sane BIOS parameter block and the 0x55AA signature.
+        // The type label is optional for FAT, so the BPB decides.
+        static bool IsFAT(const uint8_t data[])
+        {
+            const uint16_t bytesPerSector = LE16(&data[11]);
+            const uint8_t sectorsPerCluster = data[13];
+            const uint16_t reservedSectors = LE16(&data[14]);
+            const uint8_t fats = data[16];
+
+            return ((data[510] == 0x55) && (data[511] == 0xAA)
+                && ((data[0] == 0xE9) || ((data[0] == 0xEB) && (data[2] == 0x90)))
+                && ((bytesPerSector == 512) || (bytesPerSector == 1024) || (bytesPerSector == 2048) || (bytesPerSector == 4096))
+                && (sectorsPerCluster != 0) && ((sectorsPerCluster & (sectorsPerCluster - 1)) == 0)
+                && (reservedSectors != 0)
+                && ((fats == 1) || (fats == 2)));
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -25,15 +25,25 @@
 #include <sys/prctl.h>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <algorithm>
 #include <fstream>
+#include <dirent.h>
+#include <chrono>
+#include <sys/inotify.h>
 
 #include "USBMassStorageImplementation.h"
+#include "FileSystemProbe.h"
 #include "UtilsLogging.h"
 
 #define MEDIA_PATH             "/tmp/media"
 #define MOUNT_PATH             "/tmp/media/usb"
 #define FILE_SYSTEM_VFAT       "vfat"
 #define FILE_SYSTEM_EXFAT      "exfat"
+#define SYS_BLOCK_PATH         "/sys/block/"
+#define MOUNT_THREADS_MAX      4
+#define PARTITION_METRICS_TTL  2000 /* ms */
+#define PARTITION_METRICS_EVENTS (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO)
 
 using namespace std;
 
@@ -48,6 +58,14 @@ namespace Plugin {
     , _USB_DeviceNotification(*this)
     , _registeredEventHandlers(false)
     , _service(nullptr)
+    , _mountPointLock()
+    , _mountPointCount(0)
+    , _freeMountPoints()
+    , _metricsLock()
+    , _partitionMetrics()
+    , _metricsWatcher(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    , _metricsHits(0)
+    , _metricsMisses(0)
     {
         LOGINFO("Create USBMassStorageImplementation Instance");
         USBMassStorageImplementation::_instance = this;
@@ -96,6 +114,12 @@ namespace Plugin {
            _service->Release();
            _service = nullptr;
         }
+
+        if (_metricsWatcher != -1)
+        {
+            close(_metricsWatcher);
+            _metricsWatcher = -1;
+        }
     }
 
     void USBMassStorageImplementation::registerEventHandlers()
@@ -159,16 +183,69 @@ namespace Plugin {
 
     void USBMassStorageImplementation::Dispatch(Event event, USBStorageDeviceInfo storageDeviceInfo)
     {
+        std::list<Exchange::IUSBMassStorage::USBStorageMountInfo> mountInfoList;
+
+        if (USB_STORAGE_EVENT_MOUNT == event)
+        {
+            /* Mounting is done unlocked, so that devices plugged in together are mounted side by side.
+            The device is marked as being mounted, an unplug meanwhile is left to this job. */
+            _adminLock.Lock();
+            const bool mounting = (false == _mountsInProgress.emplace(storageDeviceInfo.deviceName, false).second);
+            _adminLock.Unlock();
+
+            if (true == mounting)
+            {
+                LOGWARN("Device %s is being mounted already", storageDeviceInfo.deviceName.c_str());
+                return;
+            }
+
+            DeviceMount(storageDeviceInfo, mountInfoList);
+        }
+
         _adminLock.Lock();
 
         switch(event)
         {
             case USB_STORAGE_EVENT_MOUNT:
-                DispatchMountEvent(storageDeviceInfo);
+            {
+                auto progress = _mountsInProgress.find(storageDeviceInfo.deviceName);
+                const bool unplugged = ((progress != _mountsInProgress.end()) && (true == progress->second));
+
+                if (progress != _mountsInProgress.end())
+                {
+                    _mountsInProgress.erase(progress);
+                }
+
+                if (true == unplugged)
+                {
+                    /* Never announced, so the partitions are undone without an event */
+                    LOGWARN("Device %s was unplugged while it was mounted", storageDeviceInfo.deviceName.c_str());
+                    for (const auto& mountInfo : mountInfoList)
+                    {
+                        PartitionUnmount(mountInfo);
+                    }
+                }
+                else
+                {
+                    DispatchMountEvent(storageDeviceInfo, mountInfoList);
+                }
                 break;
+            }
             case USB_STORAGE_EVENT_UNMOUNT:
-                DispatchUnMountEvent(storageDeviceInfo);
+            {
+                auto progress = _mountsInProgress.find(storageDeviceInfo.deviceName);
+
+                if (progress != _mountsInProgress.end())
+                {
+                    /* The mount job still runs, it unmounts what it mounted once it is done */
+                    progress->second = true;
+                }
+                else
+                {
+                    DispatchUnMountEvent(storageDeviceInfo);
+                }
                 break;
+            }
             default:
                 LOGERR("Unexpected event is received %u",event);
                 break;
@@ -177,78 +254,118 @@ namespace Plugin {
         _adminLock.Unlock();
     }
 
-    bool USBMassStorageImplementation::DeviceMount(const USBStorageDeviceInfo &storageDeviceInfo)
+    bool USBMassStorageImplementation::DevicePartitions(const string &deviceName, std::vector<string> &partitions)
     {
-        ifstream partitionsFile("/proc/partitions");
-        std::vector<std::string> partitions;
-        USBStorageMountFlags mountFlags = USBStorageMountFlags::READ_WRITE;
-        string line;
-        bool success = false;
-        size_t num_partitions = 0;
-        string prefix = "/dev/";
-        string partitionPath;
+        bool result = false;
+        DIR* dir = opendir((SYS_BLOCK_PATH + deviceName).c_str());
 
-        size_t pos = storageDeviceInfo.devicePath.find(prefix);
-        if (pos != std::string::npos)
+        if (nullptr != dir)
         {
-            partitionPath = storageDeviceInfo.devicePath.substr(pos + prefix.length());
+            struct dirent* entry;
+
+            /* Partitions of the device are listed as sub directories named after it, e.g. sda1 in /sys/block/sda */
+            while ((entry = readdir(dir)) != nullptr)
+            {
+                if ((strncmp(entry->d_name, deviceName.c_str(), deviceName.length()) == 0) && (entry->d_name[deviceName.length()] != '\0'))
+                {
+                    partitions.push_back("/dev/" + string(entry->d_name));
+                }
+            }
+            closedir(dir);
+
+            std::sort(partitions.begin(), partitions.end(), [](const string& lhs, const string& rhs) {
+                return ((lhs.length() < rhs.length()) || ((lhs.length() == rhs.length()) && (lhs < rhs)));
+            });
+
+            /* No partition table, the filesystem is on the device itself */
+            if (partitions.empty())
+            {
+                partitions.push_back("/dev/" + deviceName);
+            }
+            result = true;
+        }
+
+        return result;
+    }
+
+    string USBMassStorageImplementation::AllocateMountPoint()
+    {
+        uint32_t index;
+
+        _mountPointLock.Lock();
+        if (_freeMountPoints.empty())
+        {
+            index = ++_mountPointCount;
         }
         else
         {
-            partitionPath = storageDeviceInfo.devicePath;
+            index = _freeMountPoints.back();
+            _freeMountPoints.pop_back();
         }
-        LOGINFO("partitionPath [%s]", partitionPath.c_str());
+        _mountPointLock.Unlock();
+
+        return (MOUNT_PATH + std::to_string(index));
+    }
+
+    void USBMassStorageImplementation::ReleaseMountPoint(const string &mountPoint)
+    {
+        const size_t length = sizeof(MOUNT_PATH) - 1;
 
-        while (getline(partitionsFile, line))
+        if (mountPoint.compare(0, length, MOUNT_PATH) == 0)
         {
-            if (line.find(partitionPath) != std::string::npos && line != partitionPath)
+            const uint32_t index = static_cast<uint32_t>(strtoul(mountPoint.c_str() + length, nullptr, 10));
+
+            if (index != 0)
             {
-                string partition = "/dev/" + line.substr(line.find_last_of(' ') + 1); 
-                LOGINFO("Device path [%s], partition [%s]", storageDeviceInfo.devicePath.c_str(),partition.c_str());
-                partitions.push_back(partition);
+                _mountPointLock.Lock();
+                _freeMountPoints.push_back(index);
+                _mountPointLock.Unlock();
             }
         }
-        num_partitions = partitions.size();
-        LOGINFO("Device path[%s] Device Name[%s] num_partitions [%zd]",storageDeviceInfo.devicePath.c_str(),storageDeviceInfo.deviceName.c_str(),num_partitions-1);
+    }
 
-        if (!directoryExists(MEDIA_PATH))
+    bool USBMassStorageImplementation::PartitionMount(const string &partition, Exchange::IUSBMassStorage::USBStorageMountInfo &mountInfo)
+    {
+        bool mounted = false;
+
+        /* Identify the filesystem from its superblock so only the matching mount is attempted. If the
+        device can not be read, both types are tried as before. */
+        const FileSystemProbe::Type type = FileSystemProbe::Probe(partition.c_str());
+
+        if ((type != FileSystemProbe::FAT) && (type != FileSystemProbe::EXFAT) && (type != FileSystemProbe::UNREADABLE))
         {
-            if (mkdir(MEDIA_PATH, 0755) == -1)
-            {
-                LOGERR("Failed to create /tmp/media : %s",strerror(errno));
-            }
+            LOGWARN("Skipping [%s], filesystem [%s] is not supported", partition.c_str(), FileSystemProbe::Name(type));
         }
-
-        for (size_t i = 0; i < num_partitions; ++i)
+        else
         {
-            string partition = partitions[i];
-            string mountPoint;
-            Exchange::IUSBMassStorage::USBStorageMountInfo mountInfo = {};
-            int index = 1;
-
-            /* Skipping the mount path creation for partitions[0], as this is always device path(/dev/sdx). If there
-            is only one partition then we are creating the mount path on the device path (partitions[0]). */
-            if((num_partitions > 1) && (i == 0))
-            continue;
+            string mountPoint = AllocateMountPoint();
+            int result;
 
-            while (directoryExists(MOUNT_PATH + std::to_string(index)))
+            /* A directory left over from an earlier run keeps its index taken */
+            while (((result = mkdir(mountPoint.c_str(), 0755)) != 0) && (errno == EEXIST))
             {
-                ++index;
+                mountPoint = AllocateMountPoint();
             }
 
-            mountPoint = MOUNT_PATH + std::to_string(index);
             LOGINFO("MountPoint [%s]", mountPoint.c_str());
-            if (mkdir(mountPoint.c_str(), 0755) == 0)
+            if (result != 0)
+            {
+                LOGERR("Failed to create folder[%s] to mount device. Error[%s]", mountPoint.c_str(), strerror(errno));
+                ReleaseMountPoint(mountPoint);
+            }
+            else
             {
-                if ((mount(partition.c_str(), mountPoint.c_str(), FILE_SYSTEM_VFAT, 0, nullptr)) == 0)
+                if ((type != FileSystemProbe::EXFAT) && ((mount(partition.c_str(), mountPoint.c_str(), FILE_SYSTEM_VFAT, 0, nullptr)) == 0))
                 {
                     mountInfo.fileSystem = VFAT;
+                    mounted = true;
                     LOGINFO("filetype is vfat");
                 }
-                else if ((mount(partition.c_str(), mountPoint.c_str(), FILE_SYSTEM_EXFAT, 0, nullptr)) == 0)
+                else if ((type != FileSystemProbe::FAT) && ((mount(partition.c_str(), mountPoint.c_str(), FILE_SYSTEM_EXFAT, 0, nullptr)) == 0))
                 {
                     LOGINFO("filetype is exfat");
                     mountInfo.fileSystem = EXFAT;
+                    mounted = true;
                 }
                 else
                 {
@@ -257,42 +374,152 @@ namespace Plugin {
                     {
                         LOGERR("Directory[%s] removal is failed.", mountPoint.c_str());
                     }
-                    continue;
+                    else
+                    {
+                        ReleaseMountPoint(mountPoint);
+                    }
                 }
-                LOGINFO("[%s] is mounted successfully.",partition.c_str());
-                mountInfo.partitionName = partition;
-                mountInfo.mountFlags = mountFlags;
-                mountInfo.mountPath = mountPoint;
 
-                usbStorageMountInfo[storageDeviceInfo.deviceName].push_back(mountInfo);
-                success = true;
+                if (true == mounted)
+                {
+                    LOGINFO("[%s] is mounted successfully.",partition.c_str());
+                    mountInfo.partitionName = partition;
+                    mountInfo.mountFlags = USBStorageMountFlags::READ_WRITE;
+                    mountInfo.mountPath = mountPoint;
+                }
+            }
+        }
+
+        return mounted;
+    }
+
+    bool USBMassStorageImplementation::PartitionUnmount(const Exchange::IUSBMassStorage::USBStorageMountInfo &mountInfo)
+    {
+        bool unmounted = false;
+        int returnValue;
+
+        if ((returnValue = umount(mountInfo.mountPath.c_str())) == 0)
+        {
+            LOGINFO("Unmount successful");
+            if (rmdir(mountInfo.mountPath.c_str()) != 0)
+            {
+                LOGERR("Failed to remove mount path: %s",mountInfo.mountPath.c_str());
             }
             else
             {
-                LOGERR("Failed to create folder[%s] to mount device. Error[%s]", mountPoint.c_str(), strerror(errno));
+                ReleaseMountPoint(mountInfo.mountPath);
             }
+            ForgetPartitionMetrics(mountInfo.mountPath);
+            unmounted = true;
         }
-        return success;
+        else
+        {
+            LOGERR("Failed to unmount: %s, error %d",mountInfo.mountPath.c_str(),returnValue);
+        }
+
+        return unmounted;
     }
 
-    void USBMassStorageImplementation::DispatchMountEvent(const USBStorageDeviceInfo &storageDeviceInfo)
+    bool USBMassStorageImplementation::DeviceMount(const USBStorageDeviceInfo &storageDeviceInfo, std::list<Exchange::IUSBMassStorage::USBStorageMountInfo> &mountInfoList)
     {
-        Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator* mountPoints = nullptr;
+        std::vector<std::string> partitions;
+        bool success = false;
+        string prefix = "/dev/";
+        string partitionPath;
+
+        size_t pos = storageDeviceInfo.devicePath.find(prefix);
+        if (pos != std::string::npos)
+        {
+            partitionPath = storageDeviceInfo.devicePath.substr(pos + prefix.length());
+        }
+        else
+        {
+            partitionPath = storageDeviceInfo.devicePath;
+        }
+        LOGINFO("partitionPath [%s]", partitionPath.c_str());
 
-        if ( true == DeviceMount(storageDeviceInfo))
+        if (false == DevicePartitions(partitionPath, partitions))
         {
-            if (usbStorageMountInfo[storageDeviceInfo.deviceName].empty())
+            /* sysfs is not available, look the device up among all block devices */
+            ifstream partitionsFile("/proc/partitions");
+            string line;
+
+            while (getline(partitionsFile, line))
             {
-                LOGERR("Empty Mount info list");
+                if (line.find(partitionPath) != std::string::npos && line != partitionPath)
+                {
+                    string partition = "/dev/" + line.substr(line.find_last_of(' ') + 1);
+                    LOGINFO("Device path [%s], partition [%s]", storageDeviceInfo.devicePath.c_str(),partition.c_str());
+                    partitions.push_back(partition);
+                }
             }
-            else
+
+            /* partitions[0] is always the device path(/dev/sdx), it is only mounted if there is no other partition. */
+            if (partitions.size() > 1)
             {
-                usbStorageDeviceInfo.push_back(storageDeviceInfo);
-                /* mount info list updated, and Iterator create to send to clients */
-                mountPoints = (Core::Service<RPC::IteratorType<Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator>> \
-                                ::Create<Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator>(usbStorageMountInfo[storageDeviceInfo.deviceName]));
-                LOGINFO("Device mounted");
+                partitions.erase(partitions.begin());
             }
+        }
+        LOGINFO("Device path[%s] Device Name[%s] num_partitions [%zd]",storageDeviceInfo.devicePath.c_str(),storageDeviceInfo.deviceName.c_str(),partitions.size());
+
+        if (!directoryExists(MEDIA_PATH))
+        {
+            if (mkdir(MEDIA_PATH, 0755) == -1)
+            {
+                LOGERR("Failed to create /tmp/media : %s",strerror(errno));
+            }
+        }
+
+        /* Partitions are probed and mounted by up to MOUNT_THREADS_MAX threads, this one included. The
+        results are kept in partition order. */
+        std::vector<Exchange::IUSBMassStorage::USBStorageMountInfo> mountInfos(partitions.size());
+        std::vector<uint8_t> mounted(partitions.size(), 0);
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> threads;
+
+        auto worker = [&]() {
+            size_t index;
+            while ((index = next++) < partitions.size())
+            {
+                mounted[index] = (PartitionMount(partitions[index], mountInfos[index]) ? 1 : 0);
+            }
+        };
+
+        for (size_t i = 1; i < std::min<size_t>(partitions.size(), MOUNT_THREADS_MAX); ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < partitions.size(); ++i)
+        {
+            if (mounted[i] != 0)
+            {
+                mountInfoList.push_back(mountInfos[i]);
+                success = true;
+            }
+        }
+        return success;
+    }
+
+    void USBMassStorageImplementation::DispatchMountEvent(const USBStorageDeviceInfo &storageDeviceInfo, std::list<Exchange::IUSBMassStorage::USBStorageMountInfo> &mountInfoList)
+    {
+        Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator* mountPoints = nullptr;
+
+        if (false == mountInfoList.empty())
+        {
+            std::list<Exchange::IUSBMassStorage::USBStorageMountInfo>& deviceMountInfo = usbStorageMountInfo[storageDeviceInfo.deviceName];
+
+            deviceMountInfo.splice(deviceMountInfo.end(), mountInfoList);
+            usbStorageDeviceInfo.push_back(storageDeviceInfo);
+            /* mount info list updated, and Iterator create to send to clients */
+            mountPoints = (Core::Service<RPC::IteratorType<Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator>> \
+                            ::Create<Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator>(deviceMountInfo));
+            LOGINFO("Device mounted");
 
             if (mountPoints != nullptr)
             {
@@ -316,7 +543,6 @@ namespace Plugin {
     {
         Exchange::IUSBMassStorage::IUSBStorageMountInfoIterator* mountPoints = nullptr;
         auto mountInfoList = usbStorageMountInfo.find(storageDeviceInfo.deviceName);
-        int returnValue;
         bool success = false;
 
         if (mountInfoList == usbStorageMountInfo.end())
@@ -337,19 +563,10 @@ namespace Plugin {
         {
             for (const auto& mountInfo : mountInfoList->second)
             {
-                if ((returnValue = umount(mountInfo.mountPath.c_str())) == 0)
+                if (true == PartitionUnmount(mountInfo))
                 {
-                    LOGINFO("Unmount successful");
-                    if (rmdir(mountInfo.mountPath.c_str()) != 0)
-                    {
-                        LOGERR("Failed to remove mount path: %s",mountInfo.mountPath.c_str());
-                    }
                     success = true;
                 }
-                else
-                {
-                    LOGERR("Failed to unmount: %s, error %d",mountInfo.mountPath.c_str(),returnValue);
-                }
             }
         }
 
@@ -415,7 +632,7 @@ namespace Plugin {
 
                     /* storage info list updated */
                     usbStorageDeviceInfo.push_back(storageDeviceInfo);
-                    if (true == DeviceMount(storageDeviceInfo))
+                    if (true == DeviceMount(storageDeviceInfo, usbStorageMountInfo[storageDeviceInfo.deviceName]))
                     {
                         LOGINFO("Device is mounted Successfully");
                     }
@@ -521,7 +738,7 @@ namespace Plugin {
                     {
                         LOGERR("instance is null");
                     }
-                    else if ( true == USBMassStorageImplementation::_instance->DeviceMount(storageDeviceInfo))
+                    else if ( true == USBMassStorageImplementation::_instance->DeviceMount(storageDeviceInfo, USBMassStorageImplementation::_instance->usbStorageMountInfo[storageDeviceInfo.deviceName]))
                     {
                         if (USBMassStorageImplementation::_instance->usbStorageMountInfo[storageDeviceInfo.deviceName].empty())
                         {
@@ -588,6 +805,10 @@ namespace Plugin {
                 errorCode = Core::ERROR_INVALID_MOUNTPOINT;
                 LOGERR("device path is not found in list");
             }
+            else if (true == CachedPartitionMetrics(mountPath, partitionInfo))
+            {
+                errorCode = Core::ERROR_NONE;
+            }
             else
             {
                 LOGINFO("Partition path: %s, Mount path: %s",devicePath.c_str(),mountPath.c_str());
@@ -633,6 +854,7 @@ namespace Plugin {
                         LOGINFO("PartitionInfo, fileSystem[%u],partition size[%lu MB] numSectors[%lu] sectorSize[%u]totalSpace[%u]usedSpace[%u]availableSpace[%u]",
                                         partitionInfo.fileSystem,(long)size, (long)partitionInfo.numSectors, partitionInfo.sectorSize,partitionInfo.totalSpace,partitionInfo.usedSpace,partitionInfo.availableSpace);
 
+                        StorePartitionMetrics(mountPath, partitionInfo);
                         errorCode = Core::ERROR_NONE;
                     }
                     close(fd);
@@ -642,6 +864,105 @@ namespace Plugin {
         return errorCode;
     }
 
+    /* Media browsers poll the partition info for the free space. It is served from a cache that expires
+    after PARTITION_METRICS_TTL ms, or as soon as the root of the mount is written to. Writes deeper in
+    the tree are only picked up when the entry expires. */
+    bool USBMassStorageImplementation::CachedPartitionMetrics(const string &mountPath, Exchange::IUSBMassStorage::USBStoragePartitionInfo &partitionInfo) const
+    {
+        bool result = false;
+        const uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        _metricsLock.Lock();
+
+        if (_metricsWatcher != -1)
+        {
+            char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            ssize_t length;
+
+            while ((length = read(_metricsWatcher, buffer, sizeof(buffer))) > 0)
+            {
+                for (const char* cursor = buffer; cursor < (buffer + length); )
+                {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(cursor);
+
+                    for (auto& entry : _partitionMetrics)
+                    {
+                        if ((event->wd == entry.second.watch) || (event->mask & IN_Q_OVERFLOW))
+                        {
+                            entry.second.expiry = 0;
+                        }
+                    }
+                    cursor += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+
+        auto it = _partitionMetrics.find(mountPath);
+        if ((it != _partitionMetrics.end()) && (now < it->second.expiry))
+        {
+            partitionInfo = it->second.info;
+            _metricsHits++;
+            result = true;
+        }
+        else
+        {
+            _metricsMisses++;
+        }
+
+        _metricsLock.Unlock();
+
+        return result;
+    }
+
+    void USBMassStorageImplementation::StorePartitionMetrics(const string &mountPath, const Exchange::IUSBMassStorage::USBStoragePartitionInfo &partitionInfo) const
+    {
+        const uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        _metricsLock.Lock();
+
+        auto it = _partitionMetrics.find(mountPath);
+        if (it == _partitionMetrics.end())
+        {
+            PartitionMetrics metrics = {};
+            metrics.watch = (_metricsWatcher != -1 ? inotify_add_watch(_metricsWatcher, mountPath.c_str(), PARTITION_METRICS_EVENTS) : -1);
+            if (metrics.watch == -1)
+            {
+                LOGWARN("Not watching [%s] for writes, error %s", mountPath.c_str(), strerror(errno));
+            }
+            it = _partitionMetrics.emplace(mountPath, metrics).first;
+        }
+        it->second.info = partitionInfo;
+        it->second.expiry = now + PARTITION_METRICS_TTL;
+
+        _metricsLock.Unlock();
+    }
+
+    void USBMassStorageImplementation::ForgetPartitionMetrics(const string &mountPath)
+    {
+        _metricsLock.Lock();
+
+        auto it = _partitionMetrics.find(mountPath);
+        if (it != _partitionMetrics.end())
+        {
+            if (it->second.watch != -1)
+            {
+                inotify_rm_watch(_metricsWatcher, it->second.watch);
+            }
+            _partitionMetrics.erase(it);
+        }
+        LOGINFO("Partition info cache: %u hits, %u misses", _metricsHits, _metricsMisses);
+
+        _metricsLock.Unlock();
+    }
+
+    void USBMassStorageImplementation::PartitionMetricsStatistics(uint32_t &hits, uint32_t &misses) const
+    {
+        _metricsLock.Lock();
+        hits = _metricsHits;
+        misses = _metricsMisses;
+        _metricsLock.Unlock();
+    }
+
     void USBMassStorageImplementation::OnDevicePluggedIn(const USBDevice &device)
     {
         if ( LIBUSB_CLASS_MASS_STORAGE == device.deviceClass )
@@ -159,13 +159,23 @@ namespace Plugin {
         static USBMassStorageImplementation* _instance;
         static bool directoryExists(const string& path);
 
+        // Partition info cache hits and misses since activation
+        void PartitionMetricsStatistics(uint32_t &hits, uint32_t &misses) const;
+
         void OnDevicePluggedIn(const USBDevice &device);
         void OnDevicePluggedOut(const USBDevice &device);
         void registerEventHandlers();
 
     private:
+        struct PartitionMetrics {
+            Exchange::IUSBMassStorage::USBStoragePartitionInfo info;
+            uint64_t expiry; // steady clock, ms
+            int watch; // inotify watch on the mount root, -1 if none
+        };
+
         std::list<USBStorageDeviceInfo> usbStorageDeviceInfo;
         std::map<string /*<device name>*/,std::list<Exchange::IUSBMassStorage::USBStorageMountInfo>> usbStorageMountInfo;
+        std::map<string /*<device name>*/, bool /*<unplugged>*/> _mountsInProgress;
 
         mutable Core::CriticalSection _adminLock;
         Exchange::IUSBDevice* _remoteUSBDeviceObject;
@@ -173,12 +183,28 @@ namespace Plugin {
         Core::Sink<USBDeviceNotification> _USB_DeviceNotification;
         bool _registeredEventHandlers;
         PluginHost::IShell* _service;
+        Core::CriticalSection _mountPointLock;
+        uint32_t _mountPointCount;
+        std::vector<uint32_t> _freeMountPoints;
+        mutable Core::CriticalSection _metricsLock;
+        mutable std::map<string /*<mount path>*/, PartitionMetrics> _partitionMetrics;
+        int _metricsWatcher;
+        mutable uint32_t _metricsHits;
+        mutable uint32_t _metricsMisses;
 
         void MountDevicesOnBootUp();
-        bool DeviceMount(const USBStorageDeviceInfo &storageDeviceInfo);
+        static bool DevicePartitions(const string &deviceName, std::vector<string> &partitions);
+        string AllocateMountPoint();
+        void ReleaseMountPoint(const string &mountPoint);
+        bool PartitionMount(const string &partition, Exchange::IUSBMassStorage::USBStorageMountInfo &mountInfo);
+        bool PartitionUnmount(const Exchange::IUSBMassStorage::USBStorageMountInfo &mountInfo);
+        bool DeviceMount(const USBStorageDeviceInfo &storageDeviceInfo, std::list<Exchange::IUSBMassStorage::USBStorageMountInfo> &mountInfoList);
         void Dispatch(Event event, USBStorageDeviceInfo params);
-        void DispatchMountEvent(const USBStorageDeviceInfo &storageDeviceInfo);
+        void DispatchMountEvent(const USBStorageDeviceInfo &storageDeviceInfo, std::list<Exchange::IUSBMassStorage::USBStorageMountInfo> &mountInfoList);
         void DispatchUnMountEvent(USBStorageDeviceInfo &storageDeviceInfo);
+        bool CachedPartitionMetrics(const string &mountPath, Exchange::IUSBMassStorage::USBStoragePartitionInfo &partitionInfo) const;
+        void StorePartitionMetrics(const string &mountPath, const Exchange::IUSBMassStorage::USBStoragePartitionInfo &partitionInfo) const;
+        void ForgetPartitionMetrics(const string &mountPath);
         USBStorageFileSystem GetFileSystemType(__fsword_t f_type) const;
 
         friend class Job;
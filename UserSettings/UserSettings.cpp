@@ -94,6 +94,7 @@ namespace WPEFramework
             _userSetting->Register(&_usersettingsNotification);
             // Invoking Plugin API register to wpeframework
             Exchange::JUserSettings::Register(*this, _userSetting);
+            Register<void, JsonObject>(_T("getAll"), &UserSettings::endpoint_getAll, this);
 
             _userSettingsInspector = _userSetting->QueryInterface<Exchange::IUserSettingsInspector>();
             if (_userSettingsInspector != nullptr)
@@ -132,6 +133,7 @@ namespace WPEFramework
         {
             _userSetting->Unregister(&_usersettingsNotification);
             Exchange::JUserSettings::Unregister(*this);
+            Unregister(_T("getAll"));
             Exchange::JUserSettingsInspector::Unregister(*this);
 
             configure->Release();
@@ -175,6 +177,51 @@ namespace WPEFramework
        return (string());
     }
 
+    // Every setting in one call, so a UI does not need a round trip per setting at startup. The
+    // getters are served from the implementation's snapshot. The content PIN is left out on purpose.
+    uint32_t UserSettings::endpoint_getAll(JsonObject& response)
+    {
+        uint32_t result = Core::ERROR_NONE;
+        bool enabled = false;
+        double rate = 0;
+        string value;
+
+        ASSERT(nullptr != _userSetting);
+
+#define USERSETTINGS_GET(getter, key, variable) \
+        if (Core::ERROR_NONE == result) \
+        { \
+            result = _userSetting->getter(variable); \
+            if (Core::ERROR_NONE == result) \
+            { \
+                response[_T(key)] = variable; \
+            } \
+        }
+
+        USERSETTINGS_GET(GetAudioDescription, "audioDescription", enabled)
+        USERSETTINGS_GET(GetPreferredAudioLanguages, "preferredAudioLanguages", value)
+        USERSETTINGS_GET(GetPresentationLanguage, "presentationLanguage", value)
+        USERSETTINGS_GET(GetCaptions, "captions", enabled)
+        USERSETTINGS_GET(GetPreferredCaptionsLanguages, "preferredCaptionsLanguages", value)
+        USERSETTINGS_GET(GetPreferredClosedCaptionService, "preferredClosedCaptionsService", value)
+        USERSETTINGS_GET(GetPrivacyMode, "privacyMode", value)
+        USERSETTINGS_GET(GetPinControl, "pinControl", enabled)
+        USERSETTINGS_GET(GetViewingRestrictions, "viewingRestrictions", value)
+        USERSETTINGS_GET(GetViewingRestrictionsWindow, "viewingRestrictionsWindow", value)
+        USERSETTINGS_GET(GetLiveWatershed, "liveWatershed", enabled)
+        USERSETTINGS_GET(GetPlaybackWatershed, "playbackWatershed", enabled)
+        USERSETTINGS_GET(GetBlockNotRatedContent, "blockNotRatedContent", enabled)
+        USERSETTINGS_GET(GetPinOnPurchase, "pinOnPurchase", enabled)
+        USERSETTINGS_GET(GetHighContrast, "highContrast", enabled)
+        USERSETTINGS_GET(GetVoiceGuidance, "voiceGuidance", enabled)
+        USERSETTINGS_GET(GetVoiceGuidanceRate, "voiceGuidanceRate", rate)
+        USERSETTINGS_GET(GetVoiceGuidanceHints, "voiceGuidanceHints", enabled)
+
+#undef USERSETTINGS_GET
+
+        return result;
+    }
+
     void UserSettings::Deactivated(RPC::IRemoteConnection* connection)
     {
         if (connection->Id() == _connectionId) {
@@ -213,6 +213,7 @@ namespace Plugin {
 
         private:
             void Deactivated(RPC::IRemoteConnection* connection);
+            uint32_t endpoint_getAll(JsonObject& response);
 
         private:
             PluginHost::IShell* _service{};
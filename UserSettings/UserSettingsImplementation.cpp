@@ -68,6 +68,67 @@ const std::map<Exchange::IUserSettingsInspector::SettingsKey, string> UserSettin
          {Exchange::IUserSettingsInspector::SettingsKey::CONTENT_PIN, USERSETTINGS_CONTENT_PIN_KEY}};
 
 
+const char* const UserSettingsImplementation::_settingKeys[SETTING_COUNT] =
+                        {USERSETTINGS_AUDIO_DESCRIPTION_KEY,
+                         USERSETTINGS_PREFERRED_AUDIO_LANGUAGES_KEY,
+                         USERSETTINGS_PRESENTATION_LANGUAGE_KEY,
+                         USERSETTINGS_CAPTIONS_KEY,
+                         USERSETTINGS_PREFERRED_CAPTIONS_LANGUAGES_KEY,
+                         USERSETTINGS_PREFERRED_CLOSED_CAPTIONS_SERVICE_KEY,
+                         USERSETTINGS_PRIVACY_MODE_KEY,
+                         USERSETTINGS_PIN_CONTROL_KEY,
+                         USERSETTINGS_VIEWING_RESTRICTIONS_KEY,
+                         USERSETTINGS_VIEWING_RESTRICTIONS_WINDOW_KEY,
+                         USERSETTINGS_LIVE_WATERSHED_KEY,
+                         USERSETTINGS_PLAYBACK_WATERSHED_KEY,
+                         USERSETTINGS_BLOCK_NOT_RATED_CONTENT_KEY,
+                         USERSETTINGS_PIN_ON_PURCHASE_KEY,
+                         USERSETTINGS_HIGH_CONTRAST_KEY,
+                         USERSETTINGS_VOICE_GUIDANCE_KEY,
+                         USERSETTINGS_VOICE_GUIDANCE_RATE_KEY,
+                         USERSETTINGS_VOICE_GUIDANCE_HINTS_KEY,
+                         USERSETTINGS_CONTENT_PIN_KEY};
+
+const UserSettingsImplementation::SettingEvent UserSettingsImplementation::_settingEvents[SETTING_COUNT] =
+                        {{AUDIO_DESCRIPTION_CHANGED, BOOLEAN},
+                         {PREFERRED_AUDIO_CHANGED, TEXT},
+                         {PRESENTATION_LANGUAGE_CHANGED, TEXT},
+                         {CAPTIONS_CHANGED, BOOLEAN},
+                         {PREFERRED_CAPTIONS_LANGUAGE_CHANGED, TEXT},
+                         {PREFERRED_CLOSED_CAPTIONS_SERVICE_CHANGED, TEXT},
+                         {PRIVACY_MODE_CHANGED, TEXT},
+                         {PIN_CONTROL_CHANGED, BOOLEAN},
+                         {VIEWING_RESTRICTIONS_CHANGED, TEXT},
+                         {VIEWING_RESTRICTIONS_WINDOW_CHANGED, TEXT},
+                         {LIVE_WATERSHED_CHANGED, BOOLEAN},
+                         {PLAYBACK_WATERSHED_CHANGED, BOOLEAN},
+                         {BLOCK_NOT_RATED_CONTENT_CHANGED, BOOLEAN},
+                         {PIN_ON_PURCHASE_CHANGED, BOOLEAN},
+                         {HIGH_CONTRAST_CHANGED, BOOLEAN},
+                         {VOICE_GUIDANCE_CHANGED, BOOLEAN},
+                         {VOICE_GUIDANCE_RATE_CHANGED, NUMBER},
+                         {VOICE_GUIDANCE_HINTS_CHANGED, BOOLEAN},
+                         {CONTENT_PIN_CHANGED, TEXT}};
+
+// Built from _settingKeys, so a setting added there is found without touching the lookup
+const std::unordered_map<string, UserSettingsImplementation::Setting> UserSettingsImplementation::_settingIndex = []()
+{
+    std::unordered_map<string, Setting> index(SETTING_COUNT);
+    for (uint8_t setting = 0; setting < SETTING_COUNT; setting++)
+    {
+        index.emplace(_settingKeys[setting], static_cast<Setting>(setting));
+    }
+    return index;
+}();
+
+void UserSettingsImplementation::parseSetting(const string& text, SettingValue& value)
+{
+    value.Loaded = true;
+    value.Boolean = (0 == text.compare("true"));
+    value.Number = text.empty() ? 0 : std::strtod(text.c_str(), nullptr);
+    value.Text = text;
+}
+
 const double UserSettingsImplementation::minVGR = 0.1;
 const double UserSettingsImplementation::maxVGR = 10;
 
@@ -75,7 +136,10 @@ SERVICE_REGISTRATION(UserSettingsImplementation, 1, 0);
 
 UserSettingsImplementation::UserSettingsImplementation()
 : _adminLock()
+, _snapshotLock()
+, _snapshot(std::make_shared<Snapshot>())
 , _remotStoreObject(nullptr)
+, _storeInspector(nullptr)
 , _storeNotification(*this)
 , _registeredEventHandlers(false)
 , _service(nullptr)
@@ -97,7 +161,16 @@ uint32_t UserSettingsImplementation::Configure(PluginHost::IShell* service)
         _remotStoreObject = _service->QueryInterfaceByCallsign<WPEFramework::Exchange::IStore2>("org.rdk.PersistentStore");
         if (_remotStoreObject != nullptr)
         {
+            // Registered first, so no change is lost while the snapshot loads
             registerEventHandlers();
+            loadSnapshot();
+
+            // Optional, without it the migration states are read key by key
+            _storeInspector = _remotStoreObject->QueryInterface<WPEFramework::Exchange::IStoreInspector>();
+            if (_storeInspector == nullptr)
+            {
+                LOGWARN("IStoreInspector is not available");
+            }
         }
         else
         {
@@ -130,6 +203,11 @@ UserSettingsImplementation* UserSettingsImplementation::instance(UserSettingsImp
 UserSettingsImplementation::~UserSettingsImplementation()
 {
     LOGINFO("UserSettingsImplementation Destructor");
+    if(_storeInspector)
+    {
+        _storeInspector->Release();
+        _storeInspector = nullptr;
+    }
     if(_remotStoreObject)
     {
         _remotStoreObject->Release();
@@ -384,86 +462,123 @@ void UserSettingsImplementation::ValueChanged(const Exchange::IStore2::ScopeType
 {
     LOGINFO("ns:%s key:%s value:%s", ns.c_str(), key.c_str(), value.c_str());
 
-    if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_AUDIO_DESCRIPTION_KEY)))
+    Setting setting;
+    if ((0 == ns.compare(USERSETTINGS_NAMESPACE)) && settingOf(key, setting))
     {
-        dispatchEvent(AUDIO_DESCRIPTION_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PREFERRED_AUDIO_LANGUAGES_KEY)))
-    {
-        dispatchEvent(PREFERRED_AUDIO_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PRESENTATION_LANGUAGE_KEY)))
-    {
-        dispatchEvent(PRESENTATION_LANGUAGE_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_CAPTIONS_KEY)))
-    {
-        dispatchEvent(CAPTIONS_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PREFERRED_CAPTIONS_LANGUAGES_KEY)))
-    {
-        dispatchEvent(PREFERRED_CAPTIONS_LANGUAGE_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PREFERRED_CLOSED_CAPTIONS_SERVICE_KEY)))
-    {
-        dispatchEvent(PREFERRED_CLOSED_CAPTIONS_SERVICE_CHANGED, JsonValue((string)value));
-    }
-    else if((ns.compare(USERSETTINGS_NAMESPACE) == 0) && (key.compare(USERSETTINGS_PRIVACY_MODE_KEY) == 0))
-    {
-        dispatchEvent(PRIVACY_MODE_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PIN_CONTROL_KEY)))
-    {
-        dispatchEvent(PIN_CONTROL_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_VIEWING_RESTRICTIONS_KEY)))
-    {
-        dispatchEvent(VIEWING_RESTRICTIONS_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_VIEWING_RESTRICTIONS_WINDOW_KEY)))
-    {
-        dispatchEvent(VIEWING_RESTRICTIONS_WINDOW_CHANGED, JsonValue((string)value));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_LIVE_WATERSHED_KEY)))
-    {
-        dispatchEvent(LIVE_WATERSHED_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PLAYBACK_WATERSHED_KEY)))
-    {
-        dispatchEvent(PLAYBACK_WATERSHED_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
-    }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_BLOCK_NOT_RATED_CONTENT_KEY)))
-    {
-        dispatchEvent(BLOCK_NOT_RATED_CONTENT_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
+        updateSnapshot(setting, value, true);
+
+        SettingValue parsed;
+        parseSetting(value, parsed);
+
+        const SettingEvent& event = _settingEvents[setting];
+        switch (event.Type)
+        {
+            case BOOLEAN:
+                dispatchEvent(event.Notification, JsonValue(parsed.Boolean));
+                break;
+            case NUMBER:
+                dispatchEvent(event.Notification, JsonValue(parsed.Number));
+                break;
+            default:
+                dispatchEvent(event.Notification, JsonValue(parsed.Text));
+                break;
+        }
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_PIN_ON_PURCHASE_KEY)))
+    else
     {
-        dispatchEvent(PIN_ON_PURCHASE_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
+        LOGERR("Not supported");
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_HIGH_CONTRAST_KEY)))
+}
+
+bool UserSettingsImplementation::settingOf(const string& key, Setting& setting)
+{
+    auto entry = _settingIndex.find(key);
+    if (entry != _settingIndex.end())
     {
-        dispatchEvent(HIGH_CONTRAST_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
+        setting = entry->second;
+        return true;
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_VOICE_GUIDANCE_KEY)))
+    return false;
+}
+
+void UserSettingsImplementation::loadSnapshot()
+{
+    Snapshot loaded;
+    uint32_t count = 0;
+
+    for (uint8_t index = 0; index < SETTING_COUNT; index++)
     {
-        dispatchEvent(VOICE_GUIDANCE_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
+        const string key(_settingKeys[index]);
+        string value;
+        uint32_t ttl = 0;
+        uint32_t status = _remotStoreObject->GetValue(Exchange::IStore2::ScopeType::DEVICE, USERSETTINGS_NAMESPACE, key, value, ttl);
+
+        // Settings that could not be read or are not stored stay out of the snapshot and are read from
+        // the store on use. No event tells when a key is deleted, so only stored values are cached.
+        if (Core::ERROR_NONE == status)
+        {
+            parseSetting(value, loaded[index]);
+            count++;
+        }
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_VOICE_GUIDANCE_RATE_KEY)))
+
+    _snapshotLock.Lock();
+
+    std::shared_ptr<Snapshot> merged = std::make_shared<Snapshot>(*_snapshot);
+    for (uint8_t index = 0; index < SETTING_COUNT; index++)
     {
-        dispatchEvent(VOICE_GUIDANCE_RATE_CHANGED, JsonValue((double)(std::stod(value))));
+        // A ValueChanged that arrived during the load is newer than what was read
+        if (!(*merged)[index].Loaded)
+        {
+            (*merged)[index] = loaded[index];
+        }
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_VOICE_GUIDANCE_HINTS_KEY)))
+    std::atomic_store(&_snapshot, std::shared_ptr<const Snapshot>(merged));
+
+    _snapshotLock.Unlock();
+
+    LOGINFO("Loaded %u of %u settings", count, static_cast<uint32_t>(SETTING_COUNT));
+}
+
+void UserSettingsImplementation::updateSnapshot(const Setting setting, const string& text, const bool overwrite) const
+{
+    _snapshotLock.Lock();
+
+    if (overwrite || !(*_snapshot)[setting].Loaded)
     {
-        dispatchEvent(VOICE_GUIDANCE_HINTS_CHANGED, JsonValue((bool)(value.compare("true")==0)?true:false));
+        std::shared_ptr<Snapshot> updated = std::make_shared<Snapshot>(*_snapshot);
+        parseSetting(text, (*updated)[setting]);
+        std::atomic_store(&_snapshot, std::shared_ptr<const Snapshot>(updated));
     }
-    else if(0 == (ns.compare(USERSETTINGS_NAMESPACE)) && (0 == key.compare(USERSETTINGS_CONTENT_PIN_KEY)))
+
+    _snapshotLock.Unlock();
+}
+
+uint32_t UserSettingsImplementation::getSetting(const Setting setting, SettingValue& value) const
+{
+    uint32_t status = Core::ERROR_NONE;
+    const std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
+
+    if ((*snapshot)[setting].Loaded)
     {
-        dispatchEvent(CONTENT_PIN_CHANGED, JsonValue((string)value));
+        value = (*snapshot)[setting];
     }
     else
     {
-        LOGERR("Not supported");
+        string text;
+        bool stored = false;
+        status = GetUserSettingsValue(_settingKeys[setting], text, stored);
+        if (Core::ERROR_NONE == status)
+        {
+            parseSetting(text, value);
+            if (stored)
+            {
+                updateSnapshot(setting, text, false);
+            }
+        }
     }
+
+    return status;
 }
 
 uint32_t UserSettingsImplementation::SetUserSettingsValue(const string& key, const string& value)
@@ -481,13 +596,20 @@ uint32_t UserSettingsImplementation::SetUserSettingsValue(const string& key, con
         LOGERR("_remotStoreObject is null");
     }
     _adminLock.Unlock();
+
+    Setting setting;
+    if ((Core::ERROR_NONE == status) && settingOf(key, setting))
+    {
+        updateSnapshot(setting, value, true);
+    }
     return status;
 }
 
-uint32_t UserSettingsImplementation::GetUserSettingsValue(const string& key, string &value) const
+uint32_t UserSettingsImplementation::GetUserSettingsValue(const string& key, string &value, bool& stored) const
 {
     uint32_t status = Core::ERROR_GENERAL;
     uint32_t ttl = 0;
+    stored = false;
     _adminLock.Lock();
 
     LOGINFO("Key[%s]", key.c_str());
@@ -495,6 +617,7 @@ uint32_t UserSettingsImplementation::GetUserSettingsValue(const string& key, str
     {
         status = _remotStoreObject->GetValue(Exchange::IStore2::ScopeType::DEVICE, USERSETTINGS_NAMESPACE, key, value, ttl);
         LOGINFO("Key[%s] value[%s] status[%d]", key.c_str(), value.c_str(), status);
+        stored = (Core::ERROR_NONE == status);
         if(Core::ERROR_UNKNOWN_KEY == status || Core::ERROR_NOT_EXIST == status)
         {
             if(usersettingsDefaultMap.find(key)!=usersettingsDefaultMap.end())
@@ -529,22 +652,13 @@ Core::hresult UserSettingsImplementation::SetAudioDescription(const bool enabled
 
 Core::hresult UserSettingsImplementation::GetAudioDescription(bool &enabled) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(AUDIO_DESCRIPTION, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_AUDIO_DESCRIPTION_KEY, value);
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            enabled = true;
-        }
-        else
-        {
-            enabled = false;
-        }
+        enabled = value.Boolean;
     }
-
     return status;
 }
 
@@ -559,10 +673,13 @@ Core::hresult UserSettingsImplementation::SetPreferredAudioLanguages(const strin
 
 Core::hresult UserSettingsImplementation::GetPreferredAudioLanguages(string &preferredLanguages) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(PREFERRED_AUDIO_LANGUAGES, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_PREFERRED_AUDIO_LANGUAGES_KEY, preferredLanguages);
+    if(Core::ERROR_NONE == status)
+    {
+        preferredLanguages = value.Text;
+    }
     return status;
 }
 
@@ -577,10 +694,13 @@ Core::hresult UserSettingsImplementation::SetPresentationLanguage(const string&
 
 Core::hresult UserSettingsImplementation::GetPresentationLanguage(string &presentationLanguage) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(PRESENTATION_LANGUAGE, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_PRESENTATION_LANGUAGE_KEY, presentationLanguage);
+    if(Core::ERROR_NONE == status)
+    {
+        presentationLanguage = value.Text;
+    }
     return status;
 }
 
@@ -595,21 +715,12 @@ Core::hresult UserSettingsImplementation::SetCaptions(const bool enabled)
 
 Core::hresult UserSettingsImplementation::GetCaptions(bool &enabled) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_CAPTIONS_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(CAPTIONS, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            enabled = true;
-        }
-        else
-        {
-            enabled = false;
-        }
+        enabled = value.Boolean;
     }
     return status;
 }
@@ -625,10 +736,13 @@ Core::hresult UserSettingsImplementation::SetPreferredCaptionsLanguages(const st
 
 Core::hresult UserSettingsImplementation::GetPreferredCaptionsLanguages(string &preferredLanguages) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(PREFERRED_CAPTIONS_LANGUAGES, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_PREFERRED_CAPTIONS_LANGUAGES_KEY, preferredLanguages);
+    if(Core::ERROR_NONE == status)
+    {
+        preferredLanguages = value.Text;
+    }
     return status;
 }
 
@@ -643,10 +757,13 @@ Core::hresult UserSettingsImplementation::SetPreferredClosedCaptionService(const
 
 Core::hresult UserSettingsImplementation::GetPreferredClosedCaptionService(string &service) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(PREFERRED_CLOSED_CAPTIONS_SERVICE, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_PREFERRED_CLOSED_CAPTIONS_SERVICE_KEY, service);
+    if(Core::ERROR_NONE == status)
+    {
+        service = value.Text;
+    }
     return status;
 }
 
@@ -681,26 +798,43 @@ Core::hresult UserSettingsImplementation::SetPrivacyMode(const string& privacyMo
 
     _adminLock.Unlock();
 
+    if (Core::ERROR_NONE == status)
+    {
+        updateSnapshot(PRIVACY_MODE, privacyMode, true);
+    }
+
     return status;
 }
 
 Core::hresult UserSettingsImplementation::GetPrivacyMode(string &privacyMode) const
 {
     uint32_t status = Core::ERROR_NONE;
-    std::string value = "";
     uint32_t ttl = 0;
     privacyMode = "";
 
-    _adminLock.Lock();
-
-    ASSERT (nullptr != _remotStoreObject);
+    const std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
 
-    if (nullptr != _remotStoreObject)
+    if ((*snapshot)[PRIVACY_MODE].Loaded)
     {
-        _remotStoreObject->GetValue(Exchange::IStore2::ScopeType::DEVICE, USERSETTINGS_NAMESPACE, USERSETTINGS_PRIVACY_MODE_KEY, privacyMode, ttl);
+        privacyMode = (*snapshot)[PRIVACY_MODE].Text;
     }
+    else
+    {
+        _adminLock.Lock();
 
-    _adminLock.Unlock();
+        ASSERT (nullptr != _remotStoreObject);
+
+        if (nullptr != _remotStoreObject)
+        {
+            uint32_t result = _remotStoreObject->GetValue(Exchange::IStore2::ScopeType::DEVICE, USERSETTINGS_NAMESPACE, USERSETTINGS_PRIVACY_MODE_KEY, privacyMode, ttl);
+            if (Core::ERROR_NONE == result)
+            {
+                updateSnapshot(PRIVACY_MODE, privacyMode, false);
+            }
+        }
+
+        _adminLock.Unlock();
+    }
     
     if (privacyMode != "SHARE" && privacyMode != "DO_NOT_SHARE") 
     {
@@ -722,24 +856,14 @@ Core::hresult UserSettingsImplementation::SetPinControl(const bool pinControl)
 
 Core::hresult UserSettingsImplementation::GetPinControl(bool &pinControl) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_PIN_CONTROL_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(PIN_CONTROL, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            pinControl = true;
-        }
-        else
-        {
-            pinControl = false;
-        }
+        pinControl = value.Boolean;
     }
     return status;
-
 }
 
 Core::hresult UserSettingsImplementation::SetViewingRestrictions(const string& viewingRestrictions)
@@ -754,11 +878,14 @@ Core::hresult UserSettingsImplementation::SetViewingRestrictions(const string& v
 
 Core::hresult UserSettingsImplementation::GetViewingRestrictions(string &viewingRestrictions) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
+    SettingValue value;
+    uint32_t status = getSetting(VIEWING_RESTRICTIONS, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_VIEWING_RESTRICTIONS_KEY, viewingRestrictions);
+    if(Core::ERROR_NONE == status)
+    {
+        viewingRestrictions = value.Text;
+    }
     return status;
-
 }
 
 Core::hresult UserSettingsImplementation::SetViewingRestrictionsWindow(const string& viewingRestrictionsWindow)
@@ -773,9 +900,13 @@ Core::hresult UserSettingsImplementation::SetViewingRestrictionsWindow(const str
 
 Core::hresult UserSettingsImplementation::GetViewingRestrictionsWindow(string &viewingRestrictionsWindow) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
+    SettingValue value;
+    uint32_t status = getSetting(VIEWING_RESTRICTIONS_WINDOW, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_VIEWING_RESTRICTIONS_WINDOW_KEY, viewingRestrictionsWindow);
+    if(Core::ERROR_NONE == status)
+    {
+        viewingRestrictionsWindow = value.Text;
+    }
     return status;
 }
 
@@ -791,21 +922,12 @@ Core::hresult UserSettingsImplementation::SetLiveWatershed(const bool liveWaters
 
 Core::hresult UserSettingsImplementation::GetLiveWatershed(bool &liveWatershed) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_LIVE_WATERSHED_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(LIVE_WATERSHED, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            liveWatershed = true;
-        }
-        else
-        {
-            liveWatershed = false;
-        }
+        liveWatershed = value.Boolean;
     }
     return status;
 }
@@ -821,21 +943,12 @@ Core::hresult UserSettingsImplementation::SetPlaybackWatershed(const bool playba
 
 Core::hresult UserSettingsImplementation::GetPlaybackWatershed(bool &playbackWatershed) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_PLAYBACK_WATERSHED_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(PLAYBACK_WATERSHED, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            playbackWatershed = true;
-        }
-        else
-        {
-            playbackWatershed = false;
-        }
+        playbackWatershed = value.Boolean;
     }
     return status;
 }
@@ -851,21 +964,12 @@ Core::hresult UserSettingsImplementation::SetBlockNotRatedContent(const bool blo
 
 Core::hresult UserSettingsImplementation::GetBlockNotRatedContent(bool &blockNotRatedContent) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_BLOCK_NOT_RATED_CONTENT_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(BLOCK_NOT_RATED_CONTENT, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            blockNotRatedContent = true;
-        }
-        else
-        {
-            blockNotRatedContent = false;
-        }
+        blockNotRatedContent = value.Boolean;
     }
     return status;
 }
@@ -881,22 +985,12 @@ Core::hresult UserSettingsImplementation::SetPinOnPurchase(const bool pinOnPurch
 
 Core::hresult UserSettingsImplementation::GetPinOnPurchase(bool &pinOnPurchase) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_PIN_ON_PURCHASE_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(PIN_ON_PURCHASE, value);
 
     if(Core::ERROR_NONE == status)
     {
-
-        if (0 == value.compare("true"))
-        {
-            pinOnPurchase = true;
-        }
-        else
-        {
-            pinOnPurchase = false;
-        }
+        pinOnPurchase = value.Boolean;
     }
     return status;
 }
@@ -912,21 +1006,12 @@ Core::hresult UserSettingsImplementation::SetHighContrast(const bool enabled)
 
 Core::hresult UserSettingsImplementation::GetHighContrast(bool &enabled) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_HIGH_CONTRAST_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(HIGH_CONTRAST, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            enabled = true;
-        }
-        else
-        {
-            enabled = false;
-        }
+        enabled = value.Boolean;
     }
     return status;
 }
@@ -942,21 +1027,12 @@ Core::hresult UserSettingsImplementation::SetVoiceGuidance(const bool enabled)
 
 Core::hresult UserSettingsImplementation::GetVoiceGuidance(bool &enabled) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
-
-    status = GetUserSettingsValue(USERSETTINGS_VOICE_GUIDANCE_KEY, value);
+    SettingValue value;
+    uint32_t status = getSetting(VOICE_GUIDANCE, value);
 
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            enabled = true;
-        }
-        else
-        {
-            enabled = false;
-        }
+        enabled = value.Boolean;
     }
     return status;
 }
@@ -979,13 +1055,12 @@ Core::hresult UserSettingsImplementation::SetVoiceGuidanceRate(const double rate
 
 Core::hresult UserSettingsImplementation::GetVoiceGuidanceRate(double &rate) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(VOICE_GUIDANCE_RATE, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_VOICE_GUIDANCE_RATE_KEY, value);
-    if(Core::ERROR_NONE == status && !(value.empty()))
+    if(Core::ERROR_NONE == status && !(value.Text.empty()))
     {
-        rate = std::stod(value);
+        rate = value.Number;
     }
     return status;
 }
@@ -1001,20 +1076,12 @@ Core::hresult UserSettingsImplementation::SetVoiceGuidanceHints(const bool hints
 
 Core::hresult UserSettingsImplementation::GetVoiceGuidanceHints(bool &hints) const
 {
-    uint32_t status = Core::ERROR_GENERAL;
-    std::string value = "";
+    SettingValue value;
+    uint32_t status = getSetting(VOICE_GUIDANCE_HINTS, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_VOICE_GUIDANCE_HINTS_KEY, value);
     if(Core::ERROR_NONE == status)
     {
-        if (0 == value.compare("true"))
-        {
-            hints = true;
-        }
-        else
-        {
-            hints = false;
-        }
+        hints = value.Boolean;
     }
     return status;
 }
@@ -1039,9 +1106,13 @@ Core::hresult UserSettingsImplementation::SetContentPin(const string& contentPin
 
 Core::hresult UserSettingsImplementation::GetContentPin(string& contentPin) const
 {
-    Core::hresult status = Core::ERROR_GENERAL;
+    SettingValue value;
+    Core::hresult status = getSetting(CONTENT_PIN, value);
 
-    status = GetUserSettingsValue(USERSETTINGS_CONTENT_PIN_KEY, contentPin);
+    if(Core::ERROR_NONE == status)
+    {
+        contentPin = value.Text;
+    }
     return status;
 }
 
@@ -1101,7 +1172,30 @@ Core::hresult UserSettingsImplementation::GetMigrationStates(IUserSettingsMigrat
     Exchange::IUserSettingsInspector::SettingsMigrationState SettingMigrationState = {};
     std::list<Exchange::IUserSettingsInspector::SettingsMigrationState> SettingMigrationStateList;
 
-    if (nullptr != _remotStoreObject)
+    RPC::IStringIterator* keys = nullptr;
+
+    if ((nullptr != _storeInspector) && (Core::ERROR_NONE == _storeInspector->GetKeys(Exchange::IStoreInspector::ScopeType::DEVICE, USERSETTINGS_NAMESPACE, keys)) && (nullptr != keys))
+    {
+        // One query for the whole namespace, a setting needs migration when its key was never stored
+        std::unordered_set<string> stored;
+        string key;
+        while (keys->Next(key))
+        {
+            stored.insert(key);
+        }
+        keys->Release();
+
+        for (auto uimap = _userSettingsInspectorMap.begin(); uimap != _userSettingsInspectorMap.end(); uimap++)
+        {
+            SettingMigrationState.key = uimap->first;
+            SettingMigrationState.requiresMigration = (stored.find(uimap->second) == stored.end());
+            SettingMigrationStateList.emplace_back(SettingMigrationState);
+        }
+        LOGINFO("%u keys stored in %s", static_cast<uint32_t>(stored.size()), USERSETTINGS_NAMESPACE);
+        states = (Core::Service<RPC::IteratorType<Exchange::IUserSettingsInspector::IUserSettingsMigrationStateIterator>>::Create<Exchange::IUserSettingsInspector::IUserSettingsMigrationStateIterator>(SettingMigrationStateList));
+        status = Core::ERROR_NONE;
+    }
+    else if (nullptr != _remotStoreObject)
     {
         for (auto uimap = _userSettingsInspectorMap.begin(); uimap != _userSettingsInspectorMap.end(); uimap++)
         {
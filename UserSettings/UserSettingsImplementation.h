@@ -23,8 +23,13 @@
 #include <interfaces/Ids.h>
 #include <interfaces/IUserSettings.h>
 #include <interfaces/IStore2.h>
+#include <interfaces/IStoreInspector.h>
 #include <interfaces/IConfiguration.h>
 #include "tracing/Logging.h"
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <com/com.h>
@@ -224,13 +229,85 @@ namespace Plugin {
         void registerEventHandlers();
         void ValueChanged(const Exchange::IStore2::ScopeType scope, const string& ns, const string& key, const string& value);
 
+    private:
+        enum Setting : uint8_t
+        {
+            AUDIO_DESCRIPTION,
+            PREFERRED_AUDIO_LANGUAGES,
+            PRESENTATION_LANGUAGE,
+            CAPTIONS,
+            PREFERRED_CAPTIONS_LANGUAGES,
+            PREFERRED_CLOSED_CAPTIONS_SERVICE,
+            PRIVACY_MODE,
+            PIN_CONTROL,
+            VIEWING_RESTRICTIONS,
+            VIEWING_RESTRICTIONS_WINDOW,
+            LIVE_WATERSHED,
+            PLAYBACK_WATERSHED,
+            BLOCK_NOT_RATED_CONTENT,
+            PIN_ON_PURCHASE,
+            HIGH_CONTRAST,
+            VOICE_GUIDANCE,
+            VOICE_GUIDANCE_RATE,
+            VOICE_GUIDANCE_HINTS,
+            CONTENT_PIN,
+            SETTING_COUNT
+        };
+
+        // A setting as stored, with its typed forms parsed once when it enters the snapshot
+        struct SettingValue
+        {
+            SettingValue()
+                : Loaded(false)
+                , Boolean(false)
+                , Number(0)
+                , Text()
+            {
+            }
+
+            bool Loaded;
+            bool Boolean;
+            double Number;
+            string Text;
+        };
+
+        // Never modified once published, writers copy it and swap the pointer
+        typedef std::array<SettingValue, SETTING_COUNT> Snapshot;
+
+        enum SettingType : uint8_t
+        {
+            BOOLEAN,
+            NUMBER,
+            TEXT
+        };
+
+        // The event raised when a setting changes and the form its value is sent in
+        struct SettingEvent
+        {
+            Event Notification;
+            SettingType Type;
+        };
+
+        static const char* const _settingKeys[SETTING_COUNT];
+        static const SettingEvent _settingEvents[SETTING_COUNT];
+        static const std::unordered_map<string, Setting> _settingIndex;
+
     private:
         uint32_t SetUserSettingsValue(const string& key, const string& value);
-        uint32_t GetUserSettingsValue(const string& key, string &value) const;
+        uint32_t GetUserSettingsValue(const string& key, string &value, bool& stored) const;
+
+        static bool settingOf(const string& key, Setting& setting);
+        static void parseSetting(const string& text, SettingValue& value);
+        void loadSnapshot();
+        void updateSnapshot(const Setting setting, const string& text, const bool overwrite) const;
+        uint32_t getSetting(const Setting setting, SettingValue& value) const;
 
     private:
         mutable Core::CriticalSection _adminLock;
+        mutable Core::CriticalSection _snapshotLock;
+        mutable std::shared_ptr<const Snapshot> _snapshot;
         Exchange::IStore2* _remotStoreObject;
+        Exchange::IStoreInspector* _storeInspector;
         std::list<Exchange::IUserSettings::INotification*> _userSettingNotification;
         Core::Sink<Store2Notification> _storeNotification;
         bool _registeredEventHandlers;
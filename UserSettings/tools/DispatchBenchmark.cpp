@@ -0,0 +1,142 @@
+/*
+* If not stated otherwise in this file or this component's LICENSE file the
+* following copyright and licenses apply:
+*
+* Copyright 2025 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+// Time ValueChanged takes to find the setting of a key: the chain of namespace and key comparisons
+// UserSettings went through before, against one namespace comparison and the hashed key index.
+//
+//   UserSettingsDispatchBenchmark [-n lookups per key]
+//
+// Every key of the namespace is looked up, the report shows the first and the last key of the
+// chain, the mean over all keys and a key that is not a setting. Raising the event is left out,
+// it costs the same for both.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+    typedef std::chrono::steady_clock Clock;
+
+    const char Namespace[] = "UserSettings";
+
+    // In the order of the comparisons in ValueChanged before
+    const char* const Keys[] = {
+        "audioDescription", "preferredAudioLanguages", "presentationLanguage", "captions",
+        "preferredCaptionsLanguages", "preferredClosedCaptionsService", "privacyMode", "pinControl",
+        "viewingRestrictions", "viewingRestrictionsWindow", "liveWaterShed", "playbackWaterShed",
+        "blockNotRatedContent", "pinOnPurchase", "highContrast", "voiceGuidance",
+        "voiceGuidanceRate", "voiceGuidanceHints", "contentPin"
+    };
+    const int Count = sizeof(Keys) / sizeof(Keys[0]);
+
+    // What the plugin did before: every branch compares the namespace and then the key
+    int Chain(const std::string& ns, const std::string& key)
+    {
+        for (int setting = 0; setting < Count; setting++) {
+            if ((0 == ns.compare(Namespace)) && (0 == key.compare(Keys[setting]))) {
+                return (setting);
+            }
+        }
+        return (-1);
+    }
+
+    class Index {
+    public:
+        Index()
+            : _index(Count)
+        {
+            for (int setting = 0; setting < Count; setting++) {
+                _index.emplace(Keys[setting], setting);
+            }
+        }
+
+        // The plugin now: the namespace once, then the key index
+        int Find(const std::string& ns, const std::string& key) const
+        {
+            if (0 != ns.compare(Namespace)) {
+                return (-1);
+            }
+            const std::unordered_map<std::string, int>::const_iterator entry = _index.find(key);
+            return (entry != _index.end() ? entry->second : -1);
+        }
+
+    private:
+        std::unordered_map<std::string, int> _index;
+    };
+
+    volatile int sink;
+
+    template <typename LOOKUP>
+    double Measure(const LOOKUP& lookup, const std::string& key, const uint32_t lookups)
+    {
+        const std::string ns(Namespace);
+        const Clock::time_point start = Clock::now();
+        for (uint32_t index = 0; index < lookups; index++) {
+            sink = lookup(ns, key);
+        }
+        return (std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups);
+    }
+
+    template <typename LOOKUP>
+    void Report(const char name[], const LOOKUP& lookup, const uint32_t lookups)
+    {
+        double total = 0;
+        for (int setting = 0; setting < Count; setting++) {
+            total += Measure(lookup, Keys[setting], lookups);
+        }
+
+        ::printf("  %-6s first %6.1f ns  last %6.1f ns  mean %6.1f ns  unknown %6.1f ns\n", name,
+            Measure(lookup, Keys[0], lookups), Measure(lookup, Keys[Count - 1], lookups),
+            total / Count, Measure(lookup, "someOtherKey", lookups));
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t lookups = 1000000;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "n:")) != -1) {
+        switch (option) {
+        case 'n': lookups = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        default:
+            ::fprintf(stderr, "usage: %s [-n lookups per key]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if (lookups == 0) {
+        ::fprintf(stderr, "lookups must be at least 1\n");
+        return (1);
+    }
+
+    ::printf("%d keys, %u lookups per key\n", Count, lookups);
+
+    const Index index;
+    Report("chain", [](const std::string& ns, const std::string& key) { return (Chain(ns, key)); }, lookups);
+    Report("index", [&index](const std::string& ns, const std::string& key) { return (index.Find(ns, key)); }, lookups);
+
+    return (0);
+}
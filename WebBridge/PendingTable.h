@@ -0,0 +1,265 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Requests forwarded to the JavaScript service, hashed by their forwarded id and hung in a
+// hierarchical timer wheel by deadline. Insert, complete and expire are O(1) each and a cleanup
+// only visits the slots whose time has come, never the whole table. Kept free of framework
+// dependencies so tools/PendingBenchmark builds standalone.
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class PendingTable {
+    public:
+        // Ticks are milliseconds. Level 0 holds the next 256 ticks one by one, every further
+        // level 64 slots of the whole level below it: 256 ms, 16 s, 17 min and 18 h.
+        static constexpr uint32_t RootBits = 8;
+        static constexpr uint32_t LevelBits = 6;
+        static constexpr uint32_t Levels = 4;
+        static constexpr uint64_t Never = ~static_cast<uint64_t>(0);
+
+    private:
+        static constexpr uint32_t RootSlots = (1 << RootBits);
+        static constexpr uint32_t LevelSlots = (1 << LevelBits);
+        static constexpr uint64_t Horizon = (static_cast<uint64_t>(1) << (RootBits + ((Levels - 1) * LevelBits))) - 1;
+
+        struct Entry {
+            uint32_t Id;
+            uint32_t ChannelId;
+            uint32_t SequenceId;
+            uint64_t Deadline;
+            Entry** Head; // of the slot it hangs in
+            Entry* Previous;
+            Entry* Next;
+        };
+
+    public:
+        PendingTable(const PendingTable&) = delete;
+        PendingTable& operator=(const PendingTable&) = delete;
+
+        explicit PendingTable(const uint64_t now = 0)
+            : _entries()
+            , _root()
+            , _levels()
+            , _current(now)
+        {
+        }
+        ~PendingTable() = default;
+
+    public:
+        size_t Count() const
+        {
+            return (_entries.size());
+        }
+
+        // Returns false if id is pending already
+        bool Insert(const uint32_t id, const uint32_t channelId, const uint32_t sequenceId, const uint64_t now, const uint64_t deadline)
+        {
+            if (_entries.empty() == true) {
+                // Nothing hangs in the wheel, so it skips the idle time in one go
+                _current = now;
+            }
+
+            auto result = _entries.emplace(std::piecewise_construct, std::forward_as_tuple(id), std::forward_as_tuple());
+
+            if (result.second == true) {
+                Entry& entry(result.first->second);
+                entry.Id = id;
+                entry.ChannelId = channelId;
+                entry.SequenceId = sequenceId;
+                entry.Deadline = deadline;
+                Link(entry);
+            }
+
+            return (result.second);
+        }
+
+        // The response for id arrived: hands out who is waiting for it and forgets the request
+        bool Complete(const uint32_t id, uint32_t& channelId, uint32_t& sequenceId)
+        {
+            auto index = _entries.find(id);
+            bool found = (index != _entries.end());
+
+            if (found == true) {
+                channelId = index->second.ChannelId;
+                sequenceId = index->second.SequenceId;
+                Unlink(index->second);
+                _entries.erase(index);
+            }
+
+            return (found);
+        }
+
+        // Calls action(channelId, sequenceId) for every request with a deadline up to now and
+        // forgets them. Higher level slots are spread over the lower levels as their turn comes.
+        template <typename ACTION>
+        void Expire(const uint64_t now, ACTION&& action)
+        {
+            while ((_current <= now) && (_entries.empty() == false)) {
+                const uint32_t slot = static_cast<uint32_t>(_current & (RootSlots - 1));
+
+                if (slot == 0) {
+                    Cascade(0);
+                }
+
+                Entry* entry = _root[slot];
+                _root[slot] = nullptr;
+
+                while (entry != nullptr) {
+                    Entry* next = entry->Next;
+                    action(entry->ChannelId, entry->SequenceId);
+                    _entries.erase(entry->Id);
+                    entry = next;
+                }
+
+                _current++;
+            }
+
+            if (_entries.empty() == true) {
+                _current = now + 1;
+            }
+        }
+
+        // The tick by which Expire should run next: the first occupied level 0 slot, or the next
+        // cascade when only higher levels hold requests. Never when nothing is pending.
+        uint64_t NextExpiry() const
+        {
+            uint64_t result = Never;
+
+            if (_entries.empty() == false) {
+                const uint64_t cascade = _current + ((RootSlots - (_current & (RootSlots - 1))) & (RootSlots - 1));
+
+                for (uint64_t tick = _current; tick < (_current + RootSlots); tick++) {
+                    if (_root[tick & (RootSlots - 1)] != nullptr) {
+                        result = tick;
+                        break;
+                    }
+                }
+
+                if (result > cascade) {
+                    for (uint32_t level = 0; level < (Levels - 1); level++) {
+                        for (uint32_t slot = 0; slot < LevelSlots; slot++) {
+                            if (_levels[level][slot] != nullptr) {
+                                return (cascade);
+                            }
+                        }
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+        void Clear()
+        {
+            _entries.clear();
+            for (Entry*& slot : _root) {
+                slot = nullptr;
+            }
+            for (auto& level : _levels) {
+                for (Entry*& slot : level) {
+                    slot = nullptr;
+                }
+            }
+        }
+
+    private:
+        // Level 0 is indexed by the deadline itself, higher levels by its upper bits, all
+        // relative to the tick the wheel is at
+        Entry*& Slot(const uint64_t deadline)
+        {
+            const uint64_t when = (deadline < _current ? _current : deadline);
+            const uint64_t delta = when - _current;
+
+            if (delta < RootSlots) {
+                return (_root[when & (RootSlots - 1)]);
+            }
+
+            const uint64_t clamped = (delta > Horizon ? _current + Horizon : when);
+            uint32_t level = 0;
+
+            while ((level < (Levels - 2)) && ((delta >> (RootBits + ((level + 1) * LevelBits))) != 0)) {
+                level++;
+            }
+
+            return (_levels[level][(clamped >> (RootBits + (level * LevelBits))) & (LevelSlots - 1)]);
+        }
+
+        void Link(Entry& entry)
+        {
+            Entry*& head = Slot(entry.Deadline);
+
+            entry.Head = &head;
+            entry.Previous = nullptr;
+            entry.Next = head;
+            if (head != nullptr) {
+                head->Previous = &entry;
+            }
+            head = &entry;
+        }
+
+        void Unlink(Entry& entry)
+        {
+            if (entry.Previous != nullptr) {
+                entry.Previous->Next = entry.Next;
+            } else {
+                *entry.Head = entry.Next;
+            }
+            if (entry.Next != nullptr) {
+                entry.Next->Previous = entry.Previous;
+            }
+        }
+
+        // Moves the slot of level that is due now down to the levels below it, cascading the
+        // level above first when this level wrapped as well
+        void Cascade(const uint32_t level)
+        {
+            const uint32_t slot = static_cast<uint32_t>((_current >> (RootBits + (level * LevelBits))) & (LevelSlots - 1));
+
+            if ((slot == 0) && (level < (Levels - 2))) {
+                Cascade(level + 1);
+            }
+
+            Entry* entry = _levels[level][slot];
+            _levels[level][slot] = nullptr;
+
+            while (entry != nullptr) {
+                Entry* next = entry->Next;
+                Link(*entry);
+                entry = next;
+            }
+        }
+
+    private:
+        std::unordered_map<uint32_t, Entry> _entries;
+        Entry* _root[RootSlots];
+        Entry* _levels[Levels - 1][LevelSlots];
+        uint64_t _current;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
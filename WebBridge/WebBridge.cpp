@@ -81,7 +81,7 @@ namespace Plugin {
         _skipURL = static_cast<uint8_t>(service->WebPrefix().length());
         _callsign = service->Callsign();
         _service = service;
-        _timeOut = (config.TimeOut.Value() * Core::Time::TicksPerMillisecond);
+        _timeOut = config.TimeOut.Value();
 
         // On success return empty, to indicate there is no error text.
         return (message);
@@ -164,11 +164,15 @@ namespace Plugin {
         case state::STATE_CUSTOM:
             // Let's on behalf of the request forward it and update 
             uint32_t newId = Core::InterlockedIncrement(_sequenceId);
-            Core::Time waitTill = Core::Time::Now() + _timeOut;
+            uint64_t now = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond;
+            uint64_t waitTill = (_timeOut != 0 ? now + _timeOut : PendingTable::Never);
 
-            _pendingRequests.emplace(std::piecewise_construct,
-                std::forward_as_tuple(newId),
-                std::forward_as_tuple(channelId, message->Id.Value(), waitTill));
+            // The cleaner keeps itself scheduled while requests are pending, only the first one
+            // has to start it
+            _adminLock.Lock();
+            bool idle = (_pendingRequests.Count() == 0);
+            _pendingRequests.Insert(newId, channelId, message->Id.Value(), now, waitTill);
+            _adminLock.Unlock();
 
             message->Id = newId;
             message->Parameters = inbound.Parameters;
@@ -181,8 +185,8 @@ namespace Plugin {
             // Wait for ID to return, we can not report anything back yet...
             message.Release();
 
-            if (_timeOut != 0) {
-                _cleaner.Schedule(waitTill);
+            if ((_timeOut != 0) && (idle == true)) {
+                _cleaner.Schedule(Core::Time(waitTill * Core::Time::TicksPerMillisecond));
             }
 
             break;
@@ -245,12 +249,7 @@ namespace Plugin {
 
                 // This is the response to an invoked method, Let's see who should get this repsonse :-)
                 _adminLock.Lock();
-                PendingMap::iterator index = _pendingRequests.find(message->Id.Value());
-                if (index != _pendingRequests.end()) {
-                    channelId = index->second.ChannelId();
-                    requestId = index->second.SequenceId();
-                    _pendingRequests.erase(index);
-                }
+                _pendingRequests.Complete(message->Id.Value(), channelId, requestId);
                 _adminLock.Unlock();
 
                 if (channelId != 0) {
@@ -276,35 +275,32 @@ namespace Plugin {
     // -------------------------------------------------------------------------------------------------------
     void WebBridge::Cleanup() {
         // Lets see if there are still any pending request we should report Missing In Action :-)
-        Core::Time now (Core::Time::Now());
-        Core::Time nextSlot;
+        // Only the wheel slots that are due are visited, the errors go out once the lock is released.
+        uint64_t now = Core::Time::Now().Ticks() / Core::Time::TicksPerMillisecond;
+        uint64_t nextSlot;
 
         _adminLock.Lock();
-        PendingMap::iterator index(_pendingRequests.begin());
-        while (index != _pendingRequests.end()) {
-            if (now >= index->second.Issued()) {
-                // Send and Error to the requester..
-                Core::ProxyType<Core::JSONRPC::Message> message(PluginHost::IFactories::Instance().JSONRPC());
-                message->Error.SetError(Core::ERROR_TIMEDOUT);
-                message->Error.Text = _T("There is no response form the server within time!!!");
-                message->Id = index->second.SequenceId();
-
-                TRACE(Trace::Warning, (_T("Got a timeout on channelId [%d] for request [%d]"), index->second.ChannelId(), message->Id.Value()));
-
-                _service->Submit(index->second.ChannelId(), Core::ProxyType<Core::JSON::IElement>(message));
-                index = _pendingRequests.erase(index);
-            }
-            else {
-                if ((nextSlot.IsValid() == false) || (nextSlot > index->second.Issued())) {
-                    nextSlot = index->second.Issued();
-                }
-                index++;
-            }
-        }
+        _pendingRequests.Expire(now, [this](const uint32_t channelId, const uint32_t sequenceId) {
+            _expired.emplace_back(channelId, sequenceId);
+        });
+        nextSlot = _pendingRequests.NextExpiry();
         _adminLock.Unlock();
 
-        if (nextSlot.IsValid()) {
-            _cleaner.Schedule(nextSlot);
+        for (const std::pair<uint32_t, uint32_t>& entry : _expired) {
+            // Send and Error to the requester..
+            Core::ProxyType<Core::JSONRPC::Message> message(PluginHost::IFactories::Instance().JSONRPC());
+            message->Error.SetError(Core::ERROR_TIMEDOUT);
+            message->Error.Text = _T("There is no response form the server within time!!!");
+            message->Id = entry.second;
+
+            TRACE(Trace::Warning, (_T("Got a timeout on channelId [%d] for request [%d]"), entry.first, message->Id.Value()));
+
+            _service->Submit(entry.first, Core::ProxyType<Core::JSON::IElement>(message));
+        }
+        _expired.clear();
+
+        if (nextSlot != PendingTable::Never) {
+            _cleaner.Schedule(Core::Time(nextSlot * Core::Time::TicksPerMillisecond));
         }
     }
 
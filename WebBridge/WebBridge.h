@@ -20,6 +20,7 @@
 #pragma once
 
 #include "Module.h"
+#include "PendingTable.h"
 
 namespace WPEFramework {
 namespace Plugin {
@@ -75,35 +76,6 @@ namespace Plugin {
             uint32_t _id;
             string _designator;
         };
-        class Request {
-        public:
-            Request() = delete;
-            Request(const Request&) = delete;
-            Request& operator=(const Request&) = delete;
-
-            Request(const uint32_t channelId, const uint32_t sequenceId, const Core::Time& timeOut)
-                : _channelId(channelId)
-                , _sequenceId(sequenceId)
-                , _issued(timeOut) {
-            }
-            ~Request() = default;
-
-        public:
-            uint32_t ChannelId() const {
-                return (_channelId);
-            }
-            uint32_t SequenceId() const {
-                return (_sequenceId);
-            }
-            const Core::Time& Issued() const {
-                return (_issued);
-            }
-
-        private:
-            uint32_t _channelId;
-            uint32_t _sequenceId;
-            Core::Time _issued;
-        };
         class Cleaner  {
         private:
             using BaseClass = Core::IWorkerPool::JobType<Cleaner>;
@@ -129,7 +101,7 @@ namespace Plugin {
         using ObserverMap = std::map<string, ObserverList>;
         using MethodList = std::vector<string>;
         using VersionMap = std::map<uint8_t, MethodList>;
-        using PendingMap = std::map<uint32_t, Request>;
+        using ExpiredList = std::vector<std::pair<uint32_t, uint32_t>>;
 
     public:
         class Config : public Core::JSON::Container {
@@ -162,6 +134,7 @@ namespace Plugin {
             , _supportedVersions()
             , _observers()
             , _pendingRequests()
+            , _expired()
             , _javascriptService(0)
             , _sequenceId(1)
             , _timeOut(0)
@@ -338,7 +311,8 @@ namespace Plugin {
         string _callsign;
         VersionMap _supportedVersions;
         ObserverMap _observers;
-        PendingMap _pendingRequests;
+        PendingTable _pendingRequests;
+        ExpiredList _expired; // cleaner only, channel and sequence id of the timed out requests
         uint32_t _javascriptService;
         uint32_t _sequenceId;
         uint32_t _timeOut;
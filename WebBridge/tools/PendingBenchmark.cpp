@@ -0,0 +1,212 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Pending request bookkeeping of WebBridge with many calls in flight: the ordered map scanned on
+// every cleaner run it used before, against the hashed table with timer wheel.
+//
+//   WebBridgePendingBenchmark [-n in flight] [-r requests] [-p requests per ms] [-t timeout ms] [-l lost per mille]
+//
+// Time is simulated. Every request is answered in random order while n are in flight, except the
+// lost ones that run into the timeout. The cleaner runs every millisecond, as it does when the
+// deadlines of the requests in flight are spread over the timeout.
+
+#include "../PendingTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    // What WebBridge::Cleanup did before: visit every pending request for the expired ones and
+    // the next deadline
+    class OrderedPending {
+    private:
+        struct Request {
+            uint32_t ChannelId;
+            uint32_t SequenceId;
+            uint64_t Deadline;
+        };
+
+    public:
+        void Insert(const uint32_t id, const uint32_t channelId, const uint32_t sequenceId, const uint64_t, const uint64_t deadline)
+        {
+            _requests.emplace(id, Request { channelId, sequenceId, deadline });
+        }
+        bool Complete(const uint32_t id, uint32_t& channelId, uint32_t& sequenceId)
+        {
+            auto index = _requests.find(id);
+            bool found = (index != _requests.end());
+            if (found == true) {
+                channelId = index->second.ChannelId;
+                sequenceId = index->second.SequenceId;
+                _requests.erase(index);
+            }
+            return (found);
+        }
+        template <typename ACTION>
+        uint64_t Cleanup(const uint64_t now, ACTION&& action)
+        {
+            uint64_t next = PendingTable::Never;
+            auto index = _requests.begin();
+            while (index != _requests.end()) {
+                if (now >= index->second.Deadline) {
+                    action(index->second.ChannelId, index->second.SequenceId);
+                    index = _requests.erase(index);
+                } else {
+                    next = (index->second.Deadline < next ? index->second.Deadline : next);
+                    ++index;
+                }
+            }
+            return (next);
+        }
+
+    private:
+        std::map<uint32_t, Request> _requests;
+    };
+
+    class WheelPending {
+    public:
+        void Insert(const uint32_t id, const uint32_t channelId, const uint32_t sequenceId, const uint64_t now, const uint64_t deadline)
+        {
+            _table.Insert(id, channelId, sequenceId, now, deadline);
+        }
+        bool Complete(const uint32_t id, uint32_t& channelId, uint32_t& sequenceId)
+        {
+            return (_table.Complete(id, channelId, sequenceId));
+        }
+        template <typename ACTION>
+        uint64_t Cleanup(const uint64_t now, ACTION&& action)
+        {
+            _table.Expire(now, action);
+            return (_table.NextExpiry());
+        }
+
+    private:
+        PendingTable _table;
+    };
+
+    struct Result {
+        double Seconds;
+        double CleanupSeconds;
+        uint64_t Answered;
+        uint64_t Expired;
+    };
+
+    template <typename PENDING>
+    Result Run(const uint32_t inFlight, const uint32_t requests, const uint32_t rate, const uint32_t timeOut, const uint32_t lost)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        PENDING pending;
+        std::mt19937 random(42);
+        std::vector<uint32_t> answerable;
+        Result result = { 0, 0, 0, 0 };
+        uint64_t now = 1000000;
+        uint32_t next = 1;
+        uint32_t channelId, sequenceId;
+
+        answerable.reserve(inFlight);
+        const Clock::time_point start = Clock::now();
+
+        for (uint32_t count = 0; count < requests; count++) {
+            const uint32_t id = next++;
+            pending.Insert(id, (id % 64) + 1, id, now, now + timeOut);
+            if ((random() % 1000) >= lost) {
+                answerable.push_back(id);
+            }
+
+            if (answerable.size() >= inFlight) {
+                const size_t pick = random() % answerable.size();
+                if (pending.Complete(answerable[pick], channelId, sequenceId) == true) {
+                    result.Answered++;
+                }
+                answerable[pick] = answerable.back();
+                answerable.pop_back();
+            }
+
+            if (((count + 1) % rate) == 0) {
+                now++;
+                const Clock::time_point cleanup = Clock::now();
+                pending.Cleanup(now, [&result](const uint32_t, const uint32_t) { result.Expired++; });
+                result.CleanupSeconds += std::chrono::duration<double>(Clock::now() - cleanup).count();
+            }
+        }
+
+        result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return (result);
+    }
+
+    void Report(const char name[], const Result& result, const uint32_t requests)
+    {
+        ::printf("  %-14s %8.3f s, %7.1f ns per request, cleaner %6.3f s, %llu answered, %llu expired\n",
+            name, result.Seconds, (result.Seconds * 1e9) / requests, result.CleanupSeconds,
+            static_cast<unsigned long long>(result.Answered), static_cast<unsigned long long>(result.Expired));
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t inFlight = 10000;
+    uint32_t requests = 1000000;
+    uint32_t rate = 20;
+    uint32_t timeOut = 3000;
+    uint32_t lost = 5;
+    int option;
+
+    while ((option = ::getopt(argc, argv, "n:r:p:t:l:")) != -1) {
+        switch (option) {
+        case 'n': inFlight = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'r': requests = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'p': rate = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 't': timeOut = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        case 'l': lost = static_cast<uint32_t>(::strtoul(optarg, nullptr, 10)); break;
+        default:
+            ::fprintf(stderr, "usage: %s [-n in flight] [-r requests] [-p requests per ms] [-t timeout ms] [-l lost per mille]\n", argv[0]);
+            return (1);
+        }
+    }
+
+    if ((inFlight == 0) || (rate == 0)) {
+        ::fprintf(stderr, "in flight and requests per ms must be at least 1\n");
+        return (1);
+    }
+
+    ::printf("%u in flight, %u requests, %u per ms, timeout %u ms, %u per mille lost\n", inFlight, requests, rate, timeOut, lost);
+
+    const Result ordered = Run<OrderedPending>(inFlight, requests, rate, timeOut, lost);
+    const Result wheel = Run<WheelPending>(inFlight, requests, rate, timeOut, lost);
+
+    Report("ordered map", ordered, requests);
+    Report("timer wheel", wheel, requests);
+
+    if ((ordered.Answered != wheel.Answered) || (ordered.Expired != wheel.Expired)) {
+        ::printf("  results differ!\n");
+        return (2);
+    }
+
+    return (0);
+}
@@ -47,6 +47,8 @@ public:
 
 protected:
     ~BinaryInterface() = default;
+    // Nothing in flight to end before the event loop is joined
+    void shutdown() {}
 
     std::function<void(const std::string&)> onMessage{[](const std::string& message) { LOGWARN("Default onMessage."); }};
     websocketpp::frame::opcode::value opcode_{websocketpp::frame::opcode::binary};
@@ -53,6 +53,8 @@ public:
 
 protected:
     ~CommandInterface() = default;
+    // Nothing in flight to end before the event loop is joined
+    void shutdown() {}
 
     void onMessage(const std::string& message)
     {
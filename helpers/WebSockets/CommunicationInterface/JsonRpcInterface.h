@@ -18,13 +18,19 @@
 **/
 
 #pragma once
+#include <chrono>
 #include <future>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
+#include <websocketpp/common/asio.hpp>
+#include <websocketpp/common/memory.hpp>
 #include <websocketpp/frame.hpp>
-#include <boost/optional.hpp>
+#include <websocketpp/transport/base/connection.hpp>
 
 #include "../JsonRpc/Request.h"
 #include "../JsonRpc/Response.h"
@@ -40,15 +46,28 @@ template<typename Derived>
 class JsonRpcInterface
 {
 public:
+    // success: same meaning as the return value of sendRequest, false on timeout
+    using ResponseCallback = std::function<void(bool success, const JsonRpc::Response& response)>;
+
+    static constexpr uint32_t defaultTimeoutMs = 5000;
+
     JsonRpcInterface() = default;
 
     // Note: return value: sending result && receiving result && json-rpc's response field "success" value
+    // Blocks the caller, so it must not be used from a ResponseCallback or a notification handler.
     bool sendRequest(const JsonRpc::Request& request, JsonRpc::Response& response);
+    // Returns as soon as the request is sent. The callback runs once on the event loop thread, when the
+    // response arrives or the timeout passes, and should not block. Returns false, without calling the
+    // callback, if the request could not be sent.
+    bool invokeAsync(const JsonRpc::Request& request, ResponseCallback callback, uint32_t timeoutMs = defaultTimeoutMs);
     void setNotificationHandler(std::function<void(const JsonRpc::Notification&)> notificationHandler);
 
 protected:
     ~JsonRpcInterface() = default;
     void onMessage(const std::string& message);
+    // Before the event loop is joined: cancels the timer, so run() does not wait for it, and fails
+    // the requests still in flight on the calling thread.
+    void shutdown();
 
     websocketpp::frame::opcode::value opcode_{websocketpp::frame::opcode::text};
 
@@ -56,50 +75,116 @@ private:
     JsonRpcInterface(const JsonRpcInterface&) = delete;
     JsonRpcInterface& operator=(const JsonRpcInterface&) = delete;
 
-    bool getAsyncResponse(uint32_t id, std::future<string>& futureReponse, JsonRpc::Response& response);
-    boost::optional<std::future<string> > createFutureResponse(uint32_t id);
-    void removePromise(uint32_t id);
-    bool isRequestProcessingOngoing(uint32_t id);
+    using Clock = std::chrono::steady_clock;
+    using DeadlineQueue = std::multimap<Clock::time_point, uint32_t>;
+    using TimerPtr = websocketpp::lib::shared_ptr<websocketpp::lib::asio::steady_timer>;
+
+    struct PendingRequest
+    {
+        ResponseCallback callback;
+        DeadlineQueue::iterator deadline;
+    };
+
+    bool takePendingRequest(uint32_t id, ResponseCallback& callback);
+    void armTimer(Clock::time_point deadline);
+    void cancelTimer();
+    void onDeadline(Clock::time_point deadline);
     void handleNotification(const std::string& message);
     void handleResponse(uint32_t id, const std::string& message);
     bool processResponse(uint32_t id, const std::string &responseString, JsonRpc::Response &deviceResponse) const;
 
+    // All requests in flight share one deadline queue and a single event loop timer armed for the
+    // earliest deadline, instead of a waiting thread per request. The timer is cancelled once no
+    // request is left, so it never keeps the event loop running.
     std::mutex responseMutex_;
-    std::map<uint32_t, std::promise<std::string> > responseToPromise_;
+    std::map<uint32_t, PendingRequest> pendingRequests_;
+    DeadlineQueue deadlines_;
+    Clock::time_point armedDeadline_{Clock::time_point::max()};
+    TimerPtr armedTimer_;
+    bool stopped_{false};
     std::function<void(const JsonRpc::Notification&)> notificationHandler_;
 };
 
+template<typename Derived>
+constexpr uint32_t JsonRpcInterface<Derived>::defaultTimeoutMs;
+
 template<typename Derived>
 bool JsonRpcInterface<Derived>::sendRequest(const JsonRpc::Request& request, JsonRpc::Response& response)
 {
-    if (isRequestProcessingOngoing(request.getId()))
+    auto result = std::make_shared<std::promise<std::pair<bool, std::string> > >();
+    auto futureResponse = result->get_future();
+
+    bool sent = invokeAsync(request, [result](bool success, const JsonRpc::Response& asyncResponse) {
+        std::string message;
+        asyncResponse.ToString(message);
+        result->set_value(std::make_pair(success, message));
+    });
+    if (!sent)
     {
-        LOGERR("Processing of request with ID:%d is already ongoing. Dropping new one:%s",
-            request.getId(), request.toString().c_str());
         return false;
     }
 
-    auto futureReponse = createFutureResponse(request.getId());
-    if (!futureReponse)
+    // The deadline queue completes the request in time, the margin only guards against a stopped event loop
+    if (futureResponse.wait_for(std::chrono::milliseconds(2 * defaultTimeoutMs)) != std::future_status::ready)
+    {
+        LOGERR("Request with ID:%d was never completed. Dropping it.", request.getId());
+        ResponseCallback dropped;
+        takePendingRequest(request.getId(), dropped);
+        return false;
+    }
+
+    auto outcome = futureResponse.get();
+    response.FromString(outcome.second);
+    return outcome.first;
+}
+
+template<typename Derived>
+bool JsonRpcInterface<Derived>::invokeAsync(const JsonRpc::Request& request, ResponseCallback callback, uint32_t timeoutMs)
+{
+    const uint32_t id = request.getId();
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    if (!callback)
     {
-        LOGERR("Can't create future response.");
+        LOGERR("No callback for request with ID:%d. Dropping it.", id);
         return false;
     }
 
+    {
+        // Registered before sending, the response may arrive before send returns
+        std::lock_guard<std::mutex> lock(responseMutex_);
+        if (stopped_)
+        {
+            LOGERR("Endpoint is shutting down. Dropping request with ID:%d.", id);
+            return false;
+        }
+        if (pendingRequests_.count(id) != 0)
+        {
+            LOGERR("Processing of request with ID:%d is already ongoing. Dropping new one:%s",
+                id, request.toString().c_str());
+            return false;
+        }
+        PendingRequest& pending = pendingRequests_[id];
+        pending.callback = std::move(callback);
+        pending.deadline = deadlines_.emplace(deadline, id);
+    }
+
     LOGINFO("Sending json-rpc request: %s", request.toString().c_str());
     Derived& derived = static_cast<Derived&>(*this);
-    if (derived.send(request.toString()))
+    if (!derived.send(request.toString()))
     {
-        // Using futureResponse in addition to request.getId() to not lock mutex and search again.
-        return getAsyncResponse(request.getId(), *futureReponse, response);
+        LOGERR("Sending request with ID:%d failed. Cleaning internal state.", id);
+        ResponseCallback dropped;
+        takePendingRequest(id, dropped);
+        return false;
     }
-    else
+
+    std::lock_guard<std::mutex> lock(responseMutex_);
+    if ((pendingRequests_.count(id) != 0) && (deadline < armedDeadline_))
     {
-        LOGERR("Sending request with ID:%d failed. Cleaning internal state.", request.getId());
-        removePromise(request.getId());
-        return false;
+        armTimer(deadline);
     }
-    return false;
+    return true;
 }
 
 template<typename Derived>
@@ -146,50 +231,117 @@ void JsonRpcInterface<Derived>::onMessage(const std::string& message)
 }
 
 template<typename Derived>
-bool JsonRpcInterface<Derived>::getAsyncResponse(uint32_t id, std::future<string>& futureReponse, JsonRpc::Response& response)
+bool JsonRpcInterface<Derived>::takePendingRequest(uint32_t id, ResponseCallback& callback)
 {
-    switch (futureReponse.wait_for(std::chrono::seconds(5)))
+    std::lock_guard<std::mutex> lock(responseMutex_);
+    auto pending = pendingRequests_.find(id);
+    if (pending == pendingRequests_.end())
     {
-        case std::future_status::ready:
-            removePromise(id);
-            return processResponse(id, futureReponse.get(), response);
-        case std::future_status::timeout:
-            LOGERR("Timeout for request/response ID:%d", id);
-            removePromise(id);
-            return false;
-        case std::future_status::deferred:
-            LOGERR("Execution for request/response ID:%d deferred. Internal error.", id);  // "should not happen"
-            removePromise(id);
-            return false;
+        return false;
     }
-    return false;
+    callback = std::move(pending->second.callback);
+    deadlines_.erase(pending->second.deadline);
+    pendingRequests_.erase(pending);
+    if (deadlines_.empty())
+    {
+        cancelTimer();
+    }
+    return true;
 }
 
 template<typename Derived>
-boost::optional<std::future<string> > JsonRpcInterface<Derived>::createFutureResponse(uint32_t id)
+void JsonRpcInterface<Derived>::shutdown()
 {
-    std::lock_guard<std::mutex> lock(responseMutex_);
-    auto insertionResult = responseToPromise_.emplace(std::make_pair(id, std::promise<std::string>{} ));
-    if (!insertionResult.second)
+    std::map<uint32_t, PendingRequest> pending;
     {
-        LOGERR("Request with the same ID:%d already saved.", id);
-        return boost::none;
+        std::lock_guard<std::mutex> lock(responseMutex_);
+        stopped_ = true;
+        cancelTimer();
+        deadlines_.clear();
+        pending.swap(pendingRequests_);
+    }
+
+    for (auto& request : pending)
+    {
+        LOGERR("Endpoint shut down before response for ID:%d", request.first);
+        JsonRpc::Response response;
+        request.second.callback(false, response);
     }
-    return insertionResult.first->second.get_future();
 }
 
+// Called with responseMutex_ held, only ever for a deadline earlier than the armed one, which it supersedes
 template<typename Derived>
-void JsonRpcInterface<Derived>::removePromise(uint32_t id)
+void JsonRpcInterface<Derived>::armTimer(Clock::time_point deadline)
 {
-    std::lock_guard<std::mutex> lock(responseMutex_);
-    responseToPromise_.erase(id);
+    cancelTimer();
+    armedDeadline_ = deadline;
+
+    // Rounded up, so the timer does not fire just before the deadline
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count() + 1;
+    Derived& derived = static_cast<Derived&>(*this);
+    armedTimer_ = derived.endpointImpl_.set_timer(delay > 0 ? delay : 0, [this, deadline](websocketpp::lib::error_code const &ec) {
+        if (ec == websocketpp::transport::error::operation_aborted)
+        {
+            return;
+        }
+        onDeadline(deadline);
+    });
 }
 
+// Called with responseMutex_ held. The timer belongs to the event loop, so the cancel is run there.
 template<typename Derived>
-bool JsonRpcInterface<Derived>::isRequestProcessingOngoing(uint32_t id)
+void JsonRpcInterface<Derived>::cancelTimer()
 {
-    std::lock_guard<std::mutex> lock(responseMutex_);
-    return responseToPromise_.count(id) != 0;
+    armedDeadline_ = Clock::time_point::max();
+    if (armedTimer_)
+    {
+        TimerPtr timer;
+        timer.swap(armedTimer_);
+        Derived& derived = static_cast<Derived&>(*this);
+        derived.endpointImpl_.get_io_service().post([timer]() {
+            timer->cancel();
+        });
+    }
+}
+
+template<typename Derived>
+void JsonRpcInterface<Derived>::onDeadline(Clock::time_point deadline)
+{
+    std::vector<std::pair<uint32_t, ResponseCallback> > expired;
+    {
+        std::lock_guard<std::mutex> lock(responseMutex_);
+        if (deadline == armedDeadline_)
+        {
+            // Fired, nothing left to cancel
+            armedDeadline_ = Clock::time_point::max();
+            armedTimer_.reset();
+        }
+
+        const auto now = Clock::now();
+        while (!deadlines_.empty() && (deadlines_.begin()->first <= now))
+        {
+            auto pending = pendingRequests_.find(deadlines_.begin()->second);
+            expired.emplace_back(pending->first, std::move(pending->second.callback));
+            pendingRequests_.erase(pending);
+            deadlines_.erase(deadlines_.begin());
+        }
+
+        if (deadlines_.empty())
+        {
+            cancelTimer();
+        }
+        else if (deadlines_.begin()->first < armedDeadline_)
+        {
+            armTimer(deadlines_.begin()->first);
+        }
+    }
+
+    for (auto& request : expired)
+    {
+        LOGERR("Timeout for request/response ID:%d", request.first);
+        JsonRpc::Response response;
+        request.second(false, response);
+    }
 }
 
 template<typename Derived>
@@ -214,14 +366,16 @@ void JsonRpcInterface<Derived>::handleNotification(const std::string& message)
 template<typename Derived>
 void JsonRpcInterface<Derived>::handleResponse(uint32_t id, const std::string& message)
 {
-    std::lock_guard<std::mutex> lock(responseMutex_);
-    const auto& idToPromise = responseToPromise_.find(id);
-    if (idToPromise == responseToPromise_.end())
+    ResponseCallback callback;
+    if (!takePendingRequest(id, callback))
     {
         LOGERR("Can't find request with id:%d. Dropping response.", id);
         return;
     };
-    idToPromise->second.set_value(message);
+
+    JsonRpc::Response response;
+    bool success = processResponse(id, message, response);
+    callback(success, response);
 }
 
 template<typename Derived>
@@ -66,6 +66,7 @@ WSEndpoint<Role, MessagingInterface, PingPong, Encryption>::~WSEndpoint()
     LOGINFO();
     endpointImpl_.stop_perpetual();
     closeConnection();
+    MessagingInterface<WSEndpoint>::shutdown();
     stopEventLoop();
 }
 